@@ -0,0 +1,32 @@
+//  Simulator scenarios, one per subsystem. Each returns a process exit
+//  code: 0 when the run met its budget, 1 otherwise.
+
+#ifndef SCENARIOS_H_
+#define SCENARIOS_H_
+
+int simSensors(int argc, char** argv);
+int simBme280(int argc, char** argv);
+int simWarmboot(int argc, char** argv);
+int simI2cFaults(int argc, char** argv);
+int simNtag5(int argc, char** argv);
+int simNtagSram(int argc, char** argv);
+int simNtagWear(int argc, char** argv);
+int simNtagWrite(int argc, char** argv);
+int simFieldWake(int argc, char** argv);
+int simMculess(int argc, char** argv);
+int simPlanner(int argc, char** argv);
+int simHarvestBoot(int argc, char** argv);
+int simTagDetect(int argc, char** argv);
+int simNdefSwap(int argc, char** argv);
+int simEpd(int argc, char** argv);
+int simRender(int argc, char** argv);
+int simTrend(int argc, char** argv);
+int simBlink(int argc, char** argv);
+int simRail(int argc, char** argv);
+int simAlertWake(int argc, char** argv);
+int simProvision(int argc, char** argv);
+int simClock(int argc, char** argv);
+int simSupply(int argc, char** argv);
+int simBudget(int argc, char** argv);
+
+#endif /* SCENARIOS_H_ */
@@ -0,0 +1,113 @@
+#include "SimI2c.h"
+#include "Arduino.h"
+#include <string.h>
+
+SimI2cStats SimI2c::stats;
+
+static SimI2cDevice* devices[128];
+static uint32_t busHz = 100000;
+static uint32_t timeoutMicros = 0;
+static uint32_t startMicros = 0;
+
+static void busTime(uint16_t bits)
+{
+    uint32_t us = ((uint32_t)bits * 1000000UL + busHz - 1) / busHz;
+    SimI2c::stats.busMicros += us;
+    simAdvanceMicros(us);
+}
+
+void SimI2c::attach(uint8_t addr, SimI2cDevice* device)
+{
+    devices[addr & 0x7F] = device;
+}
+
+void SimI2c::detach(uint8_t addr)
+{
+    devices[addr & 0x7F] = 0;
+}
+
+void SimI2c::reset()
+{
+    memset(&stats, 0, sizeof(stats));
+}
+
+void SimI2c::setClock(uint32_t hz)
+{
+    busHz = hz;
+}
+
+uint32_t SimI2c::clock()
+{
+    return busHz;
+}
+
+uint32_t SimI2c::transactionStart()
+{
+    return startMicros;
+}
+
+void SimI2c::setTimeout(uint32_t us)
+{
+    timeoutMicros = us;
+}
+
+//  A stretching device holds SCL; Wire gives up after its timeout. Without
+//  a timeout the firmware would hang, the model just charges the full stretch.
+static bool stretched(SimI2cDevice* dev)
+{
+    uint32_t stretch = dev->stretchMicros();
+    if (!stretch)
+        return false;
+    if (timeoutMicros && stretch >= timeoutMicros)
+    {
+        SimI2c::stats.timeouts++;
+        SimI2c::stats.busMicros += timeoutMicros;
+        simAdvanceMicros(timeoutMicros);
+        return true;
+    }
+    SimI2c::stats.busMicros += stretch;
+    simAdvanceMicros(stretch);
+    return false;
+}
+
+uint8_t SimI2c::write(uint8_t addr, const uint8_t* data, uint8_t len)
+{
+    SimI2cDevice* dev = devices[addr & 0x7F];
+    startMicros = micros();
+    stats.transactions++;
+    if (!dev || !dev->acknowledge())
+    {
+        stats.nacks++;
+        busTime(1 + 9 + 1);
+        return 2;
+    }
+    if (stretched(dev))
+        return 5;
+    stats.bytes += len;
+    busTime(1 + 9 + 9 * (uint16_t)len + 1);
+    if (!dev->write(data, len))
+    {
+        stats.nacks++;
+        return 3;
+    }
+    return 0;
+}
+
+uint8_t SimI2c::read(uint8_t addr, uint8_t* data, uint8_t len)
+{
+    SimI2cDevice* dev = devices[addr & 0x7F];
+    startMicros = micros();
+    stats.transactions++;
+    if (!dev || !dev->acknowledge())
+    {
+        stats.nacks++;
+        busTime(1 + 9 + 1);
+        return 0;
+    }
+    if (stretched(dev))
+        return 0;
+    uint8_t got = dev->read(data, len);
+    stats.bytes += got;
+    busTime(1 + 9 + 9 * (uint16_t)got + 1);
+    return got;
+}
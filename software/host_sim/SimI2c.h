@@ -0,0 +1,56 @@
+//  Host-side I2C bus model
+//  -----------------------------------------
+//  Devices attach to a 7-bit address. The Wire shim forwards every
+//  transaction here and advances the virtual clock by the bit time of
+//  the transfer (START + address + 9 bits per byte + STOP).
+
+#ifndef SIM_I2C_H_
+#define SIM_I2C_H_
+
+#include <stdint.h>
+
+class SimI2cDevice
+{
+public:
+    virtual ~SimI2cDevice() {}
+    // address phase; return false to NACK (e.g. EEPROM programming)
+    virtual bool acknowledge() { return true; }
+    // one write transaction; return false to NACK a data byte
+    virtual bool write(const uint8_t* data, uint8_t len) = 0;
+    // one read transaction; return number of bytes delivered
+    virtual uint8_t read(uint8_t* data, uint8_t len) = 0;
+    // clock stretching before the transaction completes (latched-up part)
+    virtual uint32_t stretchMicros() { return 0; }
+};
+
+struct SimI2cStats
+{
+    uint32_t transactions;
+    uint32_t bytes;
+    uint32_t nacks;
+    uint32_t timeouts;
+    uint32_t busMicros;
+};
+
+class SimI2c
+{
+public:
+    static void attach(uint8_t addr, SimI2cDevice* device);
+    static void detach(uint8_t addr);
+    static void reset();
+
+    static void setClock(uint32_t hz);
+    static uint32_t clock();
+    static void setTimeout(uint32_t us);    // Wire timeout, 0 = wait forever
+
+    // called by the Wire shim; return Wire-style status / byte count
+    static uint8_t write(uint8_t addr, const uint8_t* data, uint8_t len);
+    static uint8_t read(uint8_t addr, uint8_t* data, uint8_t len);
+
+    // virtual time the last transaction began, for devices timing their side
+    static uint32_t transactionStart();
+
+    static SimI2cStats stats;
+};
+
+#endif /* SIM_I2C_H_ */
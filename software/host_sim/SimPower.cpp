@@ -0,0 +1,109 @@
+#include "SimPower.h"
+#include "Arduino.h"
+
+struct Load
+{
+    const char* name;
+    double   microAmps;
+    double   thenMicroAmps;
+    uint64_t until;
+    bool     pending;       // thenMicroAmps from until on
+    uint64_t since;         // integrated up to here
+    double   picoCoulombs;  // uA x us
+};
+
+static Load table[SimPower::MAX_LOADS];
+static uint8_t count = 0;
+
+//  charge up to now, taking a scheduled change on the way
+static Load& integrate(uint8_t id)
+{
+    Load& l = table[id];
+    uint64_t now = simMicros64();
+    if (l.pending && now >= l.until)
+    {
+        if (l.until > l.since)
+        {
+            l.picoCoulombs += l.microAmps * (double)(l.until - l.since);
+            l.since = l.until;
+        }
+        l.microAmps = l.thenMicroAmps;
+        l.pending = false;
+    }
+    l.picoCoulombs += l.microAmps * (double)(now - l.since);
+    l.since = now;
+    return l;
+}
+
+uint8_t SimPower::load(const char* name)
+{
+    if (count >= MAX_LOADS)
+        return NO_LOAD;
+    Load& l = table[count];
+    l.name = name;
+    l.microAmps = l.thenMicroAmps = 0;
+    l.pending = false;
+    l.since = simMicros64();
+    l.picoCoulombs = 0;
+    return count++;
+}
+
+void SimPower::set(uint8_t id, double microAmps)
+{
+    if (id >= count)
+        return;
+    Load& l = integrate(id);
+    l.microAmps = microAmps;
+    l.pending = false;
+}
+
+void SimPower::set(uint8_t id, double microAmps, uint32_t untilMicros, double thenMicroAmps)
+{
+    if (id >= count)
+        return;
+    Load& l = integrate(id);
+    l.microAmps = microAmps;
+    l.thenMicroAmps = thenMicroAmps;
+    l.until = simMicros64() + (int32_t)(untilMicros - micros());     // within 35 min either way
+    l.pending = true;
+    integrate(id);          // until may have passed already
+}
+
+double SimPower::current(uint8_t id)
+{
+    return id < count ? integrate(id).microAmps : 0;
+}
+
+double SimPower::charge(uint8_t id)
+{
+    return id < count ? integrate(id).picoCoulombs / 1e6 : 0;
+}
+
+double SimPower::total()
+{
+    double sum = 0;
+    for (uint8_t i = 0; i < count; i++)
+        sum += charge(i);
+    return sum;
+}
+
+void SimPower::clear()
+{
+    for (uint8_t i = 0; i < count; i++)
+        integrate(i).picoCoulombs = 0;
+}
+
+void SimPower::reset()
+{
+    count = 0;
+}
+
+uint8_t SimPower::loads()
+{
+    return count;
+}
+
+const char* SimPower::name(uint8_t id)
+{
+    return id < count ? table[id].name : "";
+}
@@ -0,0 +1,33 @@
+//  Host-side supply current model
+//  -----------------------------------------
+//  Device models register a load and report its current whenever their
+//  state changes; the charge is integrated on the virtual clock. A load
+//  can schedule its next current (the end of a conversion or a refresh),
+//  so nothing has to poll it. Loads without a registered id (NO_LOAD)
+//  are not metered.
+
+#ifndef SIM_POWER_H_
+#define SIM_POWER_H_
+
+#include <stdint.h>
+
+class SimPower
+{
+public:
+    static const uint8_t NO_LOAD = 0xFF;
+    static const uint8_t MAX_LOADS = 8;
+
+    static uint8_t load(const char* name);      // new load drawing nothing
+    static void set(uint8_t id, double microAmps);
+    static void set(uint8_t id, double microAmps, uint32_t untilMicros, double thenMicroAmps);
+    static double current(uint8_t id);          // uA now
+    static double charge(uint8_t id);           // uC since load() or clear()
+    static double total();                      // uC, all loads
+    static void clear();                        // charges back to 0, loads stay
+    static void reset();                        // forget all loads
+
+    static uint8_t loads();
+    static const char* name(uint8_t id);
+};
+
+#endif /* SIM_POWER_H_ */
@@ -0,0 +1,51 @@
+#include "SimSpi.h"
+#include "Arduino.h"
+#include <string.h>
+
+SimSpiStats SimSpi::stats;
+
+static SimSpiDevice* device = 0;
+static uint32_t busHz = 4000000UL;
+static bool on = false;
+static uint32_t nanos = 0;      // bit time below one microsecond, carried over
+
+void SimSpi::attach(SimSpiDevice* dev)
+{
+    device = dev;
+}
+
+void SimSpi::reset()
+{
+    memset(&stats, 0, sizeof(stats));
+}
+
+void SimSpi::enable(bool enable)
+{
+    on = enable;
+}
+
+bool SimSpi::enabled()
+{
+    return on;
+}
+
+void SimSpi::setClock(uint32_t hz)
+{
+    busHz = hz;
+}
+
+uint8_t SimSpi::transfer(uint8_t value)
+{
+    if (!on)
+    {
+        stats.disabled++;
+        return 0xFF;
+    }
+    stats.bytes++;
+    nanos += 8000000000ULL / busHz;
+    uint32_t us = nanos / 1000;
+    nanos %= 1000;
+    stats.busMicros += us;
+    simAdvanceMicros(us);
+    return device ? device->transfer(value) : 0xFF;
+}
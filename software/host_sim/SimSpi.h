@@ -0,0 +1,42 @@
+//  Host-side SPI bus model
+//  -----------------------------------------
+//  One device on the bus; it looks at its own select and D/C pins through
+//  digitalRead(). Every byte advances the virtual clock by 8 bit times at
+//  the clock of the last SPI.beginTransaction().
+
+#ifndef SIM_SPI_BUS_H_
+#define SIM_SPI_BUS_H_
+
+#include <stdint.h>
+
+class SimSpiDevice
+{
+public:
+    virtual ~SimSpiDevice() {}
+    virtual uint8_t transfer(uint8_t value) = 0;
+};
+
+struct SimSpiStats
+{
+    uint32_t bytes;
+    uint32_t busMicros;
+    uint32_t disabled;      // bytes sent while the peripheral was off
+};
+
+class SimSpi
+{
+public:
+    static void attach(SimSpiDevice* device);
+    static void reset();
+
+    static void enable(bool on);
+    static bool enabled();
+    static void setClock(uint32_t hz);
+
+    // called by the SPI shim
+    static uint8_t transfer(uint8_t value);
+
+    static SimSpiStats stats;
+};
+
+#endif /* SIM_SPI_BUS_H_ */
@@ -0,0 +1,235 @@
+#include "SimEpd.h"
+#include "Arduino.h"
+#include <string.h>
+
+SimEpd* SimEpd::active = 0;
+
+SimEpd::SimEpd(uint8_t cs, uint8_t dc, uint8_t res, uint8_t busy)
+    : _cs(cs), _dc(dc), _res(res), _busy(busy), _cmd(0), _count(0),
+      _xStart(0), _xEnd(EPD_ROW_BYTES - 1), _x(0), _yStart(0), _yEnd(EPD_HEIGHT - 1), _y(0),
+      _sequence(0), _asleep(false), _powered(true), _load(SimPower::NO_LOAD), _busyUntil(0)
+{
+    memset(&stats, 0, sizeof(stats));
+    noise();
+    memset(_panel, 0xFF, sizeof(_panel));
+    active = this;
+    simWatchPin(_res, onRes);
+    simSetPinSource(_busy, busyLevel);
+}
+
+SimEpd::~SimEpd()
+{
+    simWatchPin(_res, 0);
+    simSetPinSource(_busy, 0);
+    active = 0;
+}
+
+// power-up RAM content is undefined, make it visible
+void SimEpd::noise()
+{
+    for (uint16_t i = 0; i < sizeof(_ram); i++)
+        (&_ram[0][0][0])[i] = (uint8_t)(i * 0x9D + 0x5B + stats.resets);
+}
+
+void SimEpd::setPowered(bool on)
+{
+    if (on == _powered)
+        return;
+    _powered = on;
+    _asleep = false;
+    _busyUntil = micros();
+    _cmd = 0;
+    if (on)
+        noise();
+    meterState();
+}
+
+void SimEpd::meter(uint8_t load)
+{
+    _load = load;
+    meterState();
+}
+
+void SimEpd::meterState()
+{
+    if (!_powered)
+        SimPower::set(_load, 0);
+    else if (_asleep)
+        SimPower::set(_load, SLEEP_UA);
+    else if (busy())
+        SimPower::set(_load, _sequence & 0x04 ? BUSY_UA : IDLE_UA, _busyUntil, IDLE_UA);
+    else
+        SimPower::set(_load, IDLE_UA);
+}
+
+bool SimEpd::busy() const
+{
+    return _powered && (int32_t)(micros() - _busyUntil) < 0;
+}
+
+int SimEpd::busyLevel(uint8_t)
+{
+    return active && active->busy() ? HIGH : LOW;
+}
+
+void SimEpd::onRes(uint8_t, uint8_t level)
+{
+    if (!active || level != LOW || !active->_powered)
+        return;
+    SimEpd& epd = *active;
+    epd._asleep = false;
+    epd._xStart = epd._x = 0;
+    epd._xEnd = EPD_ROW_BYTES - 1;
+    epd._yStart = epd._y = 0;
+    epd._yEnd = EPD_HEIGHT - 1;
+    epd._cmd = 0;
+    epd._busyUntil = micros() + RESET_US;
+    epd.stats.busyMicros += RESET_US;
+    epd.stats.resets++;
+    epd._sequence = 0;
+    epd.meterState();
+}
+
+const uint8_t* SimEpd::ram(uint8_t cmd) const
+{
+    return &_ram[cmd == EPD_CMD_WRITE_PREVIOUS][0][0];
+}
+
+uint32_t SimEpd::stale() const
+{
+    uint32_t bits = 0;
+    for (uint16_t y = 0; y < EPD_HEIGHT; y++)
+        for (uint8_t x = 0; x < EPD_ROW_BYTES; x++)
+            bits += __builtin_popcount(_panel[y][x] ^ _ram[0][y][x]);
+    return bits;
+}
+
+uint8_t SimEpd::transfer(uint8_t value)
+{
+    if (digitalRead(_cs) != LOW)
+        return 0xFF;
+    if (!_powered)
+    {
+        stats.whileOff++;
+        return 0xFF;
+    }
+    if (_asleep)
+    {
+        stats.whileAsleep++;
+        return 0xFF;
+    }
+    if (busy())
+    {
+        stats.whileBusy++;
+        return 0xFF;
+    }
+    if (digitalRead(_dc) == LOW)
+        command(value);
+    else
+        data(value);
+    return 0xFF;
+}
+
+void SimEpd::command(uint8_t cmd)
+{
+    stats.commands++;
+    _cmd = cmd;
+    _count = 0;
+    switch (cmd)
+    {
+    case EPD_CMD_ACTIVATE:
+    {
+        if (!(_sequence & 0x04))
+            break;
+        bool partial = _sequence & 0x08;
+        for (uint16_t y = 0; y < EPD_HEIGHT; y++)
+            for (uint8_t x = 0; x < EPD_ROW_BYTES; x++)
+            {
+                uint8_t move = partial ? _ram[0][y][x] ^ _ram[1][y][x] : 0xFF;
+                _panel[y][x] = (_panel[y][x] & ~move) | (_ram[0][y][x] & move);
+            }
+        uint32_t us = partial ? PARTIAL_US : FULL_US;
+        _busyUntil = micros() + us;
+        stats.busyMicros += us;
+        if (partial)
+            stats.partialRefreshes++;
+        else
+            stats.fullRefreshes++;
+        meterState();
+        break;
+    }
+    case EPD_CMD_SW_RESET:
+        _busyUntil = micros() + RESET_US;
+        stats.busyMicros += RESET_US;
+        break;
+    case EPD_CMD_WRITE_BW:
+    case EPD_CMD_WRITE_PREVIOUS:
+    case EPD_CMD_DRIVER_OUTPUT:
+    case EPD_CMD_DEEP_SLEEP:
+    case EPD_CMD_DATA_ENTRY:
+    case EPD_CMD_TEMP_SENSOR:
+    case EPD_CMD_UPDATE_CTRL2:
+    case EPD_CMD_BORDER:
+    case EPD_CMD_RAM_X_RANGE:
+    case EPD_CMD_RAM_Y_RANGE:
+    case EPD_CMD_RAM_X_COUNTER:
+    case EPD_CMD_RAM_Y_COUNTER:
+        break;
+    default:
+        stats.unsupported++;
+    }
+}
+
+void SimEpd::data(uint8_t value)
+{
+    if (_cmd == EPD_CMD_WRITE_BW || _cmd == EPD_CMD_WRITE_PREVIOUS)
+    {
+        if (_x < EPD_ROW_BYTES && _y < EPD_HEIGHT)
+            _ram[_cmd == EPD_CMD_WRITE_PREVIOUS][_y][_x] = value;
+        stats.ramBytes++;
+        if (++_x > _xEnd)
+        {
+            _x = _xStart;
+            _y = _y >= _yEnd ? _yStart : _y + 1;
+        }
+        return;
+    }
+    if (_count < sizeof(_params))
+        _params[_count] = value;
+    _count++;
+    switch (_cmd)
+    {
+    case EPD_CMD_DATA_ENTRY:
+        if (value != EPD_DATA_ENTRY_XY_INC)
+            stats.unsupported++;
+        break;
+    case EPD_CMD_UPDATE_CTRL2:
+        _sequence = value;
+        break;
+    case EPD_CMD_DEEP_SLEEP:
+        _asleep = value != 0;
+        meterState();
+        break;
+    case EPD_CMD_RAM_X_RANGE:
+        if (_count == 2)
+        {
+            _xStart = _params[0];
+            _xEnd = _params[1];
+        }
+        break;
+    case EPD_CMD_RAM_Y_RANGE:
+        if (_count == 4)
+        {
+            _yStart = _params[0] | _params[1] << 8;
+            _yEnd = _params[2] | _params[3] << 8;
+        }
+        break;
+    case EPD_CMD_RAM_X_COUNTER:
+        _x = _params[0];
+        break;
+    case EPD_CMD_RAM_Y_COUNTER:
+        if (_count == 2)
+            _y = _params[0] | _params[1] << 8;
+        break;
+    }
+}
@@ -0,0 +1,85 @@
+//  SSD1680 e-paper controller model, the subset Epd uses: RAM windows and
+//  address counters (data entry mode 3 only), the two image RAMs, display
+//  update sequences and deep sleep. CS and D/C are read from the pins, a
+//  falling RES wakes the controller (RAM kept) and BUSY is driven from the
+//  refresh time. The panel image follows the controller: a full refresh
+//  copies the new image, a partial one (display mode 2) only moves pixels
+//  where the new and the reference image differ, so a stale reference
+//  leaves pixels behind (stale()). Bytes sent while BUSY or asleep are
+//  counted, the controller would drop them. The supply can be switched:
+//  off loses both RAMs (noise again at power-up) and keeps the panel
+//  image; the supply current goes to SimPower.
+
+#ifndef SIM_EPD_H_
+#define SIM_EPD_H_
+
+#include "../SimSpi.h"
+#include "../SimPower.h"
+#include "Epd.h"
+
+struct SimEpdStats
+{
+    uint32_t commands;
+    uint32_t ramBytes;
+    uint32_t fullRefreshes;
+    uint32_t partialRefreshes;
+    uint32_t busyMicros;        // refresh and reset time, BUSY high
+    uint32_t whileBusy;         // bytes sent while BUSY was high
+    uint32_t whileAsleep;       // bytes sent in deep sleep
+    uint32_t resets;
+    uint32_t whileOff;          // bytes sent without supply
+    uint32_t unsupported;       // commands or modes outside the model
+};
+
+class SimEpd : public SimSpiDevice
+{
+public:
+    static const uint32_t RESET_US   = 1500;
+    static const uint32_t FULL_US    = 2900000UL;
+    static const uint32_t PARTIAL_US = 420000UL;
+    static constexpr double SLEEP_UA = 1;       // deep sleep
+    static constexpr double IDLE_UA  = 150;     // awake, booster off
+    static constexpr double BUSY_UA  = 3000;    // refresh, booster and panel
+
+    SimEpd(uint8_t cs, uint8_t dc, uint8_t res, uint8_t busy);
+    ~SimEpd();
+
+    uint8_t transfer(uint8_t value);
+    void setPowered(bool on);
+    bool powered() const { return _powered; }
+    void meter(uint8_t load);
+
+    bool busy() const;
+    bool asleep() const { return _asleep; }
+    const uint8_t* panel() const { return &_panel[0][0]; }     // EPD_HEIGHT rows of EPD_ROW_BYTES
+    const uint8_t* ram(uint8_t cmd) const;
+    uint32_t stale() const;     // panel pixels that differ from the new image
+
+    SimEpdStats stats;
+
+private:
+    static void onRes(uint8_t pin, uint8_t level);
+    static int busyLevel(uint8_t pin);
+    void command(uint8_t cmd);
+    void data(uint8_t value);
+    void noise();
+    void meterState();
+
+    static SimEpd* active;
+
+    uint8_t  _ram[2][EPD_HEIGHT][EPD_ROW_BYTES];
+    uint8_t  _panel[EPD_HEIGHT][EPD_ROW_BYTES];
+    uint8_t  _cs, _dc, _res, _busy;
+    uint8_t  _cmd;
+    uint8_t  _params[4];
+    uint8_t  _count;
+    uint8_t  _xStart, _xEnd, _x;
+    uint16_t _yStart, _yEnd, _y;
+    uint8_t  _sequence;
+    bool     _asleep;
+    bool     _powered;
+    uint8_t  _load;
+    uint32_t _busyUntil;
+};
+
+#endif /* SIM_EPD_H_ */
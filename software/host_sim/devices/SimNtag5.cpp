@@ -0,0 +1,298 @@
+#include "SimNtag5.h"
+#include "Arduino.h"
+#include <string.h>
+
+SimNtag5::SimNtag5()
+    : _block(0), _offset(0), _sessionRead(false), _sessionReg(0), _sessionIndex(0), _present(true),
+      _busyNack(false), _programUs(PROGRAM_US), _busyUntil(0), _hook(0)
+{
+    memset(&stats, 0, sizeof(stats));
+    memset(_user, 0, sizeof(_user));
+    memset(_config, 0, sizeof(_config));
+    memset(_programs, 0, sizeof(_programs));
+    powerCycle();
+}
+
+void SimNtag5::powerCycle()
+{
+    memset(_sram, 0, sizeof(_sram));
+    memset(_session, 0, sizeof(_session));
+    _session[0][1] = NTAG5_STATUS1_VCC_BOOT_OK;
+    _session[0][0] = NTAG5_STATUS0_VCC_SUPPLY_OK;
+    memcpy(sessionPtr(NTAG5_REG_CONFIG), blockPtr(NTAG5_CFG_CONFIG), NTAG5_BLOCK_SIZE);
+    memcpy(sessionPtr(NTAG5_REG_EH_CONFIG), blockPtr(NTAG5_CFG_EH_CONFIG), NTAG5_BLOCK_SIZE);
+}
+
+bool SimNtag5::masterMode() const
+{
+    return (session(NTAG5_REG_CONFIG, 1) & NTAG5_CONFIG1_USE_CASE_MASK) == NTAG5_CONFIG1_USE_CASE_MASTER;
+}
+
+bool SimNtag5::vout() const
+{
+    return (session(NTAG5_REG_EH_CONFIG, 0) & NTAG5_EH_ENABLE) && (_session[0][0] & NTAG5_STATUS0_NFC_FIELD_OK);
+}
+
+void SimNtag5::masterStatus(uint8_t status)
+{
+    sessionPtr(NTAG5_REG_I2C_MASTER_STATUS)[0] = status;
+}
+
+bool SimNtag5::rfWriteI2c(uint8_t param, const uint8_t* data, uint8_t len)
+{
+    if (!(_session[0][0] & NTAG5_STATUS0_NFC_FIELD_OK) || !masterMode())
+        return false;
+    uint8_t status = NTAG5_I2C_M_NACK_ADDR;
+    if (vout())
+    {
+        stats.masterTransfers++;
+        uint8_t rc = SimI2c::write(param & 0x7F, data, len);
+        status = rc == 0 ? NTAG5_I2C_M_TRANS_OK : rc == 3 ? NTAG5_I2C_M_NACK_DATA : NTAG5_I2C_M_NACK_ADDR;
+    }
+    masterStatus(status);
+    return true;
+}
+
+bool SimNtag5::rfReadI2c(uint8_t param, uint8_t len)
+{
+    if (!(_session[0][0] & NTAG5_STATUS0_NFC_FIELD_OK) || !masterMode() || len > SRAM_BYTES)
+        return false;
+    uint8_t status = NTAG5_I2C_M_NACK_ADDR;
+    if (vout())
+    {
+        stats.masterTransfers++;
+        status = SimI2c::read(param & 0x7F, _sram, len) == len ? NTAG5_I2C_M_TRANS_OK : NTAG5_I2C_M_NACK_ADDR;
+    }
+    masterStatus(status);
+    return true;
+}
+
+bool SimNtag5::rfReadSram(uint8_t* out, uint8_t block, uint8_t count) const
+{
+    if (!(_session[0][0] & NTAG5_STATUS0_NFC_FIELD_OK) || block + count > NTAG5_SRAM_BLOCKS)
+        return false;
+    memcpy(out, _sram + block * NTAG5_BLOCK_SIZE, count * NTAG5_BLOCK_SIZE);
+    return true;
+}
+
+bool SimNtag5::rfReadConfig(uint8_t addr, uint8_t* out)
+{
+    if (!(_session[0][0] & NTAG5_STATUS0_NFC_FIELD_OK))
+        return false;
+    uint16_t block = CONFIG_BASE + addr;
+    if (block >= SESSION_BASE && block < SESSION_BASE + SESSION_REGS)
+    {
+        for (uint8_t i = 0; i < NTAG5_BLOCK_SIZE; i++)
+            out[i] = block == SESSION_BASE && i == 0 ? status0() : session(block, i);
+        return true;
+    }
+    memcpy(out, blockPtr(block), NTAG5_BLOCK_SIZE);
+    return true;
+}
+
+bool SimNtag5::rfWriteConfig(uint8_t addr, const uint8_t* data)
+{
+    if (!(_session[0][0] & NTAG5_STATUS0_NFC_FIELD_OK))
+        return false;
+    uint16_t block = CONFIG_BASE + addr;
+    if (block >= SESSION_BASE && block < SESSION_BASE + SESSION_REGS)
+    {
+        memcpy(sessionPtr(block), data, NTAG5_BLOCK_SIZE);
+        return true;
+    }
+    return writeBlock(block, data);
+}
+
+bool SimNtag5::mirrorOn() const
+{
+    uint8_t config1 = session(NTAG5_REG_CONFIG, 1);
+    return (config1 & NTAG5_CONFIG1_ARBITER_MASK) == NTAG5_CONFIG1_ARBITER_MIRROR &&
+           (config1 & NTAG5_CONFIG1_SRAM_ENABLE);
+}
+
+bool SimNtag5::edAsserted() const
+{
+    return (session(NTAG5_REG_ED_CONFIG, 0) & NTAG5_ED_MASK) == NTAG5_ED_NFC_FIELD &&
+           (_session[0][0] & NTAG5_STATUS0_NFC_FIELD_OK);
+}
+
+void SimNtag5::rfView(uint8_t* out, uint16_t block, uint16_t count) const
+{
+    for (uint16_t b = block; b < block + count; b++, out += NTAG5_BLOCK_SIZE)
+    {
+        bool mirrored = mirrorOn() && b - NTAG5_SRAM_MIRROR_BLOCK < NTAG5_SRAM_BLOCKS;
+        const uint8_t* src = mirrored ? _sram + (b - NTAG5_SRAM_MIRROR_BLOCK) * NTAG5_BLOCK_SIZE
+                                      : _user + (b % NTAG5_USER_BLOCKS) * NTAG5_BLOCK_SIZE;
+        memcpy(out, src, NTAG5_BLOCK_SIZE);
+    }
+}
+
+void SimNtag5::setField(bool on)
+{
+    if (on)
+        _session[0][0] |= NTAG5_STATUS0_NFC_FIELD_OK;
+    else
+        _session[0][0] &= ~NTAG5_STATUS0_NFC_FIELD_OK;
+}
+
+uint8_t SimNtag5::session(uint16_t reg, uint8_t index) const
+{
+    return _session[(reg - SESSION_BASE) % SESSION_REGS][index & 3];
+}
+
+uint16_t SimNtag5::hottestBlock() const
+{
+    uint16_t hottest = 0;
+    for (uint16_t b = 1; b < NTAG5_USER_BLOCKS; b++)
+        if (_programs[b] > _programs[hottest])
+            hottest = b;
+    return hottest;
+}
+
+bool SimNtag5::busy() const
+{
+    return (int32_t)(micros() - _busyUntil) < 0;
+}
+
+bool SimNtag5::acknowledge()
+{
+    if (!_present || masterMode())
+        return false;           // as I2C master the tag has no slave interface
+    if (_busyNack && busy())
+    {
+        stats.busyNacks++;
+        return false;
+    }
+    stats.transactions++;
+    return true;
+}
+
+uint8_t SimNtag5::status0()
+{
+    uint8_t status = _session[0][0];
+    if (busy())
+        status |= NTAG5_STATUS0_EEPROM_WR_BUSY;
+    return status;
+}
+
+uint8_t* SimNtag5::blockPtr(uint16_t block)
+{
+    uint32_t byte = (uint32_t)block * NTAG5_BLOCK_SIZE;
+    if (block < NTAG5_USER_BLOCKS)
+        return _user + byte;
+    if (block >= CONFIG_BASE && block < CONFIG_BASE + 0x100)
+        return _config + (byte - (uint32_t)CONFIG_BASE * NTAG5_BLOCK_SIZE);
+    if (block >= NTAG5_SRAM_BLOCK && block < NTAG5_SRAM_BLOCK + NTAG5_SRAM_BLOCKS)
+        return _sram + (byte - (uint32_t)NTAG5_SRAM_BLOCK * NTAG5_BLOCK_SIZE);
+    return 0;
+}
+
+bool SimNtag5::writeBlock(uint16_t block, const uint8_t* data)
+{
+    uint8_t* p = blockPtr(block);
+    if (!p)
+        return false;
+    memcpy(p, data, NTAG5_BLOCK_SIZE);
+    if (block >= NTAG5_SRAM_BLOCK)
+    {
+        stats.sramBlockWrites++;
+        return true;
+    }
+    stats.blockWrites++;
+    if (block < NTAG5_USER_BLOCKS)
+        _programs[block]++;
+    uint32_t now = micros();
+    if ((int32_t)(now - _busyUntil) >= 0)
+        _busyUntil = now;
+    _busyUntil += _programUs;
+    stats.programMicros += _programUs;
+    return true;
+}
+
+bool SimNtag5::write(const uint8_t* data, uint8_t len)
+{
+    bool ok = store(data, len);
+    if (ok && _hook)
+        _hook(*this);
+    return ok;
+}
+
+bool SimNtag5::store(const uint8_t* data, uint8_t len)
+{
+    if (len < 2)
+        return true;
+    uint16_t addr = (uint16_t)data[0] << 8 | data[1];
+    data += 2;
+    len -= 2;
+
+    if (addr >= SESSION_BASE && addr < SESSION_BASE + SESSION_REGS)
+    {
+        uint8_t* reg = _session[addr - SESSION_BASE];
+        if (len == 1)
+        {
+            _sessionRead = true;
+            _sessionReg = addr;
+            _sessionIndex = data[0] & 3;
+            return true;
+        }
+        if (len != 3)
+            return false;
+        uint8_t index = data[0] & 3, mask = data[1];
+        reg[index] = (reg[index] & ~mask) | (data[2] & mask);
+        return true;
+    }
+
+    _sessionRead = false;
+    _block = addr;
+    _offset = 0;
+    if (!len)
+        return true;
+    if (len % NTAG5_BLOCK_SIZE)
+    {
+        stats.misaligned++;
+        return false;
+    }
+    for (uint8_t i = 0; i < len; i += NTAG5_BLOCK_SIZE)
+        if (!writeBlock(addr++, data + i))
+            return false;
+    return true;
+}
+
+uint8_t SimNtag5::read(uint8_t* data, uint8_t len)
+{
+    if (_sessionRead)
+    {
+        for (uint8_t i = 0; i < len; i++)
+            data[i] = _sessionReg == SESSION_BASE && _sessionIndex == 0 ? status0()
+                                                                        : session(_sessionReg, _sessionIndex);
+        return len;
+    }
+    for (uint8_t i = 0; i < len; i++)
+    {
+        uint8_t* p = blockPtr(_block);
+        data[i] = p ? p[_offset] : 0;
+        if (++_offset == NTAG5_BLOCK_SIZE)
+        {
+            _offset = 0;
+            _block++;
+            stats.blockReads++;
+        }
+    }
+    return len;
+}
+
+uint8_t SimNtag5::textImage(uint8_t* out, const char* text)
+{
+    static const uint8_t header[9] = { 0x03, 0, 0xD1, 0x01, 0, 'T', 0x02, 'e', 'n' };
+    uint8_t len = strlen(text);
+    memcpy(out, header, sizeof(header));
+    out[1] = 7 + len;
+    out[4] = 3 + len;
+    uint8_t n = sizeof(header);
+    memcpy(out + n, text, len);
+    n += len;
+    out[n++] = 0xFE;
+    uint8_t blocks = (n + NTAG5_BLOCK_SIZE - 1) / NTAG5_BLOCK_SIZE;
+    memset(out + n, 0, blocks * NTAG5_BLOCK_SIZE - n);
+    return blocks;
+}
@@ -0,0 +1,113 @@
+//  NTAG 5 Link model, I2C side: 4-byte blocks behind 16-bit block
+//  addresses, session registers with REGA/MASK access, configuration
+//  blocks and SRAM. Writes must cover whole blocks; anything else is NACKed
+//  and counted, so a driver doing partial-block writes shows up at once.
+//  EEPROM blocks take PROGRAM_US each (setProgramMicros()), EEPROM_WR_BUSY
+//  is set meanwhile. With setBusyNack() the tag also NACKs its address
+//  until programming is done, as the part does on I2C. programs() counts
+//  the cycles of every user block. edAsserted() follows the field when ED
+//  is configured for NFC field detect.
+//
+//  RF side for the MCU-less boards: with the master use case active (from
+//  the configuration at power-up or the session register) and a field, the
+//  rf* commands run I2C transactions on the SimI2c bus as master, READ_I2C
+//  results land in SRAM. With energy harvesting off VOUT stays down and the
+//  sensor, powered from it, does not answer. rfReadConfig()/rfWriteConfig()
+//  take the 8-bit RF configuration address, session registers at A0h..AFh.
+//  rfView() is what a reader gets, SRAM included while the mirror is on.
+//  The write hook runs after each acknowledged write transaction, so a
+//  scenario can decode what a reader polling the tag would have seen.
+
+#ifndef SIM_NTAG5_H_
+#define SIM_NTAG5_H_
+
+#include "../SimI2c.h"
+#include "Ntag5.h"
+
+struct SimNtag5Stats
+{
+    uint32_t blockWrites;       // EEPROM blocks written over I2C
+    uint32_t sramBlockWrites;
+    uint32_t blockReads;
+    uint32_t misaligned;        // writes that were not whole blocks
+    uint32_t transactions;      // acknowledged reads and writes
+    uint32_t busyNacks;         // addresses refused while programming
+    uint32_t programMicros;     // EEPROM programming time
+    uint32_t masterTransfers;   // I2C transactions run as master
+};
+
+class SimNtag5 : public SimI2cDevice
+{
+public:
+    static const uint16_t USER_BYTES   = NTAG5_USER_BLOCKS * NTAG5_BLOCK_SIZE;
+    static const uint16_t CONFIG_BASE  = 0x1000;
+    static const uint16_t CONFIG_BYTES = 0x100 * NTAG5_BLOCK_SIZE;
+    static const uint16_t SESSION_BASE = 0x10A0;
+    static const uint16_t SESSION_REGS = 16;
+    static const uint16_t SRAM_BYTES   = NTAG5_SRAM_BLOCKS * NTAG5_BLOCK_SIZE;
+    static const uint32_t PROGRAM_US   = 4000;     // per EEPROM block
+
+    SimNtag5();
+
+    bool acknowledge();
+    bool write(const uint8_t* data, uint8_t len);
+    uint8_t read(uint8_t* data, uint8_t len);
+
+    void setPresent(bool present) { _present = present; }
+    void setBusyNack(bool on) { _busyNack = on; }
+    void setProgramMicros(uint32_t us) { _programUs = us; }
+    bool busy() const;
+    void setField(bool on);
+    void powerCycle();          // session registers and SRAM lost
+    void setWriteHook(void (*hook)(const SimNtag5& tag)) { _hook = hook; }
+
+    void rfView(uint8_t* out, uint16_t block, uint16_t count) const;
+    bool mirrorOn() const;
+    bool edAsserted() const;    // ED output pulled low
+    bool masterMode() const;
+    bool vout() const;          // harvested supply up
+
+    // RF side custom commands, false if the tag would not answer
+    bool rfWriteI2c(uint8_t param, const uint8_t* data, uint8_t len);
+    bool rfReadI2c(uint8_t param, uint8_t len);
+    bool rfReadSram(uint8_t* out, uint8_t block, uint8_t count) const;
+    bool rfReadConfig(uint8_t addr, uint8_t* out);
+    bool rfWriteConfig(uint8_t addr, const uint8_t* data);
+
+    const uint8_t* user() const { return _user; }
+    const uint8_t* sram() const { return _sram; }
+    uint8_t session(uint16_t reg, uint8_t index) const;
+    uint32_t programs(uint16_t block) const { return _programs[block % NTAG5_USER_BLOCKS]; }
+    uint16_t hottestBlock() const;
+
+    // reference encoding of a text record TLV, zero padded; returns blocks
+    static uint8_t textImage(uint8_t* out, const char* text);
+
+    SimNtag5Stats stats;
+
+protected:
+    uint8_t* blockPtr(uint16_t block);
+    uint8_t* sessionPtr(uint16_t reg) { return _session[(reg - SESSION_BASE) % SESSION_REGS]; }
+    void masterStatus(uint8_t status);
+    virtual bool writeBlock(uint16_t block, const uint8_t* data);
+    bool store(const uint8_t* data, uint8_t len);
+    virtual uint8_t status0();
+
+    uint8_t  _user[USER_BYTES];
+    uint8_t  _config[CONFIG_BYTES];
+    uint8_t  _sram[SRAM_BYTES];
+    uint32_t _programs[NTAG5_USER_BLOCKS];
+    uint8_t  _session[SESSION_REGS][4];
+    uint16_t _block;            // read pointer, memory
+    uint8_t  _offset;
+    bool     _sessionRead;      // read pointer targets a session register
+    uint16_t _sessionReg;
+    uint8_t  _sessionIndex;
+    bool     _present;
+    bool     _busyNack;
+    uint32_t _programUs;
+    uint32_t _busyUntil;
+    void   (*_hook)(const SimNtag5& tag);
+};
+
+#endif /* SIM_NTAG5_H_ */
@@ -0,0 +1,107 @@
+#include "SimRf430.h"
+#include "Arduino.h"
+#include "RF430CL330H_Shield.h"
+#include <string.h>
+
+SimRf430::SimRf430()
+    : _pointer(0), _present(true), _nacks(0), _stretch(0), _rfBusyUntil(0), _memWrites(0), _hook(0)
+{
+    memset(_mem, 0, sizeof(_mem));
+    memset(_regs, 0, sizeof(_regs));
+    _regs[(VERSION_REG - REG_BASE) / 2] = 0x0301;
+}
+
+void SimRf430::setRfBusyFor(uint32_t us)
+{
+    _rfBusyUntil = micros() + us;
+}
+
+uint16_t SimRf430::reg(uint16_t addr) const
+{
+    return _regs[(addr - REG_BASE) / 2];
+}
+
+uint16_t SimRf430::rfRead(uint8_t* out, uint16_t max) const
+{
+    if (!(reg(CONTROL_REG) & RF_ENABLE))
+        return 0;
+    // NDEF application name, then the CC file: E103, CCLEN, ..., File Control TLV
+    const uint16_t cc = 7;
+    if ((_mem[cc] << 8 | _mem[cc + 1]) != 0xE103 || _mem[cc + 9] != 0x04)
+        return 0;
+    uint16_t wanted = _mem[cc + 11] << 8 | _mem[cc + 12];
+    uint16_t extent = 2 + (_mem[cc + 13] << 8 | _mem[cc + 14]);
+    for (uint16_t at = cc + 2 + (_mem[cc + 2] << 8 | _mem[cc + 3]); at + 4 <= MEMORY_SIZE; at += extent)
+    {
+        if ((_mem[at] << 8 | _mem[at + 1]) != wanted)
+            continue;
+        uint16_t nlen = _mem[at + 2] << 8 | _mem[at + 3];
+        if (nlen > max || nlen + 2 > extent || at + 4 + nlen > MEMORY_SIZE)
+            return 0;
+        memcpy(out, _mem + at + 4, nlen);
+        return nlen;
+    }
+    return 0;
+}
+
+bool SimRf430::acknowledge()
+{
+    if (!_present)
+        return false;
+    if (_nacks)
+    {
+        _nacks--;
+        return false;
+    }
+    return true;
+}
+
+uint8_t SimRf430::readByte(uint16_t addr)
+{
+    if (addr >= REG_BASE)
+    {
+        uint16_t value = _regs[(addr - REG_BASE) / 2];
+        if ((addr & ~1) == STATUS_REG)
+        {
+            value |= READY;
+            if ((int32_t)(micros() - _rfBusyUntil) < 0)
+                value |= RF_BUSY;
+        }
+        return addr & 1 ? value >> 8 : value & 0xFF;
+    }
+    return addr < MEMORY_SIZE ? _mem[addr] : 0;
+}
+
+void SimRf430::writeByte(uint16_t addr, uint8_t value)
+{
+    if (addr >= REG_BASE)
+    {
+        uint16_t& r = _regs[(addr - REG_BASE) / 2];
+        r = addr & 1 ? (r & 0x00FF) | (uint16_t)value << 8 : (r & 0xFF00) | value;
+        return;
+    }
+    if (addr < MEMORY_SIZE)
+    {
+        _mem[addr] = value;
+        _memWrites++;
+    }
+}
+
+bool SimRf430::write(const uint8_t* data, uint8_t len)
+{
+    if (len < 2)
+        return true;
+    _pointer = (uint16_t)data[0] << 8 | data[1];
+    for (uint8_t i = 2; i < len; i++)
+        writeByte(_pointer++, data[i]);
+    if (_hook)
+        _hook(*this);
+    return true;
+}
+
+uint8_t SimRf430::read(uint8_t* data, uint8_t len)
+{
+    for (uint8_t i = 0; i < len; i++)
+        data[i] = readByte(_pointer++);
+    return len;
+}
@@ -0,0 +1,60 @@
+//  RF430CL330H model: 16-bit addressed NDEF memory plus the virtual
+//  registers at 0xFFE0..0xFFFE (little endian on the bus). Fault knobs let
+//  scenarios take the part away, NACK a few transactions or latch it up.
+//
+//  RF side: rfRead() is the NDEF message a reader gets at this instant,
+//  nothing while RF_ENABLE is clear. It follows the Type 4 procedure: the
+//  CC's File Control TLV names the NDEF file, which is looked up by its ID
+//  from the CC file on. The model takes every file after the CC as
+//  reserving the Max NDEF size the CC announces. The write hook runs after
+//  each write transaction, so a scenario can watch what a reader would
+//  have seen during an update (SimI2c::transactionStart() to micros()).
+
+#ifndef SIM_RF430_H_
+#define SIM_RF430_H_
+
+#include "../SimI2c.h"
+
+class SimRf430 : public SimI2cDevice
+{
+public:
+    static const uint16_t MEMORY_SIZE = 3072;
+    static const uint16_t REG_BASE    = 0xFFE0;
+
+    SimRf430();
+
+    bool acknowledge();
+    bool write(const uint8_t* data, uint8_t len);
+    uint8_t read(uint8_t* data, uint8_t len);
+    uint32_t stretchMicros() { return _stretch; }
+
+    // faults
+    void setPresent(bool present) { _present = present; }
+    void nackNext(uint8_t count) { _nacks = count; }
+    void setStretch(uint32_t us) { _stretch = us; }
+    void setRfBusyFor(uint32_t us);
+
+    // RF side: message bytes (after NLEN) into out, returns NLEN, 0 if none
+    uint16_t rfRead(uint8_t* out, uint16_t max) const;
+    void setWriteHook(void (*hook)(const SimRf430& tag)) { _hook = hook; }
+
+    uint16_t reg(uint16_t addr) const;
+    const uint8_t* memory() const { return _mem; }
+    uint32_t memoryWrites() const { return _memWrites; }
+
+private:
+    uint8_t readByte(uint16_t addr);
+    void writeByte(uint16_t addr, uint8_t value);
+
+    uint8_t  _mem[MEMORY_SIZE];
+    uint16_t _regs[16];
+    uint16_t _pointer;
+    bool     _present;
+    uint8_t  _nacks;
+    uint32_t _stretch;
+    uint32_t _rfBusyUntil;
+    uint32_t _memWrites;
+    void   (*_hook)(const SimRf430& tag);
+};
+
+#endif /* SIM_RF430_H_ */
@@ -0,0 +1,490 @@
+#include "SimSensors.h"
+#include "Arduino.h"
+#include <math.h>
+
+bool SimRegisterDevice::write(const uint8_t* data, uint8_t len)
+{
+    if (len == 0)
+        return true;
+    _pointer = data[0];
+    for (uint8_t i = 1; i < len; i++)
+        writeByte(_pointer++, data[i]);
+    return true;
+}
+
+uint8_t SimRegisterDevice::read(uint8_t* data, uint8_t len)
+{
+    for (uint8_t i = 0; i < len; i++)
+        data[i] = readByte(_pointer++);
+    return len;
+}
+
+// ---------------------------------------------------------------- TMP1xx
+
+bool SimTmp1xx::write(const uint8_t* data, uint8_t len)
+{
+    if (len == 0)
+        return true;
+    _pointer = data[0] & 0x0F;
+    if (len >= 3)
+    {
+        writeRegister(_pointer, (uint16_t)data[1] << 8 | data[2]);
+        meterState();
+        trackAlertMode();
+    }
+    return true;
+}
+
+void SimTmp1xx::setPowered(bool on)
+{
+    if (on == _powered)
+        return;
+    _powered = on;
+    _converting = false;
+    _pointer = 0;
+    if (on)
+        powerOn();
+    meterState();
+    trackAlertMode();
+}
+
+//  the comparator starts over when thermostat mode starts or stops
+void SimTmp1xx::trackAlertMode()
+{
+    uint32_t period = _powered ? alertPeriodMicros() : 0;
+    if (period == _alertPeriod)
+        return;
+    _alertPeriod = period;
+    _nextCompare = micros() + period;
+    _alert = false;
+    _faults = 0;
+}
+
+bool SimTmp1xx::alertActive()
+{
+    trackAlertMode();
+    if (!_alertPeriod)
+        return _alert;
+    while ((int32_t)(micros() - _nextCompare) >= 0)
+    {
+        int16_t raw = (int16_t)rawTemperature();
+        _regs[0] = (uint16_t)raw;                   // each conversion updates the result
+        bool past = _alert ? raw < lowLimit() : raw >= highLimit();
+        _faults = past ? _faults + 1 : 0;
+        if (_faults >= faultQueue())
+        {
+            _alert = !_alert;
+            _faults = 0;
+        }
+        _nextCompare += _alertPeriod;
+    }
+    return _alert;
+}
+
+void SimTmp1xx::meter(uint8_t load)
+{
+    _load = load;
+    meterState();
+}
+
+void SimTmp1xx::meterState()
+{
+    if (!_powered)
+        SimPower::set(_load, 0);
+    else if (_converting)
+        SimPower::set(_load, convertingMicroAmps(), _conversionEnd, idleMicroAmps());
+    else
+        SimPower::set(_load, idleMicroAmps());
+}
+
+uint8_t SimTmp1xx::read(uint8_t* data, uint8_t len)
+{
+    uint16_t value = readRegister(_pointer);
+    for (uint8_t i = 0; i < len; i++)
+        data[i] = (i & 1) ? value & 0xFF : value >> 8;
+    return len;
+}
+
+void SimTmp1xx::startConversion(uint32_t us)
+{
+    _converting = true;
+    _conversionEnd = micros() + us;
+}
+
+bool SimTmp1xx::conversionDone()
+{
+    if (_converting && (int32_t)(micros() - _conversionEnd) >= 0)
+    {
+        _converting = false;
+        _regs[0] = rawTemperature();
+        return true;
+    }
+    return false;
+}
+
+SimTmp112::SimTmp112()
+{
+    _regs[1] = 0x60A0;
+    _regs[2] = 0x4B00;
+    _regs[3] = 0x5000;
+}
+
+//  continuous at 4 Hz, the first result after one conversion time
+void SimTmp112::powerOn()
+{
+    memset(_regs, 0, sizeof(_regs));
+    _regs[1] = 0x60A0;
+    _regs[2] = 0x4B00;
+    _regs[3] = 0x5000;
+    startConversion(CONVERSION_US);
+}
+
+//  conversion rate from CR1 CR0: 0.25, 1, 4 or 8 Hz
+static const uint32_t TMP112_PERIOD_US[4] = { 4000000UL, 1000000UL, 250000UL, 125000UL };
+
+double SimTmp112::idleMicroAmps()
+{
+    if (_regs[1] & 0x0100)
+        return 0.5;                             // shutdown
+    return 0.5 + 9.5 * 250000.0 / TMP112_PERIOD_US[_regs[1] >> 6 & 3];    // 10 uA at 4 Hz
+}
+
+uint32_t SimTmp112::alertPeriodMicros()
+{
+    bool comparator = !(_regs[1] & 0x0200);
+    return (_regs[1] & 0x0100) || !comparator ? 0 : TMP112_PERIOD_US[_regs[1] >> 6 & 3];
+}
+
+uint8_t SimTmp112::faultQueue()
+{
+    static const uint8_t queue[4] = { 1, 2, 4, 6 };
+    return queue[_regs[1] >> 11 & 3];
+}
+
+int16_t SimTmp112::highLimit()
+{
+    return (int16_t)_regs[3];
+}
+
+int16_t SimTmp112::lowLimit()
+{
+    return (int16_t)_regs[2];
+}
+
+double SimTmp112::convertingMicroAmps()
+{
+    return 40;
+}
+
+uint16_t SimTmp112::rawTemperature()
+{
+    int32_t counts = ((int32_t)_centi * 16) / 100;
+    return (uint16_t)(counts << 4);
+}
+
+uint16_t SimTmp112::readRegister(uint8_t reg)
+{
+    bool shutdown = _regs[1] & 0x0100;
+    conversionDone();
+    if (!shutdown && !_converting)
+        _regs[0] = rawTemperature();
+    if (reg == 1)
+        return (_regs[1] & 0x7FFF) | (_converting ? 0 : 0x8000);
+    return reg < 4 ? _regs[reg] : 0;
+}
+
+void SimTmp112::writeRegister(uint8_t reg, uint16_t value)
+{
+    if (reg == 1)
+    {
+        _regs[1] = (value & 0x7FFF) | 0x6000;
+        if ((value & 0x0100) && (value & 0x8000))
+            startConversion(CONVERSION_US);
+    }
+    else if (reg == 2 || reg == 3)
+        _regs[reg] = value;
+}
+
+//  factory EEPROM: continuous, 8 averages, limits at the range ends,
+//  some NIST ID in EEPROM1..3
+SimTmp117::SimTmp117() : _unlocked(false), _programming(false), _programEnd(0)
+{
+    memset(&stats, 0, sizeof(stats));
+    memset(_eeprom, 0, sizeof(_eeprom));
+    _eeprom[1] = 0x0220;
+    _eeprom[2] = 0x6000;
+    _eeprom[3] = 0x8000;
+    _eeprom[5] = 0x1E4F;
+    _eeprom[6] = 0x02A7;
+    _eeprom[8] = 0x9C31;
+    powerOn();
+}
+
+//  the EEPROM image; the first result is not modelled
+void SimTmp117::powerOn()
+{
+    memcpy(_regs, _eeprom, sizeof(_regs));
+    _regs[0] = 0x8000;
+    _regs[0x0F] = 0x0117;
+    _unlocked = false;
+}
+
+bool SimTmp117::eepromBusy()
+{
+    if (_programming && (int32_t)(micros() - _programEnd) >= 0)
+        _programming = false;
+    return _programming;
+}
+
+//  continuous cycle from CONV and AVG: the cycle time, but at least the
+//  averaged conversions
+static uint32_t tmp117CycleMicros(uint16_t config, uint8_t& averages)
+{
+    static const uint32_t cycle[8] = { 15500, 125000, 250000, 500000, 1000000, 4000000, 8000000, 16000000 };
+    static const uint8_t avg[4] = { 1, 8, 32, 64 };
+    averages = avg[config >> 5 & 3];
+    uint32_t us = cycle[config >> 7 & 7];
+    return us > averages * 15500UL ? us : averages * 15500UL;
+}
+
+double SimTmp117::idleMicroAmps()
+{
+    uint16_t mod = _regs[1] & 0x0C00;
+    if (mod == 0x0400 || mod == 0x0C00)
+        return 0.15;                            // shutdown, also after a one-shot
+    uint8_t averages;
+    uint32_t us = tmp117CycleMicros(_regs[1], averages);
+    return 1.25 + 0.28 * averages * 1e6 / us;   // standby plus 0.28 uC per conversion: 3.5 uA at 1 Hz x 8
+}
+
+uint32_t SimTmp117::alertPeriodMicros()
+{
+    uint16_t mod = _regs[1] & 0x0C00;
+    uint8_t averages;
+    return mod == 0x0400 || mod == 0x0C00 || !(_regs[1] & 0x0010) ? 0 : tmp117CycleMicros(_regs[1], averages);
+}
+
+uint8_t SimTmp117::faultQueue()
+{
+    return 1;
+}
+
+int16_t SimTmp117::highLimit()
+{
+    return (int16_t)_regs[2];
+}
+
+int16_t SimTmp117::lowLimit()
+{
+    return (int16_t)_regs[3];
+}
+
+double SimTmp117::convertingMicroAmps()
+{
+    return 135;
+}
+
+uint16_t SimTmp117::rawTemperature()
+{
+    return (uint16_t)(int16_t)(((int32_t)_centi * 128) / 100);
+}
+
+uint16_t SimTmp117::readRegister(uint8_t reg)
+{
+    alertActive();
+    if (conversionDone())
+        _regs[1] |= 0x2000;
+    uint16_t value = _regs[reg & 0x0F];
+    if (reg == 4)
+        value = (_unlocked ? 0x8000 : 0) | (eepromBusy() ? 0x4000 : 0);
+    if (reg == 0 || reg == 1)
+        _regs[1] &= ~0x2000;
+    return value;
+}
+
+void SimTmp117::writeRegister(uint8_t reg, uint16_t value)
+{
+    reg &= 0x0F;
+    if (eepromBusy())
+    {
+        stats.writesWhileBusy++;
+        return;
+    }
+    if (reg == 4)
+    {
+        _unlocked = value & 0x8000;
+        return;
+    }
+    if (reg == 1)
+    {
+        _regs[1] = (_regs[1] & 0xF000) | (value & 0x0FFE);
+        if ((value & 0x0C00) == 0x0C00)
+            startConversion(CONVERSION_US);
+        value &= 0x0FFE;
+    }
+    else if (reg != 0 && reg != 0x0F)
+        _regs[reg] = value;
+    if (_unlocked && reg >= 1 && reg <= 8 && reg != 4)
+    {
+        _eeprom[reg] = value;
+        _programming = true;
+        _programEnd = micros() + EEPROM_WRITE_US;
+        stats.eepromWrites++;
+    }
+}
+
+// ---------------------------------------------------------------- BME280
+
+static const uint16_t T1 = 27504;
+static const int16_t  T2 = 26435, T3 = -1000;
+static const uint16_t P1 = 36477;
+static const int16_t  P2 = -10685, P3 = 3024, P4 = 2855, P5 = 140, P6 = -7, P7 = 15500, P8 = -14600, P9 = 6000;
+static const uint8_t  H1 = 75, H3 = 0;
+static const int16_t  H2 = 362, H4 = 313, H5 = 50;
+static const int8_t   H6 = 30;
+
+// floating point reference compensation from the datasheet (section 8.1)
+static double refTFine(double adcT)
+{
+    double var1 = (adcT / 16384.0 - T1 / 1024.0) * T2;
+    double var2 = (adcT / 131072.0 - T1 / 8192.0) * (adcT / 131072.0 - T1 / 8192.0) * T3;
+    return var1 + var2;
+}
+
+static double refPressure(double adcP, double tFine)
+{
+    double var1 = tFine / 2.0 - 64000.0;
+    double var2 = var1 * var1 * P6 / 32768.0;
+    var2 = var2 + var1 * P5 * 2.0;
+    var2 = var2 / 4.0 + P4 * 65536.0;
+    var1 = (P3 * var1 * var1 / 524288.0 + P2 * var1) / 524288.0;
+    var1 = (1.0 + var1 / 32768.0) * P1;
+    double p = 1048576.0 - adcP;
+    p = (p - var2 / 4096.0) * 6250.0 / var1;
+    var1 = P9 * p * p / 2147483648.0;
+    var2 = p * P8 / 32768.0;
+    return p + (var1 + var2 + P7) / 16.0;
+}
+
+static double refHumidity(double adcH, double tFine)
+{
+    double h = tFine - 76800.0;
+    h = (adcH - (H4 * 64.0 + H5 / 16384.0 * h)) *
+        (H2 / 65536.0 * (1.0 + H6 / 67108864.0 * h * (1.0 + H3 / 67108864.0 * h)));
+    h = h * (1.0 - H1 * h / 524288.0);
+    return h < 0 ? 0 : (h > 100 ? 100 : h);
+}
+
+// smallest adc code whose reference value reaches target (f monotonic)
+template <class F>
+static uint32_t invert(F f, double target, uint32_t hi, bool increasing)
+{
+    uint32_t lo = 0;
+    while (lo < hi)
+    {
+        uint32_t mid = (lo + hi) / 2;
+        bool below = increasing ? f(mid) < target : f(mid) > target;
+        if (below)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+SimBme280::SimBme280() : _measureEnd(0), _measuring(false)
+{
+    memset(_mem, 0, sizeof(_mem));
+    _mem[0xD0] = 0x60;
+    const uint16_t cal[12] = { T1, (uint16_t)T2, (uint16_t)T3, P1, (uint16_t)P2, (uint16_t)P3,
+                               (uint16_t)P4, (uint16_t)P5, (uint16_t)P6, (uint16_t)P7, (uint16_t)P8, (uint16_t)P9 };
+    for (uint8_t i = 0; i < 12; i++)
+    {
+        _mem[0x88 + 2 * i] = cal[i] & 0xFF;
+        _mem[0x89 + 2 * i] = cal[i] >> 8;
+    }
+    _mem[0xA1] = H1;
+    _mem[0xE1] = (uint16_t)H2 & 0xFF;
+    _mem[0xE2] = (uint16_t)H2 >> 8;
+    _mem[0xE3] = H3;
+    _mem[0xE4] = H4 >> 4;
+    _mem[0xE5] = (H4 & 0x0F) | (H5 & 0x0F) << 4;
+    _mem[0xE6] = H5 >> 4;
+    _mem[0xE7] = (uint8_t)H6;
+    setEnvironment(2345, 100653, 450);
+}
+
+void SimBme280::setEnvironment(int16_t centiCelsius, uint32_t pascal, uint16_t permille)
+{
+    _celsius = centiCelsius / 100.0;
+    _pascal = pascal;
+    _humidity = permille / 10.0;
+}
+
+uint32_t SimBme280::measurementMicros() const
+{
+    static const uint8_t over[8] = { 0, 1, 2, 4, 8, 16, 16, 16 };
+    uint8_t t = over[_mem[0xF4] >> 5], p = over[(_mem[0xF4] >> 2) & 7], h = over[_mem[0xF2] & 7];
+    uint32_t us = 1250 + 2300UL * t;
+    if (p)
+        us += 2300UL * p + 575;
+    if (h)
+        us += 2300UL * h + 575;
+    return us;
+}
+
+void SimBme280::update()
+{
+    if (!_measuring || (int32_t)(micros() - _measureEnd) < 0)
+        return;
+    _measuring = false;
+    _mem[0xF3] &= ~0x08;
+    _mem[0xF4] &= ~0x03;
+
+    double target = _celsius * 5120.0;
+    uint32_t adcT = invert([](uint32_t a) { return refTFine(a); }, target, 0xFFFFF, true);
+    double tFine = refTFine(adcT);
+    uint32_t adcP = invert([tFine](uint32_t a) { return refPressure(a, tFine); }, _pascal, 0xFFFFF, false);
+    uint32_t adcH = invert([tFine](uint32_t a) { return refHumidity(a, tFine); }, _humidity, 0xFFFF, true);
+
+    if (!(_mem[0xF4] >> 5))
+        adcT = 0x80000;
+    if (!((_mem[0xF4] >> 2) & 7))
+        adcP = 0x80000;
+    if (!(_mem[0xF2] & 7))
+        adcH = 0x8000;
+
+    _mem[0xF7] = adcP >> 12;
+    _mem[0xF8] = (adcP >> 4) & 0xFF;
+    _mem[0xF9] = (adcP & 0x0F) << 4;
+    _mem[0xFA] = adcT >> 12;
+    _mem[0xFB] = (adcT >> 4) & 0xFF;
+    _mem[0xFC] = (adcT & 0x0F) << 4;
+    _mem[0xFD] = adcH >> 8;
+    _mem[0xFE] = adcH & 0xFF;
+}
+
+uint8_t SimBme280::readByte(uint8_t reg)
+{
+    update();
+    return _mem[reg];
+}
+
+void SimBme280::writeByte(uint8_t reg, uint8_t value)
+{
+    update();
+    if (reg == 0xE0 && value == 0xB6)
+    {
+        _mem[0xF2] = _mem[0xF4] = _mem[0xF5] = 0;
+        return;
+    }
+    if (reg != 0xF2 && reg != 0xF4 && reg != 0xF5)
+        return;
+    _mem[reg] = value;
+    if (reg == 0xF4 && (value & 0x03) && (value & 0x03) != 0x03)
+    {
+        _measuring = true;
+        _measureEnd = micros() + measurementMicros();
+        _mem[0xF3] |= 0x08;
+    }
+}
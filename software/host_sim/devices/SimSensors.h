@@ -0,0 +1,157 @@
+//  Register-level models of the temperature sensors placed on the boards.
+//  Conversions complete on the virtual clock, so polling and delays in the
+//  firmware translate directly into simulated wake time. The TMP1xx models
+//  can be switched off and on (power-on defaults, the TMP112 converts right
+//  away) and report their supply current to SimPower. In thermostat mode
+//  they compare a conversion every period against the limits, with the
+//  fault queue, and drive ALERT; the temperature register itself reads
+//  the live value while converting continuously. The TMP117 keeps CONFIG,
+//  the limits, the offset and EEPROM1..3 in an EEPROM that is programmed
+//  while unlocked and loaded at power-up.
+
+#ifndef SIM_SENSORS_H_
+#define SIM_SENSORS_H_
+
+#include "../SimI2c.h"
+#include "../SimPower.h"
+#include <string.h>
+
+//  Devices addressed through an 8-bit register pointer
+class SimRegisterDevice : public SimI2cDevice
+{
+public:
+    SimRegisterDevice() : _pointer(0) {}
+    bool write(const uint8_t* data, uint8_t len);
+    uint8_t read(uint8_t* data, uint8_t len);
+
+protected:
+    virtual uint8_t readByte(uint8_t reg) = 0;
+    virtual void writeByte(uint8_t reg, uint8_t value) = 0;
+
+    uint8_t _pointer;
+};
+
+//  TMP112 and TMP117 share the 16-bit register layout
+class SimTmp1xx : public SimRegisterDevice
+{
+public:
+    SimTmp1xx() : _centi(2345), _conversionEnd(0), _converting(false), _powered(true), _load(SimPower::NO_LOAD),
+                  _alert(false), _faults(0), _alertPeriod(0), _nextCompare(0)
+    {
+        memset(_regs, 0, sizeof(_regs));
+    }
+    void setTemperature(int16_t centiCelsius) { _centi = centiCelsius; }
+    void setPowered(bool on);
+    bool powered() const { return _powered; }
+    void meter(uint8_t load);       // SimPower load for the supply current
+    bool acknowledge() { return _powered; }
+    bool alertActive();             // ALERT low, after the comparisons due by now
+    bool write(const uint8_t* data, uint8_t len);
+    uint8_t read(uint8_t* data, uint8_t len);
+
+protected:
+    uint8_t readByte(uint8_t) { return 0; }
+    void writeByte(uint8_t, uint8_t) {}
+
+    virtual uint16_t rawTemperature() = 0;
+    virtual uint16_t readRegister(uint8_t reg) = 0;
+    virtual void writeRegister(uint8_t reg, uint16_t value) = 0;
+    virtual void powerOn() = 0;                 // registers to their power-on state
+    virtual double idleMicroAmps() = 0;         // between conversions, per config
+    virtual double convertingMicroAmps() = 0;
+    virtual uint32_t alertPeriodMicros() = 0;   // thermostat mode conversion period, 0 if off
+    virtual uint8_t faultQueue() = 0;
+    virtual int16_t highLimit() = 0;
+    virtual int16_t lowLimit() = 0;
+    void startConversion(uint32_t us);
+    bool conversionDone();
+    void meterState();
+    void trackAlertMode();
+
+    int16_t  _centi;
+    uint32_t _conversionEnd;
+    bool     _converting;
+    bool     _powered;
+    uint8_t  _load;
+    bool     _alert;
+    uint8_t  _faults;
+    uint32_t _alertPeriod;
+    uint32_t _nextCompare;
+    uint16_t _regs[16];
+};
+
+class SimTmp112 : public SimTmp1xx
+{
+public:
+    SimTmp112();
+    static const uint32_t CONVERSION_US = 26000;
+
+protected:
+    uint16_t rawTemperature();
+    uint16_t readRegister(uint8_t reg);
+    void writeRegister(uint8_t reg, uint16_t value);
+    void powerOn();
+    double idleMicroAmps();
+    double convertingMicroAmps();
+    uint32_t alertPeriodMicros();
+    uint8_t faultQueue();
+    int16_t highLimit();
+    int16_t lowLimit();
+};  
+
+class SimTmp117 : public SimTmp1xx
+{
+public:
+    SimTmp117();
+    static const uint32_t CONVERSION_US = 15500;
+    static const uint32_t EEPROM_WRITE_US = 7000;
+
+    struct Stats
+    {
+        uint32_t eepromWrites;
+        uint32_t writesWhileBusy;       // lost, the part ignores them
+    } stats;
+
+    uint16_t eeprom(uint8_t reg) const { return _eeprom[reg & 0x0F]; }
+
+protected:
+    uint16_t rawTemperature();
+    uint16_t readRegister(uint8_t reg);
+    void writeRegister(uint8_t reg, uint16_t value);
+    void powerOn();
+    double idleMicroAmps();
+    double convertingMicroAmps();
+    uint32_t alertPeriodMicros();
+    uint8_t faultQueue();
+    int16_t highLimit();
+    int16_t lowLimit();
+
+private:
+    bool eepromBusy();
+
+    uint16_t _eeprom[16];
+    bool     _unlocked;
+    bool     _programming;
+    uint32_t _programEnd;
+};
+
+//  BME280 with the calibration example from the Bosch datasheet
+class SimBme280 : public SimRegisterDevice
+{
+public:
+    SimBme280();
+    void setEnvironment(int16_t centiCelsius, uint32_t pascal, uint16_t permille);
+
+protected:
+    uint8_t readByte(uint8_t reg);
+    void writeByte(uint8_t reg, uint8_t value);
+    uint32_t measurementMicros() const;
+    void update();
+
+    uint8_t  _mem[256];
+    double   _celsius, _pascal, _humidity;
+    uint32_t _measureEnd;
+    bool     _measuring;
+};
+
+#endif /* SIM_SENSORS_H_ */
@@ -0,0 +1,23 @@
+//  Firmware translation units built into the simulator. The firmware is
+//  compiled unchanged against the Arduino/Wire shims in shim/.
+
+#include "../nfc_sense/I2cBus.cpp"
+#include "../nfc_sense/Sensors.cpp"
+#include "../nfc_sense/Bme280.cpp"
+#include "../nfc_sense/WarmState.cpp"
+#include "../nfc_sense/Ntag5.cpp"
+#include "../nfc_sense/FieldWake.cpp"
+#include "../nfc_sense/Ntag5Master.cpp"
+#include "../nfc_sense/HarvestBoot.cpp"
+#include "../nfc_sense/TagBackend.cpp"
+#include "../nfc_sense/Standby.cpp"
+#include "../nfc_sense/Rail.cpp"
+#include "../nfc_sense/Epd.cpp"
+#include "../nfc_sense/GlyphLine.cpp"
+#include "../nfc_sense/Sparkline.cpp"
+#include "../nfc_sense/Display.cpp"
+#include "../nfc_sense/Indicator.cpp"
+#include "../nfc_sense/Clock.cpp"
+#include "../nfc_sense/Supply.cpp"
+#include "../nfc_sense/Budget.cpp"
+#include "../nfc_sense/RF430CL330H_Shield.cpp"
@@ -0,0 +1,180 @@
+#include "Arduino.h"
+#include <stdio.h>
+
+SimSerial Serial;
+SimRstctrl RSTCTRL = { 0x01 };
+
+static uint64_t nowMicros;
+static uint8_t pinModes[SIM_PIN_COUNT];
+static uint8_t pinLevels[SIM_PIN_COUNT];
+static void (*pinWatches[SIM_PIN_COUNT])(uint8_t pin, uint8_t level);
+static int (*pinSources[SIM_PIN_COUNT])(uint8_t pin);
+static bool pinDisabled[SIM_PIN_COUNT];
+
+uint32_t millis()
+{
+    return (uint32_t)(nowMicros / 1000);
+}
+
+uint32_t micros()
+{
+    return (uint32_t)nowMicros;
+}
+
+void delay(uint32_t ms)
+{
+    nowMicros += (uint64_t)ms * 1000;
+}
+
+void delayMicroseconds(uint32_t us)
+{
+    nowMicros += us;
+}
+
+void simAdvanceMicros(uint32_t us)
+{
+    nowMicros += us;
+}
+
+uint64_t simMicros64()
+{
+    return nowMicros;
+}
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+    if (pin < SIM_PIN_COUNT)
+        pinModes[pin] = mode;
+}
+
+void digitalWrite(uint8_t pin, uint8_t value)
+{
+    if (pin >= SIM_PIN_COUNT)
+        return;
+    pinLevels[pin] = value ? HIGH : LOW;
+    if (pinWatches[pin])
+        pinWatches[pin](pin, pinLevels[pin]);
+}
+
+int digitalRead(uint8_t pin)
+{
+    if (pin >= SIM_PIN_COUNT || pinDisabled[pin])
+        return LOW;
+    return pinSources[pin] ? pinSources[pin](pin) : pinLevels[pin];
+}
+
+//  like megaTinyCore: pinMode() leaves ISC alone, attaching an interrupt
+//  sets the sense mode and with it the input buffer on
+void attachInterrupt(uint8_t pin, void (*)(), int)
+{
+    if (pin < SIM_PIN_COUNT)
+        pinDisabled[pin] = false;
+}
+
+void detachInterrupt(uint8_t pin)
+{
+    if (pin < SIM_PIN_COUNT)
+        pinDisabled[pin] = false;
+}
+
+void simWatchPin(uint8_t pin, void (*watch)(uint8_t pin, uint8_t level))
+{
+    if (pin < SIM_PIN_COUNT)
+        pinWatches[pin] = watch;
+}
+
+void simSetPinSource(uint8_t pin, int (*source)(uint8_t pin))
+{
+    if (pin < SIM_PIN_COUNT)
+        pinSources[pin] = source;
+}
+
+void simSetPin(uint8_t pin, uint8_t value)
+{
+    digitalWrite(pin, value);
+}
+
+void simDisableInput(uint8_t pin)
+{
+    if (pin < SIM_PIN_COUNT)
+        pinDisabled[pin] = true;
+}
+
+uint8_t simPinMode(uint8_t pin)
+{
+    return pin < SIM_PIN_COUNT ? pinModes[pin] : INPUT;
+}
+
+String::String(const char* s) : _len(strlen(s))
+{
+    _buf = (char*)malloc(_len + 1);
+    memcpy(_buf, s, _len + 1);
+}
+
+String::String(const String& other) : String(other._buf) {}
+
+String::~String()
+{
+    free(_buf);
+}
+
+String& String::operator=(const String& other)
+{
+    if (this != &other)
+    {
+        String copy(other);
+        char* buf = _buf;
+        _buf = copy._buf;
+        _len = copy._len;
+        copy._buf = buf;
+    }
+    return *this;
+}
+
+String String::operator+(const String& rhs) const
+{
+    char* joined = (char*)malloc(_len + rhs._len + 1);
+    memcpy(joined, _buf, _len);
+    memcpy(joined + _len, rhs._buf, rhs._len + 1);
+    String result(joined);
+    free(joined);
+    return result;
+}
+
+String operator+(const char* lhs, const String& rhs)
+{
+    return String(lhs) + rhs;
+}
+
+void String::getBytes(unsigned char* buf, unsigned int size) const
+{
+    if (!size)
+        return;
+    unsigned int n = _len < size - 1 ? _len : size - 1;
+    memcpy(buf, _buf, n);
+    buf[n] = 0;
+}
+
+void SimSerial::print(const char* s)
+{
+    if (enabled)
+        fputs(s, stderr);
+}
+
+void SimSerial::print(long value, int base)
+{
+    if (enabled)
+        fprintf(stderr, base == HEX ? "%lX" : "%ld", value);
+}
+
+void SimSerial::println(const char* s)
+{
+    if (enabled)
+        fprintf(stderr, "%s\n", s);
+}
+
+void SimSerial::println(long value, int base)
+{
+    print(value, base);
+    println();
+}
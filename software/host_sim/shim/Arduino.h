@@ -0,0 +1,88 @@
+//  Minimal Arduino core for compiling firmware modules on the host.
+//  Time is virtual: delay() and bus traffic advance it, nothing sleeps.
+
+#ifndef SIM_ARDUINO_H_
+#define SIM_ARDUINO_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdlib.h>
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define HIGH    1
+#define LOW     0
+#define INPUT   0
+#define OUTPUT  1
+#define INPUT_PULLUP 2
+#define DEC     10
+#define HEX     16
+
+#define SIM_PIN_COUNT 32
+
+uint32_t millis();
+uint32_t micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+void attachInterrupt(uint8_t pin, void (*isr)(), int mode);    // input buffer back on, as ISC
+void detachInterrupt(uint8_t pin);
+#define digitalPinToInterrupt(p) (p)
+#define CHANGE  1
+#define FALLING 2
+
+// simulator hooks
+void simAdvanceMicros(uint32_t us);
+uint64_t simMicros64();                         // micros() without the wrap
+void simSetPin(uint8_t pin, uint8_t value);     // drive an input from a model
+uint8_t simPinMode(uint8_t pin);
+void simWatchPin(uint8_t pin, void (*watch)(uint8_t pin, uint8_t level));  // called on digitalWrite
+void simSetPinSource(uint8_t pin, int (*source)(uint8_t pin));             // digitalRead from a model
+void simDisableInput(uint8_t pin);  // ISC INPUT_DISABLE as Board::init() leaves it, reads LOW
+
+// reset flag register, set by the simulator before each simulated boot
+struct SimRstctrl
+{
+    uint8_t RSTFR;
+};
+extern SimRstctrl RSTCTRL;
+
+// just enough of WString for the NDEF text helpers
+class String
+{
+public:
+    String(const char* s = "");
+    String(const String& other);
+    ~String();
+    String& operator=(const String& other);
+    String operator+(const String& rhs) const;
+    unsigned int length() const { return _len; }
+    const char* c_str() const { return _buf; }
+    void getBytes(unsigned char* buf, unsigned int size) const;
+
+private:
+    char* _buf;
+    unsigned int _len;
+};
+String operator+(const char* lhs, const String& rhs);
+
+class SimSerial
+{
+public:
+    void begin(uint32_t) {}
+    void flush() {}
+    void print(const char* s);
+    void print(long value, int base = DEC);
+    void println(const char* s = "");
+    void println(long value, int base = DEC);
+    bool enabled;
+};
+
+extern SimSerial Serial;
+
+#endif /* SIM_ARDUINO_H_ */
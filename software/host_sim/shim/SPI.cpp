@@ -0,0 +1,24 @@
+#include "SPI.h"
+#include "../SimSpi.h"
+
+SPIClass SPI;
+
+void SPIClass::begin()
+{
+    SimSpi::enable(true);
+}
+
+void SPIClass::end()
+{
+    SimSpi::enable(false);
+}
+
+void SPIClass::beginTransaction(const SPISettings& settings)
+{
+    SimSpi::setClock(settings.clock);
+}
+
+uint8_t SPIClass::transfer(uint8_t value)
+{
+    return SimSpi::transfer(value);
+}
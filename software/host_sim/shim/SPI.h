@@ -0,0 +1,31 @@
+//  SPI shim routing bytes into the SimSpi bus model.
+
+#ifndef SIM_SPI_H_
+#define SIM_SPI_H_
+
+#include "Arduino.h"
+
+#define MSBFIRST    1
+#define LSBFIRST    0
+#define SPI_MODE0   0x00
+
+class SPISettings
+{
+public:
+    SPISettings(uint32_t clock = 4000000UL, uint8_t = MSBFIRST, uint8_t = SPI_MODE0) : clock(clock) {}
+    uint32_t clock;
+};
+
+class SPIClass
+{
+public:
+    void begin();
+    void end();
+    void beginTransaction(const SPISettings& settings);
+    void endTransaction() {}
+    uint8_t transfer(uint8_t value);
+};
+
+extern SPIClass SPI;
+
+#endif /* SIM_SPI_H_ */
@@ -0,0 +1,60 @@
+#include "Wire.h"
+#include "../SimI2c.h"
+
+TwoWire Wire;
+
+void TwoWire::setClock(uint32_t hz)
+{
+    SimI2c::setClock(hz);
+}
+
+void TwoWire::setWireTimeout(uint32_t timeout, bool)
+{
+    SimI2c::setTimeout(timeout);
+}
+
+void TwoWire::beginTransmission(uint8_t addr)
+{
+    _addr = addr;
+    _txLen = 0;
+}
+
+size_t TwoWire::write(uint8_t value)
+{
+    if (_txLen >= BUFFER_LENGTH)
+        return 0;
+    _tx[_txLen++] = value;
+    return 1;
+}
+
+size_t TwoWire::write(const uint8_t* data, size_t len)
+{
+    size_t n = 0;
+    while (n < len && write(data[n]))
+        n++;
+    return n;
+}
+
+uint8_t TwoWire::endTransmission(bool)
+{
+    return SimI2c::write(_addr, _tx, _txLen);
+}
+
+uint8_t TwoWire::requestFrom(uint8_t addr, uint8_t len, bool)
+{
+    if (len > BUFFER_LENGTH)
+        len = BUFFER_LENGTH;
+    _rxLen = SimI2c::read(addr, _rx, len);
+    _rxPos = 0;
+    return _rxLen;
+}
+
+int TwoWire::available()
+{
+    return _rxLen - _rxPos;
+}
+
+int TwoWire::read()
+{
+    return _rxPos < _rxLen ? _rx[_rxPos++] : -1;
+}
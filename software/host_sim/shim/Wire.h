@@ -0,0 +1,38 @@
+//  Wire (TwoWire) shim routing transactions into the SimI2c bus model.
+
+#ifndef SIM_WIRE_H_
+#define SIM_WIRE_H_
+
+#include "Arduino.h"
+
+#define BUFFER_LENGTH 32
+#define WIRE_HAS_TIMEOUT
+
+class TwoWire
+{
+public:
+    void begin() {}
+    void end() {}
+    void setClock(uint32_t hz);
+    void setWireTimeout(uint32_t timeout, bool resetOnTimeout = false);
+
+    void beginTransmission(uint8_t addr);
+    size_t write(uint8_t value);
+    size_t write(const uint8_t* data, size_t len);
+    uint8_t endTransmission(bool sendStop = true);
+
+    uint8_t requestFrom(uint8_t addr, uint8_t len, bool sendStop = true);
+    int available();
+    int read();
+
+private:
+    uint8_t _addr;
+    uint8_t _tx[BUFFER_LENGTH];
+    uint8_t _txLen;
+    uint8_t _rx[BUFFER_LENGTH];
+    uint8_t _rxLen, _rxPos;
+};
+
+extern TwoWire Wire;
+
+#endif /* SIM_WIRE_H_ */
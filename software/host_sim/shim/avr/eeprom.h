@@ -0,0 +1,20 @@
+//  avr-libc EEPROM API on a host array. Counts programmed bytes so the
+//  simulator can report wear.
+
+#ifndef SIM_AVR_EEPROM_H_
+#define SIM_AVR_EEPROM_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define SIM_EEPROM_SIZE 256
+
+extern uint8_t simEeprom[SIM_EEPROM_SIZE];
+extern uint32_t simEepromByteWrites;
+
+void eeprom_read_block(void* dst, const void* src, size_t n);
+void eeprom_update_block(const void* src, void* dst, size_t n);
+uint8_t eeprom_read_byte(const uint8_t* addr);
+void eeprom_update_byte(uint8_t* addr, uint8_t value);
+
+#endif /* SIM_AVR_EEPROM_H_ */
@@ -0,0 +1,35 @@
+#include "avr/eeprom.h"
+#include "Arduino.h"
+#include <string.h>
+
+uint8_t simEeprom[SIM_EEPROM_SIZE];
+uint32_t simEepromByteWrites;
+
+//  tinyAVR 2-series: 4 ms erase/write per EEPROM page operation
+static const uint32_t EEPROM_WRITE_US = 4000;
+
+void eeprom_read_block(void* dst, const void* src, size_t n)
+{
+    memcpy(dst, simEeprom + (size_t)src, n);
+}
+
+void eeprom_update_block(const void* src, void* dst, size_t n)
+{
+    const uint8_t* in = (const uint8_t*)src;
+    for (size_t i = 0; i < n; i++)
+        eeprom_update_byte((uint8_t*)dst + i, in[i]);
+}
+
+uint8_t eeprom_read_byte(const uint8_t* addr)
+{
+    return simEeprom[(size_t)addr];
+}
+
+void eeprom_update_byte(uint8_t* addr, uint8_t value)
+{
+    if (simEeprom[(size_t)addr] == value)
+        return;
+    simEeprom[(size_t)addr] = value;
+    simEepromByteWrites++;
+    simAdvanceMicros(EEPROM_WRITE_US);
+}
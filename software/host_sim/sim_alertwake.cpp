@@ -0,0 +1,207 @@
+//  Cold-chain watch on the display board: a day in a fridge at ~4 C with a
+//  defrost to 7 C and a door left open that takes the goods to 11 C for
+//  ten minutes. The limit is 8.0 C with 0.5 C hysteresis. Two ways per
+//  sensor: the background refresh (PIT tick every FIELD_WAKE_TICK_S, a
+//  one-shot reading every FIELD_WAKE_REFRESH_TICKS) and the ALERT wake
+//  (the sensor converts by itself in thermostat mode, FieldWake wakes on
+//  its ALERT edges and the cycle fetches the latest result). Per day: wake
+//  cycles, CPU wakes, how long the tag lags behind the crossing and the
+//  end of the excursion, sensor current and the charge of sensor and MCU
+//  for the sensor part (tag and display work scale with the cycles), the
+//  ALERT pull-up included while an alarm holds the pin low. The ALERT wake
+//  must publish exactly the start and the end of the excursion, within
+//  the fault queue of conversions, and never wake otherwise; ALERT starts
+//  input-disabled as Board::init() leaves it and the MCU pull-up must stay
+//  off. It costs more than the refresh, what for is printed at the end.
+
+#include "Scenarios.h"
+#include "Sensors.h"
+#include "I2cBus.h"
+#include "FieldWake.h"
+#include "SimPower.h"
+#include "devices/SimSensors.h"
+#include <stdio.h>
+
+static const uint8_t ALERT_PIN = 13;            // PC3 on the display board
+static const uint32_t DAY_S = 24UL * 3600;
+static const int16_t LIMIT = 800, RELEASE = 750;
+static const double MCU_ACTIVE_UA = 2500;
+static const double MCU_SLEEP_UA = 0.7;
+static const uint32_t TICK_WAKE_US = 20;        // PIT wake: ISR, poll(), back to sleep
+static const double VCC_V = 3.0;
+static const double MCU_PULLUP_KOHM = 35;       // PORT PULLUPEN, typical
+static const double ALERT_PULLUP_KOHM = 1000;   // external, Board.h
+
+enum { REFRESH, ALERT };
+
+static SimTmp1xx* model;
+
+static int alertLevel(uint8_t)
+{
+    return model->alertActive() ? LOW : HIGH;
+}
+
+//  fridge: 4 C wobbling, defrost 03:00, door open 10:00
+static int16_t temperature(uint32_t t)
+{
+    int32_t wobble = (int32_t)(t % 5400);
+    int32_t centi = 400 + (wobble < 2700 ? wobble : 5400 - wobble) * 60 / 2700 - 30;
+    if (t >= 3 * 3600 && t < 3 * 3600 + 1800)
+    {
+        uint32_t d = t - 3 * 3600;
+        centi += (d < 900 ? d : 1800 - d) * 300 / 900;
+    }
+    if (t >= 10 * 3600 && t < 10 * 3600 + 2400)
+    {
+        uint32_t d = t - 10 * 3600;
+        int32_t up = d < 350 ? d * 2 : d < 950 ? 700 : d < 1650 ? 700 - (int32_t)(d - 950) : 0;
+        centi += up;
+    }
+    return (int16_t)centi;
+}
+
+struct Run
+{
+    uint32_t cycles, cpuWakes, alarmLag, clearLag, lowS;
+    double sensorUa, chargeUc;
+    bool ok;
+};
+
+template <class Sensor, class Model>
+static Run run(uint8_t mode)
+{
+    typedef TemperatureReader<Sensor> Reader;
+    Model sensor;
+    model = &sensor;
+    SimI2c::attach(Sensor::ADDRESS, &sensor);
+    SimPower::reset();
+    uint8_t load = SimPower::load("sensor");
+    sensor.meter(load);
+    simSetPinSource(ALERT_PIN, alertLevel);
+
+    Run r = { 0, 0, 0, 0, 0, 0, 0, true };
+    bool armed = false, excursion = false, published = false;
+    uint32_t crossed = 0, cleared = 0, awake = 0;
+    int16_t shown = 0;
+
+    //  the sensor part of wakeCycle(), what the tag shows afterwards
+    auto cycle = [&]() {
+        uint32_t start = micros();
+        int16_t centi = 0;
+        I2cBus::beginSession(300000UL);
+        bool ok;
+        if (mode == ALERT && armed)
+            ok = Reader::readLatest(centi);
+        else
+            ok = (r.cycles ? Reader::resume() : Reader::begin()) && Reader::read(centi) &&
+                 (mode == REFRESH || Reader::armAlert(LIMIT, RELEASE));
+        I2cBus::endSession();
+        armed = ok && mode == ALERT;
+        awake += micros() - start;
+        r.cycles++;
+        r.ok = r.ok && ok;
+        shown = centi;
+        published = mode == ALERT ? FieldWake::alertActive() : centi >= LIMIT;
+    };
+
+    SimPower::clear();
+    sensor.setTemperature(temperature(0));
+    cycle();
+    if (mode == ALERT)
+    {
+        simDisableInput(ALERT_PIN);
+        FieldWake::watchAlert(ALERT_PIN);
+    }
+    int level = digitalRead(ALERT_PIN);
+    for (uint32_t t = 1; t <= DAY_S; t++)
+    {
+        delay(1000);
+        int16_t now = temperature(t);
+        sensor.setTemperature(now);
+        if (!excursion && now >= LIMIT && !crossed)
+        {
+            excursion = true;
+            crossed = t;
+        }
+        else if (excursion && now < RELEASE && !cleared)
+            cleared = t;
+        if (mode == ALERT && model->alertActive())
+            r.lowS++;
+
+        bool event = false;
+        if (mode == REFRESH && t % FIELD_WAKE_TICK_S == 0)
+        {
+            FieldWake::onTick();
+            event = true;
+        }
+        if (mode == ALERT && digitalRead(ALERT_PIN) != level)
+        {
+            level = digitalRead(ALERT_PIN);
+            FieldWake::onAlert();
+            event = true;
+        }
+        if (!event)
+            continue;
+        r.cpuWakes++;
+        uint8_t reason = FieldWake::poll();
+        if (reason != (mode == ALERT ? FIELD_WAKE_ALERT : FIELD_WAKE_REFRESH))
+            continue;
+        cycle();
+        if (published && crossed && !r.alarmLag)
+            r.alarmLag = t - crossed;
+        if (!published && cleared && r.alarmLag && !r.clearLag)
+        {
+            r.clearLag = t - cleared;
+            r.ok = r.ok && shown < LIMIT;
+        }
+        if (published)
+            r.ok = r.ok && shown >= RELEASE;
+    }
+    simSetPinSource(ALERT_PIN, 0);
+    SimI2c::detach(Sensor::ADDRESS);
+
+    double sensorUc = SimPower::charge(load);
+    r.sensorUa = sensorUc / DAY_S;
+    double mcuUs = awake + (double)r.cpuWakes * TICK_WAKE_US;
+    double pullUa = VCC_V * 1000 / (simPinMode(ALERT_PIN) == INPUT_PULLUP ? MCU_PULLUP_KOHM : ALERT_PULLUP_KOHM);
+    r.chargeUc = sensorUc + (mcuUs * MCU_ACTIVE_UA + (DAY_S * 1e6 - mcuUs) * MCU_SLEEP_UA) / 1e6 +
+                 r.lowS * pullUa;
+    if (mode == ALERT)
+    {
+        uint32_t bound = (Sensor::ALERT_FAULTS + 1) * Sensor::ALERT_PERIOD_MS / 1000 + 1;
+        r.ok = r.ok && simPinMode(ALERT_PIN) != INPUT_PULLUP && r.cycles == 3 && r.cpuWakes == 2 && r.alarmLag && r.alarmLag <= bound &&
+               r.clearLag && r.clearLag <= bound;
+    }
+    return r;
+}
+
+int simAlertWake(int, char**)
+{
+    static const char* const sensors[] = { "TMP112", "TMP117" };
+    static const char* const modes[] = { "15 min refresh", "ALERT wake" };
+    int status = 0;
+    Run runs[2][2];
+
+    printf("%-7s %-15s %7s %10s %9s %9s %10s %9s\n", "sensor", "wake", "cycles", "CPU wakes",
+           "alarm s", "clear s", "sensor uA", "uC/day");
+    for (uint8_t s = 0; s < 2; s++)
+        for (uint8_t mode = REFRESH; mode <= ALERT; mode++)
+        {
+            Run& r = runs[s][mode];
+            r = s ? run<Tmp117, SimTmp117>(mode) : run<Tmp112, SimTmp112>(mode);
+            printf("%-7s %-15s %7lu %10lu %9lu %9lu %10.2f %9.0f  %s\n", sensors[s], modes[mode],
+                   (unsigned long)r.cycles, (unsigned long)r.cpuWakes, (unsigned long)r.alarmLag,
+                   (unsigned long)r.clearLag, r.sensorUa, r.chargeUc, r.ok ? "ok" : "FAIL");
+            status |= r.ok ? 0 : 1;
+        }
+    printf("limit %d.%d C, released below %d.%d C; alarm/clear s: crossing to the tag showing it;\n"
+           "uC/day: sensor plus MCU for the sensor part and the wakes, tag and display per cycle extra;\n"
+           "ALERT pull-up %.0f kOhm external, %.0f s low\n",
+           LIMIT / 100, LIMIT / 10 % 10, RELEASE / 100, RELEASE / 10 % 10, ALERT_PULLUP_KOHM,
+           (double)runs[0][ALERT].lowS);
+    for (uint8_t s = 0; s < 2; s++)
+        printf("%s: ALERT wake %.2fx the charge of the refresh for the alarm %.0fx sooner\n", sensors[s],
+               runs[s][ALERT].chargeUc / runs[s][REFRESH].chargeUc,
+               (double)runs[s][REFRESH].alarmLag / runs[s][ALERT].alarmLag);
+    return status;
+}
@@ -0,0 +1,87 @@
+//  Status LED patterns (Indicator.h) on a model of the hardware that
+//  produces them: the RTC PIT prescaler at 1.024 kHz, the event channels
+//  apply() would program and the three chained CCL LUTs with their truth
+//  tables. Each pattern is run for 64 s of RTC cycles; per pattern the
+//  flashes, their length and period, the LED duty cycle and average current
+//  must match what Indicator.h promises. A CPU-driven blink of the same
+//  pattern would wake the core twice per flash; the CCL needs no wake.
+
+#include "Scenarios.h"
+#include "Indicator.h"
+#include <stdio.h>
+
+static const uint32_t RTC_HZ = 1024;
+static const uint32_t RUN_CYCLES = 64 * RTC_HZ;
+static const double LED_MA = 1.2;      // (3.0 V - 1.8 V) / 1k
+
+//  PIT prescaler bit on an event channel: DIV8192..DIV1024 on even
+//  channels, DIV512..DIV64 on odd ones, each a square wave
+static bool channel(const IndicatorConfig& config, uint8_t ch, uint32_t count)
+{
+    uint8_t bit = (ch % 2 ? 8 : 12) - (config.channel[ch] - 0x08);
+    return count >> bit & 1;
+}
+
+static bool output(const IndicatorConfig& config, uint32_t count)
+{
+    bool link = false;
+    for (uint8_t lut = 0; lut < 3; lut++)
+    {
+        const uint8_t a = 2 * lut, b = a + 1;
+        bool inA = config.channel[a] && channel(config, a, count);
+        bool inB = config.channel[b] && channel(config, b, count);
+        uint8_t in = lut ? (link | inA << 1 | inB << 2) : (inA | inB << 1);
+        link = config.truth[lut] >> in & 1;
+    }
+    return link;
+}
+
+int simBlink(int, char**)
+{
+    static const char* const names[] = { "off", "tag written", "sensor fault", "low battery" };
+    //  flashes per period, flash length in RTC cycles, period in RTC cycles
+    static const uint32_t expected[][3] = { { 0, 0, 0 }, { 1, 64, 4096 }, { 2, 64, 8192 }, { 4, 32, 8192 } };
+    int status = 0;
+
+    printf("%-14s %9s %9s %9s %7s %9s %12s\n", "pattern", "flashes", "flash ms", "period s", "duty %",
+           "LED uA", "CPU wakes/d");
+    for (uint8_t p = 0; p < INDICATOR_PATTERNS; p++)
+    {
+        Indicator::show(p);
+        const IndicatorConfig config = indicatorApplied;
+        uint32_t on = 0, flashes = 0, shortest = 0xFFFFFFFF, longest = 0, first = 0, length = 0;
+        bool was = false;
+        for (uint32_t count = 0; count < RUN_CYCLES; count++)
+        {
+            bool level = output(config, count);
+            if (level)
+            {
+                on++;
+                length++;
+                if (!was && !flashes++)
+                    first = count;
+            }
+            else if (was)
+            {
+                shortest = length < shortest ? length : shortest;
+                longest = length > longest ? length : longest;
+                length = 0;
+            }
+            was = level;
+        }
+
+        uint32_t period = expected[p][2];
+        uint32_t perPeriod = period ? flashes * period / RUN_CYCLES : 0;
+        double duty = 100.0 * on / RUN_CYCLES;
+        bool ok = Indicator::pattern() == p && perPeriod == expected[p][0] &&
+                  (!flashes || (shortest == expected[p][1] && longest == expected[p][1] && first < period));
+        printf("%-14s %4lu / %-2lu %9.1f %9.1f %7.2f %9.1f %6lu vs 0  %s\n", names[p], (unsigned long)perPeriod,
+               (unsigned long)(period / RTC_HZ), flashes ? longest * 1000.0 / RTC_HZ : 0.0, (double)period / RTC_HZ,
+               duty, duty * LED_MA * 10, (unsigned long)(flashes * 2 * 86400 / (RUN_CYCLES / RTC_HZ)),
+               ok ? "ok" : "FAIL");
+        status |= ok ? 0 : 1;
+    }
+    Indicator::show(INDICATOR_OFF);
+    printf("LED at %.1f mA while on; CPU wakes: a timer interrupt per edge vs the CCL (none)\n", LED_MA);
+    return status;
+}
@@ -0,0 +1,66 @@
+//  BME280 driver against the model: integer compensation error versus the
+//  datasheet floating point reference, and wake time per oversampling set.
+
+#include "Scenarios.h"
+#include "Bme280.h"
+#include "devices/SimSensors.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+struct OversamplingCase
+{
+    const char* name;
+    uint8_t t, p, h;
+};
+
+static const OversamplingCase cases[] = {
+    { "T1 only ", BME280_OSRS_X1, BME280_OSRS_SKIP, BME280_OSRS_SKIP },
+    { "T1 P1 H1", BME280_OSRS_X1, BME280_OSRS_X1,   BME280_OSRS_X1 },
+    { "T2 P16 H1", BME280_OSRS_X2, BME280_OSRS_X16, BME280_OSRS_X1 },
+};
+
+int simBme280(int, char**)
+{
+    SimBme280 model;
+    SimI2c::attach(BME280_I2C_ADDRESS, &model);
+    int status = 0;
+
+    SimI2c::reset();
+    uint32_t start = micros();
+    if (!Bme280::begin())
+    {
+        printf("begin failed\n");
+        return 1;
+    }
+    printf("begin (chip id + calibration)  %5lu us  %lu transactions\n",
+           (unsigned long)(micros() - start), (unsigned long)SimI2c::stats.transactions);
+
+    const int16_t temps[] = { -2000, 0, 2345, 6000 };
+    for (unsigned c = 0; c < sizeof(cases) / sizeof(cases[0]); c++)
+    {
+        Bme280::setOversampling(cases[c].t, cases[c].p, cases[c].h);
+        for (unsigned i = 0; i < sizeof(temps) / sizeof(temps[0]); i++)
+        {
+            model.setEnvironment(temps[i], 98000 + 1000 * i, 300 + 150 * i);
+            SimI2c::reset();
+            start = micros();
+
+            Bme280Data data;
+            bool ok = Bme280::startForced();
+            delay(Bme280::measurementMs());
+            ok = ok && !Bme280::measuring() && Bme280::readAll(data);
+
+            uint32_t wake = micros() - start;
+            int dt = data.centiCelsius - temps[i];
+            long dp = cases[c].p ? (long)data.pascal - (98000 + 1000 * (long)i) : 0;
+            int dh = cases[c].h ? data.humidityPermille - (300 + 150 * (int)i) : 0;
+            printf("%-9s T %6d cC  P %6lu Pa  H %4u pm  err %2d/%3ld/%2d  wake %5lu us  %lu transactions\n",
+                   cases[c].name, data.centiCelsius, (unsigned long)data.pascal, data.humidityPermille,
+                   dt, dp, dh, (unsigned long)wake, (unsigned long)SimI2c::stats.transactions);
+            if (!ok || abs(dt) > 1 || labs(dp) > 2 || abs(dh) > 2)
+                status = 1;
+        }
+    }
+    SimI2c::detach(BME280_I2C_ADDRESS);
+    return status;
+}
@@ -0,0 +1,267 @@
+//  The display board running from the NTAG 5 VOUT (22 mF storage, VOUT at
+//  2.4 V), one field window per phone: the phone harvests from 8 mA close
+//  by down to 0.3 mA at the edge of its range and is held for HOLD_US.
+//  The capacitor has just brought the MCU up at START_MV. Each window runs
+//  the sketch's wake cycle (tag set up, reading, headline on the tag) and
+//  then the tasks after it, once in table order without a check and once
+//  through Budget.h. The storage voltage follows the sensor and panel
+//  currents of the models (SimPower), the MCU's from awake and standby
+//  time and the harvest current while the field lasts; below BOD_MV the
+//  board browns out and whatever task was running is torn. Per window:
+//  whether the headline reached the reader, the tasks that ran, were shed
+//  or torn, recharge waits, when the panel was done and the lowest VDD.
+//  Through Budget.h nothing may brown out, the headline must always be on
+//  the tag and the panel refreshed wherever the harvest allows it.
+
+#include "Scenarios.h"
+#include "Budget.h"
+#include "Supply.h"
+#include "Standby.h"
+#include "Display.h"
+#include "Epd.h"
+#include "Sensors.h"
+#include "I2cBus.h"
+#include "WarmState.h"
+#include "TagBackend.h"
+#include "Ntag5.h"
+#include "SimSpi.h"
+#include "SimPower.h"
+#include "devices/SimNtag5.h"
+#include "devices/SimSensors.h"
+#include "devices/SimEpd.h"
+#include <avr/eeprom.h>
+#include <stdio.h>
+
+static const uint8_t CS = 0, DC = 1, RES = 2, BUSY = 3;     // PA4..PA7 on the board
+static const double VOUT_MV = 2400;
+static const double START_MV = 2000;
+static const double BOD_MV = 1800;
+static const uint64_t HOLD_US = 8000000ULL;
+static const double MCU_ACTIVE_UA = 1310;                   // 5 MHz at VOUT
+static const double MCU_SLEEP_UA = 0.7;
+
+struct Phone
+{
+    const char* name;
+    double harvestUa;
+};
+
+static const Phone PHONES[] = {
+    { "close", 8000 }, { "typical", 3000 }, { "far", 1000 }, { "edge", 300 },
+};
+
+enum { TASK_STATE, TASK_HISTORY, TASK_DISPLAY, TASKS };
+static const char* const TASK_NAMES[TASKS] = { "state", "history", "display" };
+
+//  storage capacitor, integrated whenever the firmware or a task looks
+static struct
+{
+    SimNtag5* tag;
+    double harvestUa, mv, lowest;
+    uint64_t last, fieldEnd;
+    double lastCharge;
+    uint32_t lastSlept;
+    bool dead;
+} cap;
+
+static void integrate()
+{
+    uint64_t now = simMicros64();
+    uint32_t dt = (uint32_t)(now - cap.last);
+    uint32_t slept = Standby::sleptMicros - cap.lastSlept;
+    if (slept > dt)
+        slept = dt;
+    uint64_t fed = cap.last < cap.fieldEnd ? (now < cap.fieldEnd ? now : cap.fieldEnd) - cap.last : 0;
+    double drawn = SimPower::total() - cap.lastCharge +
+                   ((dt - slept) * MCU_ACTIVE_UA + slept * MCU_SLEEP_UA) / 1e6;
+    cap.mv += (cap.harvestUa * fed / 1e6 - drawn) / BUDGET_BUFFER_UF * 1000;
+    if (cap.mv > VOUT_MV)
+        cap.mv = VOUT_MV;
+    if (cap.mv < cap.lowest)
+        cap.lowest = cap.mv;
+    cap.dead = cap.dead || cap.mv < BOD_MV;
+    if (now >= cap.fieldEnd)
+        cap.tag->setField(false);
+    cap.last = now;
+    cap.lastCharge = SimPower::total();
+    cap.lastSlept = Standby::sleptMicros;
+}
+
+static uint16_t vdd()
+{
+    integrate();
+    return (uint16_t)cap.mv;
+}
+
+static int16_t centi;
+static bool sensorOk;
+static uint8_t ran, torn;
+static uint64_t displayDone;
+
+//  the sketch's tasks, doing nothing once the board has browned out
+static void task(uint8_t id, void (*work)())
+{
+    integrate();
+    if (cap.dead)
+        return;
+    work();
+    integrate();
+    if (cap.dead)
+        torn |= 1 << id;
+    else
+        ran |= 1 << id;
+}
+
+static void commitState()
+{
+    task(TASK_STATE, [] { WarmState::commit(); });
+}
+
+static void updateWidgets()
+{
+    task(TASK_HISTORY, [] {
+        Display::showCentiCelsius(centi);
+        Display::record(centi);
+    });
+}
+
+static void refreshDisplay()
+{
+    task(TASK_DISPLAY, [] {
+        Display::refresh();
+        displayDone = simMicros64();
+    });
+}
+
+static const BudgetTask CYCLE_TASKS[TASKS] = {
+    { commitState,    BUDGET_STATE_UC,   BUDGET_STATE },
+    { updateWidgets,  BUDGET_HISTORY_UC, BUDGET_HISTORY },
+    { refreshDisplay, BUDGET_DISPLAY_UC, BUDGET_DISPLAY },
+};
+
+static bool contains(const uint8_t* memory, size_t size, const char* text)
+{
+    size_t len = strlen(text);
+    for (size_t i = 0; i + len <= size; i++)
+        if (!memcmp(memory + i, text, len))
+            return true;
+    return false;
+}
+
+//  setup() after the field brought the board up, returns whether the
+//  reader finds the headline
+static bool window(SimNtag5& tag, SimTmp112& sensor, int16_t set)
+{
+    typedef TemperatureReader<Tmp112> Reader;
+    RSTCTRL.RSTFR = RESET_CAUSE_POWER_ON;
+    TagBackend::reset();
+    WarmState::begin();
+    Display::value.set("");
+    Display::trend.clear();
+    Display::begin(CS, DC, RES, BUSY);
+    sensor.setTemperature(set);
+
+    I2cBus::begin();
+    I2cBus::beginSession(300000UL);
+    bool tagOk = TagBackend::setup(false) != TAG_ABSENT;
+    sensorOk = Reader::begin() && Reader::read(centi);
+    char value[8], text[32];
+    formatCentiCelsius(value, centi);
+    snprintf(text, sizeof(text), "Temperature: %s", value);
+    tagOk = tagOk && sensorOk && TagBackend::publish(OS_ANDROID, String(text) + " °C");
+    integrate();
+    uint8_t view[64 * NTAG5_BLOCK_SIZE];
+    tag.rfView(view, 0, 64);
+    bool headline = !cap.dead && tagOk && contains(view, sizeof(view), text);
+
+    WarmState::setPeripherals((tagOk ? TagBackend::warmFlag() : 0) | (sensorOk ? WARM_PERIPH_SENSOR : 0));
+    WarmState::setSensorConfig(BoardSensor::ID);
+    WarmState::setLastValue(centi);
+    WarmState::setTagLayout(tagOk ? 1 : 0);
+    I2cBus::endSession();
+
+    Budget::run(CYCLE_TASKS, TASKS);
+    return headline;
+}
+
+static void names(char* out, uint8_t mask)
+{
+    out[0] = 0;
+    for (uint8_t i = 0; i < TASKS; i++)
+        if (mask & 1 << i)
+            sprintf(out + strlen(out), "%s%s", out[0] ? "," : "", TASK_NAMES[i]);
+    if (!out[0])
+        strcpy(out, "-");
+}
+
+int simBudget(int, char**)
+{
+    int status = 0;
+    printf("%-8s %-8s %8s %-22s %-14s %-9s %5s %9s %9s\n", "phone", "tasks", "headline", "ran", "shed",
+           "torn", "waits", "panel s", "lowest V");
+    for (const Phone& phone : PHONES)
+    {
+        for (int budget = 0; budget < 2; budget++)
+        {
+            SimNtag5 tag;
+            SimTmp112 sensor;
+            SimEpd epd(CS, DC, RES, BUSY);
+            SimI2c::attach(NTAG5_I2C_ADDRESS, &tag);
+            SimI2c::attach(Tmp112::ADDRESS, &sensor);
+            SimSpi::attach(&epd);
+            SimSpi::reset();
+            SimPower::reset();
+            sensor.meter(SimPower::load("TMP112"));
+            epd.meter(SimPower::load("SSD1680"));
+            memset(simEeprom, 0xFF, sizeof(simEeprom));
+            tag.setField(true);
+
+            cap.tag = &tag;
+            cap.harvestUa = phone.harvestUa;
+            cap.mv = cap.lowest = START_MV;
+            cap.last = simMicros64();
+            cap.fieldEnd = cap.last + HOLD_US;
+            cap.lastCharge = SimPower::total();
+            cap.lastSlept = Standby::sleptMicros;
+            cap.dead = false;
+            supplySource = vdd;
+            Budget::begin(budget ? BUDGET_BUFFER_UF : 0);
+            ran = torn = 0;
+            displayDone = 0;
+            uint64_t start = cap.last;
+
+            int16_t set = 2150 + 25 * (int16_t)(&phone - PHONES);
+            bool headline = window(tag, sensor, set);
+            uint8_t shed = ((1 << TASKS) - 1) & ~ran & ~torn;
+
+            //  through Budget.h: no brown-out, the headline always, the
+            //  panel whenever the harvest fills the capacitor well within
+            //  the hold (1 mA brings it to the refresh just as the phone
+            //  leaves)
+            bool ok = true;
+            if (budget)
+                ok = headline && !torn && !cap.dead && (ran & 1 << TASK_STATE) &&
+                     (phone.harvestUa < 3000 || (ran & 1 << TASK_DISPLAY));
+            char ranText[32], shedText[32], tornText[32];
+            names(ranText, ran);
+            names(shedText, shed);
+            names(tornText, torn);
+            char panel[16] = "-";
+            if (displayDone && !(torn & 1 << TASK_DISPLAY))
+                snprintf(panel, sizeof(panel), "%.1f", (displayDone - start) / 1e6);
+            printf("%-8s %-8s %8s %-22s %-14s %-9s %5u %9s %9.2f  %s\n", phone.name,
+                   budget ? "budget" : "in order", headline ? "yes" : "no", ranText, shedText, tornText,
+                   budget ? Budget::waits : 0, panel, cap.lowest / 1000, ok ? "ok" : "FAIL");
+            status |= ok ? 0 : 1;
+
+            supplySource = 0;
+            Budget::begin(0);
+            SimSpi::attach(0);
+            SimI2c::detach(Tmp112::ADDRESS);
+            SimI2c::detach(NTAG5_I2C_ADDRESS);
+        }
+    }
+    printf("field for %.0f s from %.2f V, brown-out below %.2f V; panel: seconds to the refresh done\n",
+           HOLD_US / 1e6, START_MV / 1000, BOD_MV / 1000);
+    return status;
+}
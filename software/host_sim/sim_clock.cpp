@@ -0,0 +1,157 @@
+//  Main clock per wake phase (Clock.h) on an NTAG board: the sketch's wake
+//  cycle, tag setup and reading in CLOCK_SLOW, formatting and publishing
+//  in CLOCK_FAST. One cold and three warm cycles per sensor, the charge
+//  of each against the same cycle at F_CPU throughout. MCU current is
+//  linear in the clock (the 2.5 mA at 10 MHz of `rail`); CPU time itself
+//  is not modelled, so a cycle takes the same time both ways and the
+//  saving is the wait time spent slow. Before that, the register values
+//  Clock writes must keep the bus at or below 100 kHz (within 10%, one
+//  BAUD step is that coarse on the slow clock) and the millis timer at
+//  1 ms in both phases, and every cycle must put the sensor's value on
+//  the tag.
+
+#include "Scenarios.h"
+#include "Clock.h"
+#include "Sensors.h"
+#include "I2cBus.h"
+#include "WarmState.h"
+#include "TagBackend.h"
+#include "Ntag5.h"
+#include "devices/SimNtag5.h"
+#include "devices/SimSensors.h"
+#include <avr/eeprom.h>
+#include <Wire.h>
+#include <stdio.h>
+
+static const uint32_t BUS_HZ = 100000;
+static const unsigned CYCLES = 4;
+static const double MCU_STATIC_UA = 120;
+static const double MCU_UA_PER_MHZ = 238;       // 2.5 mA at 10 MHz
+
+static double mcuMicroAmps(uint32_t hz)
+{
+    return MCU_STATIC_UA + MCU_UA_PER_MHZ * hz / 1e6;
+}
+
+//  what the registers give: SCL from MBAUD (t_rise as Wire assumes it)
+//  and the millis tick from the TCB period
+static bool registersHold(uint32_t cpuHz, const ClockConfig& config, uint32_t& sclHz)
+{
+    sclHz = (uint32_t)(cpuHz / (10 + 2.0 * config.mbaud + cpuHz * 1e-6));
+    uint32_t tickUs = (uint32_t)((config.ccmp + 1) * 1e6 / cpuHz + 0.5);
+    return sclHz <= BUS_HZ && sclHz > BUS_HZ * 90 / 100 && tickUs == 1000 &&
+           Clock::divisor(config.mclkctrlb) == (cpuHz == F_CPU ? 2 : 2 * CLOCK_SLOW_DIV);
+}
+
+static void setTemperature(SimTmp1xx& model, int16_t centi)
+{
+    model.setTemperature(centi);
+}
+
+static void setTemperature(SimBme280& model, int16_t centi)
+{
+    model.setEnvironment(centi, 100653, 450);
+}
+
+static bool contains(const uint8_t* memory, size_t size, const char* text)
+{
+    size_t len = strlen(text);
+    for (size_t i = 0; i + len <= size; i++)
+        if (!memcmp(memory + i, text, len))
+            return true;
+    return false;
+}
+
+//  the sketch's wake cycle with NFC_SENSE_CLOCK_SCALING, tag and sensor part
+template <class Sensor>
+static bool cycle(unsigned i, int16_t& centi)
+{
+    typedef TemperatureReader<Sensor> Reader;
+    RSTCTRL.RSTFR = i ? RESET_CAUSE_WATCHDOG : RESET_CAUSE_POWER_ON;
+    TagBackend::reset();
+    WarmState::begin();
+    const WarmStateBlock& saved = WarmState::get();
+    bool warm = WarmState::valid() && saved.sensorConfig == Sensor::ID &&
+                (saved.peripherals & WARM_PERIPH_SENSOR) && (saved.peripherals & WARM_PERIPH_NTAG5);
+
+    Wire.setClock(BUS_HZ);
+    I2cBus::begin();
+    I2cBus::beginSession(300000UL);
+    Clock::set(CLOCK_SLOW);
+    bool tagOk = TagBackend::setup(warm) != TAG_ABSENT;
+    bool sensorOk = (warm ? Reader::resume() : Reader::begin()) && Reader::read(centi);
+    Clock::set(CLOCK_FAST);
+
+    char text[8];
+    formatCentiCelsius(text, centi);
+    tagOk = tagOk && sensorOk && TagBackend::publish(OS_ANDROID, "Temperature: " + String(text) + " °C");
+    I2cBus::endSession();
+    WarmState::setPeripherals((tagOk ? TagBackend::warmFlag() : 0) | (sensorOk ? WARM_PERIPH_SENSOR : 0));
+    WarmState::setSensorConfig(Sensor::ID);
+    WarmState::commit();
+    return tagOk;
+}
+
+template <class Sensor, class Model>
+static int run(const char* name)
+{
+    int status = 0;
+    SimNtag5 tag;
+    Model sensor;
+    SimI2c::attach(NTAG5_I2C_ADDRESS, &tag);
+    SimI2c::attach(Sensor::ADDRESS, &sensor);
+    memset(simEeprom, 0xFF, sizeof(simEeprom));
+    Clock::begin(BUS_HZ);
+
+    for (unsigned i = 0; i < CYCLES; i++)
+    {
+        int16_t set = 1875 + 37 * i, centi = 0;
+        setTemperature(sensor, set);
+        uint32_t start = micros(), slowBefore = Clock::slowMicros, switches = Clock::switches;
+        bool ok = cycle<Sensor>(i, centi);
+        uint32_t awake = micros() - start, slow = Clock::slowMicros - slowBefore;
+
+        char text[32], value[8];
+        formatCentiCelsius(value, centi);
+        snprintf(text, sizeof(text), "Temperature: %s", value);
+        uint8_t view[64 * NTAG5_BLOCK_SIZE];
+        tag.rfView(view, 0, 64);
+        ok = ok && abs(centi - set) < 7 && contains(view, sizeof(view), text) &&
+             Clock::switches - switches == 2 && Clock::phase() == CLOCK_FAST;
+
+        double fixedUc = awake * mcuMicroAmps(F_CPU) / 1e6;
+        double scaledUc = ((awake - slow) * mcuMicroAmps(F_CPU) + slow * mcuMicroAmps(F_CPU / CLOCK_SLOW_DIV)) / 1e6;
+        printf("%-7s %-4s %9.1f %8.1f %10.1f %11.1f %7.0f%%  %s\n", name, i ? "warm" : "cold", awake / 1000.0,
+               slow / 1000.0, fixedUc, scaledUc, 100 * (1 - scaledUc / fixedUc), ok ? "ok" : "FAIL");
+        status |= ok ? 0 : 1;
+    }
+    SimI2c::detach(NTAG5_I2C_ADDRESS);
+    SimI2c::detach(Sensor::ADDRESS);
+    return status;
+}
+
+int simClock(int, char**)
+{
+    int status = 0;
+    Clock::begin(BUS_HZ);
+    uint32_t fastScl, slowScl;
+    Clock::set(CLOCK_SLOW);
+    ClockConfig slow = clockApplied;
+    Clock::set(CLOCK_FAST);
+    ClockConfig fast = clockApplied;
+    bool ok = registersHold(F_CPU / CLOCK_SLOW_DIV, slow, slowScl) && registersHold(F_CPU, fast, fastScl);
+    printf("fast %lu MHz: SCL %lu Hz, TCB period %u   slow %.1f MHz: SCL %lu Hz, TCB period %u  %s\n",
+           (unsigned long)(F_CPU / 1000000), (unsigned long)fastScl, fast.ccmp + 1, F_CPU / CLOCK_SLOW_DIV / 1e6,
+           (unsigned long)slowScl, slow.ccmp + 1, ok ? "ok" : "FAIL");
+    status |= ok ? 0 : 1;
+
+    printf("%-7s %-4s %9s %8s %10s %11s %8s\n", "sensor", "boot", "awake ms", "slow ms",
+           "fixed uC", "scaled uC", "saved");
+    status |= run<Tmp112, SimTmp112>("TMP112");
+    status |= run<Tmp117, SimTmp117>("TMP117");
+    status |= run<Bme280Temp, SimBme280>("BME280");
+    printf("uC: MCU only, %.1f mA at %lu MHz, %.2f mA at %.1f MHz\n", mcuMicroAmps(F_CPU) / 1000,
+           (unsigned long)(F_CPU / 1000000), mcuMicroAmps(F_CPU / CLOCK_SLOW_DIV) / 1000,
+           F_CPU / CLOCK_SLOW_DIV / 1e6);
+    return status;
+}
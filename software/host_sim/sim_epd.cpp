@@ -0,0 +1,117 @@
+//  The pocket knife display's e-paper driver against the SSD1680 model.
+//  A reading is shown as four digit cells in the middle of the panel (a
+//  stand-in pattern per digit, there is no font here) and changes 30
+//  times. Two ways of showing it: the whole screen with a full refresh
+//  each time, and only the window of the cells that changed with a partial
+//  refresh. Per update: SPI bytes, MCU awake time (the refresh itself is
+//  BUSY time, the MCU sleeps through it), refresh time and flashes. The
+//  panel must show exactly the expected image afterwards, the controller
+//  must be asleep between updates and never get bytes while BUSY.
+
+#include "Scenarios.h"
+#include "Epd.h"
+#include "SimSpi.h"
+#include "devices/SimEpd.h"
+#include <stdio.h>
+
+static const uint8_t CS = 0, DC = 1, RES = 2, BUSY = 3;     // PA4..PA7 on the board
+static const uint8_t CELLS = 4;
+static const uint8_t CELL_X = 3, CELL_W = 2;                // bytes
+static const uint16_t CELL_Y = 109, CELL_H = 32;
+static const unsigned READINGS = 30;
+
+static char shown[CELLS + 1];
+
+static uint8_t pattern(char digit, uint16_t row, uint8_t half)
+{
+    if (row < 2 || row >= CELL_H - 2)
+        return 0xFF;
+    return (uint8_t)~((digit - '0' + 1) * 0x25 ^ row * 0x0B ^ half * 0x70);
+}
+
+static void screenRow(uint16_t y, uint8_t x, uint8_t w, uint8_t* row)
+{
+    for (uint8_t i = 0; i < w; i++)
+    {
+        uint8_t col = x + i;
+        bool inCells = y >= CELL_Y && y < CELL_Y + CELL_H && col >= CELL_X && col < CELL_X + CELLS * CELL_W;
+        row[i] = inCells ? pattern(shown[(col - CELL_X) / CELL_W], y - CELL_Y, (col - CELL_X) % CELL_W) : 0xFF;
+    }
+}
+
+static bool panelShows(const SimEpd& epd)
+{
+    uint8_t row[EPD_ROW_BYTES];
+    for (uint16_t y = 0; y < EPD_HEIGHT; y++)
+    {
+        screenRow(y, 0, EPD_ROW_BYTES, row);
+        if (memcmp(epd.panel() + y * EPD_ROW_BYTES, row, EPD_ROW_BYTES))
+            return false;
+    }
+    return true;
+}
+
+int simEpd(int, char**)
+{
+    static const char* const names[] = { "full screen, full", "changed cells, partial" };
+    int status = 0;
+
+    printf("%-24s %7s %7s %9s %9s %10s %6s %6s\n", "strategy", "updates", "flashes", "SPI B/upd",
+           "awake ms", "refresh ms", "stale", "errors");
+    for (uint8_t partial = 0; partial < 2; partial++)
+    {
+        SimEpd epd(CS, DC, RES, BUSY);
+        SimSpi::attach(&epd);
+        SimSpi::reset();
+        Epd::begin(CS, DC, RES, BUSY);
+        Epd::fullRefreshes = Epd::partialRefreshes = 0;
+        Epd::spiBytes = 0;
+
+        bool ok = true;
+        uint32_t updates = 0, awake = 0, busy = 0, bytes = 0;
+        memset(shown, 0, sizeof(shown));
+        for (unsigned i = 0; i < READINGS; i++)
+        {
+            char next[CELLS + 1];
+            snprintf(next, sizeof(next), "%04u", 2150 + i * i * 7 % 230);
+            uint8_t first = 0, last = CELLS;
+            if (partial && !Epd::needsFull())
+            {
+                while (first < CELLS && next[first] == shown[first])
+                    first++;
+                while (last > first && next[last - 1] == shown[last - 1])
+                    last--;
+            }
+            memcpy(shown, next, sizeof(next));
+            if (first == last)
+                continue;
+
+            uint32_t start = micros(), busyBefore = epd.stats.busyMicros, bytesBefore = SimSpi::stats.bytes;
+            bool done = partial && !Epd::needsFull()
+                ? Epd::update(CELL_X + first * CELL_W, CELL_Y, (last - first) * CELL_W, CELL_H,
+                              screenRow, EPD_REFRESH_PARTIAL)
+                : Epd::update(0, 0, EPD_ROW_BYTES, EPD_HEIGHT, screenRow, EPD_REFRESH_FULL);
+            uint32_t refresh = epd.stats.busyMicros - busyBefore;
+            updates++;
+            busy += refresh;
+            awake += micros() - start - refresh;
+            bytes += SimSpi::stats.bytes - bytesBefore;
+            ok = ok && done && epd.asleep() && !SimSpi::enabled() && panelShows(epd);
+        }
+        SimSpi::attach(0);
+
+        uint32_t errors = epd.stats.whileBusy + epd.stats.whileAsleep + epd.stats.unsupported + SimSpi::stats.disabled;
+        ok = ok && !errors && !epd.stale() && epd.stats.fullRefreshes == Epd::fullRefreshes &&
+             epd.stats.partialRefreshes == Epd::partialRefreshes && bytes == Epd::spiBytes;
+        if (partial)
+            ok = ok && Epd::fullRefreshes == 1;
+        printf("%-24s %7lu %7lu %9lu %9.1f %10.1f %6lu %6lu  %s\n", names[partial], (unsigned long)updates,
+               (unsigned long)epd.stats.fullRefreshes, (unsigned long)(bytes / updates),
+               awake / 1000.0 / updates, busy / 1000.0 / updates, (unsigned long)epd.stale(),
+               (unsigned long)errors, ok ? "ok" : "FAIL");
+        status |= ok ? 0 : 1;
+    }
+    printf("SPI at %lu MHz; awake is the MCU, refresh is BUSY time (MCU in standby)\n",
+           (unsigned long)(EPD_SPI_HZ / 1000000));
+    return status;
+}
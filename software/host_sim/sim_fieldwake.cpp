@@ -0,0 +1,149 @@
+//  One day of the field-detect wake on an NTAG board against the 250 ms
+//  polling loop of the debug sketch. The tag model drives ED from its field
+//  state, the RTC PIT ticks every FIELD_WAKE_TICK_S and a phone is held to
+//  the tag a dozen times. Each cycle is the sketch's wakeCycle() work; the
+//  reading must be on the tag within FIELD_WAKE_PUBLISH_MS of the field.
+//  ED starts with its input buffer off as Board::init() leaves it; the
+//  first field after the reset must start a cycle like any other.
+
+#include "Scenarios.h"
+#include "Sensors.h"
+#include "Ntag5.h"
+#include "I2cBus.h"
+#include "WarmState.h"
+#include "FieldWake.h"
+#include "devices/SimNtag5.h"
+#include "devices/SimSensors.h"
+#include <Wire.h>
+#include <stdio.h>
+
+namespace {
+#include "NtagUtils.h"
+}
+
+static const uint8_t ED_PIN = 5;                // PB4 on the NTAG boards
+static const uint32_t DAY_S = 24UL * 3600;
+static const uint32_t TAP_S = 3;                // phone held this long
+static const uint32_t TAPS[] = { 7 * 3600 + 12, 7 * 3600 + 40, 9 * 3600 + 5, 11 * 3600 + 300,
+                                 12 * 3600 + 17, 13 * 3600 + 1, 15 * 3600 + 999, 17 * 3600 + 42,
+                                 18 * 3600 + 7, 19 * 3600 + 30, 21 * 3600 + 11, 22 * 3600 + 58 };
+
+//  what wakeCycle() does, returns the reading it published
+static int16_t wakeCycle(SimTmp112& sensor, uint32_t t)
+{
+    sensor.setTemperature(2000 + (int16_t)(t / 240 % 300));
+    const WarmStateBlock& saved = WarmState::get();
+    bool warm = WarmState::valid() && saved.sensorConfig == BoardSensor::ID &&
+                (saved.peripherals & (WARM_PERIPH_NTAG5 | WARM_PERIPH_SENSOR)) ==
+                (WARM_PERIPH_NTAG5 | WARM_PERIPH_SENSOR);
+
+    I2cBus::beginSession(300000UL);
+    bool tagOk = setupNFC(warm) != NFC_ABSENT;
+    int16_t centi = 0;
+    bool sensorOk = (warm ? BoardThermometer::resume() : BoardThermometer::begin()) &&
+                    BoardThermometer::read(centi);
+    char value[8];
+    formatCentiCelsius(value, centi);
+    tagOk = tagOk && sensorOk && updateNFC(OS_ANDROID, "Temperature: " + String(value) + " C");
+    I2cBus::endSession();
+
+    WarmState::setPeripherals((tagOk ? WARM_PERIPH_NTAG5 : 0) | (sensorOk ? WARM_PERIPH_SENSOR : 0));
+    WarmState::setSensorConfig(BoardSensor::ID);
+    WarmState::setLastValue(centi);
+    WarmState::setTagLayout(tagOk ? 1 : 0);
+    WarmState::commit();
+    return tagOk ? centi : INT16_MIN;
+}
+
+static bool readerShows(const SimNtag5& tag, int16_t centi)
+{
+    char value[8], text[32];
+    uint8_t view[16 * NTAG5_BLOCK_SIZE];
+    formatCentiCelsius(value, centi);
+    snprintf(text, sizeof(text), "Temperature: %s C", value);
+    tag.rfView(view, 0, 16);
+    return view[4] == 0x03 && memcmp(view + 13, text, strlen(text)) == 0;
+}
+
+int simFieldWake(int, char**)
+{
+    SimNtag5 tag;
+    SimTmp112 sensor;
+    SimI2c::attach(NTAG5_I2C_ADDRESS, &tag);
+    SimI2c::attach(BoardSensor::ADDRESS, &sensor);
+    RSTCTRL.RSTFR = RESET_CAUSE_POWER_ON;
+
+    simSetPin(ED_PIN, HIGH);
+    simDisableInput(ED_PIN);
+    WarmState::begin();
+    wakeCycle(sensor, 0);
+    FieldWake::begin(ED_PIN);
+
+    uint32_t wakes = 0, fieldCycles = 0, refreshCycles = 0, worstPublish = 0, worstAge = 0;
+    uint32_t lastPublish = 0;
+    unsigned stale = 0, tap = 0;
+    bool firstField = false;
+    const unsigned tapCount = sizeof(TAPS) / sizeof(TAPS[0]);
+    for (uint32_t t = 1; t <= DAY_S; t++)
+    {
+        delay(1000);
+        bool event = false;
+        if (t % FIELD_WAKE_TICK_S == 0)
+        {
+            FieldWake::onTick();
+            event = true;
+        }
+        if (tap < tapCount && (t == TAPS[tap] || t == TAPS[tap] + TAP_S))
+        {
+            bool on = t == TAPS[tap];
+            tag.setField(on);
+            simSetPin(ED_PIN, tag.edAsserted() ? LOW : HIGH);
+            FieldWake::onEdge();
+            event = true;
+            if (!on)
+                tap++;
+            else if (t - lastPublish > worstAge)
+                worstAge = t - lastPublish;
+        }
+        if (!event)
+            continue;
+
+        wakes++;
+        uint8_t reason = FieldWake::poll();
+        if (reason == FIELD_WAKE_NONE)
+            continue;
+        uint32_t start = micros();
+        int16_t centi = wakeCycle(sensor, t);
+        uint32_t spent = micros() - start;
+        lastPublish = t;
+        if (reason == FIELD_WAKE_FIELD)
+        {
+            firstField = firstField || tap == 0;
+            fieldCycles++;
+            if (spent > worstPublish)
+                worstPublish = spent;
+            if (centi == INT16_MIN || !readerShows(tag, centi))
+                stale++;
+        }
+        else
+            refreshCycles++;
+    }
+    SimI2c::detach(NTAG5_I2C_ADDRESS);
+    SimI2c::detach(BoardSensor::ADDRESS);
+
+    uint32_t polling = DAY_S * 4;
+    printf("250 ms polling   %6lu wakes/day, %6lu cycles\n", (unsigned long)polling, (unsigned long)polling);
+    printf("field detect     %6lu wakes/day, %6lu cycles (%lu field, %lu refresh)  %.0fx fewer wakes\n",
+           (unsigned long)wakes, (unsigned long)(fieldCycles + refreshCycles), (unsigned long)fieldCycles,
+           (unsigned long)refreshCycles, (double)polling / wakes);
+    printf("  of which PIT ticks %lu; FIELD_WAKE_REFRESH_TICKS 0 leaves %lu wakes/day\n",
+           (unsigned long)(DAY_S / FIELD_WAKE_TICK_S), (unsigned long)(wakes - DAY_S / FIELD_WAKE_TICK_S));
+    printf("field to reading %6lu us worst (target %u ms), stale views %u, oldest value at tap %lu s\n",
+           (unsigned long)worstPublish, FIELD_WAKE_PUBLISH_MS, stale, (unsigned long)worstAge);
+    printf("first field after reset %s\n", firstField ? "started a cycle" : "MISSED");
+
+    bool ok = firstField && fieldCycles == tapCount && !stale && worstPublish <= FIELD_WAKE_PUBLISH_MS * 1000UL &&
+              wakes * 100 < polling &&
+              (!FIELD_WAKE_REFRESH_TICKS || worstAge <= (FIELD_WAKE_REFRESH_TICKS + 1) * FIELD_WAKE_TICK_S);
+    return ok ? 0 : 1;
+}
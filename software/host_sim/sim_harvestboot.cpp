@@ -0,0 +1,98 @@
+//  Field-powered NTAG board, from power-up to the reading on the tag:
+//  HarvestBoot::publish() against the cold path of the sketch's wake cycle
+//  (default bus clock, tag and sensor set up, EEPROM fallback written
+//  before the live image). Each run starts from a fresh tag and sensor, as
+//  after the field appeared. The fast path must stay within
+//  HARVEST_BOOT_BUDGET_CYCLES at HARVEST_BOOT_CPU_HZ, and the reader must
+//  find the value the sensor model was set to.
+
+#include "Scenarios.h"
+#include "Sensors.h"
+#include "Ntag5.h"
+#include "I2cBus.h"
+#include "WarmState.h"
+#include "HarvestBoot.h"
+#include "devices/SimNtag5.h"
+#include "devices/SimSensors.h"
+#include <Wire.h>
+#include <stdio.h>
+
+namespace {
+#include "NtagUtils.h"
+}
+
+//  what the reader finds: the text record in the first 64 blocks
+static bool readerShows(const SimNtag5& tag, int16_t centi)
+{
+    char value[8], text[32];
+    uint8_t view[64 * NTAG5_BLOCK_SIZE];
+    formatCentiCelsius(value, centi);
+    snprintf(text, sizeof(text), "Temperature: %s", value);
+    tag.rfView(view, 0, 64);
+    return view[0] == 0xE1 && view[4] == 0x03 && memcmp(view + 13, text, strlen(text)) == 0;
+}
+
+//  the sketch's setup() after a power-on reset, up to the published value
+static bool coldCycle()
+{
+    RSTCTRL.RSTFR = RESET_CAUSE_POWER_ON;
+    WarmState::begin();
+    Wire.setClock(100000);
+    I2cBus::begin();
+    I2cBus::beginSession(300000UL);
+    bool ok = setupNFC(false) != NFC_ABSENT;
+    int16_t centi = 0;
+    ok = ok && BoardThermometer::begin() && BoardThermometer::read(centi);
+    char value[8];
+    formatCentiCelsius(value, centi);
+    ok = ok && updateNFC(OS_ANDROID, "Temperature: " + String(value) + " °C");
+    I2cBus::endSession();
+    return ok;
+}
+
+static uint32_t cycles(uint32_t us)
+{
+    return (uint32_t)((uint64_t)us * HARVEST_BOOT_CPU_HZ / 1000000UL);
+}
+
+int simHarvestBoot(int, char**)
+{
+    static const int16_t temps[] = { -1250, 0, 2175, 4400 };
+    uint32_t worstFast = 0, worstCold = 0;
+    unsigned wrong = 0;
+
+    for (unsigned i = 0; i < sizeof(temps) / sizeof(temps[0]); i++)
+    {
+        for (int fast = 1; fast >= 0; fast--)
+        {
+            SimNtag5 tag;
+            SimTmp112 sensor;
+            SimI2c::attach(NTAG5_I2C_ADDRESS, &tag);
+            SimI2c::attach(BoardSensor::ADDRESS, &sensor);
+            sensor.setTemperature(temps[i]);
+            tag.setField(true);
+
+            uint32_t start = micros();
+            bool ok = fast ? HarvestBoot::publish() : coldCycle();
+            uint32_t spent = micros() - start;
+            ok = ok && readerShows(tag, temps[i]);
+            wrong += ok ? 0 : 1;
+            uint32_t& worst = fast ? worstFast : worstCold;
+            if (spent > worst)
+                worst = spent;
+            printf("%6d cC  %-10s %6lu us  %7lu cycles  %2lu EEPROM blocks  %s\n", temps[i],
+                   fast ? "fast path" : "cold cycle", (unsigned long)spent,
+                   (unsigned long)cycles(spent),
+                   (unsigned long)tag.stats.blockWrites, ok ? "ok" : "FAIL");
+            SimI2c::detach(BoardSensor::ADDRESS);
+            SimI2c::detach(NTAG5_I2C_ADDRESS);
+        }
+    }
+
+    Wire.setClock(100000);
+    uint32_t worstCycles = cycles(worstFast);
+    printf("fast path worst %lu cycles at %lu MHz, budget %lu; cold cycle worst %lu us (%.1fx)\n",
+           (unsigned long)worstCycles, (unsigned long)(HARVEST_BOOT_CPU_HZ / 1000000UL),
+           (unsigned long)HARVEST_BOOT_BUDGET_CYCLES, (unsigned long)worstCold, (double)worstCold / worstFast);
+    return !wrong && worstCycles <= HARVEST_BOOT_BUDGET_CYCLES ? 0 : 1;
+}
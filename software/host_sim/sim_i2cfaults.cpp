@@ -0,0 +1,94 @@
+//  Runs the setup() bus work (RF430 bring-up, one sensor reading, NDEF
+//  publish) against healthy and faulty parts and checks that the awake time
+//  stays inside the bound reported by I2cBus.
+
+#include "Scenarios.h"
+#include "Sensors.h"
+#include "I2cBus.h"
+#include "NfcUtils.h"
+#include "devices/SimRf430.h"
+#include "devices/SimSensors.h"
+#include <stdio.h>
+
+static const uint32_t BUDGET_US = 300000UL;     // AWAKE_BUDGET_MS in nfc_sense.ino
+
+struct Fault
+{
+    const char* name;
+    void (*apply)(SimRf430& tag, SimTmp112& sensor);
+    uint32_t budgetUs;
+};
+
+static void healthy(SimRf430&, SimTmp112&) {}
+static void tagAbsent(SimRf430& tag, SimTmp112&) { tag.setPresent(false); }
+static void tagNacks(SimRf430& tag, SimTmp112&) { tag.nackNext(2); }
+static void tagLatched(SimRf430& tag, SimTmp112&) { tag.setStretch(2000000UL); }
+static void readerBusy(SimRf430& tag, SimTmp112&) { tag.setRfBusyFor(2000000UL); }
+static void shortBudget(SimRf430&, SimTmp112&) {}
+
+static const Fault faults[] = {
+    { "healthy",     healthy,     BUDGET_US },
+    { "rf430 gone",  tagAbsent,   BUDGET_US },
+    { "rf430 nack",  tagNacks,    BUDGET_US },
+    { "rf430 latch", tagLatched,  BUDGET_US },
+    { "rf busy 2s",  readerBusy,  BUDGET_US },
+    { "sensor gone", 0,           BUDGET_US },
+    { "budget 30ms", shortBudget, 30000UL },    // ends in the conversion wait
+};
+
+int simI2cFaults(int, char**)
+{
+    int status = 0;
+    printf("%-12s %-8s %-6s %8s %8s %5s %5s %5s %3s %s\n", "case", "tag", "sensor",
+           "awake us", "bound us", "calls", "retry", "fail", "err", "wd");
+
+    for (unsigned i = 0; i < sizeof(faults) / sizeof(faults[0]); i++)
+    {
+        SimRf430 tag;
+        SimTmp112 sensor;
+        SimI2c::attach(RF430_I2C_ADDRESS, &tag);
+        if (faults[i].apply)
+        {
+            SimI2c::attach(Tmp112::ADDRESS, &sensor);
+            faults[i].apply(tag, sensor);
+        }
+
+        uint32_t start = micros();
+        Wire.begin();
+        I2cBus::begin();
+        I2cBus::beginSession(faults[i].budgetUs);
+        uint8_t state = setupNFC(false);
+        int16_t centi = 0;
+        bool sensorOk = BoardThermometer::begin() && BoardThermometer::read(centi);
+        if (state != NFC_ABSENT)
+        {
+            char text[8];
+            formatCentiCelsius(text, centi);
+            if (!updateNFC(OS_ANDROID, sensorOk ? "Temperature: " + String(text) : String("Sensor not found")))
+                state = NFC_ABSENT;
+        }
+        I2cBus::endSession();
+        uint32_t awake = micros() - start;
+        uint32_t bound = I2cBus::awakeBoundMicros();
+        bool armed = tag.reg(COMM_WD_CTRL_REG) & WD_ENABLE;
+
+        static const char* const states[] = { "absent", "written", "intact" };
+        printf("%-12s %-8s %-6s %8lu %8lu %5u %5u %5u %3u %s\n", faults[i].name, states[state],
+               sensorOk ? "ok" : "fail", (unsigned long)awake, (unsigned long)bound,
+               I2cBus::stats.calls, I2cBus::stats.retries, I2cBus::stats.failures,
+               I2cBus::lastError, armed ? "armed" : "-");
+
+        bool ok = awake <= bound;
+        if (faults[i].apply == healthy)
+            ok = ok && state == NFC_WRITTEN && sensorOk && !I2cBus::stats.failures && armed;
+        if (faults[i].apply == tagNacks)
+            ok = ok && state == NFC_WRITTEN && I2cBus::stats.retries;
+        if (faults[i].apply == tagAbsent || faults[i].apply == tagLatched)
+            ok = ok && state == NFC_ABSENT;
+        status |= ok ? 0 : 1;
+
+        SimI2c::detach(RF430_I2C_ADDRESS);
+        SimI2c::detach(Tmp112::ADDRESS);
+    }
+    return status;
+}
@@ -0,0 +1,73 @@
+//  Host simulator for the nfc_sense firmware.
+//
+//      host_sim <scenario> [args]
+//      host_sim ntagwear [sample period ms]
+//      host_sim all
+
+#include "Scenarios.h"
+#include <stdio.h>
+#include <string.h>
+
+struct Scenario
+{
+    const char* name;
+    int (*run)(int argc, char** argv);
+    const char* help;
+};
+
+static const Scenario scenarios[] = {
+    { "sensors", simSensors, "wake time and bus traffic per sensor policy" },
+    { "bme280",  simBme280,  "BME280 integer compensation and oversampling cost" },
+    { "warmboot", simWarmboot, "warm-reset state: EEPROM wear and cold vs warm wake time" },
+    { "i2cfaults", simI2cFaults, "awake time bound with missing, NACKing and latched-up parts" },
+    { "ntag5",     simNtag5,     "NTAG 5 Link driver: CC format and block-aligned NDEF writes" },
+    { "ntagsram",  simNtagSram,  "SRAM mirror publishing vs EEPROM writes: latency and wear" },
+    { "ntagwear",  simNtagWear,  "block-diff EEPROM writes: blocks per update, projected lifetime" },
+    { "ntagwrite", simNtagWrite, "NTAG write strategies and busy handling: time, traffic, wear" },
+    { "fieldwake", simFieldWake, "ED field-detect wake vs 250 ms polling: wakes per day, latency" },
+    { "mculess",   simMculess,   "MCU-less boards: tag as I2C master reads the sensor over RF" },
+    { "planner",   simPlanner,   "reader ISO 15693 plans for the MCU-less boards: frames, latency" },
+    { "harvestboot", simHarvestBoot, "field-powered boot: reset to reading on the tag, cycle budget" },
+    { "tagdetect", simTagDetect, "one build on RF430 and NTAG 5 boards: detection, caching, publish" },
+    { "ndefswap",  simNdefSwap,  "RF430 updates with RF on: double-buffered NDEF, unavailable window" },
+    { "epd",       simEpd,       "e-paper driver: partial window refresh vs full screen, sleep on BUSY" },
+    { "render",    simRender,    "glyph renderer without framebuffer: dirty cells, rows computed, SPI" },
+    { "trend",     simTrend,     "trend chart fed per reading: changed columns vs whole chart" },
+    { "blink",     simBlink,     "status LED patterns from PIT events and CCL: flashes, duty, no wakes" },
+    { "rail",      simRail,      "sensor and panel on a switched supply: sleep current, wake charge" },
+    { "alertwake", simAlertWake, "cold-chain limit on the sensor ALERT vs background refresh: wakes, lag" },
+    { "provision", simProvision, "TMP117 settings in its EEPROM: programmed once, tag read per boot" },
+    { "clock",     simClock,     "clock prescaler per wake phase vs fixed clock: charge per wake" },
+    { "supply",    simSupply,    "coin cell run down: VDD every N wakes, battery note, stretched refresh" },
+    { "budget",    simBudget,    "field-powered wake cycle: tasks against the storage charge, shed vs brown-out" },
+};
+
+static const unsigned SCENARIO_COUNT = sizeof(scenarios) / sizeof(scenarios[0]);
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        printf("usage: host_sim <scenario>|all\n");
+        for (unsigned i = 0; i < SCENARIO_COUNT; i++)
+            printf("  %-12s %s\n", scenarios[i].name, scenarios[i].help);
+        return 2;
+    }
+
+    int status = 0;
+    bool found = false;
+    for (unsigned i = 0; i < SCENARIO_COUNT; i++)
+    {
+        if (strcmp(argv[1], "all") && strcmp(argv[1], scenarios[i].name))
+            continue;
+        found = true;
+        printf("== %s\n", scenarios[i].name);
+        status |= scenarios[i].run(argc - 2, argv + 2);
+    }
+    if (!found)
+    {
+        printf("unknown scenario '%s'\n", argv[1]);
+        return 2;
+    }
+    return status;
+}
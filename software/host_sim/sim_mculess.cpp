@@ -0,0 +1,146 @@
+//  MCU-less boards: the tag is provisioned over I2C as a jig would do it,
+//  powered down, and then read from the RF side only. The reader replays
+//  the Ntag5Master recipes through the model's WRITE_I2C / READ_I2C /
+//  READ_SRAM commands, the tag runs them as I2C master against the sensor
+//  models, and the decoded values must match what the models were set to.
+//  With energy harvesting off VOUT stays down and the sensor must not
+//  answer.
+
+#include "Scenarios.h"
+#include "Ntag5.h"
+#include "Ntag5Master.h"
+#include "I2cBus.h"
+#include "devices/SimNtag5.h"
+#include "devices/SimSensors.h"
+#include <stdio.h>
+
+struct ReplayStats
+{
+    unsigned commands;      // RF commands sent
+    unsigned nacks;         // master status other than OK
+    uint32_t micros;        // I2C and waits, RF frame time not included
+};
+
+//  reader side: one recipe through the RF custom commands, result bytes in order
+static bool replay(SimNtag5& tag, const uint8_t* recipe, uint8_t* result, ReplayStats& stats)
+{
+    memset(&stats, 0, sizeof(stats));
+    uint32_t start = micros();
+    Ntag5MasterOp op;
+    uint8_t status[NTAG5_BLOCK_SIZE];
+    while ((recipe = Ntag5Master::next(recipe, op)))
+    {
+        if (op.kind == NTAG5_OP_WAIT)
+        {
+            delay(op.len);
+            continue;
+        }
+        bool sent = op.kind == NTAG5_OP_WRITE ? tag.rfWriteI2c(op.addr, op.data, op.len)
+                                              : tag.rfReadI2c(op.addr, op.len);
+        bool polled = tag.rfReadConfig(NTAG5_REG_I2C_MASTER_STATUS & 0xFF, status);
+        stats.commands += 2;
+        if (!sent || !polled)
+            return false;
+        if ((status[0] & NTAG5_I2C_M_TRANS_MASK) != NTAG5_I2C_M_TRANS_OK)
+        {
+            stats.nacks++;
+            continue;
+        }
+        if (op.kind == NTAG5_OP_READ)
+        {
+            uint8_t blocks = (op.len + NTAG5_BLOCK_SIZE - 1) / NTAG5_BLOCK_SIZE;
+            uint8_t sram[NTAG5_SRAM_BLOCKS * NTAG5_BLOCK_SIZE];
+            if (!tag.rfReadSram(sram, 0, blocks))
+                return false;
+            stats.commands++;
+            memcpy(result, sram, op.len);
+            result += op.len;
+        }
+    }
+    stats.micros = micros() - start;
+    return true;
+}
+
+//  jig on the test points: configuration over I2C, then power removed
+static bool provision(SimNtag5& tag)
+{
+    bool written, again, master;
+    I2cBus::beginSession(1000000UL);
+    bool ok = Ntag5Master::provision(NTAG5_MCULESS_CONFIG, 2, written) &&
+              Ntag5::waitEepromIdle(NTAG5_EEPROM_TIMEOUT_MS) &&
+              Ntag5Master::provision(NTAG5_MCULESS_CONFIG, 2, again) &&
+              Ntag5Master::isMaster(master);
+    I2cBus::endSession();
+    printf("provision: written %s, second pass wrote %s, master at power-up %s\n",
+           written ? "yes" : "no", again ? "yes" : "no", master ? "yes" : "no");
+    tag.powerCycle();
+    tag.setField(true);
+    return ok && written && !again && master && !I2cBus::probe(NTAG5_I2C_ADDRESS);
+}
+
+int simMculess(int, char**)
+{
+    int status = 0;
+    uint8_t result[64];
+    ReplayStats stats;
+
+    // nfc_sense_ntag_surface: TMP112
+    {
+        SimNtag5 tag;
+        SimTmp112 sensor;
+        SimI2c::attach(NTAG5_I2C_ADDRESS, &tag);
+        SimI2c::attach(0x48, &sensor);
+        status |= provision(tag) ? 0 : 1;
+
+        const int16_t temps[] = { -1000, 0, 2345, 5000 };
+        for (unsigned i = 0; i < sizeof(temps) / sizeof(temps[0]); i++)
+        {
+            sensor.setTemperature(temps[i]);
+            bool ok = replay(tag, NTAG5_RECIPE_TMP112, result, stats);
+            int16_t centi = Ntag5Master::tmp112CentiCelsius(result);
+            ok = ok && !stats.nacks && abs(centi - temps[i]) <= 7;
+            printf("TMP112 %6d cC read %6d cC  %2u RF commands  %5lu us  %s\n", temps[i], centi,
+                   stats.commands, (unsigned long)stats.micros, ok ? "ok" : "FAIL");
+            status |= ok ? 0 : 1;
+        }
+
+        // harvesting off: VOUT down, the sensor must not answer
+        tag.rfWriteConfig(NTAG5_REG_EH_CONFIG & 0xFF, (const uint8_t*)"\0\0\0\0");
+        bool ok = replay(tag, NTAG5_RECIPE_TMP112, result, stats) && stats.nacks;
+        printf("TMP112 with VOUT off: %u NACKed transfers (%s)\n", stats.nacks, ok ? "ok" : "FAIL");
+        status |= ok ? 0 : 1;
+        SimI2c::detach(0x48);
+        SimI2c::detach(NTAG5_I2C_ADDRESS);
+    }
+
+    // nfc_sense_ntag_BME: BME280
+    {
+        SimNtag5 tag;
+        SimBme280 sensor;
+        SimI2c::attach(NTAG5_I2C_ADDRESS, &tag);
+        SimI2c::attach(BME280_I2C_ADDRESS, &sensor);
+        status |= provision(tag) ? 0 : 1;
+
+        bool ok = replay(tag, NTAG5_RECIPE_BME280_CAL, result, stats) && !stats.nacks &&
+                  Ntag5Master::resultLength(NTAG5_RECIPE_BME280_CAL) == 33;
+        Ntag5Master::bme280Calibration(result);
+        printf("BME280 calibration  %2u RF commands  %5lu us  %s\n", stats.commands,
+               (unsigned long)stats.micros, ok ? "ok" : "FAIL");
+        status |= ok ? 0 : 1;
+
+        sensor.setEnvironment(2150, 99500, 455);
+        Bme280Data data;
+        ok = replay(tag, NTAG5_RECIPE_BME280, result, stats) && !stats.nacks;
+        Ntag5Master::bme280Decode(result, data);
+        // x1 oversampling: 2.6 Pa pressure resolution
+        ok = ok && abs(data.centiCelsius - 2150) <= 1 && labs((long)data.pascal - 99500) <= 4 &&
+             abs((int)data.humidityPermille - 455) <= 2;
+        printf("BME280 %d cC %lu Pa %u pm  %2u RF commands  %5lu us  %s\n", data.centiCelsius,
+               (unsigned long)data.pascal, data.humidityPermille, stats.commands,
+               (unsigned long)stats.micros, ok ? "ok" : "FAIL");
+        status |= ok ? 0 : 1;
+        SimI2c::detach(BME280_I2C_ADDRESS);
+        SimI2c::detach(NTAG5_I2C_ADDRESS);
+    }
+    return status;
+}
@@ -0,0 +1,156 @@
+//  RF430 NDEF updates while a phone may be reading. The same readings are
+//  published three ways: the old path (RF off for the whole write), the
+//  message rewritten in place with RF left on, and the double-buffered
+//  update that the firmware uses now (spare slot, then the CC switch).
+//  After every write transaction the model's RF side is decoded as a phone
+//  would: a window opens when the reader would get no message or a torn
+//  one, and the transaction that switches from one message to the next
+//  counts as a window of its own. The double buffer must never tear and
+//  keep every window within one 4-byte write (address plus file ID).
+
+#include "Scenarios.h"
+#include "I2cBus.h"
+#include "TagBackend.h"
+#include "RF430CL330H_Shield.h"
+#include "devices/SimRf430.h"
+#include <stdio.h>
+
+static const unsigned UPDATES = 24;
+static const uint8_t SWAP_BYTES = 4;
+
+enum { RF_OFF, IN_PLACE, BUFFERED };
+
+//  what the reader would show and how long it could not
+static struct
+{
+    const char* texts[2];       // message published before and after this update
+    int         shown;          // index into texts, -1 for nothing or torn
+    uint32_t    badSince;       // window start, 0 while a message is readable
+    uint32_t    windows;
+    uint32_t    worstMicros;
+    uint32_t    totalMicros;
+    uint32_t    torn;           // transactions after which RF was on and the message broken
+} watch;
+
+//  the record updateNFC() writes: NLEN, short text record, text with its NUL
+static uint16_t encode(const char* text, uint8_t* out)
+{
+    uint8_t len = strlen(text) + 1;
+    const uint8_t head[] = { 0, (uint8_t)(len + 8), 0xD1, 0x01, (uint8_t)(len + 4), 0x54, 0x02, 'e', 'n' };
+    memcpy(out, head, sizeof(head));
+    memcpy(out + sizeof(head), text, len);
+    return sizeof(head) + len;
+}
+
+static int decode(const SimRf430& tag)
+{
+    uint8_t view[RF430_NDEF_MAX_SIZE];
+    uint16_t nlen = tag.rfRead(view, sizeof(view));
+    for (int i = 0; i < 2; i++)
+    {
+        const char* text = watch.texts[i];
+        if (!text)
+            continue;
+        uint8_t len = strlen(text);
+        if (nlen == len + 9 && view[0] == 0xD1 && view[3] == 'T' &&
+            !memcmp(view + 7, text, len) && view[7 + len] == 0)
+            return i;
+    }
+    return -1;
+}
+
+static void onWrite(const SimRf430& tag)
+{
+    uint32_t start = SimI2c::transactionStart(), end = micros();
+    int shown = decode(tag);
+    uint32_t window = 0;
+    if (shown < 0 && (tag.reg(CONTROL_REG) & RF_ENABLE))
+        watch.torn++;
+    if (watch.badSince)
+    {
+        if (shown >= 0)
+        {
+            window = end - watch.badSince;
+            watch.badSince = 0;
+        }
+    }
+    else if (shown < 0)
+        watch.badSince = start;
+    else if (shown != watch.shown)
+        window = end - start;
+    if (window)
+    {
+        watch.windows++;
+        watch.totalMicros += window;
+        if (window > watch.worstMicros)
+            watch.worstMicros = window;
+    }
+    watch.shown = shown;
+}
+
+static bool publish(uint8_t scheme, RF430CL330H_Shield& nfc, const char* text)
+{
+    if (scheme == BUFFERED)
+        return TagBackend::publish(OS_ANDROID, text);
+    uint8_t msg[RF430_NDEF_MAX_SIZE];
+    uint16_t len = encode(text, msg);
+    if (scheme == RF_OFF)
+        return nfc.Write_Extended_NDEFmessage(msg, len);
+    return nfc.Write_Continuous(RF430_NDEF_SLOT_A + 2, msg, len) && nfc.Write_Register(CONTROL_REG, RF_ENABLE);
+}
+
+int simNdefSwap(int, char**)
+{
+    static const char* const names[] = { "RF off", "in place, RF on", "double buffer" };
+    static char texts[2][48];
+    uint32_t swapMicros = ((1 + 9 + 9 * SWAP_BYTES + 1) * 1000000UL + SimI2c::clock() - 1) / SimI2c::clock();
+    int status = 0;
+
+    printf("%-16s %7s %6s %8s %10s %10s\n", "scheme", "updates", "torn", "windows", "worst us", "us/update");
+    for (uint8_t scheme = RF_OFF; scheme <= BUFFERED; scheme++)
+    {
+        SimRf430 tag;
+        SimI2c::attach(RF430_I2C_ADDRESS, &tag);
+        RF430CL330H_Shield nfc(5, 4);
+        TagBackend::reset();
+        memset(&watch, 0, sizeof(watch));
+
+        I2cBus::beginSession(1000000UL);
+        bool ok = TagBackend::setup(false) == TAG_WRITTEN;
+        strcpy(texts[0], "Temperature: 20.00 °C Humidity: 40.00 %RH");
+        ok = publish(scheme, nfc, texts[0]) && nfc.Write_Register(CONTROL_REG, RF_ENABLE) && ok;
+        I2cBus::endSession();
+        watch.texts[0] = texts[0];
+        watch.shown = decode(tag);
+        ok = ok && watch.shown == 0;
+
+        tag.setWriteHook(onWrite);
+        uint32_t spent = 0;
+        for (unsigned i = 0; i < UPDATES; i++)
+        {
+            uint8_t prev = i & 1;
+            snprintf(texts[prev ^ 1], sizeof(texts[0]), "Temperature: 21.%02u °C Humidity: %u.%02u %%RH",
+                     50 + i % 40, 45 + i % 7, i * 37 % 100);
+            watch.texts[0] = texts[prev];
+            watch.texts[1] = texts[prev ^ 1];
+            I2cBus::beginSession(1000000UL);
+            ok = publish(scheme, nfc, watch.texts[1]) && ok;
+            I2cBus::endSession();
+            spent += I2cBus::sessionMicros();
+            ok = ok && decode(tag) == 1 && !watch.badSince;
+            watch.shown = 0;    // the new message is the old one of the next update
+        }
+        tag.setWriteHook(0);
+        SimI2c::detach(RF430_I2C_ADDRESS);
+
+        if (scheme == BUFFERED)
+            ok = ok && !watch.torn && watch.worstMicros <= swapMicros;
+        printf("%-16s %7u %6lu %8lu %10lu %10lu  %s\n", names[scheme], UPDATES, (unsigned long)watch.torn,
+               (unsigned long)watch.windows, (unsigned long)watch.worstMicros,
+               (unsigned long)(spent / UPDATES), ok ? "ok" : "FAIL");
+        status |= ok ? 0 : 1;
+    }
+    printf("windows bound for the double buffer: one %u byte write, %lu us at %lu kHz\n",
+           SWAP_BYTES, (unsigned long)swapMicros, (unsigned long)(SimI2c::clock() / 1000));
+    return status;
+}
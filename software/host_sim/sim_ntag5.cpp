@@ -0,0 +1,87 @@
+//  Formats an empty NTAG 5 Link model, publishes a short text record and a
+//  long message through the Ntag5 driver and checks the type 5 layout byte
+//  by byte.
+
+#include "Scenarios.h"
+#include "Ntag5.h"
+#include "I2cBus.h"
+#include "devices/SimNtag5.h"
+#include <stdio.h>
+
+//  reference layout: CC, NDEF TLV, terminator
+static uint16_t expected(uint8_t* out, const uint8_t* message, uint16_t len)
+{
+    static const uint8_t cc[4] = NTAG5_CC;
+    uint16_t n = 0;
+    memcpy(out, cc, 4);
+    n = 4;
+    out[n++] = 0x03;
+    if (len < 0xFF)
+        out[n++] = len;
+    else
+    {
+        out[n++] = 0xFF;
+        out[n++] = len >> 8;
+        out[n++] = len & 0xFF;
+    }
+    memcpy(out + n, message, len);
+    n += len;
+    out[n++] = 0xFE;
+    return n;
+}
+
+static int check(const char* name, SimNtag5& tag, const uint8_t* message, uint16_t len, uint32_t start)
+{
+    static uint8_t ref[SimNtag5::USER_BYTES];
+    uint16_t n = expected(ref, message, len);
+    bool match = memcmp(tag.user(), ref, n) == 0;
+    printf("%-10s %4u bytes  %3lu blocks  %5lu us  bus %5lu us  %3lu transactions  misaligned %lu  %s\n",
+           name, n, (unsigned long)tag.stats.blockWrites, (unsigned long)(micros() - start),
+           (unsigned long)SimI2c::stats.busMicros, (unsigned long)SimI2c::stats.transactions,
+           (unsigned long)tag.stats.misaligned, match ? "layout ok" : "LAYOUT MISMATCH");
+    return match && !tag.stats.misaligned ? 0 : 1;
+}
+
+int simNtag5(int, char**)
+{
+    int status = 0;
+    SimNtag5 tag;
+    SimI2c::attach(NTAG5_I2C_ADDRESS, &tag);
+
+    bool written = false;
+    bool up = Ntag5::begin() && Ntag5::formatCapabilityContainer(written);
+    bool again = false;
+    up = up && Ntag5::formatCapabilityContainer(again);
+    printf("begin %s, CC written %s, second format wrote %s\n",
+           up ? "ok" : "FAIL", written ? "yes" : "no", again ? "yes" : "no");
+    status |= up && written && !again ? 0 : 1;
+
+    // short text record, same bytes Ntag5::writeNdefText() should produce
+    const char* text = "Temperature: 23.4 C";
+    uint8_t record[64] = { 0xD1, 0x01, (uint8_t)(3 + strlen(text)), 'T', 0x02, 'e', 'n' };
+    memcpy(record + 7, text, strlen(text));
+    SimI2c::reset();
+    tag.stats.blockWrites = 0;
+    uint32_t start = micros();
+    status |= Ntag5::writeNdefText(text) ? 0 : 1;
+    status |= check("text", tag, record, 7 + strlen(text), start);
+
+    // message beyond 254 bytes takes the three byte TLV length
+    static uint8_t big[300];
+    const uint16_t payload = sizeof(big) - 7;   // long record: 4-byte payload length
+    big[0] = 0xC1;
+    big[1] = 0x01;
+    big[4] = payload >> 8;
+    big[5] = payload & 0xFF;
+    big[6] = 'T';
+    for (unsigned i = 7; i < sizeof(big); i++)
+        big[i] = 'a' + i % 26;
+    SimI2c::reset();
+    tag.stats.blockWrites = 0;
+    start = micros();
+    status |= Ntag5::writeNdef(big, sizeof(big)) ? 0 : 1;
+    status |= check("300 bytes", tag, big, sizeof(big), start);
+
+    SimI2c::detach(NTAG5_I2C_ADDRESS);
+    return status;
+}
@@ -0,0 +1,160 @@
+//  Publishes a stream of readings through NtagUtils.h (SRAM mirror plus a
+//  rate limited EEPROM fallback) and through plain EEPROM writes, and
+//  compares update latency and EEPROM blocks programmed. After every update
+//  the reader's view is decoded and must show the new text; after a tag
+//  power cycle it must fall back to the last EEPROM message, setupNFC()
+//  must report the mirror lost and the next update bring it back. A reader
+//  polling the tag after every write transaction must get the old text,
+//  the new one or an empty message, never a torn one, through the mirror.
+
+#include "Scenarios.h"
+#include "Sensors.h"
+#include "Ntag5.h"
+#include "WarmState.h"
+#include "devices/SimNtag5.h"
+#include <Wire.h>
+#include <stdio.h>
+
+// sketch helpers are plain definitions, sim_i2cfaults.cpp has the RF430 ones
+namespace ntag_utils {
+#include "NtagUtils.h"
+}
+using namespace ntag_utils;
+
+static const unsigned UPDATES = 256;
+
+//  text of the first record the reader finds, empty if the layout is broken
+static void readerText(const SimNtag5& tag, char* out)
+{
+    uint8_t view[64 * NTAG5_BLOCK_SIZE];
+    tag.rfView(view, 0, 64);
+    out[0] = 0;
+    if (view[0] != 0xE1 || view[4] != 0x03 || view[6] != 0xD1 || view[9] != 'T')
+        return;
+    uint8_t textLen = view[8] - 3;
+    memcpy(out, view + 13, textLen);
+    out[textLen] = 0;
+}
+
+//  reader polling during an update
+static struct
+{
+    const char* texts[2];       // before and after the update
+    unsigned    torn;
+    unsigned    empty;
+} watch;
+
+static void onWrite(const SimNtag5& tag)
+{
+    uint8_t view[64 * NTAG5_BLOCK_SIZE];
+    tag.rfView(view, 0, 64);
+    bool blank = !watch.texts[0] && view[4] != 0x03;     // nothing published yet
+    if (blank || (view[0] == 0xE1 && view[4] == 0x03 && view[5] == 0 && view[6] == 0xFE))
+    {
+        watch.empty++;
+        return;
+    }
+    char seen[64];
+    readerText(tag, seen);
+    bool whole = view[5] == view[8] + 4 && view[6 + view[5]] == 0xFE;
+    for (int i = 0; i < 2; i++)
+        if (whole && watch.texts[i] && !strcmp(seen, watch.texts[i]))
+            return;
+    watch.torn++;
+}
+
+static void reading(char* text, unsigned i)
+{
+    char value[8];
+    formatCentiCelsius(value, 2000 + (int16_t)(i * 7 % 300));
+    // now and then with the battery note (Supply.h): the length changes
+    // and the update spans more bursts
+    snprintf(text, 48, "Temperature: %s C%s", value, i % 8 == 5 ? ", battery low" : "");
+}
+
+int simNtagSram(int, char**)
+{
+    int status = 0;
+    char text[48], seen[64], last[48] = "", previous[48] = "";
+    uint32_t eepromAvg = 0;
+
+    for (int mode = 0; mode < 2; mode++)
+    {
+        SimNtag5 tag;
+        SimI2c::attach(NTAG5_I2C_ADDRESS, &tag);
+        setupNFC(false);
+        tag.stats.blockWrites = 0;
+        memset(&watch, 0, sizeof(watch));
+        tag.setWriteHook(onWrite);
+
+        uint32_t total = 0, worst = 0, live = 0;
+        unsigned wrong = 0, liveUpdates = 0;
+        for (unsigned i = 0; i < UPDATES; i++)
+        {
+            RSTCTRL.RSTFR = i ? RESET_CAUSE_WATCHDOG : RESET_CAUSE_POWER_ON;
+            WarmState::begin();
+            reading(text, i);
+            watch.texts[0] = i ? previous : 0;
+            watch.texts[1] = text;
+
+            uint32_t start = micros();
+            bool ok = mode ? updateNFC(OS_ANDROID, String(text)) : Ntag5::writeNdefText(text);
+            uint32_t spent = micros() - start;
+            total += spent;
+            if (mode && fallbackAge)
+            {
+                live += spent;
+                liveUpdates++;
+            }
+            if (spent > worst)
+                worst = spent;
+
+            readerText(tag, seen);
+            if (!ok || strcmp(seen, text))
+                wrong++;
+            if (mode && (i == 0 || fallbackAge == 0))
+                strcpy(last, text);
+            strcpy(previous, text);
+        }
+        tag.setWriteHook(0);
+
+        printf("%-14s avg %6lu us  worst %6lu us  eeprom blocks %5lu (%4.1f per update)  wrong views %u"
+               "  torn %u  empty %u\n",
+               mode ? "sram mirror" : "eeprom only", (unsigned long)(total / UPDATES),
+               (unsigned long)worst, (unsigned long)tag.stats.blockWrites,
+               (double)tag.stats.blockWrites / UPDATES, wrong, watch.torn, watch.empty);
+        status |= wrong || (mode && watch.torn) ? 1 : 0;
+        if (mode)
+        {
+            uint32_t liveAvg = liveUpdates ? live / liveUpdates : 0;
+            printf("%-14s avg %6lu us  (SRAM only, %u updates)\n", "live updates",
+                   (unsigned long)liveAvg, liveUpdates);
+            status |= liveAvg < eepromAvg ? 0 : 1;
+        }
+        else
+            eepromAvg = total / UPDATES;
+
+        if (mode)
+        {
+            tag.powerCycle();
+            readerText(tag, seen);
+            bool fallbackOk = strcmp(seen, last) == 0;
+            printf("after tag power cycle the reader sees \"%s\" (%s)\n", seen,
+                   fallbackOk ? "last fallback" : "WRONG");
+            status |= fallbackOk ? 0 : 1;
+
+            // the MCU kept running: the unchanged reading must go out again
+            uint32_t blocks = tag.stats.blockWrites;
+            uint8_t state = setupNFC(true);
+            bool ok = state == NFC_WRITTEN && updateNFC(OS_ANDROID, String(previous));
+            readerText(tag, seen);
+            ok = ok && tag.mirrorOn() && !strcmp(seen, previous);
+            printf("setupNFC then reports %s, republished \"%s\" with %lu EEPROM blocks (%s)\n",
+                   state == NFC_WRITTEN ? "written" : state == NFC_INTACT ? "intact" : "absent", seen,
+                   (unsigned long)(tag.stats.blockWrites - blocks), ok ? "mirror back" : "WRONG");
+            status |= ok ? 0 : 1;
+        }
+        SimI2c::detach(NTAG5_I2C_ADDRESS);
+    }
+    return status;
+}
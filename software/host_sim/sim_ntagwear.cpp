@@ -0,0 +1,125 @@
+//  Tag EEPROM wear at a given sample period (default 250 ms, the NTAG debug
+//  sketch loop). A slowly drifting, noisy reading is published through
+//  three writers:
+//   - full rewrite: the whole TLV image with writeBlocks(), what the
+//     library writeMod() does
+//   - block diff: Ntag5::writeNdefText(), only changed blocks programmed
+//   - sram + fallback: NtagUtils.h updateNFC(), EEPROM every
+//     NTAG_FALLBACK_EVERY publishes, block-diffed
+//  Reports blocks programmed per update, the cycles of the hottest block
+//  and the lifetime that projects to at NTAG5_EEPROM_ENDURANCE. The
+//  firmware wear counters must agree with the model block by block.
+
+#include "Scenarios.h"
+#include "Sensors.h"
+#include "Ntag5.h"
+#include "WarmState.h"
+#include "devices/SimNtag5.h"
+#include <Wire.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// second copy of the sketch helpers, sim_ntagsram.cpp has ntag_utils
+namespace {
+#include "NtagUtils.h"
+}
+
+static const unsigned SAMPLES = 2048;
+
+static int16_t sample(unsigned i)
+{
+    // 0.01 C per 40 samples of drift plus +-2 LSB of sensor noise
+    return 2150 + (int16_t)(i / 40) + (int16_t)(i * 7919 % 5) - 2;
+}
+
+static bool readerShows(const SimNtag5& tag, const char* text)
+{
+    uint8_t view[16 * NTAG5_BLOCK_SIZE];
+    tag.rfView(view, 0, 16);
+    return view[0] == 0xE1 && view[4] == 0x03 && view[13 + strlen(text)] == 0xFE &&
+           memcmp(view + 13, text, strlen(text)) == 0;
+}
+
+int simNtagWear(int argc, char** argv)
+{
+    static const char* names[] = { "full rewrite", "block diff", "sram + fallback" };
+    uint32_t periodMs = argc > 0 ? strtoul(argv[0], 0, 10) : 250;
+    if (!periodMs)
+        periodMs = 250;
+    double samplesPerYear = 365.0 * 24 * 3600 * 1000 / periodMs;
+    int status = 0;
+
+    printf("sample period %lu ms, endurance %lu cycles per block\n",
+           (unsigned long)periodMs, (unsigned long)NTAG5_EEPROM_ENDURANCE);
+
+    // the firmware counters run on from earlier scenarios: take them as
+    // they are instead of restoring them from the warm state
+    Ntag5::restoreWear(0);
+
+    for (int mode = 0; mode < 3; mode++)
+    {
+        SimNtag5 tag;
+        SimI2c::attach(NTAG5_I2C_ADDRESS, &tag);
+        uint32_t before[NTAG5_WEAR_BLOCKS];
+        for (uint16_t b = 0; b < NTAG5_WEAR_BLOCKS; b++)
+            before[b] = Ntag5::wear(b);
+
+        RSTCTRL.RSTFR = RESET_CAUSE_POWER_ON;
+        WarmState::begin();
+        setupNFC(false);
+
+        char text[32], value[8];
+        uint8_t image[64];
+        unsigned wrong = 0, updates = 0;
+        int16_t last = 0;
+        for (unsigned i = 0; i < SAMPLES; i++)
+        {
+            int16_t reading = sample(i);
+            if (i && reading == last)
+                continue;       // the sketch skips unchanged readings
+            last = reading;
+            updates++;
+            formatCentiCelsius(value, reading);
+            snprintf(text, sizeof(text), "Temperature: %s C", value);
+
+            bool ok;
+            if (mode == 0)
+                ok = Ntag5::writeBlocks(NTAG5_NDEF_BLOCK, image, SimNtag5::textImage(image, text));
+            else if (mode == 1)
+                ok = Ntag5::writeNdefText(text);
+            else
+            {
+                RSTCTRL.RSTFR = RESET_CAUSE_WATCHDOG;
+                WarmState::begin();
+                ok = updateNFC(OS_ANDROID, String(text));
+            }
+            if (!ok || !readerShows(tag, text))
+                wrong++;
+        }
+
+        unsigned mismatched = 0;
+        for (uint16_t b = 0; b < NTAG5_WEAR_BLOCKS; b++)
+            if (Ntag5::wear(b) - before[b] != tag.programs(b))
+                mismatched++;
+
+        uint16_t hot = tag.hottestBlock();
+        double perSample = (double)tag.programs(hot) / SAMPLES;
+        double years = perSample > 0 ? NTAG5_EEPROM_ENDURANCE / (perSample * samplesPerYear) : 0;
+        printf("%-16s %4u updates  %5.2f blocks/update  hottest block %3u: %5lu cycles  ",
+               names[mode], updates, (double)tag.stats.blockWrites / updates, hot,
+               (unsigned long)tag.programs(hot));
+        if (perSample == 0)
+            printf("lifetime unlimited");
+        else if (years < 2)
+            printf("lifetime %7.1f days", years * 365);
+        else
+            printf("lifetime %7.1f years", years);
+        printf("  wrong views %u  counter mismatches %u\n", wrong, mismatched);
+
+        status |= wrong || mismatched ? 1 : 0;
+        SimI2c::detach(NTAG5_I2C_ADDRESS);
+    }
+    printf("firmware estimate: %lu cycles left on the hottest block\n",
+           (unsigned long)Ntag5::remainingCycles());
+    return status;
+}
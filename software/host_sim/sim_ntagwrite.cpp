@@ -0,0 +1,113 @@
+//  NTAG write strategies compared by numbers. The same stream of readings
+//  is published four ways, each update in its own I2cBus session as on a
+//  wake:
+//   - per block: one block per transaction, waiting after each, the way
+//     the debug sketch's writeMod() pages through the message
+//   - burst: the whole TLV image with writeBlocks(), 4-block bursts
+//   - block diff: Ntag5::writeNdefText(), changed blocks only
+//   - sram mirror: Ntag5::publishLive(), no EEPROM programming
+//  and against both busy behaviours of the tag model: EEPROM_WR_BUSY only,
+//  or address NACKs while programming. Per update: wake time, transactions,
+//  bytes, NACKs, bus layer retries and EEPROM blocks. Every update must
+//  reach the reader, and the mirror must read back from the session
+//  register once it is on.
+
+#include "Scenarios.h"
+#include "Sensors.h"
+#include "Ntag5.h"
+#include "I2cBus.h"
+#include "devices/SimNtag5.h"
+#include <stdio.h>
+
+static const unsigned UPDATES = 64;
+
+static bool publish(int strategy, const char* text)
+{
+    uint8_t image[64];
+    uint8_t blocks = SimNtag5::textImage(image, text);
+    switch (strategy)
+    {
+    case 0:
+        for (uint8_t b = 0; b < blocks; b++)
+            if (!Ntag5::writeBlocks(NTAG5_NDEF_BLOCK + b, image + b * NTAG5_BLOCK_SIZE, 1))
+                return false;
+        return true;
+    case 1:
+        return Ntag5::writeBlocks(NTAG5_NDEF_BLOCK, image, blocks);
+    case 2:
+        return Ntag5::writeNdefText(text);
+    default:
+        return Ntag5::publishLive(text);
+    }
+}
+
+static bool readerShows(const SimNtag5& tag, const char* text)
+{
+    uint8_t view[16 * NTAG5_BLOCK_SIZE];
+    tag.rfView(view, 0, 16);
+    return view[0] == 0xE1 && view[4] == 0x03 && view[13 + strlen(text)] == 0xFE &&
+           memcmp(view + 13, text, strlen(text)) == 0;
+}
+
+int simNtagWrite(int, char**)
+{
+    static const char* names[] = { "per block", "burst", "block diff", "sram mirror" };
+    int status = 0;
+
+    printf("%-12s %-5s %8s %8s %6s %6s %6s %6s %7s %s\n", "strategy", "busy", "avg us", "worst us",
+           "xfers", "bytes", "nacks", "retry", "blocks", "wrong");
+    for (int nack = 0; nack < 2; nack++)
+    {
+        for (int strategy = 0; strategy < 4; strategy++)
+        {
+            SimNtag5 tag;
+            tag.setBusyNack(nack);
+            SimI2c::attach(NTAG5_I2C_ADDRESS, &tag);
+            bool written;
+            I2cBus::beginSession(1000000UL);
+            Ntag5::formatCapabilityContainer(written);
+            I2cBus::endSession();
+            delay(NTAG5_EEPROM_TIMEOUT_MS);
+
+            uint32_t total = 0, worst = 0, retries = 0;
+            unsigned wrong = 0;
+            SimI2c::reset();
+            tag.stats.blockWrites = 0;
+            for (unsigned i = 0; i < UPDATES; i++)
+            {
+                char text[32], value[8];
+                formatCentiCelsius(value, 2000 + (int16_t)(i * 7 % 300));
+                snprintf(text, sizeof(text), "Temperature: %s C", value);
+
+                I2cBus::beginSession(300000UL);
+                bool ok = publish(strategy, text);
+                I2cBus::endSession();
+                retries += I2cBus::stats.retries;
+                total += I2cBus::sessionMicros();
+                if (I2cBus::sessionMicros() > worst)
+                    worst = I2cBus::sessionMicros();
+                if (!ok || !readerShows(tag, text))
+                    wrong++;
+                delay(250);     // next sample, programming has long finished
+            }
+
+            if (strategy == 3)
+            {
+                // readRegister(NC_REG) counterpart: the mirror is visible in CONFIG
+                uint8_t config1 = 0;
+                Ntag5::readSessionReg(NTAG5_REG_CONFIG, 1, config1);
+                if ((config1 & NTAG5_CONFIG1_ARBITER_MASK) != NTAG5_CONFIG1_ARBITER_MIRROR)
+                    wrong++;
+            }
+
+            printf("%-12s %-5s %8lu %8lu %6.1f %6.1f %6.1f %6.1f %7.2f %u\n", names[strategy],
+                   nack ? "nack" : "flag", (unsigned long)(total / UPDATES), (unsigned long)worst,
+                   (double)SimI2c::stats.transactions / UPDATES, (double)SimI2c::stats.bytes / UPDATES,
+                   (double)SimI2c::stats.nacks / UPDATES, (double)retries / UPDATES,
+                   (double)tag.stats.blockWrites / UPDATES, wrong);
+            status |= wrong ? 1 : 0;
+            SimI2c::detach(NTAG5_I2C_ADDRESS);
+        }
+    }
+    return status;
+}
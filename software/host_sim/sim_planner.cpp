@@ -0,0 +1,278 @@
+//  Reader side transaction planner against the MCU-less boards. The sensor
+//  recipes and the NDEF read are planned naive and minimal, encoded to
+//  ISO 15693 frames and sent to the NTAG 5 model through a small frame
+//  decoder (CRC, flags, manufacturer code, UID). Virtual time runs the
+//  planner's own on-air figures around the model's I2C bus time, so the
+//  measured time checks the estimate's I2C part and the shortened waits
+//  against the sensor models' conversion times: a wait cut too short
+//  returns the previous reading, which changes on every run.
+
+#include "Scenarios.h"
+#include "Ntag5.h"
+#include "Ntag5Master.h"
+#include "I2cBus.h"
+#include "Iso15693Planner.h"
+#include "devices/SimNtag5.h"
+#include "devices/SimSensors.h"
+#include <stdio.h>
+
+static const uint8_t UID[ISO15693_UID_SIZE] = { 0x5A, 0x11, 0x9C, 0x37, 0x01, 0x18, 0x04, 0xE0 };
+static const char NDEF_TEXT[] = "NFC_sense TMP112, read with the nfc_sense app";
+
+//  the tag's RF side: request frame in, response frame out, time advanced
+static uint16_t transceive(SimNtag5& tag, const Iso15693Frame& frame, const Iso15693Timing& timing,
+                           uint8_t* response)
+{
+    simAdvanceMicros(Iso15693Planner::headMicros(frame, timing));
+    const uint8_t* req = frame.request;
+    uint16_t sum = Iso15693Planner::crc(req, frame.requestLen - 2);
+    if (req[frame.requestLen - 2] != (sum & 0xFF) || req[frame.requestLen - 1] != sum >> 8)
+        return 0;
+    uint8_t cmd = req[1], n = 2;
+    bool valid = true;
+    if (cmd >= NTAG5_CMD_READ_CONFIG)
+        valid = req[n++] == NTAG5_MFG_CODE_NXP;
+    if (req[0] & ISO15693_FLAG_ADDRESS)
+    {
+        if (memcmp(req + n, UID, ISO15693_UID_SIZE))
+            return 0;
+        n += ISO15693_UID_SIZE;
+    }
+    const uint8_t* p = req + n;
+    uint8_t* data = response + 1;
+    uint16_t len = 0;
+    switch (valid ? cmd : 0)
+    {
+    case NTAG5_CMD_WRITE_I2C:
+        valid = tag.rfWriteI2c(p[0], p + 2, p[1] + 1);
+        break;
+    case NTAG5_CMD_READ_I2C:
+        valid = tag.rfReadI2c(p[0], p[1] + 1);
+        break;
+    case NTAG5_CMD_READ_SRAM:
+        len = (p[1] + 1) * NTAG5_BLOCK_SIZE;
+        valid = tag.rfReadSram(data, p[0], p[1] + 1);
+        break;
+    case NTAG5_CMD_READ_CONFIG:
+        len = NTAG5_BLOCK_SIZE;
+        valid = p[1] == 0 && tag.rfReadConfig(p[0], data);
+        break;
+    case ISO15693_CMD_READ_SINGLE:
+        len = NTAG5_BLOCK_SIZE;
+        tag.rfView(data, p[0], 1);
+        break;
+    case ISO15693_CMD_READ_MULTIPLE:
+        len = (p[1] + 1) * NTAG5_BLOCK_SIZE;
+        tag.rfView(data, p[0], p[1] + 1);
+        break;
+    case ISO15693_CMD_EXT_READ_MULTIPLE:
+        len = ((p[2] | p[3] << 8) + 1) * NTAG5_BLOCK_SIZE;
+        tag.rfView(data, p[0] | p[1] << 8, len / NTAG5_BLOCK_SIZE);
+        break;
+    default:
+        valid = false;
+    }
+    response[0] = 0;
+    if (!valid)
+    {
+        response[0] = ISO15693_RESPONSE_ERROR;
+        data[0] = 0x0F;     // no information given
+        len = 1;
+    }
+    sum = Iso15693Planner::crc(response, 1 + len);
+    response[1 + len] = sum & 0xFF;
+    response[2 + len] = sum >> 8;
+    simAdvanceMicros(Iso15693Planner::tailMicros(frame, timing));
+    return 1 + len + ISO15693_CRC_SIZE;
+}
+
+//  reader: the plan frame by frame, false at the first rejected response
+static bool run(SimNtag5& tag, const Iso15693Plan& plan, const Iso15693Timing& timing, uint8_t* result,
+                uint32_t& spent)
+{
+    uint8_t response[1 + NTAG5_SRAM_BLOCKS * NTAG5_BLOCK_SIZE + ISO15693_CRC_SIZE];
+    uint32_t start = micros();
+    simAdvanceMicros(plan.leadUs);
+    bool ok = true;
+    for (uint8_t i = 0; i < plan.count && ok; i++)
+    {
+        uint16_t len = transceive(tag, plan.frames[i], timing, response);
+        ok = Iso15693Planner::accept(plan.frames[i], response, len, result);
+        simAdvanceMicros(plan.frames[i].waitUs);
+    }
+    spent = micros() - start;
+    return ok;
+}
+
+//  jig: NDEF message and master configuration over I2C, then power removed
+static bool provision(SimNtag5& tag)
+{
+    uint8_t image[64];
+    uint8_t blocks = SimNtag5::textImage(image, NDEF_TEXT);
+    bool written;
+    I2cBus::beginSession(1000000UL);
+    bool ok = Ntag5::writeBlocks(0, image, blocks) && Ntag5::waitEepromIdle(NTAG5_EEPROM_TIMEOUT_MS) &&
+              Ntag5Master::provision(NTAG5_MCULESS_CONFIG, 2, written) &&
+              Ntag5::waitEepromIdle(NTAG5_EEPROM_TIMEOUT_MS);
+    I2cBus::endSession();
+    tag.powerCycle();
+    tag.setField(true);
+    return ok;
+}
+
+struct PlanRow
+{
+    uint8_t  frames;
+    uint32_t estimate;
+    uint32_t measured;
+    bool     ok;
+};
+
+static void printRow(const char* what, const char* how, const PlanRow& row)
+{
+    printf("%-16s %-10s %3u frames  estimate %6lu us  measured %6lu us  %s\n", what, how, row.frames,
+           (unsigned long)row.estimate, (unsigned long)row.measured, row.ok ? "ok" : "FAIL");
+}
+
+//  plans a recipe, runs it, leaves the result for the caller to check
+static PlanRow runRecipe(SimNtag5& tag, const uint8_t* recipe, uint8_t options, const Iso15693Timing& timing,
+                         uint8_t* result)
+{
+    Iso15693Plan plan;
+    PlanRow row = {};
+    row.ok = Iso15693Planner::planRecipe(recipe, options, UID, timing, plan);
+    row.frames = plan.count;
+    row.estimate = Iso15693Planner::estimateMicros(plan, timing);
+    row.ok = row.ok && run(tag, plan, timing, result, row.measured) && row.measured == row.estimate;
+    return row;
+}
+
+//  naive, minimal and minimal addressed for one recipe; the minimal plan
+//  must need fewer frames and less time
+static int compareRecipe(SimNtag5& tag, const char* what, const uint8_t* recipe, const Iso15693Timing& timing,
+                         bool (*check)(const uint8_t* result))
+{
+    static const uint8_t options[3] = { ISO15693_PLAN_NAIVE, 0, ISO15693_PLAN_ADDRESSED };
+    static const char* names[3] = { "naive", "minimal", "addressed" };
+    PlanRow rows[3];
+    uint8_t result[64];
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        rows[i] = runRecipe(tag, recipe, options[i], timing, result);
+        rows[i].ok = rows[i].ok && check(result);
+        printRow(what, names[i], rows[i]);
+    }
+    bool ok = rows[0].ok && rows[1].ok && rows[2].ok && rows[1].frames < rows[0].frames &&
+              rows[1].estimate < rows[0].estimate && rows[1].estimate < rows[2].estimate;
+    return ok ? 0 : 1;
+}
+
+static SimTmp112* tmp112;
+static SimBme280* bme280;
+
+static unsigned runs;
+
+static int16_t tmp112Value(unsigned run)
+{
+    return (int16_t)(-500 + run * 731 % 4000);
+}
+
+//  checks this run got the value set before it, sets the next one
+static bool tmp112Fresh(const uint8_t* result)
+{
+    bool ok = abs(Ntag5Master::tmp112CentiCelsius(result) - tmp112Value(runs)) <= 7;
+    tmp112->setTemperature(tmp112Value(++runs));
+    return ok;
+}
+
+static bool bme280Fresh(const uint8_t* result)
+{
+    Bme280Data data;
+    Ntag5Master::bme280Decode(result, data);
+    bool ok = abs(data.centiCelsius - (int16_t)(1800 + runs * 37)) <= 1 &&
+              labs((long)data.pascal - (long)(98000 + runs * 211)) <= 4;
+    runs++;
+    bme280->setEnvironment(1800 + runs * 37, 98000 + runs * 211, 400 + runs * 9);
+    return ok;
+}
+
+//  nothing to compare against, the measurement check shows if it was right
+static bool bme280Cal(const uint8_t* result)
+{
+    Ntag5Master::bme280Calibration(result);
+    return true;
+}
+
+int simPlanner(int, char**)
+{
+    int status = 0;
+    static const Iso15693Timing* timings[2] = { &ISO15693_TIMING_FRONTEND, &ISO15693_TIMING_PHONE };
+    static const char* timingNames[2] = { "reader front end", "phone, 4 ms per command assumed" };
+
+    // nfc_sense_ntag_surface: TMP112
+    {
+        SimNtag5 tag;
+        SimTmp112 sensor;
+        tmp112 = &sensor;
+        SimI2c::attach(NTAG5_I2C_ADDRESS, &tag);
+        SimI2c::attach(0x48, &sensor);
+        status |= provision(tag) ? 0 : 1;
+        runs = 0;
+        sensor.setTemperature(tmp112Value(0));
+
+        for (uint8_t t = 0; t < 2; t++)
+        {
+            printf("-- %s\n", timingNames[t]);
+            status |= compareRecipe(tag, "TMP112", NTAG5_RECIPE_TMP112, *timings[t], tmp112Fresh);
+
+            // NDEF message: READ SINGLE BLOCK per block vs READ MULTIPLE BLOCKS
+            uint8_t expect[64], got[64];
+            uint8_t blocks = SimNtag5::textImage(expect, NDEF_TEXT);
+            for (uint8_t i = 0; i < 2; i++)
+            {
+                bool naive = i == 0;
+                Iso15693Plan plan;
+                PlanRow row = {};
+                uint8_t* out = got;
+                row.ok = Iso15693Planner::planRead(0, blocks, 32, naive ? ISO15693_PLAN_NAIVE : 0, UID, plan);
+                row.frames = plan.count;
+                row.estimate = Iso15693Planner::estimateMicros(plan, *timings[t]);
+                row.ok = row.ok && run(tag, plan, *timings[t], out, row.measured) &&
+                         !memcmp(got, expect, blocks * NTAG5_BLOCK_SIZE) && (naive || plan.count == 1);
+                printRow("NDEF read", naive ? "naive" : "minimal", row);
+                status |= row.ok ? 0 : 1;
+            }
+        }
+
+        // harvesting off: every transfer NACKs, the single status poll must see it
+        tag.rfWriteConfig(NTAG5_REG_EH_CONFIG & 0xFF, (const uint8_t*)"\0\0\0\0");
+        uint8_t result[8];
+        PlanRow row = runRecipe(tag, NTAG5_RECIPE_TMP112, 0, ISO15693_TIMING_FRONTEND, result);
+        printf("TMP112 with VOUT off: minimal plan %s\n", row.ok ? "accepted, FAIL" : "rejected (ok)");
+        status |= row.ok ? 1 : 0;
+        SimI2c::detach(0x48);
+        SimI2c::detach(NTAG5_I2C_ADDRESS);
+    }
+
+    // nfc_sense_ntag_BME: BME280
+    {
+        SimNtag5 tag;
+        SimBme280 sensor;
+        bme280 = &sensor;
+        SimI2c::attach(NTAG5_I2C_ADDRESS, &tag);
+        SimI2c::attach(BME280_I2C_ADDRESS, &sensor);
+        status |= provision(tag) ? 0 : 1;
+        runs = 0;
+        sensor.setEnvironment(1800, 98000, 400);
+
+        for (uint8_t t = 0; t < 2; t++)
+        {
+            printf("-- %s\n", timingNames[t]);
+            status |= compareRecipe(tag, "BME280 cal", NTAG5_RECIPE_BME280_CAL, *timings[t], bme280Cal);
+            status |= compareRecipe(tag, "BME280", NTAG5_RECIPE_BME280, *timings[t], bme280Fresh);
+        }
+        SimI2c::detach(BME280_I2C_ADDRESS);
+        SimI2c::detach(NTAG5_I2C_ADDRESS);
+    }
+    return status;
+}
@@ -0,0 +1,69 @@
+//  TMP117 power-up image (Tmp117::provision()): a factory-fresh part booted
+//  eight times with a power cycle before each boot, then the image of an
+//  older firmware (another tag in EEPROM1) booted twice. Per boot: what
+//  begin() costs on the bus and in wake time, EEPROM writes, the part's
+//  supply current right after power-up and the reading. The first boot of
+//  each image must program it once (config, limits, tag); every other boot
+//  must be the tag read alone, with the part powering up in shutdown.
+
+#include "Scenarios.h"
+#include "Sensors.h"
+#include "SimPower.h"
+#include "devices/SimSensors.h"
+#include <stdio.h>
+
+static const unsigned BOOTS = 8;
+static const unsigned STALE_BOOTS = 2;
+
+int simProvision(int, char**)
+{
+    typedef TemperatureReader<Tmp117> Reader;
+    SimTmp117 tmp;
+    SimI2c::attach(Tmp117::ADDRESS, &tmp);
+    SimPower::reset();
+    uint8_t load = SimPower::load("TMP117");
+    tmp.meter(load);
+    tmp.setTemperature(2345);
+
+    int status = 0;
+    printf("%-5s %-8s %13s %9s %7s %12s %8s\n", "boot", "image", "transactions", "begin ms", "writes",
+           "power-up uA", "reading");
+    for (unsigned boot = 0; boot < BOOTS + STALE_BOOTS; boot++)
+    {
+        if (boot == BOOTS)
+        {
+            //  what an older image leaves behind
+            I2cBus::writeReg16(Tmp117::ADDRESS, Tmp117::REG_EEPROM_UL, Tmp117::EEPROM_UNLOCK);
+            I2cBus::writeReg16(Tmp117::ADDRESS, Tmp117::REG_EEPROM1, Tmp117::EEPROM_TAG ^ 0x0001);
+            delay(8);
+        }
+        tmp.setPowered(false);
+        tmp.setPowered(true);
+        delay(Tmp117::POWER_UP_MS);
+        double powerUpUa = SimPower::current(load);
+
+        SimI2c::reset();
+        uint32_t writes = tmp.stats.eepromWrites;
+        uint32_t start = micros();
+        bool ok = Reader::begin();
+        uint32_t beginUs = micros() - start;
+        uint32_t transactions = SimI2c::stats.transactions;
+        int16_t centi = 0;
+        ok = ok && Reader::read(centi);
+        writes = tmp.stats.eepromWrites - writes;
+
+        bool first = boot == 0 || boot == BOOTS;
+        ok = ok && centi / 10 == 234 && tmp.eeprom(Tmp117::REG_EEPROM1) == Tmp117::EEPROM_TAG &&
+             writes == (first ? 4 : 0) && (first || transactions == 2) &&
+             (first || powerUpUa < 1) && !tmp.stats.writesWhileBusy;
+        char text[8];
+        formatCentiCelsius(text, centi);
+        printf("%-5u %-8s %13lu %9.1f %7lu %12.2f %8s  %s\n", boot + 1, boot < BOOTS ? "factory" : "older",
+               (unsigned long)transactions, beginUs / 1000.0, (unsigned long)writes, powerUpUa, text,
+               ok ? "ok" : "FAIL");
+        status |= ok ? 0 : 1;
+    }
+    SimI2c::detach(Tmp117::ADDRESS);
+    printf("power-up uA: from power-up until begin(), 8-average continuous before the image\n");
+    return status;
+}
@@ -0,0 +1,183 @@
+//  Sensor and panel on a switched supply (Rail.h) on the display board: a
+//  day of 96 background cycles, 15 min apart, each reading the TMP112 and
+//  putting the value and a trend column on the panel as the firmware's
+//  wake cycle does (the tag is left out, so the sensor start-up is slept
+//  rather than overlapped). Three ways: always powered, gated with a full
+//  refresh after every power-up, and gated with the controller RAM
+//  restored from the widgets (Display::restore()) so refreshes stay
+//  partial. The supply currents of sensor, panel and load switch come from
+//  the models (SimPower), the MCU's from its awake and standby time. Every
+//  reading must be the model's temperature and the panel must show what
+//  the widgets draw after each cycle; nothing may be sent to an unpowered
+//  controller.
+
+#include "Scenarios.h"
+#include "Rail.h"
+#include "Standby.h"
+#include "Display.h"
+#include "Epd.h"
+#include "Sensors.h"
+#include "I2cBus.h"
+#include "SimI2c.h"
+#include "SimSpi.h"
+#include "SimPower.h"
+#include "devices/SimSensors.h"
+#include "devices/SimEpd.h"
+#include <stdio.h>
+
+static const uint8_t CS = 0, DC = 1, RES = 2, BUSY = 3;     // PA4..PA7 on the board
+static const uint8_t GATE = 12;                             // PC2, load switch enable
+static const unsigned CYCLES = 96;
+static const uint32_t INTERVAL_US = 900000000UL;            // 15 min
+static const double MCU_ACTIVE_UA = 2500;                   // 10 MHz at 3 V
+static const double MCU_SLEEP_UA = 0.7;                     // standby / power-down, RTC on the ULP
+static const double SWITCH_OFF_UA = 0.01;                   // load switch, off leakage
+
+enum { ALWAYS, GATED_FULL, GATED_RESTORE };
+
+static SimTmp112* sensor;
+static SimEpd* panel;
+static uint8_t switchLoad;
+
+static void onGate(uint8_t, uint8_t level)
+{
+    sensor->setPowered(level);
+    panel->setPowered(level);
+    SimPower::set(switchLoad, level ? 0 : SWITCH_OFF_UA);
+}
+
+static int16_t reading(unsigned i)
+{
+    return 1900 + (int16_t)(i < CYCLES / 2 ? i : CYCLES - i) * 13;
+}
+
+static bool panelShows(const SimEpd& epd)
+{
+    uint8_t row[EPD_ROW_BYTES];
+    for (uint16_t y = 0; y < EPD_HEIGHT; y++)
+    {
+        Display::paintRow(y, 0, EPD_ROW_BYTES, row);
+        if (memcmp(epd.panel() + y * EPD_ROW_BYTES, row, EPD_ROW_BYTES))
+            return false;
+    }
+    return true;
+}
+
+//  the wake cycle's sensor and display part
+static bool cycle(uint8_t mode, bool warm, int16_t& centi)
+{
+    bool gated = mode != ALWAYS;
+    if (gated)
+        Rail::acquire(RAIL_SENSOR | RAIL_DISPLAY);
+    I2cBus::begin();
+    I2cBus::beginSession(300000UL);
+    bool ok;
+    if (gated)
+    {
+        Rail::settle(BoardSensor::POWER_UP_MS);
+        ok = BoardThermometer::readFresh(warm, centi);
+    }
+    else
+        ok = (warm ? BoardThermometer::resume() : BoardThermometer::begin()) && BoardThermometer::read(centi);
+    I2cBus::endSession();
+
+    if (ok)
+    {
+        if (mode == GATED_RESTORE)
+        {
+            Rail::settle(EPD_POWER_UP_MS);
+            Display::restore();
+        }
+        Display::showCentiCelsius(centi);
+        Display::record(centi);
+        ok = Display::refresh() && panelShows(*panel);
+    }
+    if (gated)
+    {
+        Display::powerDown();
+        Rail::release(RAIL_SENSOR | RAIL_DISPLAY);
+    }
+    return ok;
+}
+
+int simRail(int, char**)
+{
+    static const char* const names[] = { "always powered", "gated, full refresh", "gated, restore" };
+    double dayCharge[3] = { 0 };
+    int status = 0;
+
+    printf("%-20s %7s %8s %9s %9s %10s %10s %10s\n", "supply", "flashes", "sleep uA", "awake ms",
+           "SPI B", "wake uC", "sleep uC", "day mC");
+    for (uint8_t mode = ALWAYS; mode <= GATED_RESTORE; mode++)
+    {
+        SimTmp112 tmp;
+        SimEpd epd(CS, DC, RES, BUSY);
+        sensor = &tmp;
+        panel = &epd;
+        SimI2c::attach(Tmp112::ADDRESS, &tmp);
+        SimSpi::attach(&epd);
+        SimSpi::reset();
+        SimPower::reset();
+        tmp.meter(SimPower::load("TMP112"));
+        epd.meter(SimPower::load("SSD1680"));
+        switchLoad = SimPower::load("switch");
+        simWatchPin(GATE, onGate);
+
+        Display::value.set("");
+        Display::trend.clear();
+        Display::begin(CS, DC, RES, BUSY);
+        if (mode != ALWAYS)
+        {
+            Rail::begin(GATE);
+            Display::powerDown();
+        }
+        Epd::fullRefreshes = Epd::partialRefreshes = 0;
+        Rail::powerUps = 0;
+
+        bool ok = true;
+        double wake = 0, sleep = 0, sleepUa = 0;
+        uint32_t awake = 0, bytes = 0;
+        for (unsigned i = 0; i < CYCLES; i++)
+        {
+            tmp.setTemperature(reading(i));
+            double before = SimPower::total();
+            uint32_t start = micros(), slept = Standby::sleptMicros, spi = SimSpi::stats.bytes;
+            int16_t centi = 0;
+            ok = cycle(mode, i > 0, centi) && ok;
+            ok = ok && abs(centi - reading(i)) < 7;     // 0.0625 C steps
+
+            uint32_t spent = micros() - start, asleep = Standby::sleptMicros - slept;
+            awake += spent - asleep;
+            bytes += SimSpi::stats.bytes - spi;
+            wake += SimPower::total() - before + ((spent - asleep) * MCU_ACTIVE_UA + asleep * MCU_SLEEP_UA) / 1e6;
+
+            sleepUa = MCU_SLEEP_UA;
+            for (uint8_t l = 0; l < SimPower::loads(); l++)
+                sleepUa += SimPower::current(l);
+            before = SimPower::total();
+            simAdvanceMicros(INTERVAL_US - spent);
+            sleep += SimPower::total() - before + (INTERVAL_US - spent) * MCU_SLEEP_UA / 1e6;
+        }
+        simWatchPin(GATE, 0);
+        SimSpi::attach(0);
+        SimI2c::detach(Tmp112::ADDRESS);
+
+        uint32_t errors = epd.stats.whileBusy + epd.stats.whileAsleep + epd.stats.whileOff +
+                          epd.stats.unsupported + SimSpi::stats.disabled;
+        uint32_t fulls = mode == GATED_FULL ? CYCLES : 1 + (CYCLES - 1) / (EPD_FULL_EVERY + 1);
+        ok = ok && !errors && Epd::fullRefreshes == fulls &&
+             Rail::powerUps == (mode == ALWAYS ? 0 : CYCLES);
+        dayCharge[mode] = (wake + sleep) / 1000;
+        printf("%-20s %7lu %8.2f %9.1f %9lu %10.1f %10.1f %10.2f  %s\n", names[mode],
+               (unsigned long)Epd::fullRefreshes, sleepUa, awake / 1000.0 / CYCLES,
+               (unsigned long)(bytes / CYCLES), wake / CYCLES, sleep / CYCLES, dayCharge[mode],
+               ok ? "ok" : "FAIL");
+        status |= ok ? 0 : 1;
+    }
+    if (dayCharge[GATED_RESTORE] >= dayCharge[ALWAYS])
+        status = 1;
+    printf("sleep uA: MCU %.2f plus sensor and panel (or the switch); wake/sleep uC per cycle;\n"
+           "MCU %.1f mA awake, refresh %.1f mA while BUSY\n", MCU_SLEEP_UA, MCU_ACTIVE_UA / 1000,
+           SimEpd::BUSY_UA / 1000);
+    return status;
+}
@@ -0,0 +1,142 @@
+//  The display's framebuffer-free renderer (Display.h, GlyphLine.h) on the
+//  SSD1680 model. A reading drifts around room temperature, then falls
+//  through zero, 40 readings in all, and is shown three ways: the whole
+//  screen with a full refresh each time, the whole value line with a
+//  partial refresh, and only the changed glyph cells (Display::refresh(),
+//  what the firmware does). Per update: glyph cells redrawn, rows and bytes
+//  the row source computed, SPI bytes and MCU awake time (streaming the
+//  rows is the render time, the refresh itself is BUSY time). After every
+//  update the panel must match a reference drawn pixel by pixel from the
+//  font; "render dump" prints the final line.
+
+#include "Scenarios.h"
+#include "Display.h"
+#include "Epd.h"
+#include "Sensors.h"
+#include "SimSpi.h"
+#include "devices/SimEpd.h"
+#include <stdio.h>
+
+static const uint8_t CS = 0, DC = 1, RES = 2, BUSY = 3;     // PA4..PA7 on the board
+static const unsigned READINGS = 40;
+
+enum { FULL_SCREEN, WHOLE_LINE, CHANGED_CELLS };
+
+static int16_t reading(unsigned i)
+{
+    if (i < 20)
+        return 2150 + (int16_t)(i * i * 13 % 70) - 35;
+    return 2150 - (int16_t)(i - 19) * 117;
+}
+
+//  independent of GlyphLine::paint(): one pixel at a time from the font
+static void reference(const char* text, uint8_t* image)
+{
+    memset(image, 0xFF, EPD_HEIGHT * EPD_ROW_BYTES);
+    uint8_t n = strlen(text);
+    uint16_t left = DISPLAY_VALUE_X * 8 + (DISPLAY_VALUE_CELLS - n) * GLYPH_WIDTH * GLYPH_SCALE;
+    for (uint8_t c = 0; c < n; c++)
+        for (uint16_t y = 0; y < GLYPH_CELL_ROWS; y++)
+            for (uint16_t x = 0; x < GLYPH_WIDTH * GLYPH_SCALE; x++)
+            {
+                uint8_t bits = GlyphLine::glyphRow(text[c], y / GLYPH_SCALE);
+                if (!(bits & (0x80 >> (x / GLYPH_SCALE))))
+                    continue;
+                uint16_t px = left + c * GLYPH_WIDTH * GLYPH_SCALE + x;
+                image[(DISPLAY_VALUE_Y + y) * EPD_ROW_BYTES + px / 8] &= ~(0x80 >> (px % 8));
+            }
+}
+
+static void dump(const SimEpd& epd)
+{
+    for (uint16_t y = DISPLAY_VALUE_Y; y < DISPLAY_VALUE_Y + GLYPH_CELL_ROWS; y += 2)
+    {
+        for (uint16_t x = 0; x < EPD_WIDTH; x += 2)
+            putchar(epd.panel()[y * EPD_ROW_BYTES + x / 8] & (0x80 >> (x % 8)) ? '.' : '#');
+        putchar('\n');
+    }
+}
+
+int simRender(int argc, char** argv)
+{
+    static const char* const names[] = { "full screen, full", "value line, partial", "changed cells, partial" };
+    static uint8_t expected[EPD_HEIGHT * EPD_ROW_BYTES];
+    int status = 0;
+
+    printf("%-24s %7s %7s %7s %8s %8s %9s %9s %6s\n", "strategy", "updates", "flashes", "cells",
+           "rows/upd", "calc B", "SPI B/upd", "awake ms", "stale");
+    for (uint8_t strategy = FULL_SCREEN; strategy <= CHANGED_CELLS; strategy++)
+    {
+        SimEpd epd(CS, DC, RES, BUSY);
+        SimSpi::attach(&epd);
+        SimSpi::reset();
+        Display::value.set("");
+        Display::trend.clear();
+        Display::begin(CS, DC, RES, BUSY);
+        Epd::fullRefreshes = Epd::partialRefreshes = 0;
+        Epd::spiBytes = 0;
+        Display::rowsPainted = 0;
+
+        bool ok = true;
+        uint32_t updates = 0, cells = 0, calc = 0, awake = 0, bytes = 0;
+        for (unsigned i = 0; i < READINGS; i++)
+        {
+            char text[DISPLAY_VALUE_CELLS + 2];
+            uint8_t n = formatCentiCelsius(text, reading(i));
+            strcpy(text + n, "\xB0" "C");
+            Display::showCentiCelsius(reading(i));
+            if (!Display::value.dirty())
+                continue;
+
+            uint8_t x, w;
+            Display::value.dirtyBytes(x, w);
+            bool full = strategy == FULL_SCREEN || Epd::needsFull();
+            uint32_t start = micros(), busyBefore = epd.stats.busyMicros, bytesBefore = SimSpi::stats.bytes;
+            uint32_t rowsBefore = Display::rowsPainted;
+            bool done;
+            if (strategy == CHANGED_CELLS)
+                done = Display::refresh();
+            else
+            {
+                if (strategy == WHOLE_LINE && !full)
+                    done = Epd::update(Display::value.x(), Display::value.y(), Display::value.bytes(),
+                                       GLYPH_CELL_ROWS, Display::paintRow, EPD_REFRESH_PARTIAL);
+                else
+                    done = Epd::update(0, 0, EPD_ROW_BYTES, EPD_HEIGHT, Display::paintRow, EPD_REFRESH_FULL);
+                Display::value.clean();
+            }
+            if (full)
+                w = EPD_ROW_BYTES;
+            else if (strategy == WHOLE_LINE)
+                w = Display::value.bytes();
+            updates++;
+            cells += w / GLYPH_CELL_BYTES;
+            calc += (Display::rowsPainted - rowsBefore) * w;
+            awake += micros() - start - (epd.stats.busyMicros - busyBefore);
+            bytes += SimSpi::stats.bytes - bytesBefore;
+
+            reference(text, expected);
+            ok = ok && done && epd.asleep() && !Display::value.dirty() &&
+                 !memcmp(epd.panel(), expected, sizeof(expected));
+        }
+        SimSpi::attach(0);
+
+        uint32_t errors = epd.stats.whileBusy + epd.stats.whileAsleep + epd.stats.unsupported + SimSpi::stats.disabled;
+        ok = ok && !errors && !epd.stale() && bytes == Epd::spiBytes;
+        if (strategy != FULL_SCREEN)
+            ok = ok && Epd::fullRefreshes == 1;
+        printf("%-24s %7lu %7lu %7.1f %8lu %8lu %9lu %9.1f %6lu  %s\n", names[strategy], (unsigned long)updates,
+               (unsigned long)Epd::fullRefreshes, (double)cells / updates,
+               (unsigned long)(Display::rowsPainted / updates), (unsigned long)(calc / updates),
+               (unsigned long)(bytes / updates), awake / 1000.0 / updates, (unsigned long)epd.stale(),
+               ok ? "ok" : "FAIL");
+        status |= ok ? 0 : 1;
+
+        if (strategy == CHANGED_CELLS && argc > 0 && !strcmp(argv[0], "dump"))
+            dump(epd);
+    }
+    printf("cells: 16 x 32 pixel glyph cells redrawn (a full screen counts 8); rows: row source\n"
+           "calls, each computes the window width; RAM kept: %u glyph indices + dirty range\n",
+           (unsigned)DISPLAY_VALUE_CELLS);
+    return status;
+}
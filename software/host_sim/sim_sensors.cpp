@@ -0,0 +1,50 @@
+//  Runs one measurement through each sensor policy against its model and
+//  reports the wake time the firmware would spend on it.
+
+#include "Scenarios.h"
+#include "Sensors.h"
+#include "devices/SimSensors.h"
+#include <stdio.h>
+
+template <class Sensor>
+static int measure(const char* name, SimI2cDevice* model)
+{
+    SimI2c::attach(Sensor::ADDRESS, model);
+    SimI2c::reset();
+    uint32_t start = micros();
+
+    int16_t centi = 0;
+    bool ok = TemperatureReader<Sensor>::begin() && TemperatureReader<Sensor>::read(centi);
+
+    uint32_t wake = micros() - start;
+    char text[8];
+    formatCentiCelsius(text, centi);
+    printf("%-8s %s  %6s C  wake %6lu us  bus %5lu us  %2lu transactions  %3lu bytes\n",
+           name, ok ? "ok  " : "FAIL", text, (unsigned long)wake,
+           (unsigned long)SimI2c::stats.busMicros, (unsigned long)SimI2c::stats.transactions,
+           (unsigned long)SimI2c::stats.bytes);
+    SimI2c::detach(Sensor::ADDRESS);
+    return ok && centi / 10 == 234 ? 0 : 1;
+}
+
+int simSensors(int, char**)
+{
+    SimTmp117 tmp117;
+    SimTmp112 tmp112;
+    SimBme280 bme280;
+    tmp117.setTemperature(2345);
+    tmp112.setTemperature(2345);
+    bme280.setEnvironment(2345, 100653, 450);
+
+    //  the TMP117 as on every boot but its first, see `provision`
+    SimI2c::attach(Tmp117::ADDRESS, &tmp117);
+    Tmp117::provision();
+    tmp117.setPowered(false);
+    tmp117.setPowered(true);
+
+    int status = 0;
+    status |= measure<Tmp117>("TMP117", &tmp117);
+    status |= measure<Tmp112>("TMP112", &tmp112);
+    status |= measure<Bme280Temp>("BME280", &bme280);
+    return status;
+}
@@ -0,0 +1,182 @@
+//  A CR2032 run down on the display board (sensor and panel always powered,
+//  the per-cycle charge and sleep current of `rail`): the 15 min background
+//  refresh plus a dozen phone taps a day, until the cell falls below what
+//  the panel needs. Once with the fixed interval and no measurement, once
+//  with Supply.h: VDD every SUPPLY_MEASURE_EVERY wakes, the battery note on
+//  the tag at each change of state, the refresh stretched by stretch().
+//  The cell voltage follows a coin cell discharge curve with some recovery
+//  wobble between wakes. Days to each state and to the end, wake cycles,
+//  measurements and their charge. The adaptive run must warn on the tag
+//  before the end, change state exactly twice, measure no more often than
+//  its interval and outlast the fixed one.
+
+#include "Scenarios.h"
+#include "Supply.h"
+#include "FieldWake.h"
+#include "I2cBus.h"
+#include "TagBackend.h"
+#include "Ntag5.h"
+#include "devices/SimNtag5.h"
+#include <stdio.h>
+
+static const uint8_t ED_PIN = 5;                // PB4 on the NTAG boards
+static const uint32_t DAY_S = 24UL * 3600;
+static const uint32_t TAP_EVERY_S = 7200;       // 12 phone taps a day
+static const double CELL_UC = 220 * 3.6e6;      // 220 mAh
+static const uint16_t CUTOFF_MV = 2200;         // SSD1680 minimum VCI
+static const double WAKE_UC = 1520.5;           // display board wake cycle, always powered (`rail`)
+static const double SLEEP_UA = 2.20;            // MCU, sensor and panel asleep (`rail`)
+static const double MCU_ACTIVE_UA = 2500;
+static const double ADC_UA = 200;               // ADC with the reference on, assumed
+static const uint32_t TICK_WAKE_US = 20;        // PIT wake: ISR, poll(), back to sleep
+
+//  open-circuit voltage against capacity used, per mille
+static const uint16_t CURVE[][2] = {
+    { 0, 3000 }, { 50, 2950 }, { 700, 2850 }, { 850, 2750 },
+    { 920, 2600 }, { 960, 2450 }, { 980, 2300 }, { 1000, 2000 },
+};
+
+static uint16_t cellMillivolts(double usedUc)
+{
+    double used = usedUc / CELL_UC * 1000;
+    const unsigned n = sizeof(CURVE) / sizeof(CURVE[0]);
+    if (used >= CURVE[n - 1][0])
+        return CURVE[n - 1][1];
+    unsigned i = 1;
+    while (CURVE[i][0] < used)
+        i++;
+    double f = (used - CURVE[i - 1][0]) / (CURVE[i][0] - CURVE[i - 1][0]);
+    return (uint16_t)(CURVE[i - 1][1] + f * ((int)CURVE[i][1] - (int)CURVE[i - 1][1]));
+}
+
+static bool contains(const uint8_t* memory, size_t size, const char* text)
+{
+    size_t len = strlen(text);
+    for (size_t i = 0; i + len <= size; i++)
+        if (!memcmp(memory + i, text, len))
+            return true;
+    return false;
+}
+
+struct Run
+{
+    double days, lowDays, criticalDays;
+    uint32_t cycles, measurements, transitions, lastGap;
+    double measureUc;
+    bool warned, bounded;
+};
+
+static Run run(SimNtag5& tag, bool adaptive)
+{
+    Run r = { 0, 0, 0, 0, 0, 0, 0, 0, false, false };
+    double usedUc = 0;
+    uint32_t okCycles = 0, lastRefresh = 0, measureUs = 0;
+    uint8_t shown = 0xFF;
+    bool first = true;
+
+    FieldWake::setRefreshTicks(FIELD_WAKE_REFRESH_TICKS);
+    simSetPin(ED_PIN, HIGH);
+    FieldWake::begin(ED_PIN);
+    FieldWake::poll();
+
+    //  the supply part of wakeCycle(); the text goes to the tag when the
+    //  battery state on it is out of date, as the sketch rewrites it then
+    auto cycle = [&](uint32_t n) {
+        r.cycles++;
+        usedUc += WAKE_UC;
+        if (!adaptive)
+            return;
+        supplyMillivolts = cellMillivolts(usedUc) + (int)(n * 37 % 41) - 20;
+        uint32_t start = micros();
+        uint8_t before = Supply::state();
+        if (Supply::update(first))
+        {
+            r.measurements++;
+            measureUs += micros() - start;
+        }
+        first = false;
+        okCycles += before == SUPPLY_OK;
+        r.transitions += Supply::state() != before;
+        if (Supply::state() != shown)
+        {
+            char text[48];
+            snprintf(text, sizeof(text), "Temperature: 4.00 C%s", Supply::label());
+            TagBackend::reset();
+            I2cBus::beginSession(300000UL);
+            bool ok = TagBackend::setup(false) != TAG_ABSENT && TagBackend::publish(OS_ANDROID, text);
+            I2cBus::endSession();
+            uint8_t view[64 * NTAG5_BLOCK_SIZE];
+            tag.rfView(view, 0, 64);
+            if (ok && contains(view, sizeof(view), text))
+                shown = Supply::state();
+        }
+        FieldWake::setRefreshTicks(FIELD_WAKE_REFRESH_TICKS * Supply::stretch());
+    };
+
+    cycle(0);
+    for (uint32_t tick = 1; cellMillivolts(usedUc) >= CUTOFF_MV; tick++)
+    {
+        uint32_t t = tick * FIELD_WAKE_TICK_S;
+        usedUc += SLEEP_UA * FIELD_WAKE_TICK_S + TICK_WAKE_US * MCU_ACTIVE_UA / 1e6;
+        FieldWake::onTick();
+        if (FieldWake::poll() == FIELD_WAKE_REFRESH)
+        {
+            r.lastGap = tick - lastRefresh;
+            lastRefresh = tick;
+            cycle(tick);
+        }
+        if (t / TAP_EVERY_S != (t - FIELD_WAKE_TICK_S) / TAP_EVERY_S)
+        {
+            simSetPin(ED_PIN, LOW);
+            FieldWake::onEdge();
+            if (FieldWake::poll() == FIELD_WAKE_FIELD)
+            {
+                lastRefresh = tick;
+                cycle(tick);
+            }
+            simSetPin(ED_PIN, HIGH);
+            FieldWake::onEdge();
+            FieldWake::poll();
+        }
+        r.days = (double)t / DAY_S;
+        if (shown == SUPPLY_LOW && !r.lowDays)
+            r.lowDays = r.days;
+        if (shown == SUPPLY_CRITICAL && !r.criticalDays)
+            r.criticalDays = r.days;
+    }
+    r.measureUc = measureUs * (MCU_ACTIVE_UA + ADC_UA) / 1e6;
+    r.warned = r.lowDays && r.criticalDays && r.lowDays < r.criticalDays;
+    //  every SUPPLY_MEASURE_EVERY cycles while ok, SUPPLY_MEASURE_EVERY_LOW after
+    uint32_t bound = 1 + okCycles / SUPPLY_MEASURE_EVERY + (r.cycles - okCycles) / SUPPLY_MEASURE_EVERY_LOW;
+    r.bounded = r.measurements <= bound;
+    return r;
+}
+
+int simSupply(int, char**)
+{
+    SimNtag5 tag;
+    SimI2c::attach(NTAG5_I2C_ADDRESS, &tag);
+    int status = 0;
+
+    printf("%-9s %7s %7s %8s %8s %8s %9s %10s %12s\n", "policy", "days", "low at", "crit at", "warning",
+           "cycles", "measured", "measure uC", "refresh min");
+    Run fixed = run(tag, false);
+    Run adaptive = run(tag, true);
+    for (int i = 0; i < 2; i++)
+    {
+        const Run& r = i ? adaptive : fixed;
+        bool ok = i ? r.warned && r.bounded && r.transitions == 2 && r.days > fixed.days &&
+                      r.lastGap == FIELD_WAKE_REFRESH_TICKS * 4
+                    : !r.measurements && !r.lowDays;
+        printf("%-9s %7.0f %7.0f %8.0f %8.0f %8lu %9lu %10.1f %12.0f  %s\n", i ? "adaptive" : "fixed", r.days,
+               r.lowDays, r.criticalDays, r.lowDays ? r.days - r.lowDays : 0, (unsigned long)r.cycles,
+               (unsigned long)r.measurements, r.measureUc, r.lastGap * FIELD_WAKE_TICK_S / 60.0,
+               ok ? "ok" : "FAIL");
+        status |= ok ? 0 : 1;
+    }
+    FieldWake::setRefreshTicks(FIELD_WAKE_REFRESH_TICKS);
+    SimI2c::detach(NTAG5_I2C_ADDRESS);
+    printf("days to the end (%u mV) and to the battery state on the tag; warning: days from\n"
+           "\"battery low\" to the end; refresh: the last background interval\n", CUTOFF_MV);
+    return status;
+}
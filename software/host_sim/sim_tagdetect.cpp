@@ -0,0 +1,149 @@
+//  One build against both tag chips: TagBackend on an RF430CL330H board,
+//  an NTAG 5 board and a board whose tag is missing. Each board boots cold
+//  once and then warm a few times. The chip must be probed on the cold boot
+//  only, taken from the warm state afterwards, and the reader must find
+//  the published text on whichever chip is there. Then one boot of the
+//  NTAG 5 board with several wake cycles, as the field-wake sketch runs
+//  them without a reset in between: the tag does not answer in the first
+//  one (busy with a reader), the later ones must probe it again and publish.
+
+#include "Scenarios.h"
+#include "Sensors.h"
+#include "I2cBus.h"
+#include "WarmState.h"
+#include "TagBackend.h"
+#include "Ntag5.h"
+#include "RF430CL330H_Shield.h"
+#include "devices/SimNtag5.h"
+#include "devices/SimRf430.h"
+#include <avr/eeprom.h>
+#include <stdio.h>
+
+static const unsigned BOOTS = 4;
+
+static bool contains(const uint8_t* memory, size_t size, const char* text)
+{
+    size_t len = strlen(text);
+    for (size_t i = 0; i + len <= size; i++)
+        if (!memcmp(memory + i, text, len))
+            return true;
+    return false;
+}
+
+//  the sketch's wake cycle, tag part only
+static bool cycle(const char* text, uint8_t& state)
+{
+    const WarmStateBlock& saved = WarmState::get();
+    bool warm = WarmState::valid() && (saved.peripherals & (WARM_PERIPH_RF430 | WARM_PERIPH_NTAG5));
+
+    I2cBus::beginSession(300000UL);
+    state = TagBackend::setup(warm);
+    bool ok = state != TAG_ABSENT && TagBackend::publish(OS_ANDROID, text);
+    I2cBus::endSession();
+
+    WarmState::setPeripherals((ok ? TagBackend::warmFlag() : 0) | WARM_PERIPH_SENSOR);
+    WarmState::setSensorConfig(BoardSensor::ID);
+    WarmState::commit();
+    return ok;
+}
+
+//  setup() after a reset: the first wake cycle
+static bool boot(unsigned i, const char* text, uint8_t& state)
+{
+    RSTCTRL.RSTFR = i ? RESET_CAUSE_WATCHDOG : RESET_CAUSE_POWER_ON;
+    TagBackend::reset();
+    WarmState::begin();
+    return cycle(text, state);
+}
+
+int simTagDetect(int, char**)
+{
+    static const char* const boards[] = { "RF430CL330H", "NTAG 5 Link", "no tag" };
+    static const char* const chips[] = { "none", "RF430", "NTAG5" };
+    int status = 0;
+
+    for (uint8_t b = 0; b < 3; b++)
+    {
+        SimRf430 rf430;
+        SimNtag5 ntag5;
+        if (b == 0)
+            SimI2c::attach(RF430_I2C_ADDRESS, &rf430);
+        if (b == 1)
+            SimI2c::attach(NTAG5_I2C_ADDRESS, &ntag5);
+        memset(simEeprom, 0xFF, sizeof(simEeprom));
+        uint8_t expect = b == 0 ? TAG_RF430 : b == 1 ? TAG_NTAG5 : TAG_NONE;
+
+        for (unsigned i = 0; i < BOOTS; i++)
+        {
+            char text[32];
+            snprintf(text, sizeof(text), "Temperature: %u.%u C", 20 + i, i * 3 % 10);
+            uint8_t state;
+            uint32_t start = micros();
+            bool published = boot(i, text, state);
+            uint32_t spent = micros() - start;
+
+            uint8_t view[64 * NTAG5_BLOCK_SIZE];
+            ntag5.rfView(view, 0, 64);
+            bool seen = b == 0 ? contains(rf430.memory(), SimRf430::MEMORY_SIZE, text)
+                               : b == 1 && contains(view, sizeof(view), text);
+            const TagCapabilities& caps = TagBackend::capabilities();
+            bool ok = TagBackend::chip() == expect && published == (expect != TAG_NONE) &&
+                      seen == published && TagBackend::probes == (i == 0 || expect == TAG_NONE ? 1 : 0);
+            printf("%-12s %s boot  chip %-5s probes %u  caps %c%c max NDEF %4u, %u byte writes  %6lu us  %s\n",
+                   boards[b], i ? "warm" : "cold", chips[TagBackend::chip()], TagBackend::probes,
+                   caps.flags & TAG_CAP_SRAM_MIRROR ? 'S' : '-', caps.flags & TAG_CAP_HW_CRC ? 'C' : '-',
+                   caps.maxNdef, caps.writeGranularity, (unsigned long)spent, ok ? "ok" : "FAIL");
+            status |= ok ? 0 : 1;
+        }
+        if (expect != TAG_NONE)
+        {
+            //  the longest text the capabilities allow must be written, one
+            //  more character refused before the bus
+            char text[300];
+            size_t longest = TagBackend::capabilities().maxNdef - 7;
+            memset(text, 'x', longest + 1);
+            text[longest + 1] = 0;
+            I2cBus::beginSession(300000UL);
+            bool over = TagBackend::publish(OS_ANDROID, text);
+            uint8_t failures = I2cBus::stats.failures;
+            text[longest] = 0;
+            bool fits = TagBackend::publish(OS_ANDROID, text);
+            I2cBus::endSession();
+            bool ok = fits && !over && !failures;
+            printf("%-12s longest text %u characters: %s, one more %s  %s\n", boards[b], (unsigned)longest,
+                   fits ? "written" : "refused", over ? "written" : "refused", ok ? "ok" : "FAIL");
+            status |= ok ? 0 : 1;
+        }
+        SimI2c::detach(RF430_I2C_ADDRESS);
+        SimI2c::detach(NTAG5_I2C_ADDRESS);
+    }
+
+    //  one boot, the tag refusing its address in the first cycle only
+    SimNtag5 ntag5;
+    SimI2c::attach(NTAG5_I2C_ADDRESS, &ntag5);
+    memset(simEeprom, 0xFF, sizeof(simEeprom));
+    unsigned recovered = 0, cycles = 4;
+    for (unsigned i = 0; i < cycles; i++)
+    {
+        char text[32];
+        snprintf(text, sizeof(text), "Temperature: 1%u.%u C", i, i * 7 % 10);
+        ntag5.setPresent(i != 0);
+        uint8_t state;
+        bool published = i ? cycle(text, state) : boot(0, text, state);
+        uint8_t view[64 * NTAG5_BLOCK_SIZE];
+        ntag5.rfView(view, 0, 64);
+        if (i && published && TagBackend::chip() == TAG_NTAG5 && contains(view, sizeof(view), text))
+            recovered++;
+        if (!i && (published || TagBackend::chip() != TAG_NONE))
+            recovered = cycles;         // the failure went unnoticed
+    }
+    SimI2c::detach(NTAG5_I2C_ADDRESS);
+    memset(simEeprom, 0xFF, sizeof(simEeprom));     // no warm state for the scenarios after
+    WarmState::begin();
+    bool ok = recovered == cycles - 1;
+    printf("NTAG 5 Link  one boot, tag missing in cycle 1 of %u: published in %u of the %u after  %s\n",
+           cycles, recovered, cycles - 1, ok ? "ok" : "FAIL");
+    status |= ok ? 0 : 1;
+    printf("caps: S = SRAM mirror, C = hardware CRC\n");
+    return status;
+}
@@ -0,0 +1,175 @@
+//  The display's trend chart (Sparkline.h) fed one reading per wake cycle.
+//  300 readings: a slow daily swing with noise, a cold spell that pulls the
+//  axis down and the return, so the chart wraps three times and rescales.
+//  Two ways of putting each reading on the panel: the whole chart with its
+//  labels as one partial refresh, and only the changed columns through
+//  Display::refresh() (what the firmware does). Per update: window bytes,
+//  SPI bytes, rows computed and MCU awake time. After every update the panel
+//  must match a reference drawn from the reading history on its own (axis,
+//  columns, labels); "trend dump" prints the final chart.
+
+#include "Scenarios.h"
+#include "Display.h"
+#include "Epd.h"
+#include "SimSpi.h"
+#include "devices/SimEpd.h"
+#include <math.h>
+#include <stdio.h>
+#include <vector>
+
+static const uint8_t CS = 0, DC = 1, RES = 2, BUSY = 3;     // PA4..PA7 on the board
+static const unsigned READINGS = 300;
+static const unsigned COLUMNS = DISPLAY_TREND_W * 8;
+
+static int16_t reading(unsigned i)
+{
+    int16_t swing = (int16_t)(i % 96 < 48 ? i % 96 : 96 - i % 96) * 9;
+    int16_t noise = (int16_t)(i * 37 % 23) - 11;
+    int16_t cold = i >= 180 && i < 215 ? -1450 : 0;
+    return 1950 + swing + noise + cold;
+}
+
+static void ink(uint8_t* image, unsigned x, unsigned y)
+{
+    image[y * EPD_ROW_BYTES + x / 8] &= ~(0x80 >> (x % 8));
+}
+
+static void label(uint8_t* image, int degrees, unsigned y)
+{
+    char text[8];
+    snprintf(text, sizeof(text), "%d", degrees);
+    unsigned n = strlen(text);
+    for (unsigned c = 0; c < n; c++)
+        for (unsigned r = 0; r < GLYPH_HEIGHT; r++)
+            for (unsigned b = 0; b < GLYPH_WIDTH; b++)
+                if (GlyphLine::glyphRow(text[c], r) & (0x80 >> b))
+                    ink(image, (DISPLAY_TREND_X - SPARKLINE_LABEL_CELLS + SPARKLINE_LABEL_CELLS - n + c) * 8 + b, y + r);
+}
+
+//  the chart from the history alone: the last COLUMNS - 1 readings in the
+//  slots they were written to, the slot after the newest left blank
+static void reference(const std::vector<int16_t>& history, uint8_t* image, int& lo, int& hi)
+{
+    memset(image, 0xFF, EPD_HEIGHT * EPD_ROW_BYTES);
+    unsigned n = history.size();
+    unsigned start = n > COLUMNS - 1 ? n - (COLUMNS - 1) : 0;
+    int16_t least = history[start], most = history[start];
+    for (unsigned k = start; k < n; k++)
+    {
+        least = history[k] < least ? history[k] : least;
+        most = history[k] > most ? history[k] : most;
+    }
+    lo = (int)floor(least / 100.0);
+    hi = (int)ceil(most / 100.0);
+    if (hi - lo < SPARKLINE_MIN_SPAN)
+        hi = lo + SPARKLINE_MIN_SPAN;
+
+    const unsigned H = DISPLAY_TREND_H;
+    std::vector<int> rows(n);
+    for (unsigned k = start; k < n; k++)
+        rows[k] = (H - 1) - (int)((history[k] - lo * 100L) * (long)(H - 1) / ((hi - lo) * 100L));
+    for (unsigned k = start; k < n; k++)
+    {
+        int a = rows[k], b = k > start ? rows[k - 1] : rows[k];
+        for (int r = a < b ? a : b; r <= (a < b ? b : a); r++)
+            ink(image, DISPLAY_TREND_X * 8 + k % COLUMNS, DISPLAY_TREND_Y + r);
+    }
+    label(image, hi, DISPLAY_TREND_Y);
+    label(image, lo, DISPLAY_TREND_Y + H - GLYPH_HEIGHT);
+}
+
+static void dump(const SimEpd& epd)
+{
+    for (uint16_t y = DISPLAY_TREND_Y; y < DISPLAY_TREND_Y + DISPLAY_TREND_H; y += 2)
+    {
+        for (uint16_t x = 0; x < EPD_WIDTH; x++)
+        {
+            const uint8_t* row = epd.panel() + y * EPD_ROW_BYTES;
+            bool dark = !(row[x / 8] & (0x80 >> (x % 8))) || !(row[EPD_ROW_BYTES + x / 8] & (0x80 >> (x % 8)));
+            putchar(dark ? '#' : '.');
+        }
+        putchar('\n');
+    }
+}
+
+int simTrend(int argc, char** argv)
+{
+    static const char* const names[] = { "whole chart, partial", "changed columns, partial" };
+    static uint8_t expected[EPD_HEIGHT * EPD_ROW_BYTES];
+    int status = 0;
+
+    printf("%-26s %7s %8s %8s %8s %9s %9s %6s\n", "strategy", "updates", "rescales", "window B",
+           "rows/upd", "SPI B/upd", "awake ms", "stale");
+    for (uint8_t columns = 0; columns < 2; columns++)
+    {
+        SimEpd epd(CS, DC, RES, BUSY);
+        SimSpi::attach(&epd);
+        SimSpi::reset();
+        Display::value.set("");
+        Display::trend.clear();
+        Display::begin(CS, DC, RES, BUSY);
+        Epd::fullRefreshes = Epd::partialRefreshes = 0;
+        Epd::spiBytes = 0;
+        Display::rowsPainted = 0;
+
+        bool ok = Display::refresh();       // the blank screen, full refresh
+        uint32_t windowBytes = 0, narrow = 0, awake = 0, bytes = 0, rows = 0;
+        std::vector<int16_t> history;
+        for (unsigned i = 0; i < READINGS; i++)
+        {
+            history.push_back(reading(i));
+            uint16_t rescales = Display::trend.rescales;
+            Display::record(reading(i));
+
+            uint8_t x, w;
+            uint16_t y, h;
+            Display::trend.window(x, y, w, h);
+            if (!columns)
+            {
+                x = DISPLAY_TREND_X - SPARKLINE_LABEL_CELLS;
+                w = DISPLAY_TREND_W + SPARKLINE_LABEL_CELLS;
+            }
+            uint32_t start = micros(), busyBefore = epd.stats.busyMicros, bytesBefore = SimSpi::stats.bytes;
+            uint32_t rowsBefore = Display::rowsPainted;
+            bool done;
+            if (columns)
+                done = Display::refresh();
+            else
+            {
+                done = Epd::update(x, y, w, h, Display::paintRow, EPD_REFRESH_PARTIAL);
+                Display::trend.clean();
+            }
+            windowBytes += w;
+            narrow += Display::trend.rescales == rescales && w <= 2;
+            rows += Display::rowsPainted - rowsBefore;
+            awake += micros() - start - (epd.stats.busyMicros - busyBefore);
+            bytes += SimSpi::stats.bytes - bytesBefore;
+
+            int lo, hi;
+            reference(history, expected, lo, hi);
+            ok = ok && done && epd.asleep() && !Display::trend.dirty() &&
+                 lo == Display::trend.axisMin() && hi == Display::trend.axisMax() &&
+                 !memcmp(epd.panel(), expected, sizeof(expected));
+        }
+        SimSpi::attach(0);
+
+        uint32_t errors = epd.stats.whileBusy + epd.stats.whileAsleep + epd.stats.unsupported + SimSpi::stats.disabled;
+        uint32_t updates = READINGS;
+        ok = ok && !errors && !epd.stale() && Epd::fullRefreshes == 1 + READINGS / EPD_FULL_EVERY;
+        // a reading repaints one or two bytes, except on rescales and the two
+        // readings per pass whose columns straddle the wrap
+        if (columns)
+            ok = ok && narrow + Display::trend.rescales + 2 * (READINGS / COLUMNS) >= READINGS;
+        printf("%-26s %7lu %8u %8.1f %8lu %9lu %9.1f %6lu  %s\n", names[columns], (unsigned long)updates,
+               Display::trend.rescales, (double)windowBytes / updates, (unsigned long)(rows / updates),
+               (unsigned long)(bytes / updates), awake / 1000.0 / updates, (unsigned long)epd.stale(),
+               ok ? "ok" : "FAIL");
+        status |= ok ? 0 : 1;
+
+        if (columns && argc > 0 && !strcmp(argv[0], "dump"))
+            dump(epd);
+    }
+    printf("%u columns, one per reading and the gap; rows: row source calls, both RAM writes;\n"
+           "every %u partial refreshes one is a full screen\n", COLUMNS, EPD_FULL_EVERY);
+    return status;
+}
@@ -0,0 +1,83 @@
+//  Boots the firmware's warm-reset path many times with a slowly drifting
+//  temperature and reports EEPROM wear and the wake time saved on warm boots.
+
+#include "Scenarios.h"
+#include "Sensors.h"
+#include "WarmState.h"
+#include "devices/SimSensors.h"
+#include <avr/eeprom.h>
+#include <stdio.h>
+
+static const unsigned BOOTS = 512;
+static const unsigned POWER_CYCLE_EVERY = 128;
+
+//  one setup() worth of sensor and warm-state work, returns wake time in us
+static uint32_t boot(uint8_t cause, bool& warm, int16_t& centi)
+{
+    RSTCTRL.RSTFR = cause;
+    uint32_t start = micros();
+
+    WarmState::begin();
+    const WarmStateBlock& saved = WarmState::get();
+    warm = WarmState::valid() && saved.sensorConfig == BoardSensor::ID &&
+           (saved.peripherals & WARM_PERIPH_SENSOR);
+    bool ok = warm ? BoardThermometer::resume() : BoardThermometer::begin();
+    ok = ok && BoardThermometer::read(centi);
+    if (ok)
+    {
+        WarmState::setPeripherals(WARM_PERIPH_RF430 | WARM_PERIPH_SENSOR);
+        WarmState::setSensorConfig(BoardSensor::ID);
+        WarmState::setLastValue(centi);
+    }
+    WarmState::setTagLayout(1);
+    WarmState::commit();
+    return micros() - start;
+}
+
+int simWarmboot(int, char**)
+{
+    SimTmp112 sensor;
+    SimI2c::attach(BoardSensor::ADDRESS, &sensor);
+    memset(simEeprom, 0xFF, sizeof(simEeprom));
+    simEepromByteWrites = 0;
+
+    uint32_t coldWake = 0, warmWake = 0;
+    unsigned coldBoots = 0, warmBoots = 0;
+    int16_t temperature = 2100;
+    for (unsigned i = 0; i < BOOTS; i++)
+    {
+        // +-0.0625 C steps, one full degree of drift over the run
+        temperature += (i % 3 == 0) ? 7 : -2;
+        sensor.setTemperature(temperature);
+
+        uint8_t cause = i % POWER_CYCLE_EVERY == 0 ? RESET_CAUSE_POWER_ON : RESET_CAUSE_WATCHDOG;
+        bool warm;
+        int16_t centi;
+        uint32_t wake = boot(cause, warm, centi);
+        if (warm)
+        {
+            warmWake += wake;
+            warmBoots++;
+        }
+        else
+        {
+            coldWake += wake;
+            coldBoots++;
+        }
+    }
+    SimI2c::detach(BoardSensor::ADDRESS);
+
+    unsigned long naive = (unsigned long)BOOTS * sizeof(WarmStateBlock);
+    printf("boots %u (cold %u, warm %u), block %u bytes\n",
+           BOOTS, coldBoots, warmBoots, (unsigned)sizeof(WarmStateBlock));
+    printf("wake  cold %6lu us  warm %6lu us (avg)\n",
+           coldBoots ? (unsigned long)(coldWake / coldBoots) : 0UL,
+           warmBoots ? (unsigned long)(warmWake / warmBoots) : 0UL);
+    printf("eeprom commits %u, bytes programmed %lu (write every boot: %lu)\n",
+           WarmState::eepromWrites, (unsigned long)simEepromByteWrites, naive);
+
+    // at least one commit per power cycle is fine, one per boot is not
+    bool ok = warmBoots > coldBoots && simEepromByteWrites * 8 < naive &&
+              (!coldBoots || !warmBoots || warmWake / warmBoots <= coldWake / coldBoots);
+    return ok ? 0 : 1;
+}
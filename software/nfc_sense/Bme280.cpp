@@ -0,0 +1,202 @@
+#include "Bme280.h"
+#include "I2cBus.h"
+
+Bme280Calibration Bme280::cal;
+int32_t Bme280::tFine;
+uint8_t Bme280::ctrlHum = BME280_OSRS_X1;
+uint8_t Bme280::ctrlMeas = BME280_OSRS_X1 << 5 | BME280_OSRS_X1 << 2;
+bool Bme280::_calibrated = false;
+
+static inline uint16_t le16(const uint8_t* p)
+{
+    return (uint16_t)p[1] << 8 | p[0];
+}
+
+/**
+**  @brief  Checks the chip id and caches the calibration words
+**  @retrun bool    false if no BME280 answers at BME280_I2C_ADDRESS
+**/
+bool Bme280::begin()
+{
+    uint8_t id;
+    if (!I2cBus::readReg(BME280_I2C_ADDRESS, BME280_REG_CHIP_ID, &id, 1) || id != BME280_CHIP_ID)
+        return false;
+    return _calibrated || readCalibration();
+}
+
+bool Bme280::readCalibration()
+{
+    uint8_t calib00[26], calib26[7];
+    if (!I2cBus::readReg(BME280_I2C_ADDRESS, BME280_REG_CALIB_00, calib00, 26) ||
+        !I2cBus::readReg(BME280_I2C_ADDRESS, BME280_REG_CALIB_26, calib26, 7))
+        return false;
+    parseCalibration(calib00, calib26);
+    return true;
+}
+
+/**
+**  @brief  Calibration from the raw register dumps, for readers that fetch
+**          them some other way (NTAG 5 I2C master)
+**  @param  const uint8_t*  calib00     26 bytes from 0x88
+**  @param  const uint8_t*  calib26     7 bytes from 0xE1
+**/
+void Bme280::parseCalibration(const uint8_t* calib00, const uint8_t* calib26)
+{
+    const uint8_t* buf = calib00;
+    cal.T1 = le16(buf + 0);
+    cal.T2 = (int16_t)le16(buf + 2);
+    cal.T3 = (int16_t)le16(buf + 4);
+    cal.P1 = le16(buf + 6);
+    cal.P2 = (int16_t)le16(buf + 8);
+    cal.P3 = (int16_t)le16(buf + 10);
+    cal.P4 = (int16_t)le16(buf + 12);
+    cal.P5 = (int16_t)le16(buf + 14);
+    cal.P6 = (int16_t)le16(buf + 16);
+    cal.P7 = (int16_t)le16(buf + 18);
+    cal.P8 = (int16_t)le16(buf + 20);
+    cal.P9 = (int16_t)le16(buf + 22);
+    cal.H1 = buf[25];
+
+    buf = calib26;
+    cal.H2 = (int16_t)le16(buf + 0);
+    cal.H3 = buf[2];
+    cal.H4 = (int16_t)((int16_t)(int8_t)buf[3] * 16 | (buf[4] & 0x0F));
+    cal.H5 = (int16_t)((int16_t)(int8_t)buf[5] * 16 | (buf[4] >> 4));
+    cal.H6 = (int8_t)buf[6];
+
+    _calibrated = true;
+}
+
+/**
+**  @brief  Restores calibration cached outside the chip (warm boot)
+**/
+void Bme280::setCalibration(const Bme280Calibration& calibration)
+{
+    cal = calibration;
+    _calibrated = true;
+}
+
+/**
+**  @brief  Selects oversampling per channel, BME280_OSRS_SKIP disables one
+**/
+void Bme280::setOversampling(uint8_t osrsT, uint8_t osrsP, uint8_t osrsH)
+{
+    ctrlHum = osrsH & 0x07;
+    ctrlMeas = (osrsT & 0x07) << 5 | (osrsP & 0x07) << 2;
+}
+
+/**
+**  @brief  Maximum forced-mode measurement time for the current settings
+**          (datasheet appendix B: 1.25 + 2.3 T + 2.3 P + 0.575 + 2.3 H + 0.575 ms)
+**/
+uint16_t Bme280::measurementMs()
+{
+    static const uint8_t samples[8] = { 0, 1, 2, 4, 8, 16, 16, 16 };
+    uint8_t t = samples[ctrlMeas >> 5];
+    uint8_t p = samples[(ctrlMeas >> 2) & 0x07];
+    uint8_t h = samples[ctrlHum & 0x07];
+    uint32_t us = 1250 + 2300UL * t;
+    if (p)
+        us += 2300UL * p + 575;
+    if (h)
+        us += 2300UL * h + 575;
+    return (uint16_t)((us + 999) / 1000);
+}
+
+/**
+**  @brief  Starts one forced measurement. ctrl_hum only latches on the
+**          following ctrl_meas write, both go out as register/data pairs
+**          in a single transaction.
+**/
+bool Bme280::startForced()
+{
+    uint8_t buf[4] = { BME280_REG_CTRL_HUM, ctrlHum,
+                       BME280_REG_CTRL_MEAS, (uint8_t)(ctrlMeas | BME280_MODE_FORCED) };
+    return I2cBus::write(BME280_I2C_ADDRESS, buf, sizeof(buf));
+}
+
+bool Bme280::measuring()
+{
+    uint8_t status;
+    if (!I2cBus::readReg(BME280_I2C_ADDRESS, BME280_REG_STATUS, &status, 1))
+        return true;
+    return status & BME280_STATUS_MEASURING;
+}
+
+/**
+**  @brief  Burst reads all data registers and compensates every enabled channel
+**  @param  Bme280Data& data    result
+**  @retrun bool        false on bus error
+**/
+bool Bme280::readAll(Bme280Data& data)
+{
+    uint8_t buf[8];
+    if (!I2cBus::readReg(BME280_I2C_ADDRESS, BME280_REG_DATA, buf, 8))
+        return false;
+
+    int32_t adcP = (int32_t)buf[0] << 12 | (int32_t)buf[1] << 4 | buf[2] >> 4;
+    int32_t adcT = (int32_t)buf[3] << 12 | (int32_t)buf[4] << 4 | buf[5] >> 4;
+    int32_t adcH = (int32_t)buf[6] << 8 | buf[7];
+
+    // temperature first, it produces tFine for the other two
+    data.centiCelsius = compensateTemperature(adcT);
+    data.pascal = (ctrlMeas >> 2) & 0x07 ? compensatePressure(adcP) : 0;
+    data.humidityPermille = ctrlHum ? (uint16_t)((compensateHumidity(adcH) * 10 + 512) >> 10) : 0;
+    return true;
+}
+
+/**
+**  @brief  Reads only the three temperature registers
+**/
+bool Bme280::readTemperature(int16_t& centiCelsius)
+{
+    uint8_t buf[3];
+    if (!I2cBus::readReg(BME280_I2C_ADDRESS, BME280_REG_DATA + 3, buf, 3))
+        return false;
+    centiCelsius = compensateTemperature((int32_t)buf[0] << 12 | (int32_t)buf[1] << 4 | buf[2] >> 4);
+    return true;
+}
+
+int16_t Bme280::compensateTemperature(int32_t adcT)
+{
+    int32_t var1 = ((((adcT >> 3) - ((int32_t)cal.T1 << 1))) * ((int32_t)cal.T2)) >> 11;
+    int32_t var2 = (((((adcT >> 4) - ((int32_t)cal.T1)) * ((adcT >> 4) - ((int32_t)cal.T1))) >> 12) *
+                    ((int32_t)cal.T3)) >> 14;
+    tFine = var1 + var2;
+    return (int16_t)((tFine * 5 + 128) >> 8);
+}
+
+uint32_t Bme280::compensatePressure(int32_t adcP)
+{
+    int32_t var1, var2;
+    uint32_t p;
+    var1 = (tFine >> 1) - (int32_t)64000;
+    var2 = (((var1 >> 2) * (var1 >> 2)) >> 11) * ((int32_t)cal.P6);
+    var2 = var2 + ((var1 * ((int32_t)cal.P5)) << 1);
+    var2 = (var2 >> 2) + (((int32_t)cal.P4) << 16);
+    var1 = ((((int32_t)cal.P3 * (((var1 >> 2) * (var1 >> 2)) >> 13)) >> 3) + ((((int32_t)cal.P2) * var1) >> 1)) >> 18;
+    var1 = ((((32768 + var1)) * ((int32_t)cal.P1)) >> 15);
+    if (var1 == 0)
+        return 0;   // avoid division by zero
+    p = (((uint32_t)(((int32_t)1048576) - adcP) - (var2 >> 12))) * 3125;
+    if (p < 0x80000000)
+        p = (p << 1) / ((uint32_t)var1);
+    else
+        p = (p / (uint32_t)var1) * 2;
+    var1 = (((int32_t)cal.P9) * ((int32_t)(((p >> 3) * (p >> 3)) >> 13))) >> 12;
+    var2 = (((int32_t)(p >> 2)) * ((int32_t)cal.P8)) >> 13;
+    p = (uint32_t)((int32_t)p + ((var1 + var2 + cal.P7) >> 4));
+    return p;
+}
+
+uint32_t Bme280::compensateHumidity(int32_t adcH)
+{
+    int32_t v = (tFine - ((int32_t)76800));
+    v = (((((adcH << 14) - (((int32_t)cal.H4) << 20) - (((int32_t)cal.H5) * v)) + ((int32_t)16384)) >> 15) *
+         (((((((v * ((int32_t)cal.H6)) >> 10) * (((v * ((int32_t)cal.H3)) >> 11) + ((int32_t)32768))) >> 10) +
+            ((int32_t)2097152)) * ((int32_t)cal.H2) + 8192) >> 14));
+    v = (v - (((((v >> 15) * (v >> 15)) >> 7) * ((int32_t)cal.H1)) >> 4));
+    v = (v < 0 ? 0 : v);
+    v = (v > 419430400 ? 419430400 : v);
+    return (uint32_t)(v >> 12);
+}
@@ -0,0 +1,96 @@
+//  BME280 forced-mode driver, integer only
+//  -----------------------------------------
+//  Calibration is read once in begin() and cached. Compensation uses the
+//  32-bit integer formulas from the Bosch datasheet (BST-BME280-DS002,
+//  section 4.2.3 / 8.2), no float or double is pulled in.
+//
+//  A full measurement is:
+//      Bme280::startForced();          one write, ctrl_hum + ctrl_meas
+//      ... wait Bme280::measurementMs() or poll Bme280::measuring()
+//      Bme280::readAll(data);          one 8-byte burst 0xF7..0xFE
+
+#ifndef BME280_H_
+#define BME280_H_
+#if ARDUINO >= 100
+ #include "Arduino.h"
+#else
+ #include "WProgram.h"
+#endif
+
+#define BME280_I2C_ADDRESS      (0x76)      // SDO tied to GND on the ntag_BME boards
+#define BME280_CHIP_ID          (0x60)
+
+#define BME280_REG_CALIB_00     0x88        // 0x88..0xA1, T1..P9, H1 at 0xA1
+#define BME280_REG_CHIP_ID      0xD0
+#define BME280_REG_RESET        0xE0
+#define BME280_REG_CALIB_26     0xE1        // 0xE1..0xE7, H2..H6
+#define BME280_REG_CTRL_HUM     0xF2
+#define BME280_REG_STATUS       0xF3
+#define BME280_REG_CTRL_MEAS    0xF4
+#define BME280_REG_CONFIG       0xF5
+#define BME280_REG_DATA         0xF7        // press[3], temp[3], hum[2]
+
+#define BME280_STATUS_MEASURING BIT3
+#define BME280_MODE_SLEEP       0x00
+#define BME280_MODE_FORCED      0x01
+
+//oversampling settings, osrs_x register fields
+#define BME280_OSRS_SKIP        0
+#define BME280_OSRS_X1          1
+#define BME280_OSRS_X2          2
+#define BME280_OSRS_X4          3
+#define BME280_OSRS_X8          4
+#define BME280_OSRS_X16         5
+
+#ifndef BIT3
+ #define BIT3                   0x0008
+#endif
+
+struct Bme280Calibration
+{
+    uint16_t T1;
+    int16_t  T2, T3;
+    uint16_t P1;
+    int16_t  P2, P3, P4, P5, P6, P7, P8, P9;
+    uint8_t  H1, H3;
+    int16_t  H2, H4, H5;
+    int8_t   H6;
+};
+
+struct Bme280Data
+{
+    int16_t  centiCelsius;      // 0.01 C
+    uint32_t pascal;            // Pa, 0 if pressure skipped
+    uint16_t humidityPermille;  // 0.1 %RH, 0 if humidity skipped
+};
+
+class Bme280
+{
+public:
+    static bool begin();
+    static void setCalibration(const Bme280Calibration& calibration);
+    static void parseCalibration(const uint8_t* calib00, const uint8_t* calib26);
+    static bool calibrated() { return _calibrated; }
+    static void setOversampling(uint8_t osrsT, uint8_t osrsP, uint8_t osrsH);
+    static uint16_t measurementMs();
+
+    static bool startForced();
+    static bool measuring();
+    static bool readAll(Bme280Data& data);
+    static bool readTemperature(int16_t& centiCelsius);
+
+    static int16_t compensateTemperature(int32_t adcT);
+    static uint32_t compensatePressure(int32_t adcP);
+    static uint32_t compensateHumidity(int32_t adcH);   // %RH in Q22.10
+
+    static Bme280Calibration cal;
+
+private:
+    static bool readCalibration();
+
+    static int32_t tFine;
+    static uint8_t ctrlHum, ctrlMeas;
+    static bool _calibrated;
+};
+
+#endif /* BME280_H_ */
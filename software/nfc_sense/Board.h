@@ -0,0 +1,253 @@
+//  Per-board pin roles and low-leakage port configuration
+//  -----------------------------------------
+//  Each board lists only the pins that are wired to something. Pins marked
+//  ASSUMED have no MCU net in the schematic yet and need a wire from the
+//  named part to that pin until the next board revision. Every other
+//  pin ends up as input with the digital input buffer disabled, which is the
+//  lowest-leakage state for an unconnected pin. The masks are folded at
+//  compile time, so Board::init() is a handful of VPORT/PORT writes instead
+//  of one pinMode() call per pin.
+//
+//  ATtiny1626 (20-pin) Arduino pin numbers, megaTinyCore:
+//
+//      0 PA4   4 PB5   8 PB1(SDA)  12 PC2  16 PA3
+//      1 PA5   5 PB4   9 PB0(SCL)  13 PC3  17 PA0(UPDI)
+//      2 PA6   6 PB3  10 PC0       14 PA1
+//      3 PA7   7 PB2  11 PC1       15 PA2
+
+#ifndef BOARD_H_
+#define BOARD_H_
+
+#include "BoardConfig.h"
+#if ARDUINO >= 100
+ #include "Arduino.h"
+#else
+ #include "WProgram.h"
+#endif
+
+#define BOARD_PORT_A    0
+#define BOARD_PORT_B    1
+#define BOARD_PORT_C    2
+
+//pin roles
+#define PIN_ROLE_PERIPHERAL     0   // left to the peripheral driver (TWI, SPI)
+#define PIN_ROLE_OUT_LOW        1
+#define PIN_ROLE_OUT_HIGH       2
+#define PIN_ROLE_IN             3   // input buffer on, no pull
+#define PIN_ROLE_IN_PULLUP      4
+#define PIN_ROLE_IN_FLOATING    5   // open-drain source, buffer off until used
+
+struct BoardPin
+{
+    uint8_t pin;
+    uint8_t role;
+};
+
+static const uint8_t NO_PIN = 0xFF;
+
+//  ---------------------------------------------------------------------
+//  Board tables
+//  ---------------------------------------------------------------------
+
+#if defined(BOARD_NFC_SENSE_ATTINY) || defined(BOARD_NFC_SENSE_COIN) || defined(BOARD_POCKET_KNIFE)
+
+#define BOARD_HAS_RF430
+#define BOARD_PIN_RF430_RESET   4   // PB5
+#define BOARD_PIN_RF430_INTO    5   // PB4, active low
+
+static constexpr BoardPin BOARD_PINS[] = {
+    { 9,  PIN_ROLE_PERIPHERAL },    // SCL
+    { 8,  PIN_ROLE_PERIPHERAL },    // SDA
+    { BOARD_PIN_RF430_RESET, PIN_ROLE_OUT_HIGH },
+    { BOARD_PIN_RF430_INTO,  PIN_ROLE_IN_FLOATING },
+#if defined(BOARD_PIN_SENSOR_ALERT)
+    { BOARD_PIN_SENSOR_ALERT, PIN_ROLE_IN_FLOATING },
+#endif
+};
+
+#elif defined(BOARD_POCKET_KNIFE_DISPLAY)
+
+//  The e-paper nets (SDI, SCLK, CS, D/C, RES, BUSY) are placed as labels
+//  next to PORTA in the schematic; SDI/SCLK sit on the SPI0 default pins.
+//  ED has no MCU net (a lone global label at the NTAG) and is expected on
+//  PB4, the former RF430_INT.
+//  D1 is a power LED (VCC, R3); see Indicator.h for using it as status LED.
+//  Q1 (Si1308) is the SSD1680 booster switch, not a supply switch: sensor
+//  and panel are on VCC. See Rail.h for a load switch in front of them.
+#define BOARD_HAS_NTAG5
+#define BOARD_HAS_DISPLAY
+#define BOARD_PIN_NTAG_ED       5   // PB4, ASSUMED: wire from NTAG ED
+#define BOARD_PIN_EPD_SDI       14  // PA1, MOSI
+#define BOARD_PIN_EPD_SCLK      16  // PA3, SCK
+#define BOARD_PIN_EPD_CS        0   // PA4
+#define BOARD_PIN_EPD_DC        1   // PA5
+#define BOARD_PIN_EPD_RES       2   // PA6
+#define BOARD_PIN_EPD_BUSY      3   // PA7
+
+static constexpr BoardPin BOARD_PINS[] = {
+    { 9,  PIN_ROLE_PERIPHERAL },    // SCL
+    { 8,  PIN_ROLE_PERIPHERAL },    // SDA
+    { BOARD_PIN_NTAG_ED,      PIN_ROLE_IN_FLOATING },
+#if defined(BOARD_PIN_SENSOR_ALERT)
+    { BOARD_PIN_SENSOR_ALERT, PIN_ROLE_IN_FLOATING },
+#endif
+    { BOARD_PIN_EPD_SDI,  PIN_ROLE_OUT_LOW },
+    { BOARD_PIN_EPD_SCLK, PIN_ROLE_OUT_LOW },
+#if defined(BOARD_PIN_RAIL_GATE)
+    { BOARD_PIN_EPD_CS,   PIN_ROLE_OUT_LOW },   // panel unpowered until used
+    { BOARD_PIN_RAIL_GATE, PIN_ROLE_OUT_LOW },
+#else
+    { BOARD_PIN_EPD_CS,   PIN_ROLE_OUT_HIGH },
+#endif
+    { BOARD_PIN_EPD_DC,   PIN_ROLE_OUT_LOW },
+    { BOARD_PIN_EPD_RES,  PIN_ROLE_OUT_LOW },  // panel held in reset until used
+    { BOARD_PIN_EPD_BUSY, PIN_ROLE_IN_FLOATING },
+#if defined(BOARD_PIN_STATUS_LED)
+    { BOARD_PIN_STATUS_LED, PIN_ROLE_OUT_LOW },
+#endif
+};
+
+#elif defined(BOARD_NFC_SENSE_NTAG) || defined(BOARD_NFC_SENSE_NTAG_BME2)
+
+//  ED is routed to the NTAG only (a lone global label); PB4 is the
+//  expected MCU net.
+//  D1 is a power LED (VCC, R4/R2); see Indicator.h for using it as status LED.
+#define BOARD_HAS_NTAG5
+#define BOARD_PIN_NTAG_ED       5   // PB4, ASSUMED: wire from NTAG ED
+
+static constexpr BoardPin BOARD_PINS[] = {
+    { 9,  PIN_ROLE_PERIPHERAL },    // SCL
+    { 8,  PIN_ROLE_PERIPHERAL },    // SDA
+    { BOARD_PIN_NTAG_ED, PIN_ROLE_IN_FLOATING },
+#if defined(BOARD_PIN_STATUS_LED)
+    { BOARD_PIN_STATUS_LED, PIN_ROLE_OUT_LOW },
+#endif
+};
+
+#endif
+
+//  Status LED on the CCL LUT1 alternate output, see Indicator.h. No board
+//  routes it; build with -DBOARD_PIN_STATUS_LED=11 after the rework.
+#if defined(BOARD_PIN_STATUS_LED) && BOARD_PIN_STATUS_LED != 11
+ #error "the status LED must be on PC1 (pin 11), the CCL LUT1 alternate output"
+#endif
+
+//  Sensor ALERT for the ALERT wake (FieldWake.h). The schematics leave it a
+//  lone global label at the sensor, no board routes it. After the rework
+//  (ALERT wired to PC3 plus an external pull-up to VCC, 1 MOhm: FieldWake
+//  leaves the MCU's ~35 kOhm one off, it would draw ~85 uA for as long as
+//  an alarm lasts) build with -DBOARD_PIN_SENSOR_ALERT=13.
+
+//  Load switch enable for the sensor and panel supply, see Rail.h. No board
+//  has one; build with e.g. -DBOARD_PIN_RAIL_GATE=12 (PC2) after the rework.
+#if defined(BOARD_PIN_RAIL_GATE) && !defined(BOARD_HAS_DISPLAY)
+ #error "BOARD_PIN_RAIL_GATE is only wired up on the display board"
+#endif
+
+//  ---------------------------------------------------------------------
+//  Compile-time mask folding
+//  ---------------------------------------------------------------------
+
+class Board
+{
+public:
+    static constexpr uint8_t port(uint8_t pin)
+    {
+        return pin <= 3 || (pin >= 14 && pin <= 17) ? BOARD_PORT_A :
+               pin <= 9 ? BOARD_PORT_B : BOARD_PORT_C;
+    }
+
+    static constexpr uint8_t bit(uint8_t pin)
+    {
+        return pin <= 3 ? pin + 4 :             // PA4..PA7
+               pin <= 9 ? 9 - pin :             // PB5..PB0
+               pin <= 13 ? pin - 10 :           // PC0..PC3
+               pin - 13;                        // PA1..PA3, PA0 (17 -> 4 is never used)
+    }
+
+    static constexpr uint8_t mask(uint8_t pin)
+    {
+        return pin == 17 ? 0 : (uint8_t)(1 << bit(pin));
+    }
+
+    // pins of a port that have the given role
+    static constexpr uint8_t roleMask(uint8_t p, uint8_t role, uint8_t i = 0)
+    {
+        return i >= sizeof(BOARD_PINS) / sizeof(BOARD_PINS[0]) ? 0 :
+               (uint8_t)(((port(BOARD_PINS[i].pin) == p && BOARD_PINS[i].role == role) ? mask(BOARD_PINS[i].pin) : 0) |
+                         roleMask(p, role, i + 1));
+    }
+
+    static constexpr uint8_t usedMask(uint8_t p, uint8_t i = 0)
+    {
+        return i >= sizeof(BOARD_PINS) / sizeof(BOARD_PINS[0]) ? 0 :
+               (uint8_t)((port(BOARD_PINS[i].pin) == p ? mask(BOARD_PINS[i].pin) : 0) | usedMask(p, i + 1));
+    }
+
+    static constexpr uint8_t dir(uint8_t p)
+    {
+        return roleMask(p, PIN_ROLE_OUT_LOW) | roleMask(p, PIN_ROLE_OUT_HIGH);
+    }
+
+    static constexpr uint8_t out(uint8_t p)
+    {
+        return roleMask(p, PIN_ROLE_OUT_HIGH);
+    }
+
+    // unused pins plus open-drain inputs: digital input buffer off.
+    // PA0 is UPDI and never touched.
+    static constexpr uint8_t inputDisable(uint8_t p)
+    {
+        return (uint8_t)((~usedMask(p) | roleMask(p, PIN_ROLE_IN_FLOATING)) & (p == BOARD_PORT_A ? 0xFE : p == BOARD_PORT_B ? 0x3F : 0x0F));
+    }
+
+    static constexpr uint8_t pullup(uint8_t p)
+    {
+        return roleMask(p, PIN_ROLE_IN_PULLUP);
+    }
+
+    static void init();
+    static void powerDownPeripherals();
+};
+
+#if defined(__AVR__)
+
+//  PINnCTRL of the pins in the mask, one write each; the tinyAVR 2-series
+//  has no multi-pin PINCONFIG/PINCTRLUPD (AVR DD/EA only). m is a constant,
+//  so the loop unrolls to the pins the board actually uses.
+#define BOARD_PINCTRL(port, m, value)                                   \
+    do { for (uint8_t b = 0; b < 8; b++) if ((m) & (1 << b)) (&(port).PIN0CTRL)[b] = (value); } while (0)
+
+/**
+**  @brief  Applies the board table: direction, level and PINnCTRL per port
+**/
+inline void Board::init()
+{
+    VPORTA.OUT = out(BOARD_PORT_A);
+    VPORTA.DIR = dir(BOARD_PORT_A);
+    VPORTB.OUT = out(BOARD_PORT_B);
+    VPORTB.DIR = dir(BOARD_PORT_B);
+    VPORTC.OUT = out(BOARD_PORT_C);
+    VPORTC.DIR = dir(BOARD_PORT_C);
+
+    BOARD_PINCTRL(PORTA, inputDisable(BOARD_PORT_A), PORT_ISC_INPUT_DISABLE_gc);
+    BOARD_PINCTRL(PORTB, inputDisable(BOARD_PORT_B), PORT_ISC_INPUT_DISABLE_gc);
+    BOARD_PINCTRL(PORTC, inputDisable(BOARD_PORT_C), PORT_ISC_INPUT_DISABLE_gc);
+
+    BOARD_PINCTRL(PORTA, pullup(BOARD_PORT_A), PORT_PULLUPEN_bm);
+    BOARD_PINCTRL(PORTB, pullup(BOARD_PORT_B), PORT_PULLUPEN_bm);
+    BOARD_PINCTRL(PORTC, pullup(BOARD_PORT_C), PORT_PULLUPEN_bm);
+}
+
+/**
+**  @brief  Stops the peripherals the core starts but the firmware never uses
+**/
+inline void Board::powerDownPeripherals()
+{
+    TCA0.SPLIT.CTRLA = 0;                   // PWM timer started by the core
+    ADC0.CTRLA &= ~ADC_ENABLE_bm;           // Very important on the tinyAVR 2-series
+}
+
+#endif /* __AVR__ */
+
+#endif /* BOARD_H_ */
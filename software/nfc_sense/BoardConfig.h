@@ -0,0 +1,45 @@
+//  Compile-time board selection
+//  -----------------------------------------
+//  Define one BOARD_* symbol in the build flags, e.g.
+//      arduino-cli compile --build-property "build.extra_flags=-DBOARD_NFC_SENSE_COIN"
+//  Without one the nfc_sense_attiny board is assumed.
+//
+//  Board                         | Tag          | Sensor  |
+//  -----------------------------------------------------
+//  BOARD_NFC_SENSE_ATTINY        | RF430CL330H  | TMP112  |
+//  BOARD_NFC_SENSE_COIN          | RF430CL330H  | TMP112  |
+//  BOARD_POCKET_KNIFE            | RF430CL330H  | TMP112  |
+//  BOARD_POCKET_KNIFE_DISPLAY    | NTAG 5 Link  | TMP112  |
+//  BOARD_NFC_SENSE_NTAG          | NTAG 5 Link  | TMP112  |
+//  BOARD_NFC_SENSE_NTAG_BME2     | NTAG 5 Link  | BME280  |
+//  -----------------------------------------------------
+//
+//  The sensor can be overridden with SENSOR_TMP117 / SENSOR_TMP112 /
+//  SENSOR_BME280, e.g. for the TMP117 breakout used during bring-up.
+//
+//  ALERT_HIGH_CENTI is the limit for the sensor's ALERT wake
+//  (NFC_SENSE_ALERT_WAKE); the TMP117 also keeps it in its EEPROM.
+
+#ifndef BOARD_CONFIG_H_
+#define BOARD_CONFIG_H_
+
+#if !defined(BOARD_NFC_SENSE_ATTINY) && !defined(BOARD_NFC_SENSE_COIN) && \
+    !defined(BOARD_POCKET_KNIFE) && !defined(BOARD_POCKET_KNIFE_DISPLAY) && \
+    !defined(BOARD_NFC_SENSE_NTAG) && !defined(BOARD_NFC_SENSE_NTAG_BME2)
+ #define BOARD_NFC_SENSE_ATTINY
+#endif
+
+#if !defined(SENSOR_TMP117) && !defined(SENSOR_TMP112) && !defined(SENSOR_BME280)
+ #if defined(BOARD_NFC_SENSE_NTAG_BME2)
+  #define SENSOR_BME280
+ #else
+  #define SENSOR_TMP112
+ #endif
+#endif
+
+#if !defined(ALERT_HIGH_CENTI)
+ #define ALERT_HIGH_CENTI       800     // cold chain, 8.0 C
+#endif
+#define ALERT_HYSTERESIS_CENTI  50
+
+#endif /* BOARD_CONFIG_H_ */
@@ -0,0 +1,86 @@
+#include "Budget.h"
+#include "Supply.h"
+#include "Standby.h"
+#include "Ntag5.h"
+#include "I2cBus.h"
+
+uint8_t Budget::shed = 0;
+uint8_t Budget::waits = 0;
+uint16_t Budget::millivolts = 0;
+uint16_t Budget::buffer = 0;
+
+/**
+**  @brief  Storage capacitor on VOUT; 0 runs every task without a check
+**/
+void Budget::begin(uint16_t bufferUf)
+{
+    buffer = bufferUf;
+}
+
+/**
+**  @brief  Runs the tasks by priority, each once the supply can carry it,
+**          recharging in standby in between while the field holds
+**  @param  const BudgetTask* tasks   at most 8, equal priorities in table order
+**  @retrun uint8_t bit per task that ran
+**/
+uint8_t Budget::run(const BudgetTask* tasks, uint8_t count)
+{
+    uint8_t all = count < 8 ? (1 << count) - 1 : 0xFF;
+    uint8_t pending = all;
+    waits = 0;
+    for (;;)
+    {
+        while (pending)
+        {
+            uint8_t next = 0xFF;
+            for (uint8_t i = 0; i < count; i++)
+                if ((pending & 1 << i) && (next == 0xFF || tasks[i].priority < tasks[next].priority))
+                    next = i;
+            if (!affords(tasks[next]))
+                break;
+            tasks[next].run();
+            pending &= ~(1 << next);
+        }
+        if (!pending || waits == BUDGET_RETRIES || !harvesting())
+            break;
+
+        uint16_t before = millivolts;
+        Standby::sleep(BUDGET_RECHARGE_MS);
+        waits++;
+        millivolts = Supply::measure();
+        if (millivolts <= before)
+            break;              // full and the task still too big
+    }
+    shed = pending;
+    return all & ~pending;
+}
+
+/**
+**  @brief  Charge the capacitor holds above BUDGET_VMIN_MV, at the last check
+**/
+uint32_t Budget::reserveUc()
+{
+    return millivolts > BUDGET_VMIN_MV ? (uint32_t)buffer * (millivolts - BUDGET_VMIN_MV) / 1000 : 0;
+}
+
+/**
+**  @brief  The reader field is still there, so is the harvest current.
+**          run() comes after the wake cycle's session has ended, so the
+**          status read gets one of its own, bounded like a single call.
+**/
+bool Budget::harvesting()
+{
+    uint8_t status0;
+    I2cBus::beginSession(I2cBus::callBoundMicros());
+    bool field = Ntag5::status(status0) && (status0 & NTAG5_STATUS0_NFC_FIELD_OK);
+    I2cBus::endSession();
+    return field;
+}
+
+bool Budget::affords(const BudgetTask& task)
+{
+    if (!buffer)
+        return true;
+    millivolts = Supply::measure();
+    return reserveUc() >= task.costUc;
+}
@@ -0,0 +1,83 @@
+//  Wake cycle tasks against the charge a field-powered board has left
+//  -----------------------------------------
+//  On boards supplied from the NTAG 5 VOUT (NFC_SENSE_HARVEST_BOOT) the MCU
+//  and panel run from a storage capacitor that the harvester tops up while
+//  a phone holds the tag, at a rate that depends on the phone and the
+//  distance. The reading goes to the tag first, in the I2C session; the
+//  rest of the cycle (warm state, trend, panel refresh) is a table of
+//  BudgetTasks that run() takes by priority once the session has ended.
+//
+//  Each task declares the charge it draws at worst. Before a task run()
+//  measures VDD (Supply::measure(), no bus traffic) and takes what the
+//  capacitor holds above BUDGET_VMIN_MV, BUDGET_BUFFER_UF * (VDD - VMIN).
+//  The harvest current is not counted on: the phone may leave while the
+//  task runs. A task that does not fit holds back itself and every task
+//  after it, and while the NTAG 5 still reports the field (STATUS0
+//  NFC_FIELD_OK) the board sleeps BUDGET_RECHARGE_MS in standby and tries
+//  again. The wake cycle's I2cBus session has ended by then, so the status
+//  read opens a short session of its own. Without the field, when VDD
+//  stops rising (the capacitor full and the task still too big) or after
+//  BUDGET_RETRIES waits, what is left is shed; a cycle that lost its power
+//  halfway would lose it as well, minus the brown-out and a torn EEPROM
+//  write or refresh.
+//
+//  Size BUDGET_BUFFER_UF for the largest task below the VOUT setting: a
+//  full refresh takes 9.2 mC, 22 mF from 2.4 V (NTAG5_EH_VOUT_2V4) hold
+//  11 mC above BUDGET_VMIN_MV.
+//
+//  begin(0), the default, leaves the check out: every task runs, in
+//  priority order, as on the battery boards.
+
+#ifndef BUDGET_H_
+#define BUDGET_H_
+#if ARDUINO >= 100
+ #include "Arduino.h"
+#else
+ #include "WProgram.h"
+#endif
+
+#if !defined(BUDGET_BUFFER_UF)
+ #define BUDGET_BUFFER_UF       22000   // VOUT storage, 22 mF
+#endif
+#define BUDGET_VMIN_MV          1900    // BOD at 1.8 V plus the ADC's error
+#define BUDGET_RECHARGE_MS      250     // standby between attempts
+#define BUDGET_RETRIES          60      // 15 s of recharging at most
+
+//task priorities, lower runs first
+#define BUDGET_STATE            0       // what the next boot relies on
+#define BUDGET_HISTORY          1       // value and trend widgets
+#define BUDGET_DISPLAY          2       // panel refresh
+
+//what the sketch's tasks draw from VOUT at worst, measured at 5 MHz: the
+//clock HarvestBoot.cpp requires of the VOUT boards, the only ones that
+//check (F_CPU 10 MHz elsewhere, where begin(0) runs every task)
+#define BUDGET_STATE_UC         40      // warm state block, EEPROM erase and write
+#define BUDGET_HISTORY_UC       2       // RAM only
+#define BUDGET_DISPLAY_UC       9200    // full refresh, 2.9 s at 3 mA plus the MCU
+
+struct BudgetTask
+{
+    void (*run)();
+    uint16_t costUc;            // charge drawn from VOUT at worst
+    uint8_t  priority;          // BUDGET_*
+};
+
+class Budget
+{
+public:
+    static void begin(uint16_t bufferUf);
+    static uint8_t run(const BudgetTask* tasks, uint8_t count);   // bit per task that ran
+    static uint32_t reserveUc();
+    static bool harvesting();
+
+    static uint8_t shed;            // bit per task of the last run() that did not run
+    static uint8_t waits;           // recharge waits in the last run()
+    static uint16_t millivolts;     // VDD at the last check
+
+private:
+    static bool affords(const BudgetTask& task);
+
+    static uint16_t buffer;         // uF, 0 = no check
+};
+
+#endif /* BUDGET_H_ */
@@ -0,0 +1,151 @@
+#include "Clock.h"
+
+#if defined(__AVR__)
+ #if defined(MILLIS_USE_TIMERB0)
+  #define CLOCK_MILLIS_TCB  TCB0
+ #elif defined(MILLIS_USE_TIMERB1)
+  #define CLOCK_MILLIS_TCB  TCB1
+ #elif !defined(MILLIS_USE_TIMERRTC) && !defined(MILLIS_USE_TIMERNONE)
+  #error "Clock: the millis timer must be a TCB (or the RTC, which keeps its clock)"
+ #endif
+#endif
+
+//  MCLKCTRLB.PDIV codes 0..12, 0 = reserved
+static const uint8_t DIVISIONS[13] = { 2, 4, 8, 16, 32, 64, 0, 0, 6, 10, 12, 24, 48 };
+
+ClockConfig Clock::fast;
+ClockConfig Clock::slow;
+uint8_t Clock::current = CLOCK_FAST;
+bool Clock::scalable = false;
+uint32_t Clock::since = 0;
+uint16_t Clock::switches = 0;
+uint32_t Clock::slowMicros = 0;
+
+/**
+**  @brief  Takes the clock setup of the core as CLOCK_FAST and derives
+**          CLOCK_SLOW from it. Call after the core's init(), in CLOCK_FAST.
+**  @param  uint32_t busHz   I2C clock to keep, Wire's default is 100 kHz
+**/
+void Clock::begin(uint32_t busHz)
+{
+#if defined(__AVR__)
+    fast.mclkctrlb = CLKCTRL.MCLKCTRLB;
+ #if defined(CLOCK_MILLIS_TCB)
+    fast.ccmp = CLOCK_MILLIS_TCB.CCMP;
+ #else
+    fast.ccmp = 0;
+ #endif
+#else
+    fast.mclkctrlb = 0x01;                      // PDIV 2X, PEN
+    fast.ccmp = F_CPU / 1000 - 1;
+#endif
+    fast.mbaud = twiBaud(F_CPU, busHz);
+
+    uint8_t division = divisor(fast.mclkctrlb);
+    slow.mclkctrlb = division ? prescaler(division * CLOCK_SLOW_DIV) : 0xFF;
+    slow.mbaud = twiBaud(F_CPU / CLOCK_SLOW_DIV, busHz);
+    slow.ccmp = fast.ccmp ? (fast.ccmp + 1) / CLOCK_SLOW_DIV - 1 : 0;
+    scalable = slow.mclkctrlb != 0xFF;
+    current = CLOCK_FAST;
+}
+
+/**
+**  @brief  Switches the prescaler and what runs from it; a no-op before
+**          begin() or without a prescaler setting CLOCK_SLOW_DIV below
+**  @param  uint8_t phase   CLOCK_FAST or CLOCK_SLOW
+**/
+void Clock::set(uint8_t phase)
+{
+    if (phase == current || !scalable)
+        return;
+    uint32_t now = micros();
+    if (current == CLOCK_SLOW)
+        slowMicros += now - since;
+    since = now;
+    current = phase;
+    switches++;
+    apply(phase == CLOCK_SLOW ? slow : fast);
+}
+
+uint8_t Clock::phase()
+{
+    return current;
+}
+
+uint32_t Clock::hz()
+{
+    return current == CLOCK_SLOW ? F_CPU / CLOCK_SLOW_DIV : F_CPU;
+}
+
+/**
+**  @brief  delayMicroseconds() in real microseconds in either phase
+**/
+void Clock::delayMicros(uint16_t us)
+{
+#if defined(__AVR__)
+    delayMicroseconds(current == CLOCK_SLOW ? us / CLOCK_SLOW_DIV : us);
+#else
+    delayMicroseconds(us);                      // virtual time, no cycles to count
+#endif
+}
+
+uint8_t Clock::divisor(uint8_t mclkctrlb)
+{
+    if (!(mclkctrlb & 0x01))
+        return 1;
+    uint8_t code = mclkctrlb >> 1 & 0x0F;
+    return code < sizeof(DIVISIONS) ? DIVISIONS[code] : 0;
+}
+
+uint8_t Clock::prescaler(uint8_t division)
+{
+    if (division == 1)
+        return 0;
+    for (uint8_t code = 0; code < sizeof(DIVISIONS); code++)
+        if (DIVISIONS[code] == division)
+            return code << 1 | 0x01;
+    return 0xFF;
+}
+
+/**
+**  @brief  TWI0.MBAUD for any clock, with the t_rise megaTinyCore's Wire
+**          assumes: f_SCL = f_CPU / (10 + 2 * BAUD + f_CPU * t_rise).
+**          Rounded up, so f_SCL never exceeds busHz.
+**/
+uint8_t Clock::twiBaud(uint32_t cpuHz, uint32_t busHz)
+{
+    uint16_t riseNs = busHz <= 100000UL ? 1000 : busHz <= 400000UL ? 300 : 120;
+    int32_t cycles = (int32_t)((cpuHz + busHz - 1) / busHz) - (int32_t)(cpuHz / 1000 * riseNs / 1000000UL) - 10;
+    int32_t baud = (cycles + 1) / 2;
+    return baud < 0 ? 0 : baud > 255 ? 255 : (uint8_t)baud;
+}
+
+#if defined(__AVR__)
+
+void Clock::apply(const ClockConfig& config)
+{
+    uint8_t sreg = SREG;
+    cli();
+    _PROTECTED_WRITE(CLKCTRL.MCLKCTRLB, config.mclkctrlb);
+    TWI0.MBAUD = config.mbaud;
+ #if defined(CLOCK_MILLIS_TCB)
+    // same fraction of the millisecond, or a count past the new period
+    // would run to 0xFFFF first
+    uint32_t count = CLOCK_MILLIS_TCB.CNT;
+    CLOCK_MILLIS_TCB.CNT = count * (config.ccmp + 1) / (CLOCK_MILLIS_TCB.CCMP + 1);
+    CLOCK_MILLIS_TCB.CCMP = config.ccmp;
+ #endif
+    SREG = sreg;
+}
+
+#else
+
+//  host builds: what apply() would write, for the simulator
+ClockConfig clockApplied;
+
+void Clock::apply(const ClockConfig& config)
+{
+    clockApplied = config;
+}
+
+#endif /* __AVR__ */
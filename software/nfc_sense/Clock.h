@@ -0,0 +1,80 @@
+//  Main clock prescaler per wake phase
+//  -----------------------------------------
+//  Most of a wake cycle is waiting: I2C bytes at 100 kHz, the sensor's
+//  conversion, the tag's EEPROM, with the CPU spinning in Wire and
+//  delay(). Active current grows with the clock, so set(CLOCK_SLOW) runs
+//  those phases from F_CPU / CLOCK_SLOW_DIV and set(CLOCK_FAST) puts the
+//  core clock back for formatting, NDEF encoding and the panel rows.
+//
+//  A switch keeps what depends on CLK_PER:
+//   - TWI0.MBAUD is recomputed for the bus clock given to begin(); Wire
+//     computes it from F_CPU only. The slow clock must be at least ~10x
+//     the bus clock, beyond that the bus runs at what it gives.
+//   - the millis TCB gets a period of one millisecond at the new clock, so
+//     millis() and delay() keep counting milliseconds. micros() adds the
+//     timer count as if at F_CPU, within the millisecond it lags while slow.
+//   - delayMicroseconds() counts cycles and lasts CLOCK_SLOW_DIV times as
+//     long while slow; delayMicros() is the form that knows the phase.
+//  SPI settings are computed from F_CPU as well, so the panel is only
+//  driven in CLOCK_FAST.
+//
+//  Build with -DNFC_SENSE_CLOCK_SCALING; without it the sketch never
+//  switches and everything runs at F_CPU as before.
+
+#ifndef CLOCK_H_
+#define CLOCK_H_
+#if ARDUINO >= 100
+ #include "Arduino.h"
+#else
+ #include "WProgram.h"
+#endif
+
+#if !defined(F_CPU)
+ #define F_CPU 10000000UL       // host builds: 20 MHz oscillator / 2, the boards at 3 V
+#endif
+
+//phases
+#define CLOCK_FAST      0       // F_CPU
+#define CLOCK_SLOW      1       // F_CPU / CLOCK_SLOW_DIV
+
+#define CLOCK_SLOW_DIV  4       // 10 MHz -> 2.5 MHz, 25x a 100 kHz bus
+
+//  what set() writes
+struct ClockConfig
+{
+    uint8_t  mclkctrlb;         // CLKCTRL.MCLKCTRLB
+    uint8_t  mbaud;             // TWI0.MBAUD
+    uint16_t ccmp;              // millis TCB period
+};
+
+class Clock
+{
+public:
+    static void begin(uint32_t busHz);
+    static void set(uint8_t phase);
+    static uint8_t phase();
+    static uint32_t hz();
+    static void delayMicros(uint16_t us);
+
+    static uint8_t divisor(uint8_t mclkctrlb);          // 0 if not a prescaler setting
+    static uint8_t prescaler(uint8_t division);         // MCLKCTRLB, 0xFF if there is none
+    static uint8_t twiBaud(uint32_t cpuHz, uint32_t busHz);
+
+    static uint16_t switches;
+    static uint32_t slowMicros;     // time in CLOCK_SLOW since begin(), by micros()
+
+private:
+    static void apply(const ClockConfig& config);
+
+    static ClockConfig fast;
+    static ClockConfig slow;
+    static uint8_t current;
+    static bool scalable;           // begin() found a slow setting
+    static uint32_t since;          // micros() at the last switch
+};
+
+#if !defined(__AVR__)
+extern ClockConfig clockApplied;    // host builds: last apply()
+#endif
+
+#endif /* CLOCK_H_ */
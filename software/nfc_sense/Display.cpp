@@ -0,0 +1,115 @@
+#include "Display.h"
+#include "Epd.h"
+#include "Sensors.h"
+
+GlyphLine Display::value(DISPLAY_VALUE_X, DISPLAY_VALUE_Y, DISPLAY_VALUE_CELLS);
+Sparkline Display::trend(DISPLAY_TREND_X, DISPLAY_TREND_Y, DISPLAY_TREND_W, DISPLAY_TREND_H);
+uint32_t Display::rowsPainted = 0;
+
+/**
+**  @brief  Panel pins, see Epd::begin(); nothing is drawn until refresh()
+**/
+void Display::begin(uint8_t cs, uint8_t dc, uint8_t res, uint8_t busy)
+{
+    Epd::begin(cs, dc, res, busy);
+    value.invalidate();
+    trend.invalidate();
+}
+
+/**
+**  @brief  Reading as "21.5°C", marks the cells that change
+**/
+void Display::showCentiCelsius(int16_t centi)
+{
+    char text[DISPLAY_VALUE_CELLS + 2];
+    uint8_t n = formatCentiCelsius(text, centi);
+    text[n++] = GLYPH_DEGREE;
+    text[n++] = 'C';
+    text[n] = 0;
+    value.set(text);
+}
+
+void Display::record(int16_t centi)
+{
+    trend.add(centi);
+}
+
+//  grows the window [x0, x1) x [y0, y1) to cover another one
+static void cover(uint8_t& x0, uint8_t& x1, uint16_t& y0, uint16_t& y1,
+                  uint8_t x, uint8_t w, uint16_t y, uint16_t h)
+{
+    if (!w)
+        return;
+    if (x < x0)
+        x0 = x;
+    if (x + w > x1)
+        x1 = x + w;
+    if (y < y0)
+        y0 = y;
+    if (y + h > y1)
+        y1 = y + h;
+}
+
+/**
+**  @brief  Puts pending changes on the panel
+**  @retrun bool    false if the panel did not finish; the changes stay
+**                  pending for the next call
+**/
+bool Display::refresh()
+{
+    bool ok;
+    if (Epd::needsFull())
+    {
+        ok = Epd::update(0, 0, EPD_ROW_BYTES, EPD_HEIGHT, paintRow, EPD_REFRESH_FULL);
+    }
+    else
+    {
+        uint8_t x0 = EPD_ROW_BYTES, x1 = 0, x, w;
+        uint16_t y0 = EPD_HEIGHT, y1 = 0, y, h;
+        value.dirtyBytes(x, w);
+        cover(x0, x1, y0, y1, x, w, value.y(), value.rows());
+        trend.window(x, y, w, h);
+        cover(x0, x1, y0, y1, x, w, y, h);
+        if (x1 <= x0)
+            return true;
+        ok = Epd::update(x0, y0, x1 - x0, y1 - y0, paintRow, EPD_REFRESH_PARTIAL);
+    }
+    if (ok)
+    {
+        value.clean();
+        trend.clean();
+    }
+    return ok;
+}
+
+/**
+**  @brief  Panel pins low, the supply is about to go off
+**/
+void Display::powerDown()
+{
+    Epd::powerOff();
+}
+
+/**
+**  @brief  Controller RAM back from the widgets after the supply came on
+**  @retrun bool    false if changes were pending (the widgets no longer
+**                  draw the panel) or the panel did not answer; the next
+**                  refresh() is then a full one
+**/
+bool Display::restore()
+{
+    if (value.dirty() || trend.dirty())
+        return false;
+    return Epd::restore(paintRow);
+}
+
+/**
+**  @brief  Row source for Epd::update(): white, then the line's part
+**/
+void Display::paintRow(uint16_t y, uint8_t x, uint8_t w, uint8_t* row)
+{
+    memset(row, 0xFF, w);
+    value.paint(y, x, w, row);
+    trend.paint(y, x, w, row);
+    rowsPainted++;
+}
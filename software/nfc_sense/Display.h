@@ -0,0 +1,57 @@
+//  What the pocket knife display shows
+//  -----------------------------------------
+//  The reading as one GlyphLine ("-12.3°C", seven cells) in the middle of
+//  the 122 x 250 panel and the trend of the recent readings below it (a
+//  Sparkline, one column per reading), everything else white. The screen
+//  is never held in RAM: paintRow() computes any row from the widgets, and
+//  refresh() streams only what changed through Epd:
+//
+//   - partial refresh of the window around the dirty parts, e.g. the
+//     changed value cells and the trend's new column, in one refresh
+//   - the whole screen with a full refresh when Epd asks for one (first
+//     update, then every EPD_FULL_EVERY)
+//
+//  State in RAM is the widgets': the line's glyph indices and the trend's
+//  readings, each with its dirty range.
+//
+//  On a switched supply (Rail.h) powerDown() before the rail goes off and
+//  restore() after it came back, before the widgets change: while nothing
+//  is pending the widgets still draw what the panel shows, and that goes
+//  back into the controller RAM so the next refresh stays partial.
+
+#ifndef DISPLAY_H_
+#define DISPLAY_H_
+#if ARDUINO >= 100
+ #include "Arduino.h"
+#else
+ #include "WProgram.h"
+#endif
+#include "GlyphLine.h"
+#include "Sparkline.h"
+
+#define DISPLAY_VALUE_X         1       // bytes, 112 pixels from x = 8
+#define DISPLAY_VALUE_Y         109
+#define DISPLAY_VALUE_CELLS     7
+#define DISPLAY_TREND_X         3       // bytes, labels in 0..2
+#define DISPLAY_TREND_Y         156
+#define DISPLAY_TREND_W         12      // bytes, 96 readings less the gap
+#define DISPLAY_TREND_H         64
+
+class Display
+{
+public:
+    static void begin(uint8_t cs, uint8_t dc, uint8_t res, uint8_t busy);
+    static void showCentiCelsius(int16_t centi);
+    static void record(int16_t centi);  // next trend column
+    static bool refresh();
+    static void powerDown();
+    static bool restore();
+
+    static void paintRow(uint16_t y, uint8_t x, uint8_t w, uint8_t* row);
+
+    static GlyphLine value;
+    static Sparkline trend;
+    static uint32_t rowsPainted;    // row source calls, each computes w bytes
+};
+
+#endif /* DISPLAY_H_ */
@@ -0,0 +1,247 @@
+#include "Epd.h"
+#include <SPI.h>
+#include "Standby.h"
+
+uint16_t Epd::partialRefreshes = 0;
+uint16_t Epd::fullRefreshes = 0;
+uint32_t Epd::spiBytes = 0;
+uint8_t Epd::csPin = 0;
+uint8_t Epd::dcPin = 0;
+uint8_t Epd::resPin = 0;
+uint8_t Epd::busyPin = 0;
+bool Epd::awake = false;
+bool Epd::cleared = false;
+bool Epd::ramValid = true;
+uint8_t Epd::partials = 0;
+
+/**
+**  @brief  Takes the panel pins; the controller stays in reset until the
+**          first update()
+**  @param  uint8_t cs      chip select, active low
+**  @param  uint8_t dc      data/command, low for a command byte
+**  @param  uint8_t res     reset, active low
+**  @param  uint8_t busy    high while the controller works
+**/
+void Epd::begin(uint8_t cs, uint8_t dc, uint8_t res, uint8_t busy)
+{
+    csPin = cs;
+    dcPin = dc;
+    resPin = res;
+    busyPin = busy;
+    digitalWrite(csPin, HIGH);
+    pinMode(csPin, OUTPUT);
+    pinMode(dcPin, OUTPUT);
+    pinMode(resPin, OUTPUT);
+    pinMode(busyPin, INPUT);
+    awake = false;
+    cleared = false;
+    ramValid = true;
+    partials = 0;
+}
+
+bool Epd::needsFull()
+{
+    return !cleared || !ramValid || partials >= EPD_FULL_EVERY;
+}
+
+void Epd::onBusy()
+{
+}
+
+/**
+**  @brief  Before the supply is switched off: every panel pin low, the
+**          controller and its RAM are gone. RES low holds it in reset once
+**          the supply returns.
+**/
+void Epd::powerOff()
+{
+    if (awake)
+    {
+        SPI.endTransaction();
+        SPI.end();
+        awake = false;
+    }
+    digitalWrite(csPin, LOW);
+    digitalWrite(dcPin, LOW);
+    digitalWrite(resPin, LOW);
+    ramValid = false;
+}
+
+/**
+**  @brief  After the supply came back: the whole screen into both RAMs,
+**          from the source of what the panel shows, without a refresh
+**  @retrun bool    false if there was nothing to restore (no full refresh
+**                  since begin()) or the controller did not come up; the
+**                  next update is then a full refresh
+**/
+bool Epd::restore(EpdRowSource source)
+{
+    if (ramValid)
+        return true;
+    if (!cleared)
+        return false;
+    digitalWrite(csPin, HIGH);
+    if (!wake())
+        return false;
+    writeRam(EPD_CMD_WRITE_BW, 0, 0, EPD_ROW_BYTES, EPD_HEIGHT, source);
+    writeRam(EPD_CMD_WRITE_PREVIOUS, 0, 0, EPD_ROW_BYTES, EPD_HEIGHT, source);
+    ramValid = true;
+    sleep();
+    return true;
+}
+
+/**
+**  @brief  Out of deep sleep (or reset) into a configured controller: RES
+**          pulse, then driver output, data entry, border, temperature sensor
+**  @retrun bool    false if BUSY did not drop after the reset
+**/
+bool Epd::wake()
+{
+    if (awake)
+        return true;
+    digitalWrite(csPin, HIGH);
+    digitalWrite(resPin, LOW);
+    delay(EPD_RESET_MS);
+    digitalWrite(resPin, HIGH);
+    SPI.begin();
+    SPI.beginTransaction(SPISettings(EPD_SPI_HZ, MSBFIRST, SPI_MODE0));
+    awake = true;
+    if (!waitBusy(EPD_BUSY_TIMEOUT_MS))
+    {
+        sleep();
+        return false;
+    }
+
+    const uint8_t output[] = { (EPD_HEIGHT - 1) & 0xFF, (EPD_HEIGHT - 1) >> 8, 0x00 };
+    const uint8_t entry = EPD_DATA_ENTRY_XY_INC;
+    const uint8_t border = 0x05;                // follows the white LUT
+    const uint8_t sensor = 0x80;                // internal temperature sensor
+    command(EPD_CMD_DRIVER_OUTPUT, output, sizeof(output));
+    command(EPD_CMD_DATA_ENTRY, &entry, 1);
+    command(EPD_CMD_BORDER, &border, 1);
+    command(EPD_CMD_TEMP_SENSOR, &sensor, 1);
+    return true;
+}
+
+/**
+**  @brief  Deep sleep mode 1: booster already off, RAM kept, only a RES
+**          pulse wakes the controller. The SPI peripheral is released.
+**/
+void Epd::sleep()
+{
+    if (!awake)
+        return;
+    const uint8_t mode = EPD_DEEP_SLEEP_KEEP_RAM;
+    command(EPD_CMD_DEEP_SLEEP, &mode, 1);
+    SPI.endTransaction();
+    SPI.end();
+    awake = false;
+}
+
+/**
+**  @brief  One command byte and its parameters in one CS frame
+**/
+void Epd::command(uint8_t cmd, const uint8_t* data, uint8_t len)
+{
+    digitalWrite(dcPin, LOW);
+    digitalWrite(csPin, LOW);
+    SPI.transfer(cmd);
+    digitalWrite(dcPin, HIGH);
+    for (uint8_t i = 0; i < len; i++)
+        SPI.transfer(data[i]);
+    digitalWrite(csPin, HIGH);
+    spiBytes += 1 + len;
+}
+
+/**
+**  @brief  Streams a window into one of the RAMs, row by row from source
+**  @param  uint8_t cmd     EPD_CMD_WRITE_BW or EPD_CMD_WRITE_PREVIOUS
+**/
+void Epd::writeRam(uint8_t cmd, uint8_t x, uint16_t y, uint8_t w, uint16_t h, EpdRowSource source)
+{
+    const uint8_t xRange[] = { x, (uint8_t)(x + w - 1) };
+    const uint8_t yRange[] = { (uint8_t)(y & 0xFF), (uint8_t)(y >> 8),
+                               (uint8_t)((y + h - 1) & 0xFF), (uint8_t)((y + h - 1) >> 8) };
+    command(EPD_CMD_RAM_X_RANGE, xRange, sizeof(xRange));
+    command(EPD_CMD_RAM_Y_RANGE, yRange, sizeof(yRange));
+    command(EPD_CMD_RAM_X_COUNTER, xRange, 1);
+    command(EPD_CMD_RAM_Y_COUNTER, yRange, 2);
+
+    uint8_t row[EPD_ROW_BYTES];
+    digitalWrite(dcPin, LOW);
+    digitalWrite(csPin, LOW);
+    SPI.transfer(cmd);
+    digitalWrite(dcPin, HIGH);
+    for (uint16_t r = 0; r < h; r++)
+    {
+        source(y + r, x, w, row);
+        for (uint8_t i = 0; i < w; i++)
+            SPI.transfer(row[i]);
+    }
+    digitalWrite(csPin, HIGH);
+    spiBytes += 1 + (uint32_t)w * h;
+}
+
+/**
+**  @brief  Shows a window: new image, refresh, reference image, deep sleep
+**  @param  uint8_t     x       first column in bytes (8 pixels)
+**  @param  uint16_t    y       first row
+**  @param  uint8_t     w       width in bytes
+**  @param  uint16_t    h       height in rows
+**  @param  EpdRowSource source called twice per row, must return the same
+**  @param  uint8_t     mode    EPD_REFRESH_PARTIAL or EPD_REFRESH_FULL;
+**                              partial is upgraded when needsFull()
+**  @retrun bool        false if the window is off the panel or the
+**                      controller did not finish in time
+**/
+bool Epd::update(uint8_t x, uint16_t y, uint8_t w, uint16_t h, EpdRowSource source, uint8_t mode)
+{
+    if (!w || !h || x + w > EPD_ROW_BYTES || y + h > EPD_HEIGHT)
+        return false;
+    if (!wake())
+        return false;
+    if (needsFull())
+        mode = EPD_REFRESH_FULL;
+
+    writeRam(EPD_CMD_WRITE_BW, x, y, w, h, source);
+    const uint8_t sequence = mode == EPD_REFRESH_FULL ? EPD_SEQ_FULL : EPD_SEQ_PARTIAL;
+    command(EPD_CMD_UPDATE_CTRL2, &sequence, 1);
+    command(EPD_CMD_ACTIVATE, 0, 0);
+    bool ok = waitBusy(EPD_BUSY_TIMEOUT_MS);
+    if (ok)
+    {
+        writeRam(EPD_CMD_WRITE_PREVIOUS, x, y, w, h, source);
+        if (mode == EPD_REFRESH_FULL)
+        {
+            fullRefreshes++;
+            cleared = true;
+            if (w == EPD_ROW_BYTES && h == EPD_HEIGHT)
+                ramValid = true;
+            partials = 0;
+        }
+        else
+        {
+            partialRefreshes++;
+            partials++;
+        }
+    }
+    sleep();
+    return ok;
+}
+
+bool Epd::idle()
+{
+    return digitalRead(busyPin) == LOW;
+}
+
+/**
+**  @brief  Standby until BUSY drops, the pin change wakes the CPU
+**  @retrun bool    false on timeout
+**/
+bool Epd::waitBusy(uint16_t timeoutMs)
+{
+    attachInterrupt(digitalPinToInterrupt(busyPin), onBusy, CHANGE);
+    bool ok = Standby::until(idle, timeoutMs);
+    detachInterrupt(digitalPinToInterrupt(busyPin));
+    return ok;
+}
@@ -0,0 +1,108 @@
+//  E-paper panel on the pocket knife display board
+//  -----------------------------------------
+//  SSD1680 controller, 122 x 250 panel on the 20-pin connector (the
+//  GDR/RESE/PREVGH/PREVGL booster is the SSD1680 reference circuit),
+//  4-wire SPI on SPI0's default pins plus CS, D/C, RES and BUSY.
+//
+//  There is no framebuffer: update() takes a window and a row source and
+//  streams the rows into the controller RAM, so a caller only recomputes
+//  the rows that changed. The controller keeps two images: the new one
+//  (0x24) and the one the panel shows (0x26). A partial refresh (display
+//  mode 2) only drives the pixels that differ between them, so a new
+//  reading costs one partial refresh of its window and no full-screen
+//  flash. After the refresh the window goes to 0x26 as well, from the same
+//  source, so the next partial starts from what is on the panel.
+//
+//  A full refresh (display mode 1) clears ghosting: the first update after
+//  begin() and every EPD_FULL_EVERY partial ones are upgraded to it. Its
+//  caller must have drawn the whole screen once since begin(), the RAM of
+//  a cold controller holds noise.
+//
+//  Between updates the panel is powered down: the update sequence switches
+//  the booster and oscillator off, then the controller goes to deep sleep
+//  mode 1 (RAM kept, woken by a RES pulse). While the refresh runs the MCU
+//  sleeps in standby and wakes on the BUSY edge (Standby.h); the wait is
+//  bounded at EPD_BUSY_TIMEOUT_MS. millis() does not advance meanwhile.
+//
+//  On a gated supply (Rail.h) powerOff() parks the pins low, so nothing
+//  feeds the unpowered controller through its inputs, and forgets the
+//  RAM. The panel keeps its image; restore() writes it back into both RAMs
+//  after power-up, which lets partial refreshes continue without a full one.
+
+#ifndef EPD_H_
+#define EPD_H_
+#if ARDUINO >= 100
+ #include "Arduino.h"
+#else
+ #include "WProgram.h"
+#endif
+
+#define EPD_WIDTH               122     // source lines, x
+#define EPD_HEIGHT              250     // gate lines, y
+#define EPD_ROW_BYTES           ((EPD_WIDTH + 7) / 8)
+#define EPD_SPI_HZ              4000000UL
+#define EPD_RESET_MS            2
+#define EPD_POWER_UP_MS         10      // supply on to the first RES pulse
+#define EPD_BUSY_TIMEOUT_MS     5000    // full refresh is ~3 s
+#define EPD_FULL_EVERY          64      // partial refreshes between full ones
+
+//update() modes
+#define EPD_REFRESH_PARTIAL     0
+#define EPD_REFRESH_FULL        1
+
+//SSD1680 commands
+#define EPD_CMD_DRIVER_OUTPUT   0x01
+#define EPD_CMD_DEEP_SLEEP      0x10
+#define EPD_CMD_DATA_ENTRY      0x11
+#define EPD_CMD_SW_RESET        0x12
+#define EPD_CMD_TEMP_SENSOR     0x18
+#define EPD_CMD_ACTIVATE        0x20
+#define EPD_CMD_UPDATE_CTRL2    0x22
+#define EPD_CMD_WRITE_BW        0x24    // new image
+#define EPD_CMD_WRITE_PREVIOUS  0x26    // image on the panel, partial refresh reference
+#define EPD_CMD_BORDER          0x3C
+#define EPD_CMD_RAM_X_RANGE     0x44
+#define EPD_CMD_RAM_Y_RANGE     0x45
+#define EPD_CMD_RAM_X_COUNTER   0x4E
+#define EPD_CMD_RAM_Y_COUNTER   0x4F
+
+//UPDATE_CTRL2 sequences, both end with booster and oscillator off
+#define EPD_SEQ_FULL            0xF7    // clock, analog, temperature, LUT mode 1, display, off
+#define EPD_SEQ_PARTIAL         0xFF    // same with display mode 2
+#define EPD_DATA_ENTRY_XY_INC   0x03    // x then y, both incrementing
+#define EPD_DEEP_SLEEP_KEEP_RAM 0x01
+
+//  fills one row of the window: w bytes, MSB is the leftmost pixel, 1 = white
+typedef void (*EpdRowSource)(uint16_t y, uint8_t x, uint8_t w, uint8_t* row);
+
+class Epd
+{
+public:
+    static void begin(uint8_t cs, uint8_t dc, uint8_t res, uint8_t busy);
+    static bool update(uint8_t x, uint16_t y, uint8_t w, uint16_t h, EpdRowSource source, uint8_t mode);
+    static void sleep();
+    static bool needsFull();        // next update will be a full refresh
+    static void powerOff();
+    static bool restore(EpdRowSource source);
+
+    static void onBusy();           // BUSY pin change
+
+    static uint16_t partialRefreshes;
+    static uint16_t fullRefreshes;
+    static uint32_t spiBytes;
+
+private:
+    static bool wake();
+    static void command(uint8_t cmd, const uint8_t* data, uint8_t len);
+    static void writeRam(uint8_t cmd, uint8_t x, uint16_t y, uint8_t w, uint16_t h, EpdRowSource source);
+    static bool waitBusy(uint16_t timeoutMs);
+    static bool idle();
+
+    static uint8_t csPin, dcPin, resPin, busyPin;
+    static bool awake;
+    static bool cleared;            // full refresh done since begin()
+    static bool ramValid;           // both RAMs hold the panel image, false after powerOff()
+    static uint8_t partials;        // since the last full refresh
+};
+
+#endif /* EPD_H_ */
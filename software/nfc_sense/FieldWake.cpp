@@ -0,0 +1,163 @@
+#include "FieldWake.h"
+#if defined(__AVR__)
+ #include <avr/interrupt.h>
+ #include <avr/sleep.h>
+#endif
+
+uint32_t FieldWake::wakes = 0;
+uint8_t FieldWake::pin = 0;
+uint8_t FieldWake::alertPin = 0xFF;
+bool FieldWake::fieldPresent = false;
+bool FieldWake::alertState = false;
+volatile bool FieldWake::edge = false;
+volatile bool FieldWake::alertEdge = false;
+volatile uint8_t FieldWake::ticks = 0;
+uint8_t FieldWake::refreshTicks = FIELD_WAKE_REFRESH_TICKS;
+
+/**
+**  @brief  ED as pulled-up input sensed on both edges, RTC PIT for the
+**          background refresh. The tag side (ED event) is set in setupNFC().
+**          Board::init() leaves the pin with its input buffer off and
+**          pinMode() does not touch the sense mode, so the level is only
+**          read once the interrupt has turned the buffer on.
+**  @param  uint8_t edPin   Arduino pin wired to the NTAG 5 ED output
+**/
+void FieldWake::begin(uint8_t edPin)
+{
+    pin = edPin;
+    pinMode(pin, INPUT_PULLUP);
+    attachInterrupt(digitalPinToInterrupt(pin), onEdge, CHANGE);
+    fieldPresent = digitalRead(pin) == LOW;     // the cycle that just ran covered it
+
+#if defined(__AVR__) && FIELD_WAKE_REFRESH_TICKS
+    while (RTC.PITSTATUS & RTC_CTRLBUSY_bm)
+        ;
+    RTC.CLKSEL = RTC_CLKSEL_INT1K_gc;
+    RTC.PITINTCTRL = RTC_PI_bm;
+    RTC.PITCTRLA = RTC_PERIOD_CYC32768_gc | RTC_PITEN_bm;
+#endif
+}
+
+/**
+**  @brief  Sensor ALERT (open drain, low while active) as a second wake
+**          source, sensed on both edges. The pull-up is external (Board.h);
+**          the MCU's would draw ~85 uA for as long as an alarm lasts. The
+**          level is read once the interrupt has turned the buffer on.
+**/
+void FieldWake::watchAlert(uint8_t alert)
+{
+    alertPin = alert;
+    pinMode(alertPin, INPUT);
+    alertEdge = false;
+    attachInterrupt(digitalPinToInterrupt(alertPin), onAlert, CHANGE);
+    alertState = digitalRead(alertPin) == LOW;
+}
+
+/**
+**  @brief  Background refresh interval in PIT ticks. Only takes effect
+**          with the PIT running, i.e. FIELD_WAKE_REFRESH_TICKS non-zero.
+**/
+void FieldWake::setRefreshTicks(uint8_t refresh)
+{
+    refreshTicks = refresh;
+}
+
+bool FieldWake::alertActive()
+{
+    return alertState;
+}
+
+void FieldWake::onEdge()
+{
+    edge = true;
+}
+
+void FieldWake::onAlert()
+{
+    alertEdge = true;
+}
+
+void FieldWake::onTick()
+{
+    if (ticks < 0xFF)
+        ticks++;
+}
+
+/**
+**  @brief  Consumes pending events. A falling ED edge that finds the field
+**          present or a change of the alert state starts a cycle, anything
+**          else only updates the state.
+**  @retrun uint8_t FIELD_WAKE_NONE, FIELD_WAKE_FIELD, FIELD_WAKE_ALERT or
+**                  FIELD_WAKE_REFRESH
+**/
+uint8_t FieldWake::poll()
+{
+    bool alerted = false;
+    if (alertEdge)
+    {
+        alertEdge = false;
+        bool active = digitalRead(alertPin) == LOW;
+        alerted = active != alertState;
+        alertState = active;
+    }
+    if (edge)
+    {
+        edge = false;
+        bool present = digitalRead(pin) == LOW;
+        bool arrived = present && !fieldPresent;
+        fieldPresent = present;
+        if (arrived)
+        {
+            ticks = 0;
+            return FIELD_WAKE_FIELD;
+        }
+    }
+    if (alerted)
+    {
+        ticks = 0;
+        return FIELD_WAKE_ALERT;
+    }
+    if (refreshTicks && ticks >= refreshTicks)
+    {
+        ticks = 0;
+        return FIELD_WAKE_REFRESH;
+    }
+    return FIELD_WAKE_NONE;
+}
+
+#if defined(__AVR__)
+
+/**
+**  @brief  Power-down until poll() has something. Events are checked with
+**          interrupts off and sei; sleep back to back, so an edge arriving
+**          in between still wakes the sleep instead of being lost.
+**/
+uint8_t FieldWake::sleep()
+{
+    set_sleep_mode(SLEEP_MODE_PWR_DOWN);
+    for (;;)
+    {
+        cli();
+        uint8_t reason = poll();
+        if (reason != FIELD_WAKE_NONE)
+        {
+            sei();
+            return reason;
+        }
+        sleep_enable();
+        sei();
+        sleep_cpu();
+        sleep_disable();
+        wakes++;
+    }
+}
+
+#if FIELD_WAKE_REFRESH_TICKS
+ISR(RTC_PIT_vect)
+{
+    RTC.PITINTFLAGS = RTC_PI_bm;
+    FieldWake::onTick();
+}
+#endif
+
+#endif /* __AVR__ */
@@ -0,0 +1,79 @@
+//  Field-detect wake for the NTAG boards
+//  -----------------------------------------
+//  Instead of waking on a fixed interval to re-read the sensor, the MCU
+//  stays in power-down until the NTAG 5 ED pin reports a reader field
+//  (NTAG5_ED_NFC_FIELD, open drain, low while the field is present). One
+//  wake cycle then puts a fresh reading on the tag while the phone is
+//  still there; the phone gets the previous value if it reads before that.
+//
+//  ED is sensed on both edges (the sense mode that works in power-down on
+//  every pin); the falling one starts a cycle, the rising one (field gone)
+//  only goes back to sleep. A phone held on the tag gives one cycle.
+//
+//  Optionally the RTC PIT wakes the MCU every FIELD_WAKE_TICK_S seconds and
+//  every FIELD_WAKE_REFRESH_TICKS ticks a cycle refreshes the published
+//  value, so it is never older than that when the field arrives. A field
+//  cycle restarts the interval. setRefreshTicks() changes the interval at
+//  run time, e.g. stretched while the cell is low (Supply.h). The PIT's event outputs drive the status
+//  LED (Indicator.h) as well; both keep the RTC on the 1.024 kHz ULP.
+//
+//  With NFC_SENSE_ALERT_WAKE the sensor watches the temperature instead
+//  (armAlert() in Sensors.h): watchAlert() senses its ALERT pin on both
+//  edges like ED, and a change of the alert state starts a cycle, so a
+//  limit crossing reaches the tag within the sensor's conversion period.
+//  The background refresh is off then; without a field or a crossing the
+//  MCU does not wake at all. The sensor converting at its slowest rate
+//  still draws more than it does shut down between refreshes, so this
+//  trades charge for lag (host_sim alertwake); ALERT needs a wire and an
+//  external pull-up (Board.h).
+
+#ifndef FIELD_WAKE_H_
+#define FIELD_WAKE_H_
+#if ARDUINO >= 100
+ #include "Arduino.h"
+#else
+ #include "WProgram.h"
+#endif
+
+#define FIELD_WAKE_TICK_S           32      // RTC PIT period, 32768 cycles of the 1.024 kHz ULP
+#if defined(NFC_SENSE_ALERT_WAKE)
+ #define FIELD_WAKE_REFRESH_TICKS   0       // the sensor's ALERT replaces the refresh
+#else
+ #define FIELD_WAKE_REFRESH_TICKS   28      // ~15 min background refresh, 0 = field only
+#endif
+#define FIELD_WAKE_PUBLISH_MS       100     // field to fresh reading on the tag, design target
+
+//sleep() results
+#define FIELD_WAKE_NONE         0
+#define FIELD_WAKE_FIELD        1   // reader field appeared
+#define FIELD_WAKE_REFRESH      2   // background interval elapsed
+#define FIELD_WAKE_ALERT        3   // sensor ALERT became active or inactive
+
+class FieldWake
+{
+public:
+    static void begin(uint8_t edPin);
+    static void watchAlert(uint8_t alertPin);
+    static bool alertActive();  // as of the last poll()
+    static uint8_t sleep();     // power-down until a cycle is due
+    static uint8_t poll();      // pending events, FIELD_WAKE_NONE if nothing is due
+    static void setRefreshTicks(uint8_t ticks);     // 0 = field only
+
+    static void onEdge();       // ED pin change
+    static void onAlert();      // ALERT pin change
+    static void onTick();       // RTC PIT
+
+    static uint32_t wakes;      // CPU wake-ups, ignored ones included
+
+private:
+    static uint8_t pin;
+    static uint8_t alertPin;    // 0xFF until watchAlert()
+    static bool fieldPresent;
+    static bool alertState;
+    static volatile bool edge;
+    static volatile bool alertEdge;
+    static volatile uint8_t ticks;
+    static uint8_t refreshTicks;
+};
+
+#endif /* FIELD_WAKE_H_ */
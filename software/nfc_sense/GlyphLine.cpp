@@ -0,0 +1,147 @@
+#include "GlyphLine.h"
+
+static const char GLYPH_CHARS[] = " 0123456789-.\xB0" "CF%";
+
+static const uint8_t GLYPHS[][GLYPH_HEIGHT] = {
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },  // ' '
+    { 0x00, 0x00, 0x3C, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x3C, 0x00, 0x00 },  // '0'
+    { 0x00, 0x00, 0x18, 0x38, 0x78, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x7E, 0x00, 0x00 },  // '1'
+    { 0x00, 0x00, 0x3C, 0x66, 0x06, 0x06, 0x0C, 0x18, 0x30, 0x60, 0x60, 0x60, 0x60, 0x7E, 0x00, 0x00 },  // '2'
+    { 0x00, 0x00, 0x3C, 0x66, 0x06, 0x06, 0x06, 0x1E, 0x06, 0x06, 0x06, 0x06, 0x66, 0x3C, 0x00, 0x00 },  // '3'
+    { 0x00, 0x00, 0x0C, 0x1C, 0x3C, 0x6C, 0x6C, 0xCC, 0xFE, 0x0C, 0x0C, 0x0C, 0x0C, 0x0C, 0x00, 0x00 },  // '4'
+    { 0x00, 0x00, 0x7E, 0x60, 0x60, 0x60, 0x7C, 0x06, 0x06, 0x06, 0x06, 0x06, 0x66, 0x3C, 0x00, 0x00 },  // '5'
+    { 0x00, 0x00, 0x3C, 0x66, 0x60, 0x60, 0x7C, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x3C, 0x00, 0x00 },  // '6'
+    { 0x00, 0x00, 0x7E, 0x06, 0x06, 0x0C, 0x0C, 0x18, 0x18, 0x30, 0x30, 0x30, 0x30, 0x30, 0x00, 0x00 },  // '7'
+    { 0x00, 0x00, 0x3C, 0x66, 0x66, 0x66, 0x66, 0x3C, 0x66, 0x66, 0x66, 0x66, 0x66, 0x3C, 0x00, 0x00 },  // '8'
+    { 0x00, 0x00, 0x3C, 0x66, 0x66, 0x66, 0x66, 0x66, 0x3E, 0x06, 0x06, 0x06, 0x66, 0x3C, 0x00, 0x00 },  // '9'
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x7E, 0x7E, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },  // '-'
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x18, 0x18, 0x00, 0x00 },  // '.'
+    { 0x00, 0x00, 0x38, 0x6C, 0x6C, 0x38, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },  // degree
+    { 0x00, 0x00, 0x3C, 0x66, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x66, 0x3C, 0x00, 0x00 },  // 'C'
+    { 0x00, 0x00, 0x7E, 0x60, 0x60, 0x60, 0x60, 0x7C, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x00, 0x00 },  // 'F'
+    { 0x00, 0x00, 0x62, 0x66, 0x06, 0x0C, 0x0C, 0x18, 0x18, 0x30, 0x30, 0x60, 0x66, 0x46, 0x00, 0x00 },  // '%'
+};
+
+//  a nibble with every pixel doubled
+static const uint8_t DOUBLED[16] = {
+    0x00, 0x03, 0x0C, 0x0F, 0x30, 0x33, 0x3C, 0x3F,
+    0xC0, 0xC3, 0xCC, 0xCF, 0xF0, 0xF3, 0xFC, 0xFF,
+};
+
+/**
+**  @brief  A line of cells, blank and dirty until the first flush
+**  @param  uint8_t     x       first RAM column in bytes
+**  @param  uint16_t    y       first row
+**  @param  uint8_t     cells   up to GLYPH_LINE_MAX_CELLS
+**  @param  uint8_t     scale   1 (8 x 16 cells) or 2 (16 x 32)
+**/
+GlyphLine::GlyphLine(uint8_t x, uint16_t y, uint8_t cells, uint8_t scale)
+    : _x(x), _y(y), _cells(cells > GLYPH_LINE_MAX_CELLS ? GLYPH_LINE_MAX_CELLS : cells),
+      _scale(scale == 1 ? 1 : 2)
+{
+    memset(_glyphs, 0, sizeof(_glyphs));
+    invalidate();
+}
+
+//  font index, unknown characters are blank
+static uint8_t glyphIndex(char c)
+{
+    const char* at = c ? strchr(GLYPH_CHARS, c) : 0;
+    return at ? at - GLYPH_CHARS : 0;
+}
+
+uint8_t GlyphLine::glyphRow(char c, uint8_t row)
+{
+    return GLYPHS[glyphIndex(c)][row];
+}
+
+/**
+**  @brief  New text, right-aligned; cells whose glyph changed are added
+**          to the dirty range. Longer text keeps its right end.
+**/
+void GlyphLine::set(const char* text)
+{
+    uint8_t next[GLYPH_LINE_MAX_CELLS];
+    uint8_t n = 0;
+    for (const char* c = text; *c; c++)
+        if (*c != '\xC2')
+            n++;
+    uint8_t skip = n > _cells ? n - _cells : 0;
+    uint8_t i = 0;
+    for (; i < _cells - (n - skip); i++)
+        next[i] = 0;
+    for (const char* c = text; *c; c++)
+    {
+        if (*c == '\xC2')
+            continue;
+        if (skip)
+            skip--;
+        else
+            next[i++] = glyphIndex(*c);
+    }
+
+    for (i = 0; i < _cells; i++)
+    {
+        if (next[i] == _glyphs[i])
+            continue;
+        _glyphs[i] = next[i];
+        if (_first >= _last)
+        {
+            _first = i;
+            _last = i + 1;
+        }
+        else
+        {
+            if (i < _first)
+                _first = i;
+            if (i + 1 > _last)
+                _last = i + 1;
+        }
+    }
+}
+
+void GlyphLine::invalidate()
+{
+    _first = 0;
+    _last = _cells;
+}
+
+void GlyphLine::clean()
+{
+    _first = _last = 0;
+}
+
+/**
+**  @brief  RAM columns covering the dirty cells
+**  @param  uint8_t&    x   first column in bytes
+**  @param  uint8_t&    w   width in bytes, 0 when nothing changed
+**/
+void GlyphLine::dirtyBytes(uint8_t& x, uint8_t& w) const
+{
+    x = _x + _first * cellBytes();
+    w = dirty() ? (_last - _first) * cellBytes() : 0;
+}
+
+/**
+**  @brief  The line's part of one panel row, other bytes are left alone
+**  @param  uint16_t    y       panel row
+**  @param  uint8_t     x       first RAM column of row[]
+**  @param  uint8_t     w       bytes in row[]
+**  @param  uint8_t*    row     1 = white, as the panel RAM
+**/
+void GlyphLine::paint(uint16_t y, uint8_t x, uint8_t w, uint8_t* row) const
+{
+    if (y < _y || y >= _y + rows())
+        return;
+    uint8_t fontRow = (y - _y) / _scale;
+    uint8_t end = _x + bytes();
+    for (uint8_t col = x < _x ? _x : x; col < x + w && col < end; col++)
+    {
+        uint8_t offset = col - _x;
+        uint8_t bits = GLYPHS[_glyphs[offset / cellBytes()]][fontRow];
+        if (_scale == 1)
+            row[col - x] = ~bits;
+        else
+            row[col - x] = ~DOUBLED[offset % 2 ? bits & 0x0F : bits >> 4];
+    }
+}
@@ -0,0 +1,61 @@
+//  One line of large glyphs on the e-paper panel, drawn without a framebuffer
+//  -----------------------------------------
+//  The font covers what a reading needs: digits, minus, decimal point,
+//  degree sign and the units C, F and %. Each glyph is 8 x 16 pixels in
+//  flash (16 bytes; tinyAVR maps flash into the data space, so the const
+//  table is read in place) and drawn doubled into a 16 x 32 cell, two RAM
+//  bytes wide, or as it is (scale 1) for small text such as axis labels.
+//  paint() computes any row of the line on demand, which is what Epd's row
+//  source needs.
+//
+//  RAM per line: the font index of each cell and the range of cells that
+//  changed since the last flush, GLYPH_LINE_MAX_CELLS + 2 bytes. set() right-aligns
+//  the text, so the digits of a reading keep their cells and a new value
+//  usually dirties one or two of them.
+
+#ifndef GLYPH_LINE_H_
+#define GLYPH_LINE_H_
+#if ARDUINO >= 100
+ #include "Arduino.h"
+#else
+ #include "WProgram.h"
+#endif
+
+#define GLYPH_WIDTH             8       // font, pixels
+#define GLYPH_HEIGHT            16
+#define GLYPH_SCALE             2       // default, 1 or 2
+#define GLYPH_CELL_BYTES        (GLYPH_WIDTH * GLYPH_SCALE / 8)     // at the default scale
+#define GLYPH_CELL_ROWS         (GLYPH_HEIGHT * GLYPH_SCALE)
+#define GLYPH_LINE_MAX_CELLS    8
+#define GLYPH_DEGREE            '\xB0'  // Latin-1; set() folds the UTF-8 "\xC2\xB0" to it
+
+class GlyphLine
+{
+public:
+    GlyphLine(uint8_t x, uint16_t y, uint8_t cells, uint8_t scale = GLYPH_SCALE);
+
+    void set(const char* text);
+    void invalidate();                  // everything dirty, e.g. after a full refresh
+    bool dirty() const { return _first < _last; }
+    void dirtyBytes(uint8_t& x, uint8_t& w) const;
+    void clean();
+
+    void paint(uint16_t y, uint8_t x, uint8_t w, uint8_t* row) const;
+    uint8_t x() const { return _x; }
+    uint16_t y() const { return _y; }
+    uint8_t bytes() const { return _cells * cellBytes(); }
+    uint8_t cellBytes() const { return GLYPH_WIDTH * _scale / 8; }
+    uint8_t rows() const { return GLYPH_HEIGHT * _scale; }
+
+    static uint8_t glyphRow(char c, uint8_t row);   // font row, MSB left, 1 = ink
+
+private:
+    uint8_t  _x;                        // bytes
+    uint16_t _y;
+    uint8_t  _cells;
+    uint8_t  _scale;
+    uint8_t  _glyphs[GLYPH_LINE_MAX_CELLS];  // font index per cell, what the panel shows after a flush
+    uint8_t  _first, _last;             // dirty cells [first, last)
+};
+
+#endif /* GLYPH_LINE_H_ */
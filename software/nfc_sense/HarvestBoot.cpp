@@ -0,0 +1,45 @@
+#include "HarvestBoot.h"
+#include "Board.h"
+#include "Sensors.h"
+#include "Ntag5.h"
+#include <Wire.h>
+
+#if defined(__AVR__)
+ #if F_CPU == 5000000UL || F_CPU == 4000000UL
+  #define HARVEST_BOOT_MCLKCTRLB    (CLKCTRL_PDIV_4X_gc | CLKCTRL_PEN_bm)  // 20 or 16 MHz oscillator / 4
+ #else
+  #error "NFC_SENSE_HARVEST_BOOT: VOUT powered boards run at 5 MHz (or 4 MHz), select that clock"
+ #endif
+#endif
+
+bool HarvestBoot::published = false;
+int16_t HarvestBoot::value = 0;
+
+/**
+**  @brief  Reset to reading on the tag with nothing but the clock, the
+**          pins, the TWI, one conversion and the SRAM image
+**  @retrun bool    false if the sensor or the tag failed; the normal wake
+**                  cycle that follows tries again
+**/
+bool HarvestBoot::publish()
+{
+#if defined(__AVR__)
+    _PROTECTED_WRITE(CLKCTRL.MCLKCTRLB, HARVEST_BOOT_MCLKCTRLB);
+    Board::init();
+#endif
+    Wire.begin();
+    Wire.setClock(HARVEST_BOOT_I2C_HZ);
+
+    int16_t centi;
+    if (!(BoardThermometer::resume() || BoardThermometer::begin()) ||
+        !BoardThermometer::readPolled(centi, HARVEST_BOOT_POLL_US))
+        return false;
+
+    // same text as the sketch's wake cycle
+    char text[32] = "Temperature: ";
+    uint8_t n = 13 + formatCentiCelsius(text + 13, centi);
+    strcpy(text + n, " °C");
+    published = Ntag5::publishLive(text);
+    value = centi;
+    return published;
+}
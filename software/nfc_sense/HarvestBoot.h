@@ -0,0 +1,53 @@
+//  Boot-to-publish fast path for boards running from the reader field
+//  -----------------------------------------
+//  On an NTAG board supplied from the NTAG 5 energy harvesting output
+//  (VOUT), the MCU only runs while a phone holds the tag, and the phone
+//  reads within a few tens of milliseconds. publish() is called from
+//  megaTinyCore's onBeforeInit() hook, i.e. right after the C runtime
+//  start-up and before the core's init():
+//
+//   - clock: one protected write of the prescaler, nothing else. VOUT is
+//     1.8..2.4 V, which limits the tinyAVR to 5 MHz; harvest builds use the
+//     5 MHz (or 4 MHz) clock option and the prescaler here matches it.
+//   - pins: Board::init(), a handful of VPORT writes
+//   - TWI: Wire.begin() and the bus clock once, no I2cBus session (its
+//     budget runs on micros(), which is not running yet)
+//   - one conversion, polled with delayMicroseconds(); the BME280 reads
+//     its calibration first
+//   - the reading goes to the tag through the SRAM mirror, no EEPROM
+//     programming
+//
+//  Afterwards init() and setup() run as usual: the normal wake cycle writes
+//  the EEPROM fallback and the warm state while the reader already has the
+//  value, and the tasks after it only as the storage capacitor allows
+//  (Budget.h).
+//
+//  HARVEST_BOOT_BUDGET_CYCLES bounds reset to reading on the tag; the host
+//  simulator checks it at HARVEST_BOOT_CPU_HZ. Core start-up before
+//  onBeforeInit() (vector table, .data/.bss) is not included.
+//
+//  Enable with -DNFC_SENSE_HARVEST_BOOT on the NTAG boards.
+
+#ifndef HARVEST_BOOT_H_
+#define HARVEST_BOOT_H_
+#if ARDUINO >= 100
+ #include "Arduino.h"
+#else
+ #include "WProgram.h"
+#endif
+
+#define HARVEST_BOOT_CPU_HZ         5000000UL   // highest clock at VOUT 1.8 V
+#define HARVEST_BOOT_I2C_HZ         400000UL
+#define HARVEST_BOOT_POLL_US        1000        // conversion ready polling
+#define HARVEST_BOOT_BUDGET_CYCLES  200000UL    // reset to reading on the tag, 40 ms at 5 MHz
+
+class HarvestBoot
+{
+public:
+    static bool publish();
+
+    static bool published;      // reading is on the tag
+    static int16_t value;       // what was published, 0.01 C
+};
+
+#endif /* HARVEST_BOOT_H_ */
@@ -0,0 +1,228 @@
+#include "I2cBus.h"
+#include "Clock.h"
+#include <Wire.h>
+
+uint8_t I2cBus::retries = I2C_DEFAULT_RETRIES;
+uint8_t I2cBus::lastError = I2C_OK;
+I2cStats I2cBus::stats;
+uint32_t I2cBus::sessionStart = 0;
+uint32_t I2cBus::sessionEnd = 0;
+uint32_t I2cBus::sessionBudget = 0;
+bool I2cBus::sessionOpen = false;
+
+/**
+**  @brief  Arms the Wire timeout so a stuck slave cannot hold the CPU.
+**          Call after Wire.begin().
+**/
+void I2cBus::begin()
+{
+#if defined(WIRE_HAS_TIMEOUT)
+    Wire.setWireTimeout(I2C_WIRE_TIMEOUT_US, true);     // reset the TWI on timeout
+#endif
+}
+
+/**
+**  @brief  One transaction: head + tx written, then rxLen bytes read after a
+**          repeated start. A pure read skips the write phase.
+**  @retrun uint8_t     I2C_* status
+**/
+uint8_t I2cBus::attempt(uint8_t addr, const uint8_t* head, uint8_t headLen,
+                        const uint8_t* tx, uint8_t txLen, uint8_t* rx, uint8_t rxLen)
+{
+    if (headLen || txLen || !rxLen)
+    {
+        Wire.beginTransmission(addr);
+        if (Wire.write(head, headLen) != headLen || Wire.write(tx, txLen) != txLen)
+            return I2C_ERR_LENGTH;
+        uint8_t status = Wire.endTransmission(rxLen == 0);
+        if (status != I2C_OK)
+            return status;
+    }
+    if (!rxLen)
+        return I2C_OK;
+
+    uint8_t got = Wire.requestFrom(addr, rxLen);
+    for (uint8_t i = 0; i < got; i++)
+        rx[i] = Wire.read();
+    return got == rxLen ? I2C_OK : I2C_ERR_SHORT_READ;
+}
+
+/**
+**  @brief  Runs attempt() until it succeeds, the retry budget is used up or
+**          the session deadline has passed
+**/
+bool I2cBus::transfer(uint8_t addr, const uint8_t* head, uint8_t headLen,
+                      const uint8_t* tx, uint8_t txLen, uint8_t* rx, uint8_t rxLen)
+{
+    uint32_t start = micros();
+    uint8_t status = I2C_ERR_DEADLINE;
+    stats.calls++;
+
+    for (uint8_t n = 0; n <= retries && !expired(); n++)
+    {
+        if (n)
+        {
+            stats.retries++;
+            Clock::delayMicros(I2C_RETRY_DELAY_US);
+        }
+        status = attempt(addr, head, headLen, tx, txLen, rx, rxLen);
+        if (status == I2C_OK || status == I2C_ERR_LENGTH)
+            break;
+    }
+
+    uint32_t spent = micros() - start;
+    if (spent > stats.worstCallMicros)
+        stats.worstCallMicros = spent;
+    if (status == I2C_OK)
+        return true;
+    lastError = status;
+    stats.failures++;
+    return false;
+}
+
+/**
+**  @brief  Writes len bytes in one transaction, with stop
+**  @param  uint8_t         addr    7-bit slave address
+**  @param  const uint8_t*  data    bytes to send
+**  @param  uint8_t         len     number of bytes
+**  @retrun bool            true if every byte was acknowledged
+**/
+bool I2cBus::write(uint8_t addr, const uint8_t* data, uint8_t len)
+{
+    return transfer(addr, 0, 0, data, len, 0, 0);
+}
+
+/**
+**  @brief  Reads len bytes in one transaction
+**/
+bool I2cBus::read(uint8_t addr, uint8_t* data, uint8_t len)
+{
+    return transfer(addr, 0, 0, 0, 0, data, len);
+}
+
+/**
+**  @brief  Writes tx, then reads rxLen bytes after a repeated start
+**/
+bool I2cBus::writeRead(uint8_t addr, const uint8_t* tx, uint8_t txLen, uint8_t* rx, uint8_t rxLen)
+{
+    return transfer(addr, 0, 0, tx, txLen, rx, rxLen);
+}
+
+/**
+**  @brief  Addresses the device without payload, true if it acknowledges.
+**          Single attempt: an absent part is the expected answer here.
+**/
+bool I2cBus::probe(uint8_t addr)
+{
+    if (expired())
+        return false;
+    stats.calls++;
+    return attempt(addr, 0, 0, 0, 0, 0, 0) == I2C_OK;
+}
+
+bool I2cBus::writeTo(uint8_t addr, const uint8_t* reg, uint8_t regLen, const uint8_t* data, uint8_t len)
+{
+    return transfer(addr, reg, regLen, data, len, 0, 0);
+}
+
+bool I2cBus::readReg(uint8_t addr, uint8_t reg, uint8_t* data, uint8_t len)
+{
+    return transfer(addr, &reg, 1, 0, 0, data, len);
+}
+
+bool I2cBus::writeReg(uint8_t addr, uint8_t reg, const uint8_t* data, uint8_t len)
+{
+    return transfer(addr, &reg, 1, data, len, 0, 0);
+}
+
+bool I2cBus::readReg16(uint8_t addr, uint8_t reg, uint16_t& value)
+{
+    uint8_t buf[2];
+    if (!readReg(addr, reg, buf, 2))
+        return false;
+    value = (uint16_t)buf[0] << 8 | buf[1];
+    return true;
+}
+
+bool I2cBus::writeReg16(uint8_t addr, uint8_t reg, uint16_t value)
+{
+    uint8_t buf[2] = { (uint8_t)(value >> 8), (uint8_t)(value & 0xFF) };
+    return writeReg(addr, reg, buf, 2);
+}
+
+bool I2cBus::writeReg8(uint8_t addr, uint8_t reg, uint8_t value)
+{
+    return writeReg(addr, reg, &value, 1);
+}
+
+/**
+**  @brief  Opens a wake cycle: calls started after budgetMicros fail with
+**          I2C_ERR_DEADLINE without touching the bus. Clears stats.
+**/
+void I2cBus::beginSession(uint32_t budgetMicros)
+{
+    sessionStart = micros();
+    sessionBudget = budgetMicros;
+    sessionOpen = true;
+    memset(&stats, 0, sizeof(stats));
+    lastError = I2C_OK;
+}
+
+void I2cBus::endSession()
+{
+    sessionEnd = micros();
+    sessionOpen = false;
+}
+
+bool I2cBus::expired()
+{
+    return sessionOpen && micros() - sessionStart >= sessionBudget;
+}
+
+uint32_t I2cBus::sessionMicros()
+{
+    return (sessionOpen ? micros() : sessionEnd) - sessionStart;
+}
+
+/**
+**  @brief  Waits inside the session, cut short where its budget runs out.
+**          Outside a session it is a plain wait.
+**  @param  uint32_t    us      conversion time, programming time, poll interval
+**  @retrun bool        false if the budget ran out first (I2C_ERR_DEADLINE)
+**/
+bool I2cBus::wait(uint32_t us)
+{
+    bool whole = true;
+    if (sessionOpen)
+    {
+        uint32_t spent = micros() - sessionStart;
+        uint32_t left = spent < sessionBudget ? sessionBudget - spent : 0;
+        if (us > left)
+        {
+            us = left;
+            whole = false;
+            lastError = I2C_ERR_DEADLINE;
+        }
+    }
+    delay(us / 1000);
+    Clock::delayMicros(us % 1000);
+    return whole;
+}
+
+/**
+**  @brief  Worst case of one call: every attempt runs into the Wire timeout
+**/
+uint32_t I2cBus::callBoundMicros()
+{
+    return (uint32_t)(retries + 1) * I2C_WIRE_TIMEOUT_US + (uint32_t)retries * I2C_RETRY_DELAY_US;
+}
+
+/**
+**  @brief  Latest point the session can keep the MCU awake: the budget plus
+**          one call that started just before it ran out. Holds for waits
+**          made through wait(), not for delay() calls in the session.
+**/
+uint32_t I2cBus::awakeBoundMicros()
+{
+    return sessionBudget + callBoundMicros();
+}
@@ -0,0 +1,95 @@
+//  I2C transaction layer shared by the sensor policies and the tag drivers
+//  -----------------------------------------
+//  Every call is one transaction with a bounded retry budget. All functions
+//  return false when the device does not acknowledge, delivers fewer bytes
+//  than requested or the bus times out; lastError holds the reason.
+//
+//  Latency bound:
+//   - one attempt is limited by the Wire timeout (I2C_WIRE_TIMEOUT_US,
+//     SCL held low / lost arbitration / missing STOP)
+//   - one call makes at most retries + 1 attempts, I2C_RETRY_DELAY_US apart
+//   - an open session (beginSession) refuses new calls once its budget is
+//     spent, so a wake cycle ends at most callBoundMicros() after its budget
+//   - waits between calls (conversions, EEPROM programming, status polls)
+//     go through wait(), which ends where the budget does; a plain delay()
+//     in the session would not be covered by awakeBoundMicros()
+//
+//  stats keeps what the current wake actually cost, for the debug output
+//  and the host simulator.
+
+#ifndef I2C_BUS_H_
+#define I2C_BUS_H_
+#if ARDUINO >= 100
+ #include "Arduino.h"
+#else
+ #include "WProgram.h"
+#endif
+
+//status codes, 1..5 are the Wire endTransmission() codes
+#define I2C_OK                  0
+#define I2C_ERR_LENGTH          1       // does not fit the Wire buffer
+#define I2C_ERR_NACK_ADDR       2
+#define I2C_ERR_NACK_DATA       3
+#define I2C_ERR_OTHER           4
+#define I2C_ERR_TIMEOUT         5
+#define I2C_ERR_SHORT_READ      6
+#define I2C_ERR_DEADLINE        7       // session budget spent, not attempted
+
+#define I2C_DEFAULT_RETRIES     2
+#define I2C_RETRY_DELAY_US      200     // lets a busy slave finish (e.g. EEPROM write)
+#define I2C_WIRE_TIMEOUT_US     5000    // per attempt, SCL stretching included
+
+struct I2cStats
+{
+    uint16_t calls;
+    uint16_t retries;
+    uint16_t failures;
+    uint32_t worstCallMicros;   // slowest call including its retries
+};
+
+class I2cBus
+{
+public:
+    static void begin();
+
+    static bool write(uint8_t addr, const uint8_t* data, uint8_t len);
+    static bool read(uint8_t addr, uint8_t* data, uint8_t len);
+    static bool writeRead(uint8_t addr, const uint8_t* tx, uint8_t txLen, uint8_t* rx, uint8_t rxLen);
+    static bool probe(uint8_t addr);
+
+    // register pointer of regLen bytes followed by data, one transaction
+    static bool writeTo(uint8_t addr, const uint8_t* reg, uint8_t regLen, const uint8_t* data, uint8_t len);
+
+    // devices with an 8-bit register pointer
+    static bool readReg(uint8_t addr, uint8_t reg, uint8_t* data, uint8_t len);
+    static bool writeReg(uint8_t addr, uint8_t reg, const uint8_t* data, uint8_t len);
+    static bool readReg16(uint8_t addr, uint8_t reg, uint16_t& value);     // MSB first
+    static bool writeReg16(uint8_t addr, uint8_t reg, uint16_t value);     // MSB first
+    static bool writeReg8(uint8_t addr, uint8_t reg, uint8_t value);
+
+    // wake cycle budget
+    static void beginSession(uint32_t budgetMicros);
+    static void endSession();
+    static bool expired();
+    static uint32_t sessionMicros();      // elapsed, frozen by endSession()
+    static bool wait(uint32_t us);        // false if the budget ran out first
+    static uint32_t callBoundMicros();
+    static uint32_t awakeBoundMicros();
+
+    static uint8_t retries;     // extra attempts per call
+    static uint8_t lastError;   // I2C_* of the last failed call
+    static I2cStats stats;
+
+private:
+    static bool transfer(uint8_t addr, const uint8_t* head, uint8_t headLen,
+                         const uint8_t* tx, uint8_t txLen, uint8_t* rx, uint8_t rxLen);
+    static uint8_t attempt(uint8_t addr, const uint8_t* head, uint8_t headLen,
+                           const uint8_t* tx, uint8_t txLen, uint8_t* rx, uint8_t rxLen);
+
+    static uint32_t sessionStart;
+    static uint32_t sessionEnd;
+    static uint32_t sessionBudget;
+    static bool sessionOpen;
+};
+
+#endif /* I2C_BUS_H_ */
@@ -0,0 +1,151 @@
+#include "Indicator.h"
+
+static constexpr uint8_t PATTERNS[INDICATOR_PATTERNS] = {
+    0,                                                                          // INDICATOR_OFF
+    INDICATOR_4S | INDICATOR_2S | INDICATOR_1S | INDICATOR_500MS | INDICATOR_250MS | INDICATOR_125MS,
+    INDICATOR_8S | INDICATOR_4S | INDICATOR_2S | INDICATOR_500MS | INDICATOR_250MS | INDICATOR_125MS,
+    INDICATOR_8S | INDICATOR_4S | INDICATOR_2S | INDICATOR_250MS | INDICATOR_125MS | INDICATOR_62MS,
+};
+
+static constexpr uint8_t bitCount(uint8_t v)
+{
+    return v ? (v & 1) + bitCount(v >> 1) : 0;
+}
+
+static constexpr bool fitsChannels(uint8_t i = 0)
+{
+    return i >= INDICATOR_PATTERNS ||
+           (bitCount(PATTERNS[i] & INDICATOR_SLOW_BITS) <= 3 &&
+            bitCount(PATTERNS[i] & ~INDICATOR_SLOW_BITS) <= 3 && fitsChannels(i + 1));
+}
+
+static_assert(fitsChannels(), "a pattern uses more than three slow or three fast PIT bits");
+
+//  EVSYS.CHANNELn codes 0x08..0x0B are the PIT outputs: DIV8192..DIV1024 on
+//  even channels, DIV512..DIV64 on odd ones
+#define INDICATOR_EVGEN_PIT     0x08
+
+uint8_t Indicator::current = INDICATOR_OFF;
+
+uint8_t Indicator::pattern()
+{
+    return current;
+}
+
+//  AND of the inputs in used (LUT input bits), the others are masked to 0
+static uint8_t andTruth(uint8_t used)
+{
+    uint8_t truth = 0;
+    for (uint8_t in = 0; in < 8; in++)
+        if ((in & used) == used)
+            truth |= 1 << in;
+    return truth;
+}
+
+/**
+**  @brief  Event channels and truth tables for a set of PIT bits. LUT3
+**          takes channels 0/1 on inputs 0/1, LUT2 and LUT1 take the LUT
+**          before them on input 0 and channels 2/3 and 4/5 on inputs 1/2.
+**  @param  uint8_t bits    INDICATOR_8S .. INDICATOR_62MS, all must be high
+**/
+void Indicator::configure(uint8_t bits, IndicatorConfig& config)
+{
+    memset(&config, 0, sizeof(config));
+    uint8_t slow = 0, fast = 1;
+    for (uint8_t b = 0; b < 8; b++)
+    {
+        uint8_t bit = 0x80 >> b;
+        if (!(bits & bit))
+            continue;
+        uint8_t& ch = bit & INDICATOR_SLOW_BITS ? slow : fast;
+        if (ch < 6)
+            config.channel[ch] = INDICATOR_EVGEN_PIT + b % 4;
+        ch += 2;
+    }
+    for (uint8_t lut = 0; lut < 3; lut++)
+    {
+        const uint8_t* ch = config.channel + 2 * lut;
+        uint8_t first = lut ? 0x02 : 0x01;      // input of the A channel
+        uint8_t used = lut ? 0x01 : 0;          // link from the LUT before
+        if (ch[0])
+            used |= first;
+        if (ch[1])
+            used |= first << 1;
+        config.truth[lut] = andTruth(used);
+    }
+}
+
+/**
+**  @brief  Starts a pattern in place of the running one
+**  @param  uint8_t pattern INDICATOR_OFF .. INDICATOR_LOW_BATTERY
+**/
+void Indicator::show(uint8_t pattern)
+{
+    if (pattern >= INDICATOR_PATTERNS || pattern == current)
+        return;
+    IndicatorConfig config;
+    configure(PATTERNS[pattern], config);
+    current = pattern;
+    apply(config);
+}
+
+#if defined(__AVR__)
+
+void Indicator::apply(const IndicatorConfig& config)
+{
+    CCL.CTRLA = 0;                              // LUT registers are only writable with CCL off
+    if (current == INDICATOR_OFF)
+    {
+        CCL.LUT1CTRLA = 0;
+        CCL.LUT2CTRLA = 0;
+        CCL.LUT3CTRLA = 0;
+        for (uint8_t ch = 0; ch < 6; ch++)
+            (&EVSYS.CHANNEL0)[ch] = 0;
+        return;                                 // the PIT belongs to FieldWake as well, left running
+    }
+
+    // PIT outputs need the PIT on; its period and interrupt stay FieldWake's
+    while (RTC.PITSTATUS & RTC_CTRLBUSY_bm)
+        ;
+    RTC.CLKSEL = RTC_CLKSEL_INT1K_gc;
+    if (!(RTC.PITCTRLA & RTC_PITEN_bm))
+        RTC.PITCTRLA = RTC_PERIOD_OFF_gc | RTC_PITEN_bm;
+
+    for (uint8_t ch = 0; ch < 6; ch++)
+        (&EVSYS.CHANNEL0)[ch] = config.channel[ch];
+    EVSYS.USERCCLLUT3A = EVSYS_USER_CHANNEL0_gc;
+    EVSYS.USERCCLLUT3B = EVSYS_USER_CHANNEL1_gc;
+    EVSYS.USERCCLLUT2A = EVSYS_USER_CHANNEL2_gc;
+    EVSYS.USERCCLLUT2B = EVSYS_USER_CHANNEL3_gc;
+    EVSYS.USERCCLLUT1A = EVSYS_USER_CHANNEL4_gc;
+    EVSYS.USERCCLLUT1B = EVSYS_USER_CHANNEL5_gc;
+
+    CCL.LUT3CTRLB = (config.channel[1] ? CCL_INSEL1_EVENTB_gc : CCL_INSEL1_MASK_gc) |
+                    (config.channel[0] ? CCL_INSEL0_EVENTA_gc : CCL_INSEL0_MASK_gc);
+    CCL.LUT3CTRLC = CCL_INSEL2_MASK_gc;
+    CCL.TRUTH3 = config.truth[0];
+    CCL.LUT2CTRLB = (config.channel[2] ? CCL_INSEL1_EVENTA_gc : CCL_INSEL1_MASK_gc) | CCL_INSEL0_LINK_gc;
+    CCL.LUT2CTRLC = config.channel[3] ? CCL_INSEL2_EVENTB_gc : CCL_INSEL2_MASK_gc;
+    CCL.TRUTH2 = config.truth[1];
+    CCL.LUT1CTRLB = (config.channel[4] ? CCL_INSEL1_EVENTA_gc : CCL_INSEL1_MASK_gc) | CCL_INSEL0_LINK_gc;
+    CCL.LUT1CTRLC = config.channel[5] ? CCL_INSEL2_EVENTB_gc : CCL_INSEL2_MASK_gc;
+    CCL.TRUTH1 = config.truth[2];
+
+    PORTMUX.CCLROUTEA |= PORTMUX_LUT1_bm;       // LUT1 OUT on PC1
+    CCL.LUT3CTRLA = CCL_ENABLE_bm;
+    CCL.LUT2CTRLA = CCL_ENABLE_bm;
+    CCL.LUT1CTRLA = CCL_ENABLE_bm | CCL_OUTEN_bm;
+    CCL.CTRLA = CCL_ENABLE_bm | CCL_RUNSTDBY_bm;
+}
+
+#else
+
+//  host builds: what apply() would write, for the simulator's CCL model
+IndicatorConfig indicatorApplied;
+
+void Indicator::apply(const IndicatorConfig& config)
+{
+    indicatorApplied = config;
+}
+
+#endif /* __AVR__ */
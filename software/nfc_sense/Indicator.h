@@ -0,0 +1,73 @@
+//  Status LED patterns without the CPU
+//  -----------------------------------------
+//  A pattern is a short flash repeating every few seconds, produced by
+//  hardware that keeps running while the core sleeps: the RTC PIT
+//  prescaler (1.024 kHz ULP, the clock FieldWake and Epd use as well)
+//  puts square waves of 62.5 ms .. 8 s period on event channels, and three
+//  chained CCL LUTs AND them onto the LED pin. The LUTs are plain
+//  combinational logic (no filter, edge detector or sequencer), so the
+//  output follows the events in standby and power-down and no interrupt
+//  is involved; TCA0 stays off.
+//
+//  A pattern is one byte, the PIT bits that must all be high, so the flash
+//  is where they coincide. The even event channels carry the slow bits
+//  (8 s .. 1 s period), the odd ones the fast bits (500 .. 62.5 ms), three of
+//  each at most. Patterns live in a const table in flash; RAM holds the
+//  running pattern's index. A pattern runs until show() replaces it.
+//
+//  The LED must be on the LUT1 alternate output, PC1 (BOARD_PIN_STATUS_LED).
+//  D1 on the NTAG and display boards is a power LED from VCC through 1k;
+//  moving its resistor end to PC1 turns it into the status LED.
+
+#ifndef INDICATOR_H_
+#define INDICATOR_H_
+#if ARDUINO >= 100
+ #include "Arduino.h"
+#else
+ #include "WProgram.h"
+#endif
+
+//PIT bits, wave period; high in the second half
+#define INDICATOR_8S            0x80    // DIV8192, even channels
+#define INDICATOR_4S            0x40    // DIV4096
+#define INDICATOR_2S            0x20    // DIV2048
+#define INDICATOR_1S            0x10    // DIV1024
+#define INDICATOR_500MS         0x08    // DIV512, odd channels
+#define INDICATOR_250MS         0x04    // DIV256
+#define INDICATOR_125MS         0x02    // DIV128
+#define INDICATOR_62MS          0x01    // DIV64
+#define INDICATOR_SLOW_BITS     0xF0
+
+//patterns
+#define INDICATOR_OFF           0
+#define INDICATOR_TAG_WRITTEN   1       // one 62 ms flash every 4 s
+#define INDICATOR_SENSOR_FAULT  2       // two 62 ms flashes, 0.5 s apart, every 8 s
+#define INDICATOR_LOW_BATTERY   3       // four 31 ms flashes within 1 s, every 8 s
+#define INDICATOR_PATTERNS      4
+
+//  event channel generators and LUT truth tables for one pattern,
+//  LUTs in chain order: LUT3 -> LUT2 -> LUT1 -> pin
+struct IndicatorConfig
+{
+    uint8_t channel[6];     // EVSYS.CHANNELn, 0 = unused
+    uint8_t truth[3];       // LUT3, LUT2, LUT1
+};
+
+class Indicator
+{
+public:
+    static void show(uint8_t pattern);
+    static uint8_t pattern();
+    static void configure(uint8_t bits, IndicatorConfig& config);
+
+private:
+    static void apply(const IndicatorConfig& config);
+
+    static uint8_t current;
+};
+
+#if !defined(__AVR__)
+extern IndicatorConfig indicatorApplied;    // host builds: last apply()
+#endif
+
+#endif /* INDICATOR_H_ */
@@ -8,6 +8,7 @@
 
 #include <Wire.h>
 #include "RF430CL330H_Shield.h"
+#include "I2cBus.h"
 
 #define IRQ   (5)
 #define RESET (4)
@@ -15,6 +16,11 @@
 #define OS_ANDROID 0
 #define OS_IOS 1
 
+//setupNFC() results
+#define NFC_ABSENT   0    // RF430 never became ready or stopped answering
+#define NFC_WRITTEN  1    // CC file (re)written
+#define NFC_INTACT   2    // warm boot, tag still held our layout
+
 #define RF430_DEFAULT_DATA                                                              \
 {                                                                                       \
 /*NDEF Tag Application Name*/                                                           \
@@ -105,7 +111,13 @@ void RF430_Interrupt()
 
 }
 
-void setupNFC()
+/**
+**  @brief  Brings the RF430 up with our CC file
+**  @param  bool    warm    warm boot: skip the reset pulse and only rewrite
+**                          the CC file if the tag lost it
+**  @retrun uint8_t NFC_ABSENT, NFC_WRITTEN or NFC_INTACT
+**/
+uint8_t setupNFC(bool warm)
 {
 
   // pinMode(IRQ, INPUT);
@@ -113,11 +125,22 @@ void setupNFC()
   
   // Reset the RF430
   
+  if (!warm) {
   digitalWrite(RESET, HIGH);
   digitalWrite(RESET, LOW);
-  delay(10);                   //Reset:low level 100ms
+  bool held = I2cBus::wait(10000UL);   //Reset:low level 100ms
   digitalWrite(RESET, HIGH);
-  delay(10);
+  if (!held || !I2cBus::wait(10000UL))
+    return NFC_ABSENT;
+  }
+
+  // bounded: a missing or latched-up RF430 must not keep us awake
+  if (!nfc.Wait_Status(READY, READY, RF430_READY_TIMEOUT_MS))
+    return NFC_ABSENT;
+
+  // chip-side backstop: the RF430 resets its serial interface on its own
+  // if a transfer stalls, e.g. when the MCU browns out in the middle of it
+  nfc.Arm_CommWatchdog(TIMEOUT_PERIOD_2_SEC);
   
   /*
   nfc.Write_Register(CONTROL_REG, SW_RESET);
@@ -134,7 +157,7 @@ void setupNFC()
   uint16_t version;
 
   version = nfc.Read_Register(VERSION_REG);
-      /** Errata Fix : Unresponsive RF - recommended firmware
+      ** Errata Fix : Unresponsive RF - recommended firmware
   *   reference: RF430CL330H Device Erratasheet, SLAZ540D-June 2013-Revised January
   */
 
@@ -166,30 +189,6 @@ void setupNFC()
   // static length 35 bytes
   // nlen at index 26 & 27
   
-  byte nfcTemplateStatic_ASDASD[] = {
-  /*NDEF Tag Application Name*/                                                           \
-  0xD2, 0x76, 0x00, 0x00, 0x85, 0x01, 0x01,                                               \
-                                                                                          \
-  /*Capability Container ID*/                                                             \
-  0xE1, 0x03,                                                                             \
-  0x00, 0x0F, /* CCLEN */                                                                 \
-  0x20,       /* Mapping version 2.0 */                                                   \
-  0x00, 0xF9, /* MLe (249 bytes); Maximum R-APDU data size */                             \
-  0x00, 0xF6, /* MLc (246 bytes); Maximum C-APDU data size */                             \
-  0x04,       /* Tag, File Control TLV (4 = NDEF file) */                                 \
-  0x06,       /* Length, File Control TLV (6 = 6 bytes of data for this tag) */           \
-  0xE1, 0x04, /* File Identifier */                                                       \
-  0x0B, 0xDF, /* Max NDEF size (3037 bytes of useable memory) */                          \
-  0x00,       /* NDEF file read access condition, read access without any security */     \
-  0x00,       /* NDEF file write access condition; write access without any security */   \
-                                                                                          \
-  /* NDEF File ID */                                                                      \
-  0xE1, 0x04,                                                                             \
-                                                                                          \
-                                                           \
-                                                                                           
-  };
-
     byte nfcTemplateStatic[] = {
   /*NDEF Tag Application Name*/                                                           \
   0xD2, 0x76, 0x00, 0x00, 0x85, 0x01, 0x01,                                               \
@@ -206,110 +205,42 @@ void setupNFC()
   0x00, 0xF0, /* Max NDEF size (255 bytes of usable memory) */                            \
   0x00,       /* NDEF file read access condition, read access without any security */     \
   0x00,       /* NDEF file write access condition; write access without any security */   \
-                                                                                                                                                                             
+  0xE1, 0x04, /* NDEF File ID of the first slot, see Write_Buffered_NDEFmessage() */      \
   };
 
-      byte nfcTemplateStatic_iOS[] = {
-  /*NDEF Tag Application Name*/                                                           \
-  0xD2, 0x76, 0x00, 0x00, 0x85, 0x01, 0x01,                                               \
-                                                                                          \
-  /*Capability Container ID*/                                                             \
-  0xE1, 0x03,                                                                             \
-  0x00, 0x0F, /* CCLEN */                                                                 \
-  0x20,       /* Mapping version 2.0 */                                                   \
-  0x00, 0xF9, /* MLe (249 bytes); Maximum R-APDU data size */                             \
-  0x00, 0xF6, /* MLc (246 bytes); Maximum C-APDU data size */                             \
-  0x04,       /* Tag, File Control TLV (4 = NDEF file) */                                 \
-  0x06,       /* Length, File Control TLV (6 = 6 bytes of data for this tag) */           \
-  0xE1, 0x04, /* File Identifier */                                                       \
-  0x00, 0xF0, /* Max NDEF size (255 bytes of usable memory) */                            \
-  0x00,       /* NDEF file read access condition, read access without any security */     \
-  0x00,       /* NDEF file write access condition; write access without any security */   \
-  0xE1, 0x04,     /* NDEF File ID NEW NEW NEW*/                                           \  
-                                                                                                                                                                             
-  };
-    
+  // warm boot: one read instead of reset + rewrite when the RF430 kept its RAM
+  if (warm) {
+    byte current[sizeof(nfcTemplateStatic)];
+    if (nfc.Read_Continuous(0, current, sizeof(current))) {
+      // the CC names whichever NDEF slot was published last
+      if (current[RF430_CC_NDEF_FILE_ID] == (RF430_NDEF_FILE_B >> 8) &&
+          current[RF430_CC_NDEF_FILE_ID + 1] == (RF430_NDEF_FILE_B & 0xFF))
+        current[RF430_CC_NDEF_FILE_ID + 1] = RF430_NDEF_FILE_A & 0xFF;
+      if (memcmp(current, nfcTemplateStatic, sizeof(current)) == 0)
+        return NFC_INTACT;
+    }
+  }
+
   //write NDEF memory with Capability Container + NDEF message
-  nfc.Write_Continuous(0, nfcTemplateStatic, sizeof(nfcTemplateStatic));
+  if (!nfc.Write_Continuous(0, nfcTemplateStatic, sizeof(nfcTemplateStatic)))
+    return NFC_ABSENT;
 
 
   // nfc.Write_Register(CONTROL_REG, INT_ENABLE + INTO_DRIVE);
+  return NFC_WRITTEN;
 }
 
 
 
-void updateNFC(int osType, String nfcString)
+/**
+**  @brief  Publishes nfcString as a single text record
+**  @retrun bool    false if the message could not be written
+**/
+bool updateNFC(int osType, String nfcString)
 {
 
 
-  byte NDEFfieldsLength_asdasdasdasdasd[] = {
-  /* NDEF File for Hello World  (48 bytes total length) */                                \
-  0x00, 0x13, /* NLEN; NDEF length (2 byte long message) */                               \
-  0xD1, /* Record Header  */                                                              \
-  0x01, /* Type Length */                                                                 \
-  0x00, /* bytes after this -1  = NLEN - 4*/                                              \
-  0x54, /* type  T = text */                                                              \
-  0x02,  /* ID length  */                                                                 \
-  0x65, 0x6E, /* 'e', 'n', */                                                             \
-  };
-
-  byte NDEFfieldsLength_correct[] = {
-  /* NDEF File for Hello World */                                                        
-  0x00, 0x00, /* NLEN; NDEF length will be updated */                                     
-  0xD1,       /* Record Header (MB=1, ME=1, CF=0, SR=1, IL=0, TNF=0x01) */                                                              
-  0x01,       /* Type Length */                                                                 
-  0x00,       /* Payload Length (will be updated) */                                              
-  0x54,       /* Type: 'T' for text */                                                             
-  0x02,       /* Language Code Length */                                                                 
-  0x65, 0x6E  /* Language Code: 'en' */                                                             
-  };
-  
-  byte NDEFfieldsLength_URL[] = {
-  /* NDEF File for Hello World */                                                        
-  0x00, 0x00,       /* NLEN; NDEF length will be updated */                                     
-  0xD1,       /* Record Header (MB=1, ME=1, CF=0, SR=1, IL=0, TNF=0x01) */                                                              
-  0x01,       /* Type Length */                                                                 
-  0x0B,       /* Payload Length (will be updated) */                                              
-  0x55,       /* Type: 'T' for text */                                                             
-  0x03,                                                             
-  };
-  
-  if (osType == OS_IOS) {
-    byte NDEFfieldsLength[] = {
-      0xE1, 0x04,     /* NDEF File ID NEW NEW NEW*/
-  
-      // NDEF File body starts immediately after CC file
-      0x00, 0x00, /* NLEN = bytes after this */                                     
-      0xD1,       /* Record Header (MB=1, ME=1, CF=0, SR=1, IL=0, TNF=0x01) */                                                              
-      0x01,       /* Type Length */                                                                 
-      0x00,       /* Payload Length = bytes after this -1(will be updated) */                                              
-      0x55,       /* Type = URI */                                                             
-      0x02,
-    };
-  } else {
-    
-    byte NDEFfieldsLength[] = {
-    /* NDEF File for Hello World */                                                        
-      0x00, 0x00, /* NLEN; NDEF length will be updated */                                     
-      0xD1,       /* Record Header (MB=1, ME=1, CF=0, SR=1, IL=0, TNF=0x01) */                                                              
-      0x01,       /* Type Length */                                                                 
-      0x00,       /* Payload Length (will be updated) */                                              
-      0x54,       /* Type: 'T' for text */                                                             
-      0x02,       /* Language Code Length */                                                                 
-      0x65, 0x6E  /* Language Code: 'en' */                                                             
-    };
-  }
-
-  byte NDEFfieldsLength_iOS[] = {
-      // NDEF File body starts immediately after CC file
-      0x00, 0x00, /* NLEN = bytes after this */                                     
-      0xD1,       /* Record Header (MB=1, ME=1, CF=0, SR=1, IL=0, TNF=0x01) */                                                              
-      0x01,       /* Type Length */                                                                 
-      0x00,       /* Payload Length = bytes after this -1(will be updated) */                                              
-      0x55,       /* Type = URI */                                                             
-      0x00,
-    };
- byte NDEFfieldsLength[] = {
+  byte NDEFfieldsLength[] = {
     /* NDEF File for Hello World */                                                        
       0x00, 0x00, /* NLEN; NDEF length will be updated */                                     
       0xD1,       /* Record Header (MB=1, ME=1, CF=0, SR=1, IL=0, TNF=0x01) */                                                              
@@ -344,13 +275,13 @@ void updateNFC(int osType, String nfcString)
   byte nfcInput[nfcInputSize];
 
   int pointer;
-  for (int i = 0 ; i < sizeof(NDEFfieldsLength); i++) {
+  for (int i = 0 ; i < (int)sizeof(NDEFfieldsLength); i++) {
       nfcInput[i] = NDEFfieldsLength[i];
       pointer = i;
       
       }
   
-  for (int i = 0, j = pointer + 1; i < stringSize ,  j < pointer + 1 + stringSize; i++, j++) { 
+  for (int i = 0, j = pointer + 1; j < pointer + 1 + stringSize; i++, j++) { 
       /*Serial.println("i");
       Serial.println(i);
       Serial.println("j");
@@ -370,12 +301,14 @@ void updateNFC(int osType, String nfcString)
   //Enable interrupts for End of Read and End of Write
   // nfc.Write_Register(INT_ENABLE_REG, EOW_INT_ENABLE + EOR_INT_ENABLE);
 
-  nfc.Write_Extended_NDEFmessage(nfcInput, sizeof(nfcInput));
+  // RF stays on: the message goes to the spare NDEF slot, then the CC switches
+  bool written = nfc.Write_Buffered_NDEFmessage(nfcInput, sizeof(nfcInput));
+  // nfc.Write_Extended_NDEFmessage(nfcInput, sizeof(nfcInput));
   // nfc.Write_Extended_NDEFmessage(nfcUrlTest, sizeof(nfcUrlTest));
   // nfc.Write_NDEFmessage(nfcInput, sizeof(nfcInput));
   
   //Configure INTO pin for active low and enable RF
-  nfc.Write_Register(CONTROL_REG, RF_ENABLE);
+  return nfc.Write_Register(CONTROL_REG, RF_ENABLE) && written;
 
 }
 
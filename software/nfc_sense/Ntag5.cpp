@@ -0,0 +1,433 @@
+#include "Ntag5.h"
+#include "I2cBus.h"
+
+#define NTAG5_READ_BURST_BLOCKS     8       // 32 bytes, the Wire receive buffer
+
+uint16_t Ntag5::blocksWritten = 0;
+uint16_t Ntag5::blocksSkipped = 0;
+
+//  Program cycles per block, kept across resets. The magic guards against
+//  RAM content after power loss; wearFresh marks counters that were just
+//  cleared and still wait for restoreWear().
+#define NTAG5_WEAR_MAGIC    0x5EA7
+static uint16_t wearMagic __attribute__((section(".noinit")));
+static uint32_t wearCount[NTAG5_WEAR_BLOCKS] __attribute__((section(".noinit")));
+static uint32_t wearBeyond __attribute__((section(".noinit")));
+static bool wearFresh = false;
+
+/**
+**  @brief  Streams bytes into whole blocks and writes them in bursts.
+**          The tail of the last block is zero padding. With headLast the
+**          first burst is held back and written by finish() after the rest.
+**/
+class NdefBlockStream
+{
+public:
+    NdefBlockStream(uint16_t block, bool headLast = false)
+        : _block(block), _headBlock(block), _headBlocks(0), _fill(0), _ok(true), _headLast(headLast) {}
+
+    void put(uint8_t value)
+    {
+        _buf[_fill++] = value;
+        if (_fill == sizeof(_buf))
+            flush(NTAG5_WRITE_BURST_BLOCKS);
+    }
+
+    void put(const uint8_t* data, uint16_t len)
+    {
+        while (len--)
+            put(*data++);
+    }
+
+    bool finish()
+    {
+        if (_fill)
+        {
+            uint8_t blocks = (_fill + NTAG5_BLOCK_SIZE - 1) / NTAG5_BLOCK_SIZE;
+            memset(_buf + _fill, 0, blocks * NTAG5_BLOCK_SIZE - _fill);
+            flush(blocks);
+        }
+        if (_headBlocks)
+            _ok = _ok && Ntag5::updateBlocks(_headBlock, _head, _headBlocks);
+        return _ok;
+    }
+
+private:
+    void flush(uint8_t blocks)
+    {
+        if (_headLast && _block == _headBlock)
+        {
+            memcpy(_head, _buf, sizeof(_head));
+            _headBlocks = blocks;
+        }
+        else
+            _ok = _ok && Ntag5::updateBlocks(_block, _buf, blocks);
+        _block += blocks;
+        _fill = 0;
+    }
+
+    uint8_t  _buf[NTAG5_WRITE_BURST_BLOCKS * NTAG5_BLOCK_SIZE];
+    uint8_t  _head[NTAG5_WRITE_BURST_BLOCKS * NTAG5_BLOCK_SIZE];
+    uint16_t _block;
+    uint16_t _headBlock;
+    uint8_t  _headBlocks;
+    uint8_t  _fill;
+    bool     _ok;
+    bool     _headLast;
+};
+
+/**
+**  @brief  Checks that an NTAG 5 answers and has finished its boot
+**  @retrun bool    false if nothing acknowledges at NTAG5_I2C_ADDRESS
+**/
+bool Ntag5::begin()
+{
+    initWear();
+    uint8_t status1;
+    if (!readSessionReg(NTAG5_REG_STATUS, 1, status1))
+        return false;
+    return status1 & (NTAG5_STATUS1_VCC_BOOT_OK | NTAG5_STATUS1_NFC_BOOT_OK);
+}
+
+bool Ntag5::isEeprom(uint16_t block)
+{
+    return block < NTAG5_SRAM_BLOCK;
+}
+
+/**
+**  @brief  Reads count blocks starting at block
+**  @param  uint16_t    block   I2C block address
+**  @param  uint8_t*    data    count * NTAG5_BLOCK_SIZE bytes
+**  @param  uint8_t     count   number of blocks
+**  @retrun bool        false on bus error
+**/
+bool Ntag5::readBlocks(uint16_t block, uint8_t* data, uint8_t count)
+{
+    while (count)
+    {
+        uint8_t n = count > NTAG5_READ_BURST_BLOCKS ? NTAG5_READ_BURST_BLOCKS : count;
+        uint8_t addr[2] = { (uint8_t)(block >> 8), (uint8_t)block };
+        if (!I2cBus::writeRead(NTAG5_I2C_ADDRESS, addr, 2, data, n * NTAG5_BLOCK_SIZE))
+            return false;
+        block += n;
+        data += n * NTAG5_BLOCK_SIZE;
+        count -= n;
+    }
+    return true;
+}
+
+/**
+**  @brief  Writes count whole blocks in bursts of NTAG5_WRITE_BURST_BLOCKS.
+**          EEPROM bursts wait for the programming to finish, SRAM does not.
+**  @retrun bool        false on bus error, EEPROM error or timeout
+**/
+bool Ntag5::writeBlocks(uint16_t block, const uint8_t* data, uint8_t count)
+{
+    bool eeprom = isEeprom(block);
+    while (count)
+    {
+        uint8_t n = count > NTAG5_WRITE_BURST_BLOCKS ? NTAG5_WRITE_BURST_BLOCKS : count;
+        uint8_t addr[2] = { (uint8_t)(block >> 8), (uint8_t)block };
+        if (!I2cBus::writeTo(NTAG5_I2C_ADDRESS, addr, 2, data, n * NTAG5_BLOCK_SIZE))
+            return false;
+        if (eeprom)
+        {
+            blocksWritten += n;
+            countWear(block, n);
+            if (!waitEepromIdle(NTAG5_EEPROM_TIMEOUT_MS))
+                return false;
+        }
+        block += n;
+        data += n * NTAG5_BLOCK_SIZE;
+        count -= n;
+    }
+    return true;
+}
+
+/**
+**  @brief  Writes count whole blocks, EEPROM blocks only where the content
+**          differs: each burst is read back first and runs of changed
+**          blocks are written with writeBlocks(). SRAM is written as is.
+**  @retrun bool        false on bus error, EEPROM error or timeout
+**/
+bool Ntag5::updateBlocks(uint16_t block, const uint8_t* data, uint8_t count)
+{
+    if (!isEeprom(block))
+        return writeBlocks(block, data, count);
+
+    uint8_t current[NTAG5_WRITE_BURST_BLOCKS * NTAG5_BLOCK_SIZE];
+    while (count)
+    {
+        uint8_t n = count > NTAG5_WRITE_BURST_BLOCKS ? NTAG5_WRITE_BURST_BLOCKS : count;
+        if (!readBlocks(block, current, n))
+            return false;
+
+        uint8_t i = 0;
+        while (i < n)
+        {
+            uint8_t run = 0;
+            while (i + run < n && memcmp(current + (i + run) * NTAG5_BLOCK_SIZE,
+                                         data + (i + run) * NTAG5_BLOCK_SIZE, NTAG5_BLOCK_SIZE))
+                run++;
+            if (!run)
+            {
+                blocksSkipped++;
+                i++;
+                continue;
+            }
+            if (!writeBlocks(block + i, data + i * NTAG5_BLOCK_SIZE, run))
+                return false;
+            i += run;
+        }
+        block += n;
+        data += n * NTAG5_BLOCK_SIZE;
+        count -= n;
+    }
+    return true;
+}
+
+void Ntag5::initWear()
+{
+    if (wearMagic == NTAG5_WEAR_MAGIC)
+        return;
+    wearMagic = NTAG5_WEAR_MAGIC;
+    memset(wearCount, 0, sizeof(wearCount));
+    wearBeyond = 0;
+    wearFresh = true;
+}
+
+void Ntag5::countWear(uint16_t block, uint8_t count)
+{
+    initWear();
+    for (; count; count--, block++)
+    {
+        if (block < NTAG5_WEAR_BLOCKS)
+            wearCount[block]++;
+        else
+            wearBeyond++;
+    }
+}
+
+/**
+**  @brief  Program cycles of a user block, blocks from NTAG5_WEAR_BLOCKS on
+**          (and configuration blocks) report their shared counter
+**/
+uint32_t Ntag5::wear(uint16_t block)
+{
+    initWear();
+    return block < NTAG5_WEAR_BLOCKS ? wearCount[block] : wearBeyond;
+}
+
+uint32_t Ntag5::hottestWear()
+{
+    initWear();
+    uint32_t hottest = wearBeyond;
+    for (uint8_t i = 0; i < NTAG5_WEAR_BLOCKS; i++)
+        if (wearCount[i] > hottest)
+            hottest = wearCount[i];
+    return hottest;
+}
+
+/**
+**  @brief  Endurance left on the most worn block
+**/
+uint32_t Ntag5::remainingCycles()
+{
+    uint32_t hottest = hottestWear();
+    return hottest < NTAG5_EEPROM_ENDURANCE ? NTAG5_EEPROM_ENDURANCE - hottest : 0;
+}
+
+/**
+**  @brief  After power loss the counters start from zero; raises every one
+**          of them to the hottest count saved before. No-op once the
+**          counters have carried over a reset.
+**  @param  uint32_t    cycles  hottestWear() as saved in WarmState
+**/
+void Ntag5::restoreWear(uint32_t cycles)
+{
+    initWear();
+    if (!wearFresh)
+        return;
+    wearFresh = false;
+    for (uint8_t i = 0; i < NTAG5_WEAR_BLOCKS; i++)
+        if (wearCount[i] < cycles)
+            wearCount[i] = cycles;
+    if (wearBeyond < cycles)
+        wearBeyond = cycles;
+}
+
+/**
+**  @brief  Reads byte index (REGA) of a session register
+**/
+bool Ntag5::readSessionReg(uint16_t reg, uint8_t index, uint8_t& value)
+{
+    uint8_t tx[3] = { (uint8_t)(reg >> 8), (uint8_t)reg, index };
+    return I2cBus::writeRead(NTAG5_I2C_ADDRESS, tx, 3, &value, 1);
+}
+
+/**
+**  @brief  Changes the bits in mask of byte index (REGA) of a session register
+**/
+bool Ntag5::writeSessionReg(uint16_t reg, uint8_t index, uint8_t mask, uint8_t value)
+{
+    uint8_t tx[5] = { (uint8_t)(reg >> 8), (uint8_t)reg, index, mask, value };
+    return I2cBus::write(NTAG5_I2C_ADDRESS, tx, 5);
+}
+
+bool Ntag5::status(uint8_t& status0)
+{
+    return readSessionReg(NTAG5_REG_STATUS, 0, status0);
+}
+
+/**
+**  @brief  Selects the event the ED pin signals (NTAG5_ED_*). Session
+**          register only, a tag power cycle returns to the configured default.
+**/
+bool Ntag5::setEventDetect(uint8_t event)
+{
+    return writeSessionReg(NTAG5_REG_ED_CONFIG, 0, NTAG5_ED_MASK, event);
+}
+
+/**
+**  @brief  Polls EEPROM_WR_BUSY. A NACK counts as busy, the chip may refuse
+**          the address while it programs.
+**  @retrun bool    false on timeout or if the write reported an error
+**/
+bool Ntag5::waitEepromIdle(uint16_t timeoutMs)
+{
+    uint32_t start = millis();
+    for (;;)
+    {
+        uint8_t status0;
+        if (status(status0) && !(status0 & NTAG5_STATUS0_EEPROM_WR_BUSY))
+            return !(status0 & NTAG5_STATUS0_EEPROM_WR_ERROR);
+        if (millis() - start >= timeoutMs || !I2cBus::wait(NTAG5_POLL_INTERVAL_US))
+            return false;
+    }
+}
+
+/**
+**  @brief  Makes block 0 hold our type 5 capability container
+**  @param  bool&   written     true if the block had to be programmed
+**  @retrun bool    false on bus error
+**/
+bool Ntag5::formatCapabilityContainer(bool& written)
+{
+    static const uint8_t cc[NTAG5_BLOCK_SIZE] = NTAG5_CC;
+    uint8_t current[NTAG5_BLOCK_SIZE];
+    written = false;
+    if (!readBlocks(NTAG5_CC_BLOCK, current, 1))
+        return false;
+    if (memcmp(current, cc, sizeof(cc)) == 0)
+        return true;
+    written = true;
+    return writeBlocks(NTAG5_CC_BLOCK, cc, 1);
+}
+
+/**
+**  @brief  Writes an NDEF message as NDEF TLV + terminator TLV from
+**          NTAG5_NDEF_BLOCK on, in whole blocks
+**  @param  const uint8_t*  message     raw NDEF message (records)
+**  @param  uint16_t        len         message length
+**  @retrun bool            false if it does not fit or on bus error
+**/
+bool Ntag5::writeNdef(const uint8_t* message, uint16_t len)
+{
+    // CC data area minus the TLV header (up to 4 bytes) and terminator
+    if (len > (NTAG5_USER_BLOCKS - NTAG5_NDEF_BLOCK) * NTAG5_BLOCK_SIZE - 5)
+        return false;
+
+    NdefBlockStream out(NTAG5_NDEF_BLOCK);
+    out.put(0x03);
+    if (len < 0xFF)
+        out.put((uint8_t)len);
+    else
+    {
+        out.put(0xFF);
+        out.put((uint8_t)(len >> 8));
+        out.put((uint8_t)len);
+    }
+    out.put(message, len);
+    out.put(0xFE);
+    return out.finish();
+}
+
+/**
+**  @brief  Writes a single short text record ("en") without building the
+**          message in RAM first
+**/
+bool Ntag5::writeNdefText(const char* text)
+{
+    return streamText(NTAG5_NDEF_BLOCK, false, text);
+}
+
+/**
+**  @brief  Text record as NDEF TLV from block, optionally preceded by the
+**          capability container (SRAM image of block 0)
+**  @param  bool    headLast    first burst (TLV length) written after the rest
+**/
+bool Ntag5::streamText(uint16_t block, bool withCc, const char* text, bool headLast)
+{
+    size_t textLen = strlen(text);
+    if (textLen + 7 > NTAG5_MAX_TLV_NDEF)
+        return false;
+
+    uint8_t payloadLen = 3 + textLen;               // status byte + "en" + text
+    uint8_t messageLen = 4 + payloadLen;            // D1 01 len 'T' + payload
+    static const uint8_t header[7] = { 0xD1, 0x01, 0, 'T', 0x02, 'e', 'n' };
+    static const uint8_t cc[NTAG5_BLOCK_SIZE] = NTAG5_CC;
+
+    NdefBlockStream out(block, headLast);
+    if (withCc)
+        out.put(cc, sizeof(cc));
+    out.put(0x03);
+    out.put(messageLen);
+    out.put(header, 2);
+    out.put(payloadLen);
+    out.put(header + 3, 4);
+    out.put((const uint8_t*)text, textLen);
+    out.put(0xFE);
+    return out.finish();
+}
+
+/**
+**  @brief  Switches the arbiter between SRAM mirror and normal mode
+**/
+bool Ntag5::setSramMirror(bool on)
+{
+    uint8_t value = on ? NTAG5_CONFIG1_ARBITER_MIRROR | NTAG5_CONFIG1_SRAM_ENABLE
+                       : NTAG5_CONFIG1_ARBITER_NORMAL;
+    return writeSessionReg(NTAG5_REG_CONFIG, 1,
+                           NTAG5_CONFIG1_ARBITER_MASK | NTAG5_CONFIG1_SRAM_ENABLE, value);
+}
+
+/**
+**  @brief  Arbiter mode as the session register has it now; off after a
+**          tag power cycle
+**/
+bool Ntag5::sramMirror(bool& on)
+{
+    uint8_t config1;
+    if (!readSessionReg(NTAG5_REG_CONFIG, 1, config1))
+        return false;
+    on = (config1 & NTAG5_CONFIG1_ARBITER_MASK) == NTAG5_CONFIG1_ARBITER_MIRROR &&
+         (config1 & NTAG5_CONFIG1_SRAM_ENABLE);
+    return true;
+}
+
+/**
+**  @brief  Publishes text through the SRAM mirror: CC + NDEF TLV are written
+**          to SRAM (no EEPROM programming) and the mirror is switched on.
+**          The TLV block is emptied first and gets its length back last,
+**          so a reader polling the mirror in between the bursts never
+**          decodes half of the update.
+**  @retrun bool    false on bus error or if the text does not fit
+**/
+bool Ntag5::publishLive(const char* text)
+{
+    if (strlen(text) + 7 > NTAG5_MAX_SRAM_NDEF)
+        return false;
+    static const uint8_t empty[NTAG5_BLOCK_SIZE] = { 0x03, 0x00, 0xFE, 0x00 };
+    return writeBlocks(NTAG5_SRAM_BLOCK + NTAG5_NDEF_BLOCK, empty, 1) &&
+           streamText(NTAG5_SRAM_BLOCK, true, text, true) && setSramMirror(true);
+}
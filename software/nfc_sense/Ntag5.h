@@ -0,0 +1,169 @@
+//  NTAG 5 Link (NTP53x2) I2C slave driver
+//  -----------------------------------------
+//  I2C view of the memory, 16-bit block addresses, 4-byte blocks:
+//
+//  Address         | Blocks | Description                   |
+//  -------------------------------------------------------------
+//  0x0000 - 0x01FF | 512    | user EEPROM (NFC type 5 area) |
+//  0x1000 - 0x10FF |        | configuration (EEPROM)        |
+//  0x10A0 - 0x10AF |        | session registers (RAM)       |
+//  0x2000 - 0x203F | 64     | SRAM                          |
+//  -------------------------------------------------------------
+//
+//  Memory access:      [addr MSB, addr LSB] + n * 4 data bytes
+//  Session register:   write [addr MSB, addr LSB, REGA, MASK, DATA]
+//                      read  [addr MSB, addr LSB, REGA] + read 1 byte
+//
+//  While the EEPROM programs a block the chip NACKs further memory writes;
+//  writeBlocks() polls EEPROM_WR_BUSY with a bounded wait after each burst.
+//  NDEF messages are streamed into whole blocks, the trailing bytes of the
+//  last block are padding after the terminator TLV, so no block is ever
+//  read back to be merged.
+//
+//  EEPROM updates are block-diffed: updateBlocks() reads each burst back
+//  (bus time, no programming) and programs only the blocks that differ. A
+//  reading usually changes one or two blocks of the text record instead of
+//  the whole message. Every programmed block is counted; the counters
+//  survive MCU resets in .noinit RAM and the hottest one is restored from
+//  WarmState after power loss, so remainingCycles() stays an upper bound
+//  on the wear of any block.
+//
+//  Live publishing goes to SRAM with the arbiter in SRAM mirror mode: the
+//  reader sees SRAM in place of user blocks 0..63, so an update costs bus
+//  time only. The mirror setting lives in the session registers and is
+//  gone after a tag power cycle, the reader then sees the EEPROM copy,
+//  which is kept as a persistent fallback and written far less often.
+//  A reader may poll SRAM in between the bursts of an update: the TLV
+//  block goes first with length 0 (an empty message), the new tail after
+//  it and the header with the real length last, so a reader gets the old
+//  message, none or the new one, never a mix.
+
+#ifndef NTAG5_H_
+#define NTAG5_H_
+#if ARDUINO >= 100
+ #include "Arduino.h"
+#else
+ #include "WProgram.h"
+#endif
+
+#define NTAG5_I2C_ADDRESS           0x54
+#define NTAG5_BLOCK_SIZE            4
+#define NTAG5_USER_BLOCKS           512
+#define NTAG5_SRAM_BLOCK            0x2000
+#define NTAG5_SRAM_BLOCKS           64
+#define NTAG5_WRITE_BURST_BLOCKS    4       // 2 address + 16 data bytes per Wire transfer
+#define NTAG5_EEPROM_TIMEOUT_MS     20      // worst case per burst, typ. 4 ms per block
+#define NTAG5_POLL_INTERVAL_US      500
+#define NTAG5_WEAR_BLOCKS           32      // blocks 0..31 counted one by one, the rest share one counter
+#define NTAG5_EEPROM_ENDURANCE      100000UL    // program cycles per block we design for
+
+//session registers
+#define NTAG5_REG_STATUS            0x10A0  // REGA 0..1
+#define NTAG5_REG_CONFIG            0x10A1  // REGA 0..2
+#define NTAG5_REG_SYNC_DATA_BLOCK   0x10A2
+#define NTAG5_REG_EH_CONFIG         0x10A7  // REGA 0
+#define NTAG5_REG_ED_CONFIG         0x10A8  // REGA 0
+#define NTAG5_REG_ED_INTR_CLEAR     0x10A9
+#define NTAG5_REG_I2C_MASTER_STATUS 0x10AD  // REGA 0
+//configuration blocks holding the power-on values of the session registers
+#define NTAG5_CFG_CONFIG            0x1037
+#define NTAG5_CFG_EH_CONFIG         0x103D
+
+//NTAG5_REG_STATUS byte 0
+#define NTAG5_STATUS0_EEPROM_WR_BUSY    0x80
+#define NTAG5_STATUS0_EEPROM_WR_ERROR   0x40
+#define NTAG5_STATUS0_SRAM_DATA_READY   0x20
+#define NTAG5_STATUS0_SYNCH_BLOCK_WRITE 0x10
+#define NTAG5_STATUS0_SYNCH_BLOCK_READ  0x08
+#define NTAG5_STATUS0_PT_TRANSFER_DIR   0x04
+#define NTAG5_STATUS0_VCC_SUPPLY_OK     0x02
+#define NTAG5_STATUS0_NFC_FIELD_OK      0x01
+//NTAG5_REG_STATUS byte 1
+#define NTAG5_STATUS1_VCC_BOOT_OK       0x08
+#define NTAG5_STATUS1_NFC_BOOT_OK       0x04
+#define NTAG5_STATUS1_ACTIVE_I2C        0x02
+#define NTAG5_STATUS1_ACTIVE_NFC        0x01
+
+//NTAG5_REG_CONFIG byte 1
+#define NTAG5_CONFIG1_ARBITER_MASK      0x0C
+#define NTAG5_CONFIG1_ARBITER_NORMAL    0x00
+#define NTAG5_CONFIG1_ARBITER_MIRROR    0x04    // SRAM mapped over user blocks 0..63
+#define NTAG5_CONFIG1_ARBITER_PASS      0x08    // pass-through
+#define NTAG5_CONFIG1_SRAM_ENABLE       0x02
+#define NTAG5_CONFIG1_PT_TRANSFER_DIR   0x01
+#define NTAG5_CONFIG1_USE_CASE_MASK     0x30
+#define NTAG5_CONFIG1_USE_CASE_SLAVE    0x00
+#define NTAG5_CONFIG1_USE_CASE_MASTER   0x10    // tag drives I2C, slave interface off
+#define NTAG5_SRAM_MIRROR_BLOCK         0x0000  // first user block replaced by SRAM
+
+//NTAG5_REG_ED_CONFIG byte 0, event signalled on the open-drain ED pin
+#define NTAG5_ED_MASK                   0x0F
+#define NTAG5_ED_DISABLED               0x00
+#define NTAG5_ED_NFC_FIELD              0x01    // ED low while a reader field is present
+
+//NTAG5_REG_EH_CONFIG byte 0, energy harvesting output VOUT
+#define NTAG5_EH_ENABLE                 0x01
+#define NTAG5_EH_VOUT_MASK              0x0E
+#define NTAG5_EH_VOUT_1V8               0x00
+#define NTAG5_EH_VOUT_2V4               0x02
+#define NTAG5_EH_VOUT_3V0               0x04
+
+//NTAG5_REG_I2C_MASTER_STATUS byte 0, outcome of the last RF I2C command
+#define NTAG5_I2C_M_BUSY                0x01
+#define NTAG5_I2C_M_TRANS_MASK          0x06
+#define NTAG5_I2C_M_TRANS_OK            0x00
+#define NTAG5_I2C_M_NACK_ADDR           0x02
+#define NTAG5_I2C_M_NACK_DATA           0x04
+
+//NFC type 5 tag layout: CC in block 0, NDEF TLV from block 1
+#define NTAG5_CC_BLOCK              0
+#define NTAG5_NDEF_BLOCK            1
+#define NTAG5_CC                    { 0xE1, 0x40, 0xFF, 0x01 }  // v1.0 rw, 2040 bytes, MBREAD
+#define NTAG5_MAX_TLV_NDEF          0xFE    // one-byte TLV length
+#define NTAG5_MAX_SRAM_NDEF         (NTAG5_SRAM_BLOCKS * NTAG5_BLOCK_SIZE - NTAG5_BLOCK_SIZE - 3)  // CC, TLV header and terminator in SRAM
+
+class Ntag5
+{
+public:
+    static bool begin();
+
+    // user memory / SRAM / configuration, whole blocks
+    static bool readBlocks(uint16_t block, uint8_t* data, uint8_t count);
+    static bool writeBlocks(uint16_t block, const uint8_t* data, uint8_t count);
+    static bool updateBlocks(uint16_t block, const uint8_t* data, uint8_t count);    // changed blocks only
+
+    // session registers, one byte at a time
+    static bool readSessionReg(uint16_t reg, uint8_t index, uint8_t& value);
+    static bool writeSessionReg(uint16_t reg, uint8_t index, uint8_t mask, uint8_t value);
+
+    static bool status(uint8_t& status0);
+    static bool waitEepromIdle(uint16_t timeoutMs);
+    static bool setEventDetect(uint8_t event);
+
+    // NDEF
+    static bool formatCapabilityContainer(bool& written);
+    static bool writeNdef(const uint8_t* message, uint16_t len);
+    static bool writeNdefText(const char* text);
+
+    // SRAM mirror publishing
+    static bool setSramMirror(bool on);
+    static bool sramMirror(bool& on);
+    static bool publishLive(const char* text);
+
+    // EEPROM wear
+    static uint32_t wear(uint16_t block);
+    static uint32_t hottestWear();
+    static uint32_t remainingCycles();
+    static void restoreWear(uint32_t cycles);
+
+    static uint16_t blocksWritten;  // EEPROM blocks programmed since boot
+    static uint16_t blocksSkipped;  // unchanged blocks updateBlocks() left alone
+
+private:
+    static bool isEeprom(uint16_t block);
+    static void initWear();
+    static void countWear(uint16_t block, uint8_t count);
+    static bool streamText(uint16_t block, bool withCc, const char* text, bool headLast = false);
+};
+
+#endif /* NTAG5_H_ */
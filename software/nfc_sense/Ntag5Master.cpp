@@ -0,0 +1,121 @@
+#include "Ntag5Master.h"
+
+/**
+**  @brief  Applies a configuration table. Configuration blocks are read,
+**          changed and programmed only if a masked byte differs; session
+**          registers are written directly.
+**  @param  bool&   written     true if a configuration block was programmed
+**  @retrun bool    false on bus error
+**/
+bool Ntag5Master::provision(const Ntag5ConfigWrite* table, uint8_t count, bool& written)
+{
+    written = false;
+    for (uint8_t i = 0; i < count; i++)
+    {
+        const Ntag5ConfigWrite& entry = table[i];
+        if (entry.block >= NTAG5_REG_STATUS && entry.block < NTAG5_REG_STATUS + 0x10)
+        {
+            if (!Ntag5::writeSessionReg(entry.block, entry.index, entry.mask, entry.value))
+                return false;
+            continue;
+        }
+
+        uint8_t block[NTAG5_BLOCK_SIZE];
+        if (!Ntag5::readBlocks(entry.block, block, 1))
+            return false;
+        uint8_t value = (block[entry.index] & ~entry.mask) | (entry.value & entry.mask);
+        if (value == block[entry.index])
+            continue;
+        block[entry.index] = value;
+        if (!Ntag5::writeBlocks(entry.block, block, 1))
+            return false;
+        written = true;
+    }
+    return true;
+}
+
+/**
+**  @brief  Whether the master use case is configured for the next power-up.
+**          A tag already running as master does not answer at all.
+**/
+bool Ntag5Master::isMaster(bool& master)
+{
+    uint8_t block[NTAG5_BLOCK_SIZE];
+    if (!Ntag5::readBlocks(NTAG5_CFG_CONFIG, block, 1))
+        return false;
+    master = (block[1] & NTAG5_CONFIG1_USE_CASE_MASK) == NTAG5_CONFIG1_USE_CASE_MASTER;
+    return true;
+}
+
+/**
+**  @brief  Decodes the op at recipe
+**  @retrun const uint8_t*  the following op, 0 at NTAG5_OP_END
+**/
+const uint8_t* Ntag5Master::next(const uint8_t* recipe, Ntag5MasterOp& op)
+{
+    op.kind = recipe[0];
+    op.addr = 0;
+    op.len = 0;
+    op.data = 0;
+    switch (op.kind)
+    {
+    case NTAG5_OP_WRITE:
+        op.addr = recipe[1];
+        op.len = recipe[2];
+        op.data = recipe + 3;
+        return recipe + 3 + op.len;
+    case NTAG5_OP_READ:
+        op.addr = recipe[1];
+        op.len = recipe[2];
+        return recipe + 3;
+    case NTAG5_OP_WAIT:
+        op.len = recipe[1];
+        return recipe + 2;
+    default:
+        op.kind = NTAG5_OP_END;
+        return 0;
+    }
+}
+
+/**
+**  @brief  Bytes all reads of a recipe return, in order
+**/
+uint8_t Ntag5Master::resultLength(const uint8_t* recipe)
+{
+    uint8_t total = 0;
+    Ntag5MasterOp op;
+    while ((recipe = next(recipe, op)))
+        if (op.kind == NTAG5_OP_READ)
+            total += op.len;
+    return total;
+}
+
+/**
+**  @brief  NTAG5_RECIPE_TMP112 result: 12-bit left aligned, 0.0625 C/LSB
+**/
+int16_t Ntag5Master::tmp112CentiCelsius(const uint8_t* result)
+{
+    int16_t raw = (int16_t)((uint16_t)result[0] << 8 | result[1]);
+    return (int16_t)(((int32_t)raw * 25) >> 6);
+}
+
+/**
+**  @brief  NTAG5_RECIPE_BME280_CAL result into Bme280::cal
+**/
+void Ntag5Master::bme280Calibration(const uint8_t* result)
+{
+    Bme280::parseCalibration(result, result + 26);
+}
+
+/**
+**  @brief  NTAG5_RECIPE_BME280 result, needs the calibration first
+**/
+void Ntag5Master::bme280Decode(const uint8_t* result, Bme280Data& data)
+{
+    int32_t adcP = (int32_t)result[0] << 12 | (int32_t)result[1] << 4 | result[2] >> 4;
+    int32_t adcT = (int32_t)result[3] << 12 | (int32_t)result[4] << 4 | result[5] >> 4;
+    int32_t adcH = (int32_t)result[6] << 8 | result[7];
+    data.centiCelsius = Bme280::compensateTemperature(adcT);
+    data.pascal = Bme280::compensatePressure(adcP);
+    data.humidityPermille = (uint16_t)((Bme280::compensateHumidity(adcH) * 10 + 512) >> 10);
+}
@@ -0,0 +1,136 @@
+//  NTAG 5 Link as I2C master, for the boards without MCU
+//  -----------------------------------------
+//  nfc_sense_ntag_surface (TMP112) and nfc_sense_ntag_BME (BME280) carry
+//  only the tag and the sensor. With the I2C master use case and energy
+//  harvesting configured, the reader field powers VOUT, VOUT powers the
+//  sensor, and the reader runs the sensor through the tag with the NXP
+//  custom commands:
+//
+//      WRITE_I2C   D4h  param, len - 1, data     reader bytes to the slave
+//      READ_I2C    D5h  param, len - 1           slave bytes into SRAM
+//      READ_SRAM   D2h  block, count - 1         the result
+//
+//  param is the 7-bit slave address, bit 7 suppresses the STOP condition.
+//  NTAG5_REG_I2C_MASTER_STATUS tells whether the slave acknowledged.
+//
+//  This file holds the two halves that do not depend on who talks to the
+//  tag:
+//   - configuration tables (use case, VOUT) applied once, over I2C from a
+//     programming jig on the test points with provision(), or over RF
+//     with WRITE_CONFIG. Once the master use case is active after the next
+//     power-up the tag no longer answers as an I2C slave.
+//   - sensor recipes: byte-coded I2C transactions and waits a reader
+//     replays, plus the decoders for what comes back.
+//
+//  Recipe encoding, one op after the other:
+//      NTAG5_OP_WRITE  addr, len, data[len]
+//      NTAG5_OP_READ   addr, len                 len result bytes
+//      NTAG5_OP_WAIT   ms
+//      NTAG5_OP_END
+
+#ifndef NTAG5_MASTER_H_
+#define NTAG5_MASTER_H_
+#if ARDUINO >= 100
+ #include "Arduino.h"
+#else
+ #include "WProgram.h"
+#endif
+#include "Ntag5.h"
+#include "Bme280.h"
+
+//ISO 15693 custom commands, NXP manufacturer code
+#define NTAG5_CMD_READ_CONFIG       0xC0
+#define NTAG5_CMD_WRITE_CONFIG      0xC1
+#define NTAG5_CMD_READ_SRAM         0xD2
+#define NTAG5_CMD_WRITE_SRAM        0xD3
+#define NTAG5_CMD_WRITE_I2C         0xD4
+#define NTAG5_CMD_READ_I2C          0xD5
+#define NTAG5_MFG_CODE_NXP          0x04
+#define NTAG5_I2C_PARAM_NO_STOP     0x80
+
+#define NTAG5_OP_END                0x00
+#define NTAG5_OP_WRITE              0x01
+#define NTAG5_OP_READ               0x02
+#define NTAG5_OP_WAIT               0x03
+
+#define NTAG5_VOUT_SETTLE_MS        2       // VOUT up to the sensor's POR, before the first op
+
+struct Ntag5ConfigWrite
+{
+    uint16_t block;     // NTAG5_CFG_* (persistent) or NTAG5_REG_* (session)
+    uint8_t  index;
+    uint8_t  mask;
+    uint8_t  value;
+};
+
+struct Ntag5MasterOp
+{
+    uint8_t        kind;    // NTAG5_OP_*
+    uint8_t        addr;
+    uint8_t        len;     // bytes to write / read, ms to wait
+    const uint8_t* data;
+};
+
+//  Persistent configuration of the MCU-less boards: master use case, VOUT
+//  at 2.4 V (TMP112 and BME280 both run from 1.71 V, the margin is for the
+//  4.7k pull-ups)
+static const Ntag5ConfigWrite NTAG5_MCULESS_CONFIG[] = {
+    { NTAG5_CFG_CONFIG,    1, NTAG5_CONFIG1_USE_CASE_MASK, NTAG5_CONFIG1_USE_CASE_MASTER },
+    { NTAG5_CFG_EH_CONFIG, 0, NTAG5_EH_ENABLE | NTAG5_EH_VOUT_MASK, NTAG5_EH_ENABLE | NTAG5_EH_VOUT_2V4 },
+};
+
+//  Same settings for the running session only, e.g. to try a board on the
+//  jig without touching the configuration EEPROM
+static const Ntag5ConfigWrite NTAG5_MCULESS_SESSION[] = {
+    { NTAG5_REG_EH_CONFIG, 0, NTAG5_EH_ENABLE | NTAG5_EH_VOUT_MASK, NTAG5_EH_ENABLE | NTAG5_EH_VOUT_2V4 },
+    { NTAG5_REG_CONFIG,    1, NTAG5_CONFIG1_USE_CASE_MASK, NTAG5_CONFIG1_USE_CASE_MASTER },
+};
+
+//  TMP112: one-shot from shutdown, 35 ms conversion, 2 byte result
+static const uint8_t NTAG5_RECIPE_TMP112[] = {
+    NTAG5_OP_WAIT,  NTAG5_VOUT_SETTLE_MS,
+    NTAG5_OP_WRITE, 0x48, 3, 0x01, 0xE1, 0xA0,      // CONFIG: OS | SD | CR1 | R1 R0 | AL
+    NTAG5_OP_WAIT,  35,
+    NTAG5_OP_WRITE, 0x48, 1, 0x00,                  // pointer to TEMP
+    NTAG5_OP_READ,  0x48, 2,
+    NTAG5_OP_END
+};
+
+//  BME280 calibration, once per board: 26 + 7 byte result
+static const uint8_t NTAG5_RECIPE_BME280_CAL[] = {
+    NTAG5_OP_WAIT,  NTAG5_VOUT_SETTLE_MS,
+    NTAG5_OP_WRITE, BME280_I2C_ADDRESS, 1, BME280_REG_CALIB_00,
+    NTAG5_OP_READ,  BME280_I2C_ADDRESS, 26,
+    NTAG5_OP_WRITE, BME280_I2C_ADDRESS, 1, BME280_REG_CALIB_26,
+    NTAG5_OP_READ,  BME280_I2C_ADDRESS, 7,
+    NTAG5_OP_END
+};
+
+//  BME280 forced measurement, x1 oversampling everywhere: 8 byte result
+static const uint8_t NTAG5_RECIPE_BME280[] = {
+    NTAG5_OP_WAIT,  NTAG5_VOUT_SETTLE_MS,
+    NTAG5_OP_WRITE, BME280_I2C_ADDRESS, 4, BME280_REG_CTRL_HUM, 0x01, BME280_REG_CTRL_MEAS, 0x25,
+    NTAG5_OP_WAIT,  10,
+    NTAG5_OP_WRITE, BME280_I2C_ADDRESS, 1, BME280_REG_DATA,
+    NTAG5_OP_READ,  BME280_I2C_ADDRESS, 8,
+    NTAG5_OP_END
+};
+
+class Ntag5Master
+{
+public:
+    // configuration, over the tag's I2C slave interface
+    static bool provision(const Ntag5ConfigWrite* table, uint8_t count, bool& written);
+    static bool isMaster(bool& master);
+
+    // recipes
+    static const uint8_t* next(const uint8_t* recipe, Ntag5MasterOp& op);
+    static uint8_t resultLength(const uint8_t* recipe);
+
+    // results
+    static int16_t tmp112CentiCelsius(const uint8_t* result);
+    static void bme280Calibration(const uint8_t* result);
+    static void bme280Decode(const uint8_t* result, Bme280Data& data);
+};
+
+#endif /* NTAG5_MASTER_H_ */
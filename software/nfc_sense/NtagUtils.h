@@ -0,0 +1,84 @@
+
+
+#if ARDUINO >= 100
+ #include "Arduino.h"
+#else
+ #include "WProgram.h"
+#endif
+
+#include <Wire.h>
+#include "Ntag5.h"
+#include "WarmState.h"
+
+//  NTAG 5 Link counterpart of NfcUtils.h, same entry points so the sketch
+//  does not care which tag the board carries.
+
+#define OS_ANDROID 0
+#define OS_IOS 1
+
+//setupNFC() results
+#define NFC_ABSENT   0    // NTAG 5 did not answer
+#define NFC_WRITTEN  1    // CC block (re)written, or the SRAM mirror lost
+#define NFC_INTACT   2    // CC block in place, mirror on
+
+// the EEPROM fallback message is refreshed every NTAG_FALLBACK_EVERY
+// publishes and after every tag power-on, live values only go to SRAM
+#define NTAG_FALLBACK_EVERY 64
+
+static uint8_t fallbackAge __attribute__((section(".noinit")));
+
+/**
+**  @brief  Checks the NTAG 5 and its capability container. The user memory
+**          is EEPROM, so unlike the RF430 the layout survives power loss and
+**          the warm flag changes nothing here. Wear counters lost with
+**          power are restored from the warm state. ED is set to signal
+**          the reader field, for the field-detect wake.
+**
+**          SRAM and the arbiter mode are volatile: a tag that lost power
+**          without the MCU (brown-out, the tag rail dropping) shows the
+**          EEPROM fallback. Without the mirror the result is NFC_WRITTEN,
+**          so the sketch publishes even an unchanged reading, and the
+**          fallback is due with it.
+**  @retrun uint8_t NFC_ABSENT, NFC_WRITTEN or NFC_INTACT
+**/
+uint8_t setupNFC(bool warm)
+{
+  (void)warm;
+  bool written, mirrored;
+  if (!Ntag5::begin())
+    return NFC_ABSENT;
+  Ntag5::restoreWear(WarmState::get().tagWear);
+  if (!Ntag5::setEventDetect(NTAG5_ED_NFC_FIELD) ||
+      !Ntag5::formatCapabilityContainer(written) ||
+      !Ntag5::sramMirror(mirrored))
+    return NFC_ABSENT;
+  if (!mirrored)
+    fallbackAge = NTAG_FALLBACK_EVERY;
+  return written || !mirrored ? NFC_WRITTEN : NFC_INTACT;
+}
+
+/**
+**  @brief  Publishes nfcString as a single text record: live through the
+**          SRAM mirror, into EEPROM only when the fallback is due
+**  @retrun bool    false if the message could not be written
+**/
+bool updateNFC(int osType, String nfcString)
+{
+  (void)osType;
+  // live first: once the mirror is on the reader never sees the EEPROM
+  // being programmed, not even on the first publish after a tag power-on
+  if (!Ntag5::publishLive(nfcString.c_str()))
+    return false;
+
+  // setupNFC() makes it due when the tag came up without the mirror
+  if (fallbackAge < NTAG_FALLBACK_EVERY) {
+    fallbackAge++;
+    return true;
+  }
+  bool written = Ntag5::writeNdefText(nfcString.c_str());
+  WarmState::setTagWear(Ntag5::hottestWear());
+  if (!written)
+    return false;
+  fallbackAge = 0;
+  return true;
+}
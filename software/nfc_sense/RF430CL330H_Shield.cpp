@@ -6,51 +6,19 @@
 //link to original https://github.com/adafruit/Adafruit_NFCShield_I2C
 
 #include "RF430CL330H_Shield.h"
+#include "I2cBus.h"
 #define I2C_BUFFER_LENGTH  30   //because library Wire's I2C buffer default is 32 bytes
 
 /* Uncomment these lines to enable debug output for RF430(I2C) */
 // #define RF430DEBUG
  
-/**
-**  @brief  Sends a single byte via I2C
-**  @param  x    The byte to send
-**/
-static inline void wiresend(uint8_t x)
-{
-  #if ARDUINO >= 100
-    Wire.write((uint8_t)x);
-  #else
-    Wire.send(x);
-  #endif
-}
-
-
-/**
-**  @brief  Reads a single byte via I2C
-**/
-static inline uint8_t wirerecv(void) 
-{
-  #if ARDUINO >= 100
-    return Wire.read();
-  #else
-    return Wire.receive();
-  #endif
-}
-
-
-
-
 /**
 **  @brief  Instantiates a new RF430 class
 **  @param  irq       Location of the IRQ pin
 **  @param  reset     Location of the RSTPD_N pin
 **/
-RF430CL330H_Shield::RF430CL330H_Shield(uint8_t irq, uint8_t reset)
+RF430CL330H_Shield::RF430CL330H_Shield(uint8_t /*irq*/, uint8_t reset)
 {
-    byte RxData[2] = {0,0};
-    byte TxData[2] = {0,0};
-    byte TxAddr[2] = {0,0};
-
     //_irq = irq;
     _reset = reset;
 
@@ -59,21 +27,48 @@ RF430CL330H_Shield::RF430CL330H_Shield(uint8_t irq, uint8_t reset)
 }
 
 
+/**
+**  @brief  Polls STATUS_REG until (status & mask) == value
+**  @param  uint16_t    mask        status bits to look at
+**  @param  uint16_t    value       expected value of those bits
+**  @param  uint16_t    timeout_ms  give up after this long
+**  @retrun bool        false on timeout or bus error
+**/
+bool RF430CL330H_Shield::Wait_Status(uint16_t mask, uint16_t value, uint16_t timeout_ms)
+{
+    uint32_t start = millis();
+    for (;;)
+    {
+        uint16_t status;
+        if (!Read_Register(STATUS_REG, status))
+            return false;
+        if ((status & mask) == value)
+            return true;
+        if (millis() - start >= timeout_ms || !I2cBus::wait(RF430_POLL_INTERVAL_MS * 1000UL))
+            return false;
+    }
+}
+
+
 /** 
 **  @brief  Setups the HW 
+**  @retrun bool    false if the RF430 did not come up or stopped answering
 **/
-void RF430CL330H_Shield::begin()
+bool RF430CL330H_Shield::begin()
 {
     uint16_t version;
     Wire.begin();
+    I2cBus::begin();
     // Reset the RF430
     digitalWrite(_reset, HIGH);
     digitalWrite(_reset, LOW);
     delay(100);                   //Reset:low level 100ms
     digitalWrite(_reset, HIGH);
-    delay(1000);
+    delay(20);
     
-    while(!(Read_Register(STATUS_REG) & READY)); //wait until READY bit has been set
+    //wait until READY bit has been set
+    if (!Wait_Status(READY, READY, RF430_READY_TIMEOUT_MS))
+        return false;
 
     version = Read_Register(VERSION_REG);
     Serial.print("Fireware Version:");Serial.println(version, HEX);    
@@ -99,48 +94,66 @@ void RF430CL330H_Shield::begin()
     //Upon exit of this block, the control register is set to 0x0
     /** Fix end */
 
+    Arm_CommWatchdog(TIMEOUT_PERIOD_2_SEC);
+
     byte NDEF_Application_Data[] = RF430_iOS_working_URL;
     //write NDEF memory with Capability Container + NDEF message
-    Write_Continuous(0, NDEF_Application_Data, sizeof(NDEF_Application_Data));
+    if (!Write_Continuous(0, NDEF_Application_Data, sizeof(NDEF_Application_Data)))
+        return false;
 
     //Enable interrupts for End of Read and End of Write
     Write_Register(INT_ENABLE_REG, EOW_INT_ENABLE + EOR_INT_ENABLE);
 
     //Configure INTO pin for active low and enable RF
-    Write_Register(CONTROL_REG, INT_ENABLE + INTO_DRIVE + RF_ENABLE );
+    return Write_Register(CONTROL_REG, INT_ENABLE + INTO_DRIVE + RF_ENABLE );
+}
+
+
+/**
+**  @brief  Arms the RF430 communication watchdog: the chip resets its I2C
+**          interface on its own if a transaction stalls for longer than the
+**          period, so a hung transfer cannot pin SDA/SCL low until the next
+**          power cycle
+**  @param  uint16_t    period      TIMEOUT_PERIOD_2_SEC / _32_SEC / _8_5_MIN
+**  @retrun bool        false on bus error
+**/
+bool RF430CL330H_Shield::Arm_CommWatchdog(uint16_t period)
+{
+    return Write_Register(COMM_WD_CTRL_REG, WD_ENABLE | (period & (TIMEOUT_PERIOD_MASK)));
 }
 
 
 /** 
 **  @brief  Reads the register at reg_addr, returns the result
 **  @param  uint16_t    reg_addr    RF430 Register address
-**  @retrun uint16_t    the value of register
+**  @retrun uint16_t    the value of register, 0 on bus error
 **/
 uint16_t RF430CL330H_Shield::Read_Register(uint16_t reg_addr)
+{
+    uint16_t value;
+    return Read_Register(reg_addr, value) ? value : 0;
+}
+
+/** 
+**  @brief  Reads the register at reg_addr
+**  @param  uint16_t    reg_addr    RF430 Register address
+**  @param  uint16_t&   value       the value of register (LSB first on the bus)
+**  @retrun bool        false on bus error, see I2cBus::lastError
+**/
+bool RF430CL330H_Shield::Read_Register(uint16_t reg_addr, uint16_t& value)
 {
     TxAddr[0] = reg_addr >> 8;      // MSB of address
     TxAddr[1] = reg_addr & 0xFF;    // LSB of address TxAddr[0]TxAddr[1]
 #ifdef RF430DEBUG    
     Serial.print("Read_Register[0x");Serial.print(reg_addr, HEX);Serial.print("]:0x");
 #endif
-    //send slave addr
-    Wire.beginTransmission(RF430_I2C_ADDRESS);
-    wiresend(TxAddr[0]); //bit15~8
-    wiresend(TxAddr[1]); //bit7~0
-    Wire.endTransmission(); 
-    
-    //resend slave addr with data
-    Wire.requestFrom((uint8_t)RF430_I2C_ADDRESS, (uint8_t)2);
-    RxData[0] = wirerecv();
-    RxData[1] = wirerecv();
-    
-    //send stop
-    Wire.endTransmission();
-    
+    if (!I2cBus::writeRead(RF430_I2C_ADDRESS, TxAddr, 2, RxData, 2))
+        return false;
+    value = RxData[1] << 8 | RxData[0];
 #ifdef RF430DEBUG    
-    Serial.println(RxData[1] << 8 | RxData[0], HEX);
+    Serial.println(value, HEX);
 #endif
-    return RxData[1] << 8 | RxData[0];
+    return true;
 }
 
 /** 
@@ -150,7 +163,7 @@ uint16_t RF430CL330H_Shield::Read_Register(uint16_t reg_addr)
 **/
 uint8_t RF430CL330H_Shield::Read_OneByte(uint16_t reg_addr)
 {
-    byte buf[1];
+    byte buf[1] = {0};
     Read_Continuous(reg_addr, buf, 1);
     return buf[0];
 }
@@ -160,66 +173,30 @@ uint8_t RF430CL330H_Shield::Read_OneByte(uint16_t reg_addr)
 **  @param  uint16_t    reg_addr       RF430 Register address
 **  @param  uint8_t*    read_data      buffer for store the data
 **  @param  uint16_t    data_length    length of data    
-**  @retrun void
+**  @retrun bool        false if a chunk failed, the rest is not read
 **/
-void RF430CL330H_Shield::Read_Continuous(uint16_t reg_addr, uint8_t* read_data, uint16_t data_length)
+bool RF430CL330H_Shield::Read_Continuous(uint16_t reg_addr, uint8_t* read_data, uint16_t data_length)
 {
-    uint16_t split_num = 0;
-    uint16_t remainder = data_length;
-    uint16_t index= 0;
-
-    //splite data avoid beyond the wire buffer
-    if (data_length > I2C_BUFFER_LENGTH)
-    {
-        split_num = data_length / I2C_BUFFER_LENGTH;
-        remainder = data_length % I2C_BUFFER_LENGTH;
-    }
-    
-    for (uint8_t k=0; k < split_num+1; k++)
+    //split data to stay within the wire buffer
+    while (data_length)
     {
-        //send slave addr
-        Wire.beginTransmission(RF430_I2C_ADDRESS);
+        uint8_t chunk = data_length > I2C_BUFFER_LENGTH ? I2C_BUFFER_LENGTH : data_length;
         TxAddr[0] = reg_addr >> 8;      // MSB of address
         TxAddr[1] = reg_addr & 0xFF;    // LSB of address
-        wiresend(TxAddr[0]); //bit15~8
-        wiresend(TxAddr[1]); //bit7~0
-        Wire.endTransmission();
-
-        if (k != split_num)
-        {
-            //resend slave addr with data
-            Wire.requestFrom((uint8_t)RF430_I2C_ADDRESS, (uint8_t)I2C_BUFFER_LENGTH);
-            while (Wire.available())
-            {
-              for (uint8_t i=0; i < I2C_BUFFER_LENGTH; i++) 
-                  read_data[index+i] = wirerecv();
-            }
-
-            //increase addr
-            index += I2C_BUFFER_LENGTH;
-            reg_addr += I2C_BUFFER_LENGTH;
-        }
-        else
-        {
-            //resend slave addr with data
-            Wire.requestFrom((uint8_t)RF430_I2C_ADDRESS, remainder);
-            while (Wire.available())
-            {
-                for (uint8_t i=0; i < remainder; i++) 
-                  read_data[index+i] = wirerecv();
-            }
-        }
-
-        //send stop
-        Wire.endTransmission();
-    }
+        if (!I2cBus::writeRead(RF430_I2C_ADDRESS, TxAddr, 2, read_data, chunk))
+            return false;
 
 #ifdef RF430DEBUG    
-    Serial.print("RxData[] = 0x");
-    for (uint8_t i=0; i<data_length; i++) 
-        {Serial.print(read_data[i], HEX);Serial.print(" ");}
-    Serial.println("");
+        Serial.print("RxData[] = 0x");
+        for (uint8_t i=0; i<chunk; i++) 
+            {Serial.print(read_data[i], HEX);Serial.print(" ");}
+        Serial.println("");
 #endif
+        read_data += chunk;
+        reg_addr += chunk;
+        data_length -= chunk;
+    }
+    return true;
 }
 
 
@@ -227,30 +204,19 @@ void RF430CL330H_Shield::Read_Continuous(uint16_t reg_addr, uint8_t* read_data,
 **  @brief  writes the register at reg_addr with value
 **  @param  uint16_t    reg_addr    RF430 Register address
 **  @param  uint16_t    value       writted value   
-**  @retrun void
+**  @retrun bool        false on bus error
 **/
-void RF430CL330H_Shield::Write_Register(uint16_t reg_addr, uint16_t value)
+bool RF430CL330H_Shield::Write_Register(uint16_t reg_addr, uint16_t value)
 {
     TxAddr[0] = reg_addr >> 8;      // MSB of address
     TxAddr[1] = reg_addr & 0xFF;    // LSB of address
-    TxData[0] = value >> 8;
-    TxData[1] = value & 0xFF;
+    TxData[0] = value & 0xFF;       // LSB first
+    TxData[1] = value >> 8;
 #ifdef RF430DEBUG    
         Serial.print("Write_Register[0x");Serial.print(reg_addr, HEX);
         Serial.print("]:0x");Serial.println(value, HEX);
 #endif
-    //send slave addr
-    Wire.beginTransmission(RF430_I2C_ADDRESS);
-    wiresend(TxAddr[0]); //bit15~8
-    wiresend(TxAddr[1]); //bit7~0
-
-    //send value
-    wiresend(TxData[1]); //bit7~0
-    wiresend(TxData[0]); //bit15~8
-
-    //send stop
-    Wire.endTransmission();
-    
+    return I2cBus::writeTo(RF430_I2C_ADDRESS, TxAddr, 2, TxData, 2);
 }
 
 
@@ -259,13 +225,10 @@ void RF430CL330H_Shield::Write_Register(uint16_t reg_addr, uint16_t value)
 **  @param  uint16_t    reg_addr       RF430 Register address
 **  @param  uint8_t*    write_data     buffer for store the data
 **  @param  uint16_t    data_length    length of data    
-**  @retrun void
+**  @retrun bool        false if a chunk failed, the rest is not written
 **/
-void RF430CL330H_Shield::Write_Continuous(uint16_t reg_addr, uint8_t* write_data, uint16_t data_length)
+bool RF430CL330H_Shield::Write_Continuous(uint16_t reg_addr, uint8_t* write_data, uint16_t data_length)
 {
-    uint16_t split_num = 0;
-    uint16_t remainder = data_length;
-    uint16_t index=0;
 #ifdef RF430DEBUG    
     Serial.print("start_addr = 0x");Serial.println(reg_addr, HEX);
     Serial.print("data_length = 0x");Serial.println(data_length, HEX);
@@ -275,45 +238,20 @@ void RF430CL330H_Shield::Write_Continuous(uint16_t reg_addr, uint8_t* write_data
     Serial.println();  
 #endif
 
-    //splite data avoid beyond the wire buffer
-    if(data_length > I2C_BUFFER_LENGTH)
+    //split data to stay within the wire buffer (2 address bytes + chunk)
+    while (data_length)
     {
-        split_num = data_length / I2C_BUFFER_LENGTH;
-        remainder = data_length % I2C_BUFFER_LENGTH;
-    }
-
-    for (int k=0; k < split_num+1; k++)
-    {
-        //send slave addr
-        Wire.beginTransmission(RF430_I2C_ADDRESS);
-
-        //Serial.print("reg_addr = 0x");Serial.println(reg_addr, HEX);
+        uint8_t chunk = data_length > I2C_BUFFER_LENGTH ? I2C_BUFFER_LENGTH : data_length;
         TxAddr[0] = reg_addr >> 8;        // MSB of address
         TxAddr[1] = reg_addr & 0xFF;      // LSB of address
-        wiresend(TxAddr[0]); //bit15~8
-        wiresend(TxAddr[1]); //bit7~0
-
-        if (k != split_num)
-        {
-            //send data
-            for (uint8_t i=0; i < I2C_BUFFER_LENGTH; i++) 
-                wiresend(write_data[index+i]); 
-                
-            //increase addr
-            index += I2C_BUFFER_LENGTH;
-            reg_addr += I2C_BUFFER_LENGTH;
-        } 
-        else 
-        {
-            //send data
-            for (uint8_t i=0; i < remainder; i++) 
-                wiresend(write_data[index+i]); 
-        }
-        //send stop
-        Wire.endTransmission();
+        if (!I2cBus::writeTo(RF430_I2C_ADDRESS, TxAddr, 2, write_data, chunk))
+            return false;
 
+        write_data += chunk;
+        reg_addr += chunk;
+        data_length -= chunk;
     }
-
+    return true;
 }
 
 
@@ -321,70 +259,110 @@ void RF430CL330H_Shield::Write_Continuous(uint16_t reg_addr, uint8_t* write_data
 **  @brief  writes the NDEF message to RF430 memory
 **  @param  uint8_t*    msgNDEF     buffer for store the NDEF message
 **  @param  uint16_t    msg_length  length of message    
-**  @retrun void
+**  @retrun bool        false if the reader kept RF busy or on bus error
 **/
-void RF430CL330H_Shield::Write_NDEFmessage(uint8_t* msgNDEF, uint16_t msg_length)
+bool RF430CL330H_Shield::Write_NDEFmessage(uint8_t* msgNDEF, uint16_t msg_length)
 {
     byte buf[2];
     buf[0] = msg_length >> 8;      // MSB of message length
     buf[1] = msg_length & 0xFF;    // LSB of message length 
 
-    while (Read_Register(STATUS_REG) & RF_BUSY)
-        delay(1000);
+    if (!Wait_Status(RF_BUSY, 0, RF430_BUSY_TIMEOUT_MS))
+        return false;
         
     //clear control reg to disable RF
-    Write_Register(CONTROL_REG, Read_Register(CONTROL_REG) & ~RF_ENABLE); 
+    uint16_t control;
+    if (!Read_Register(CONTROL_REG, control) || !Write_Register(CONTROL_REG, control & ~RF_ENABLE))
+        return false;
 
     //write message data
-    Write_Continuous(0x1A, buf, 2);
-    Write_Continuous(0x1C, msgNDEF, msg_length);
+    bool ok = Write_Continuous(0x1A, buf, 2) && Write_Continuous(0x1C, msgNDEF, msg_length);
 
     //Configure INTO pin for active low and enable RF
-    Write_Register(CONTROL_REG, Read_Register(CONTROL_REG) | RF_ENABLE);
+    return Write_Register(CONTROL_REG, control | RF_ENABLE) && ok;
 }
 
-void RF430CL330H_Shield::Write_Extended_NDEFmessage(uint8_t* msgNDEF, uint16_t msg_length)
+bool RF430CL330H_Shield::Write_Extended_NDEFmessage(uint8_t* msgNDEF, uint16_t msg_length)
 {
 
     // static length 35 bytes
     // nlen at index 26 & 27
 
+#ifdef RF430DEBUG    
     Serial.println("msg_length");
     Serial.println(msg_length);
+#endif
 
     //clear control reg to disable RF
-    Write_Register(CONTROL_REG, Read_Register(CONTROL_REG) & ~RF_ENABLE);
+    uint16_t control;
+    if (!Read_Register(CONTROL_REG, control) || !Write_Register(CONTROL_REG, control & ~RF_ENABLE))
+        return false;
     
-    while (Read_Register(STATUS_REG) & RF_BUSY)
+    //a reader transfer in flight finishes within the busy timeout
+    if (!Wait_Status(RF_BUSY, 0, RF430_BUSY_TIMEOUT_MS))
     {
-        Serial.println("RF busy");
-        delay(1000);
+        Write_Register(CONTROL_REG, control | RF_ENABLE);
+        return false;
     }
-    
-    //clear control reg to disable RF
-    Write_Register(CONTROL_REG, Read_Register(CONTROL_REG) & ~RF_ENABLE); 
 
     //write message data
     // Write_Register(0x1B, 8 + msg_length);
     // Write_Register(0x1D, 0x0E);
-    Write_Continuous(0x1A, msgNDEF, msg_length);
+    bool ok = Write_Continuous(0x1A, msgNDEF, msg_length);
     // Write_Continuous(0, msgNDEF, msg_length);
-    Read_OneByte(0x1B);
 
 
     //Enable interrupts for End of Read and End of Write
-    Write_Register(INT_ENABLE_REG, EOW_INT_ENABLE + EOR_INT_ENABLE);
+    ok = Write_Register(INT_ENABLE_REG, EOW_INT_ENABLE + EOR_INT_ENABLE) && ok;
   
     //Configure INTO pin for active low and enable RF
-    Write_Register(CONTROL_REG, Read_Register(CONTROL_REG) | RF_ENABLE);
+    return Write_Register(CONTROL_REG, control | RF_ENABLE) && ok;
     
 }
 
+/**
+**  @brief  writes the NDEF message without taking the tag off the air.
+**          Two NDEF files sit at fixed places, E104 at RF430_NDEF_SLOT_A and
+**          E105 at RF430_NDEF_SLOT_B, each RF430_NDEF_MAX_SIZE long. The
+**          message goes to the one the CC does not point to while RF stays
+**          enabled, then one 2-byte write of the CC's File Control TLV makes
+**          it the NDEF file. A reader that selected the CC before that still
+**          finds its file unchanged; the old slot is only rewritten on the
+**          next update.
+**  @param  uint8_t*    msgNDEF     NLEN followed by the message
+**  @param  uint16_t    msg_length  length of both
+**  @retrun bool        false if the message does not fit a slot, the reader
+**                      kept RF busy or on bus error; the tag then still
+**                      shows the previous message
+**/
+bool RF430CL330H_Shield::Write_Buffered_NDEFmessage(uint8_t* msgNDEF, uint16_t msg_length)
+{
+    if (msg_length > RF430_NDEF_MAX_SIZE)
+        return false;
+
+    //the CC names the file a reader gets now, write the other one
+    byte fileId[2];
+    if (!Read_Continuous(RF430_CC_NDEF_FILE_ID, fileId, 2))
+        return false;
+    bool toB = (fileId[0] << 8 | fileId[1]) != RF430_NDEF_FILE_B;
+    uint16_t slot = toB ? RF430_NDEF_SLOT_B : RF430_NDEF_SLOT_A;
+    fileId[0] = (toB ? RF430_NDEF_FILE_B : RF430_NDEF_FILE_A) >> 8;
+    fileId[1] = (toB ? RF430_NDEF_FILE_B : RF430_NDEF_FILE_A) & 0xFF;
+
+    if (!Write_Continuous(slot, fileId, 2) || !Write_Continuous(slot + 2, msgNDEF, msg_length))
+        return false;
+
+    //switch between reader transfers, the only write a reader can notice
+    if (!Wait_Status(RF_BUSY, 0, RF430_BUSY_TIMEOUT_MS))
+        return false;
+    return Write_Continuous(RF430_CC_NDEF_FILE_ID, fileId, 2);
+}
+
 /**  @brief  set NDEF message is read-only
 **  @param  uint8_t    onOff     true: read-only
-**  @retrun void
+**  @retrun bool       false if the reader kept RF busy or on bus error
 **/
-void RF430CL330H_Shield::SetReadOnly(uint8_t onOff)
+bool RF430CL330H_Shield::SetReadOnly(uint8_t onOff)
 {
     byte buf[1];
     
@@ -393,14 +371,16 @@ void RF430CL330H_Shield::SetReadOnly(uint8_t onOff)
     else
         buf[0] = 0x00;
         
-    while (Read_Register(STATUS_REG) & RF_BUSY)
-        delay(1000);
+    if (!Wait_Status(RF_BUSY, 0, RF430_BUSY_TIMEOUT_MS))
+        return false;
     //clear control reg to disable RF
-    Write_Register(CONTROL_REG, Read_Register(CONTROL_REG) & ~RF_ENABLE); 
+    uint16_t control;
+    if (!Read_Register(CONTROL_REG, control) || !Write_Register(CONTROL_REG, control & ~RF_ENABLE))
+        return false;
 
     //write access data
-    Write_Continuous(0x17, buf, 1); 
+    bool ok = Write_Continuous(0x17, buf, 1); 
     
     //Configure INTO pin for active low and enable RF
-    Write_Register(CONTROL_REG, Read_Register(CONTROL_REG) | RF_ENABLE); 
+    return Write_Register(CONTROL_REG, control | RF_ENABLE) && ok; 
 }
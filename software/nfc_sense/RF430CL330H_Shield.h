@@ -55,6 +55,19 @@
 #define RF430_I2C_READY                     (0x01)
 #define RF430_I2C_READYTIMEOUT              (20)
 
+//bounded waits, nothing polls the RF430 forever
+#define RF430_READY_TIMEOUT_MS              (100)   //after reset
+#define RF430_BUSY_TIMEOUT_MS               (500)   //reader transfer in progress
+#define RF430_POLL_INTERVAL_MS              (5)
+
+//double-buffered NDEF file, see Write_Buffered_NDEFmessage()
+#define RF430_CC_NDEF_FILE_ID               (0x12)  //File Identifier of the CC's File Control TLV
+#define RF430_NDEF_MAX_SIZE                 (0xF0)  //per file incl. NLEN, as announced in the CC
+#define RF430_NDEF_SLOT_A                   (0x18)  //file ID, NLEN at 0x1A, message
+#define RF430_NDEF_SLOT_B                   (RF430_NDEF_SLOT_A + 2 + RF430_NDEF_MAX_SIZE)
+#define RF430_NDEF_FILE_A                   (0xE104)
+#define RF430_NDEF_FILE_B                   (0xE105)
+
 #define BIT(_bit_)          (1 << (_bit_))
 #define BIT0                0x0001
 #define BIT1                0x0002
@@ -233,22 +246,27 @@ class RF430CL330H_Shield
 {
 public:
     RF430CL330H_Shield(uint8_t irq, uint8_t reset);
-    void begin();
+    bool begin();
     
     uint16_t Read_Register(uint16_t reg_addr);
+    bool Read_Register(uint16_t reg_addr, uint16_t& value);
     uint8_t Read_OneByte(uint16_t reg_addr); 
-    void Read_Continuous(uint16_t reg_addr, uint8_t* read_data, uint16_t data_length);
+    bool Read_Continuous(uint16_t reg_addr, uint8_t* read_data, uint16_t data_length);
+
+    bool Write_Register(uint16_t reg_addr, uint16_t value);
+    bool Write_Continuous(uint16_t reg_addr, uint8_t* write_data, uint16_t data_length);
+    bool Write_NDEFmessage(uint8_t* msgNDEF, uint16_t msg_length);
+    bool Write_Extended_NDEFmessage(uint8_t* msgNDEF, uint16_t msg_length);
+    bool Write_Buffered_NDEFmessage(uint8_t* msgNDEF, uint16_t msg_length);
+    bool SetReadOnly(uint8_t onOff);
 
-    void Write_Register(uint16_t reg_addr, uint16_t value);
-    void Write_Continuous(uint16_t reg_addr, uint8_t* write_data, uint16_t data_length);
-    void Write_NDEFmessage(uint8_t* msgNDEF, uint16_t msg_length);
-    void Write_Extended_NDEFmessage(uint8_t* msgNDEF, uint16_t msg_length);
-    void SetReadOnly(uint8_t onOff);
+    bool Wait_Status(uint16_t mask, uint16_t value, uint16_t timeout_ms);
+    bool Arm_CommWatchdog(uint16_t period);
 private:
     byte RxData[2];
     byte TxData[2];
     byte TxAddr[2];
-    
+
     uint8_t _irq, _reset;
 };
 
@@ -0,0 +1,70 @@
+#include "Rail.h"
+#include "Standby.h"
+
+uint16_t Rail::powerUps = 0;
+uint8_t Rail::gate = 0;
+uint8_t Rail::holders = 0;
+uint32_t Rail::onSince = 0;
+
+/**
+**  @brief  Takes the load switch enable, rail off
+**  @param  uint8_t gatePin     enable, active high
+**/
+void Rail::begin(uint8_t gatePin)
+{
+    gate = gatePin;
+    holders = 0;
+    digitalWrite(gate, LOW);
+    pinMode(gate, OUTPUT);
+}
+
+/**
+**  @brief  Rail on for users (RAIL_*)
+**  @retrun bool    true if it was off: the parts come from power-on reset
+**/
+bool Rail::acquire(uint8_t users)
+{
+    bool off = !holders;
+    holders |= users;
+    if (off && holders)
+    {
+        digitalWrite(gate, HIGH);
+        onSince = micros();
+        powerUps++;
+        return true;
+    }
+    return false;
+}
+
+/**
+**  @brief  Sleeps in standby until ms after the rail came on, returns at
+**          once if that has passed or the rail is off
+**/
+void Rail::settle(uint16_t ms)
+{
+    if (!holders)
+        return;
+    uint32_t on = micros() - onSince;
+    uint32_t need = ms * 1000UL;
+    if (on >= need)
+        return;
+    Standby::sleep((need - on) / 1000 + 1);     // RTC ticks are 0.98 ms
+    onSince = micros() - need;      // micros() stood still in standby
+}
+
+/**
+**  @brief  Rail off once no user holds it
+**/
+void Rail::release(uint8_t users)
+{
+    if (!holders)
+        return;
+    holders &= ~users;
+    if (!holders)
+        digitalWrite(gate, LOW);
+}
+
+bool Rail::powered()
+{
+    return holders != 0;
+}
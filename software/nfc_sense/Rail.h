@@ -0,0 +1,52 @@
+//  Switched supply for the sensor and the e-paper panel
+//  -----------------------------------------
+//  With BOARD_PIN_RAIL_GATE the sensor and the panel sit behind a load
+//  switch and are only powered around a cycle that uses them; asleep they
+//  draw its off leakage instead of the TMP112's shutdown and the SSD1680's
+//  deep sleep current. The tag stays on VCC (it wakes the MCU), and so do
+//  the I2C pull-ups: the sensors' SDA/SCL inputs have no diode to their
+//  supply, so a powered bus does not feed an unpowered sensor.
+//
+//  acquire() switches the rail on for a set of users and tells whether it
+//  was off; the parts then start from their power-on state and need their
+//  start-up time before the first access. settle() waits the rest of it in
+//  standby (Standby.h), so bus work done after acquire(), e.g. the tag
+//  setup, overlaps the start-up. release() switches the rail off once the
+//  last user is done; drivers park their pins low before that (e.g.
+//  Epd::powerOff()), an output driven high would feed the part through its
+//  input clamp.
+//
+//  Settle times are measured from acquire() with micros(), which does not
+//  count time in standby: between acquire() and settle() only run code
+//  that keeps the CPU awake.
+
+#ifndef RAIL_H_
+#define RAIL_H_
+#if ARDUINO >= 100
+ #include "Arduino.h"
+#else
+ #include "WProgram.h"
+#endif
+
+//users
+#define RAIL_SENSOR     0x01
+#define RAIL_DISPLAY    0x02
+
+class Rail
+{
+public:
+    static void begin(uint8_t gatePin);
+    static bool acquire(uint8_t users);     // true if it switched the rail on
+    static void settle(uint16_t ms);        // at least ms since the rail came on
+    static void release(uint8_t users);
+    static bool powered();
+
+    static uint16_t powerUps;
+
+private:
+    static uint8_t gate;
+    static uint8_t holders;
+    static uint32_t onSince;                // micros() at power-up
+};
+
+#endif /* RAIL_H_ */
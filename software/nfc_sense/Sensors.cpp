@@ -0,0 +1,29 @@
+#include "Sensors.h"
+
+uint8_t formatCentiCelsius(char* out, int16_t centi)
+{
+    uint8_t n = 0;
+    int32_t value = centi;
+    if (value < 0)
+    {
+        out[n++] = '-';
+        value = -value;
+    }
+    uint16_t tenths = (uint16_t)((value + 5) / 10);
+    uint16_t whole = tenths / 10;
+
+    char digits[5];
+    uint8_t d = 0;
+    do
+    {
+        digits[d++] = '0' + whole % 10;
+        whole /= 10;
+    } while (whole);
+    while (d)
+        out[n++] = digits[--d];
+
+    out[n++] = '.';
+    out[n++] = '0' + tenths % 10;
+    out[n] = 0;
+    return n;
+}
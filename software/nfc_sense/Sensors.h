@@ -0,0 +1,400 @@
+//  Compile-time temperature sensor policies
+//  -----------------------------------------
+//  Every policy is a struct of static members, no objects, no virtuals:
+//
+//      ADDRESS             7-bit I2C address
+//      CONVERSION_MS       worst case one-shot conversion time
+//      POWER_UP_MS         supply on to the first bus access (Rail.h), for
+//                          a part that converts by itself: to its result
+//      POWER_UP_CONVERTS   the part starts converting at power-up, its
+//                          first result is fetched instead of triggering one
+//      SCALE_MUL/SHIFT     centi-degrees = (raw * SCALE_MUL) >> SCALE_SHIFT
+//      ID                  sensor id, persisted with the warm-boot state
+//      begin()             probe and put the part into one-shot/shutdown
+//                          (the TMP117 keeps that state in its EEPROM)
+//      resume()            warm boot: restore RAM-side settings, no bus traffic
+//      startConversion()   trigger one conversion
+//      ready()             conversion finished
+//      readRaw(raw)        fetch the raw result
+//
+//  The TMP1xx parts can also convert by themselves at a low rate and drive
+//  ALERT (open drain, low while active) in thermostat mode: active from a
+//  reading at or above the high limit until one below the low limit, so
+//  the limits give the hysteresis (FieldWake.h wakes on both edges):
+//
+//      ALERT_PERIOD_MS     time between two conversions while armed
+//      ALERT_FAULTS        readings past a limit before ALERT changes
+//      armAlert(high, low) raw limits, then continuous conversions
+//
+//  The board sensor is picked in BoardConfig.h and exposed as BoardSensor,
+//  so the build only links the code for the part that is actually placed.
+
+#ifndef SENSORS_H_
+#define SENSORS_H_
+
+#include "BoardConfig.h"
+#include "I2cBus.h"
+#include "Bme280.h"
+
+//  TMP117 -- 7.8125 mC/LSB, one-shot without averaging
+//
+//  The part loads CONFIG and the limits from its EEPROM at power-up.
+//  begin() programs our settings there once (provision()) and marks them
+//  with EEPROM_TAG in EEPROM1; after that a boot only reads the tag back
+//  and the part already sits in shutdown with AVG = 0 and the ALERT
+//  limits set. EEPROM1 held a third of the factory NIST ID, which nothing
+//  here reads. Change EEPROM_VERSION when the image changes meaning; a
+//  change of the values changes the tag by itself.
+struct Tmp117
+{
+    static const uint8_t  ID            = 1;
+    static const uint8_t  ADDRESS       = 0x48;
+    static const uint16_t CONVERSION_MS = 16;
+    static const uint16_t POWER_UP_MS   = 2;        // 1.5 ms reset, loads the EEPROM image
+    static const bool     POWER_UP_CONVERTS = false;
+    static const int16_t  SCALE_MUL     = 25;       // 0.78125 = 25 / 32
+    static const uint8_t  SCALE_SHIFT   = 5;
+
+    static const uint16_t ALERT_PERIOD_MS = 16000;
+    static const uint8_t  ALERT_FAULTS  = 1;
+
+    static const uint8_t  REG_TEMP      = 0x00;
+    static const uint8_t  REG_CONFIG    = 0x01;
+    static const uint8_t  REG_HIGH      = 0x02;
+    static const uint8_t  REG_LOW       = 0x03;
+    static const uint8_t  REG_EEPROM_UL = 0x04;
+    static const uint8_t  REG_EEPROM1   = 0x05;
+    static const uint8_t  REG_DEVICE_ID = 0x0F;
+
+    static const uint16_t CFG_DATA_READY = 0x2000;
+    static const uint16_t CFG_SHUTDOWN   = 0x0400;  // MOD = 01
+    static const uint16_t CFG_ONE_SHOT   = 0x0C00;  // MOD = 11, AVG = 0
+    static const uint16_t CFG_ALERT      = 0x0390;  // MOD = 00, CONV = 111 (16 s), AVG = 0, therm mode
+
+    static const uint16_t EEPROM_UNLOCK  = 0x8000;  // EUN
+    static const uint16_t EEPROM_BUSY    = 0x4000;
+    static const uint16_t EEPROM_WRITE_MS = 7;
+
+    //  power-up image
+    static const uint16_t EEPROM_VERSION = 1;
+    static const uint16_t EEPROM_CONFIG  = CFG_SHUTDOWN;
+    static const int16_t  EEPROM_HIGH    = (int16_t)((int32_t)ALERT_HIGH_CENTI * 32 / 25);
+    static const int16_t  EEPROM_LOW     = (int16_t)((int32_t)(ALERT_HIGH_CENTI - ALERT_HYSTERESIS_CENTI) * 32 / 25);
+    static const uint16_t EEPROM_TAG     = (uint16_t)((0xA500 + EEPROM_VERSION) ^ EEPROM_CONFIG ^
+                                                      (uint16_t)EEPROM_HIGH ^ (uint16_t)EEPROM_LOW);
+
+    static bool begin()
+    {
+        uint16_t tag;
+        if (!I2cBus::readReg16(ADDRESS, REG_EEPROM1, tag))
+            return false;
+        return tag == EEPROM_TAG || provision();
+    }
+
+    /**
+    **  @brief  Probes the part and programs the power-up image, the tag
+    **          last, so an interrupted provisioning is redone on the next
+    **          boot. About 30 ms, once per part.
+    **  @retrun bool    false on bus error, another part or EEPROM timeout
+    **/
+    static bool provision()
+    {
+        uint16_t id;
+        if (!I2cBus::readReg16(ADDRESS, REG_DEVICE_ID, id) || (id & 0x0FFF) != 0x0117)
+            return false;
+        if (!I2cBus::writeReg16(ADDRESS, REG_EEPROM_UL, EEPROM_UNLOCK))
+            return false;
+        bool ok = program(REG_CONFIG, EEPROM_CONFIG) && program(REG_HIGH, EEPROM_HIGH) &&
+                  program(REG_LOW, EEPROM_LOW) && program(REG_EEPROM1, EEPROM_TAG);
+        return I2cBus::writeReg16(ADDRESS, REG_EEPROM_UL, 0) && ok;
+    }
+
+    static bool program(uint8_t reg, uint16_t value)
+    {
+        if (!I2cBus::writeReg16(ADDRESS, reg, value) || !I2cBus::wait(EEPROM_WRITE_MS * 1000UL))
+            return false;
+        uint16_t waited = 0;
+        uint16_t lock = EEPROM_BUSY;
+        while (I2cBus::readReg16(ADDRESS, REG_EEPROM_UL, lock) && (lock & EEPROM_BUSY))
+        {
+            if (++waited > EEPROM_WRITE_MS || !I2cBus::wait(1000))
+                return false;
+        }
+        return !(lock & EEPROM_BUSY);
+    }
+
+    static bool resume()
+    {
+        return true;
+    }
+
+    static bool startConversion()
+    {
+        return I2cBus::writeReg16(ADDRESS, REG_CONFIG, CFG_ONE_SHOT);
+    }
+
+    static bool ready()
+    {
+        uint16_t config;
+        return I2cBus::readReg16(ADDRESS, REG_CONFIG, config) && (config & CFG_DATA_READY);
+    }
+
+    //  the image's limits are in the registers since power-up, only other
+    //  ones are written; the firmware arms one pair per build
+    static bool armAlert(int16_t high, int16_t low)
+    {
+        if (high != EEPROM_HIGH || low != EEPROM_LOW)
+        {
+            if (!I2cBus::writeReg16(ADDRESS, REG_HIGH, high) || !I2cBus::writeReg16(ADDRESS, REG_LOW, low))
+                return false;
+        }
+        return I2cBus::writeReg16(ADDRESS, REG_CONFIG, CFG_ALERT);
+    }
+
+    static bool readRaw(int32_t& raw)
+    {
+        uint16_t value;
+        if (!I2cBus::readReg16(ADDRESS, REG_TEMP, value))
+            return false;
+        raw = (int16_t)value;
+        return true;
+    }
+};
+
+//  TMP112 -- 12-bit left aligned, 0.0625 C/LSB, shutdown + one-shot (OS)
+struct Tmp112
+{
+    static const uint8_t  ID            = 2;
+    static const uint8_t  ADDRESS       = 0x48;
+    static const uint16_t CONVERSION_MS = 35;
+    static const uint16_t POWER_UP_MS   = 35;       // first continuous conversion, 26 ms typical
+    static const bool     POWER_UP_CONVERTS = true;
+    static const int16_t  SCALE_MUL     = 25;       // 100 / 256 = 25 / 64
+    static const uint8_t  SCALE_SHIFT   = 6;
+
+    static const uint16_t ALERT_PERIOD_MS = 4000;
+    static const uint8_t  ALERT_FAULTS  = 2;
+
+    static const uint8_t  REG_TEMP      = 0x00;
+    static const uint8_t  REG_CONFIG    = 0x01;
+    static const uint8_t  REG_LOW       = 0x02;
+    static const uint8_t  REG_HIGH      = 0x03;
+
+    static const uint16_t CFG_ONE_SHOT  = 0x8000;   // OS, reads 1 when done
+    static const uint16_t CFG_DEFAULT   = 0x60A0;   // R1 R0, CR1 (4 Hz), AL
+    static const uint16_t CFG_SHUTDOWN  = 0x0100;   // SD
+    static const uint16_t CFG_ALERT     = 0x6800;   // R1 R0, F0 (2 faults), comparator, CR = 00 (0.25 Hz)
+
+    static bool begin()
+    {
+        return I2cBus::writeReg16(ADDRESS, REG_CONFIG, CFG_DEFAULT | CFG_SHUTDOWN);
+    }
+
+    static bool resume()
+    {
+        return true;        // every startConversion() rewrites the full config
+    }
+
+    static bool startConversion()
+    {
+        return I2cBus::writeReg16(ADDRESS, REG_CONFIG, CFG_DEFAULT | CFG_SHUTDOWN | CFG_ONE_SHOT);
+    }
+
+    static bool ready()
+    {
+        uint16_t config;
+        return I2cBus::readReg16(ADDRESS, REG_CONFIG, config) && (config & CFG_ONE_SHOT);
+    }
+
+    static bool armAlert(int16_t high, int16_t low)
+    {
+        return I2cBus::writeReg16(ADDRESS, REG_HIGH, high & 0xFFF0) && I2cBus::writeReg16(ADDRESS, REG_LOW, low & 0xFFF0) &&
+               I2cBus::writeReg16(ADDRESS, REG_CONFIG, CFG_ALERT);
+    }
+
+    static bool readRaw(int32_t& raw)
+    {
+        uint16_t value;
+        if (!I2cBus::readReg16(ADDRESS, REG_TEMP, value))
+            return false;
+        raw = (int16_t)value;
+        return true;
+    }
+};
+
+//  BME280 -- temperature only, forced mode, x1 oversampling, see Bme280.h
+//  for pressure and humidity. The raw value is already compensated to
+//  centi-degrees, so the scale is the identity.
+struct Bme280Temp
+{
+    static const uint8_t  ID            = 3;
+    static const uint8_t  ADDRESS       = BME280_I2C_ADDRESS;
+    static const uint16_t CONVERSION_MS = 4;
+    static const uint16_t POWER_UP_MS   = 2;        // start-up time, then in sleep mode
+    static const bool     POWER_UP_CONVERTS = false;
+    static const int16_t  SCALE_MUL     = 1;
+    static const uint8_t  SCALE_SHIFT   = 0;
+
+    static bool begin()
+    {
+        if (!Bme280::begin())
+            return false;
+        Bme280::setOversampling(BME280_OSRS_X1, BME280_OSRS_SKIP, BME280_OSRS_SKIP);
+        return true;
+    }
+
+    static bool resume()
+    {
+        Bme280::setOversampling(BME280_OSRS_X1, BME280_OSRS_SKIP, BME280_OSRS_SKIP);
+        return Bme280::calibrated();
+    }
+
+    static bool startConversion()
+    {
+        return Bme280::startForced();
+    }
+
+    static bool ready()
+    {
+        return !Bme280::measuring();
+    }
+
+    static bool readRaw(int32_t& raw)
+    {
+        int16_t centi;
+        if (!Bme280::readTemperature(centi))
+            return false;
+        raw = centi;
+        return true;
+    }
+};
+
+/**
+**  @brief  Runs one conversion on a sensor policy and scales the result
+**/
+template <class Sensor>
+class TemperatureReader
+{
+public:
+    static bool begin()
+    {
+        return Sensor::begin();
+    }
+
+    static bool resume()
+    {
+        return Sensor::resume();
+    }
+
+    /**
+    **  @brief  Triggers a conversion, waits for it and reads the result
+    **  @param  int16_t&    centiCelsius    result in 0.01 C
+    **  @retrun bool        false on bus error or conversion timeout
+    **/
+    static bool read(int16_t& centiCelsius)
+    {
+        if (!Sensor::startConversion() || !I2cBus::wait(Sensor::CONVERSION_MS * 1000UL))
+            return false;
+
+        uint16_t waited = 0;
+        while (!Sensor::ready())
+        {
+            if (++waited > Sensor::CONVERSION_MS || !I2cBus::wait(1000))
+                return false;
+        }
+
+        return fetch(centiCelsius);
+    }
+
+    /**
+    **  @brief  Same conversion, polled from the start instead of sleeping the
+    **          worst case first. Busy-waits with delayMicroseconds(), so it
+    **          also runs before the core has started millis().
+    **  @param  uint16_t    pollUs  time between two ready() checks
+    **/
+    static bool readPolled(int16_t& centiCelsius, uint16_t pollUs)
+    {
+        if (!Sensor::startConversion())
+            return false;
+
+        uint32_t waited = 0;
+        while (!Sensor::ready())
+        {
+            waited += pollUs;
+            if (waited > Sensor::CONVERSION_MS * 1000UL)
+                return false;
+            delayMicroseconds(pollUs);
+        }
+        return fetch(centiCelsius);
+    }
+
+    /**
+    **  @brief  Reading right after the part was powered up (Rail.h), at
+    **          least POWER_UP_MS later. A part that converts at power-up
+    **          already has the reading: a one-shot would be ignored in
+    **          continuous mode, so its first result is fetched. The others
+    **          start from their reset state and convert once.
+    **  @param  bool        warm    settings known from the warm state
+    **/
+    static bool readFresh(bool warm, int16_t& centiCelsius)
+    {
+        if (Sensor::POWER_UP_CONVERTS)
+            return fetch(centiCelsius);
+        return (warm ? resume() : begin()) && read(centiCelsius);
+    }
+
+    /**
+    **  @brief  The sensor's latest result without triggering a conversion,
+    **          e.g. while it converts by itself after armAlert()
+    **/
+    static bool readLatest(int16_t& centiCelsius)
+    {
+        return fetch(centiCelsius);
+    }
+
+    /**
+    **  @brief  Thermostat mode on ALERT, conversions every ALERT_PERIOD_MS
+    **          from now on; read() and begin() end it
+    **  @param  int16_t highCenti       ALERT active from here
+    **  @param  int16_t releaseCenti    inactive again below this
+    **/
+    static bool armAlert(int16_t highCenti, int16_t releaseCenti)
+    {
+        return Sensor::armAlert(toRaw(highCenti), toRaw(releaseCenti));
+    }
+
+private:
+    static int16_t toRaw(int16_t centiCelsius)
+    {
+        return (int16_t)((int32_t)centiCelsius * (1L << Sensor::SCALE_SHIFT) / Sensor::SCALE_MUL);
+    }
+
+    static bool fetch(int16_t& centiCelsius)
+    {
+        int32_t raw;
+        if (!Sensor::readRaw(raw))
+            return false;
+        centiCelsius = (int16_t)((raw * Sensor::SCALE_MUL) >> Sensor::SCALE_SHIFT);
+        return true;
+    }
+};
+
+#if defined(SENSOR_TMP117)
+typedef Tmp117 BoardSensor;
+#elif defined(SENSOR_BME280)
+typedef Bme280Temp BoardSensor;
+#else
+typedef Tmp112 BoardSensor;
+#endif
+
+typedef TemperatureReader<BoardSensor> BoardThermometer;
+
+/**
+**  @brief  Formats centi-degrees with one decimal ("-3.5", "23.9")
+**  @param  char*       out     buffer, at least 8 bytes
+**  @param  int16_t     centi   value in 0.01 units
+**  @retrun uint8_t     number of characters written (without terminator)
+**/
+uint8_t formatCentiCelsius(char* out, int16_t centi);
+
+#endif /* SENSORS_H_ */
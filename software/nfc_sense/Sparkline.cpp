@@ -0,0 +1,232 @@
+#include "Sparkline.h"
+
+/**
+**  @brief  An empty chart with its labels to the left
+**  @param  uint8_t     x   first RAM column of the chart in bytes, at
+**                          least SPARKLINE_LABEL_CELLS for the labels
+**  @param  uint16_t    y   first row
+**  @param  uint8_t     w   width in bytes, 8 columns each
+**  @param  uint8_t     h   height in rows, at least the two labels
+**/
+Sparkline::Sparkline(uint8_t x, uint16_t y, uint8_t w, uint8_t h)
+    : _x(x), _w(w > SPARKLINE_MAX_COLUMNS / 8 ? SPARKLINE_MAX_COLUMNS / 8 : w), _h(h), _y(y),
+      _top(x - SPARKLINE_LABEL_CELLS, y, SPARKLINE_LABEL_CELLS, 1),
+      _bottom(x - SPARKLINE_LABEL_CELLS, y + h - GLYPH_HEIGHT, SPARKLINE_LABEL_CELLS, 1)
+{
+    _columns = _w * 8;
+    clear();
+}
+
+//  whole degrees, as the labels show them
+static void formatDegrees(char* out, int16_t degrees)
+{
+    uint8_t n = 0;
+    if (degrees < 0)
+    {
+        out[n++] = '-';
+        degrees = -degrees;
+    }
+    if (degrees >= 100)
+        out[n++] = '0' + degrees / 100;
+    if (degrees >= 10)
+        out[n++] = '0' + degrees / 10 % 10;
+    out[n++] = '0' + degrees % 10;
+    out[n] = 0;
+}
+
+/**
+**  @brief  Forgets every reading; the blank chart is dirty
+**/
+void Sparkline::clear()
+{
+    memset(_rows, SPARKLINE_EMPTY, sizeof(_rows));
+    _next = 0;
+    _count = 0;
+    _min = _max = 0;
+    _lo = _hi = 0;
+    rescales = 0;
+    _top.set("");
+    _bottom.set("");
+    invalidate();
+}
+
+/**
+**  @brief  One reading into the next column. The oldest one leaves through
+**          the gap; unless the axis moves, only the new column, the gap
+**          and the column after it (now the oldest, drawn as a dot) change.
+**  @param  int16_t centi   0.01 C
+**/
+void Sparkline::add(int16_t centi)
+{
+    uint8_t gap = _next + 1 < _columns ? _next + 1 : 0;
+    bool evicted = _rows[gap] != SPARKLINE_EMPTY;
+    int16_t old = _values[gap];
+    _rows[gap] = SPARKLINE_EMPTY;
+    if (evicted)
+        _count--;
+
+    _values[_next] = centi;
+    _rows[_next] = 0;
+    _count++;
+    if (_count == 1)
+        _min = _max = centi;
+    else if (evicted && (old == _min || old == _max))
+        rescan();
+    else
+    {
+        if (centi < _min)
+            _min = centi;
+        if (centi > _max)
+            _max = centi;
+    }
+
+    if (fitAxis())
+    {
+        for (uint8_t i = 0; i < _columns; i++)
+            if (_rows[i] != SPARKLINE_EMPTY)
+                _rows[i] = pixelRow(_values[i]);
+        char label[SPARKLINE_LABEL_CELLS + 2];
+        formatDegrees(label, _hi);
+        _top.set(label);
+        formatDegrees(label, _lo);
+        _bottom.set(label);
+        rescales++;
+        _all = true;
+    }
+    else
+    {
+        _rows[_next] = pixelRow(centi);
+        markColumn(_next);
+        markColumn(gap);
+        markColumn(gap + 1 < _columns ? gap + 1 : 0);
+    }
+    _next = gap;
+}
+
+//  minimum and maximum over the held readings, after the old extreme left
+void Sparkline::rescan()
+{
+    bool first = true;
+    for (uint8_t i = 0; i < _columns; i++)
+    {
+        if (_rows[i] == SPARKLINE_EMPTY)
+            continue;
+        if (first || _values[i] < _min)
+            _min = _values[i];
+        if (first || _values[i] > _max)
+            _max = _values[i];
+        first = false;
+    }
+}
+
+/**
+**  @brief  Axis around the running minimum and maximum, whole degrees
+**  @retrun bool    true if it moved
+**/
+bool Sparkline::fitAxis()
+{
+    int16_t lo = _min >= 0 ? _min / 100 : -((99 - (int32_t)_min) / 100);
+    int16_t hi = _max >= 0 ? (_max + 99) / 100 : -(-(int32_t)_max / 100);
+    if (hi - lo < SPARKLINE_MIN_SPAN)
+        hi = lo + SPARKLINE_MIN_SPAN;
+    if (lo == _lo && hi == _hi)
+        return false;
+    _lo = lo;
+    _hi = hi;
+    return true;
+}
+
+uint8_t Sparkline::pixelRow(int16_t centi) const
+{
+    int32_t span = (int32_t)(_hi - _lo) * 100;
+    return (_h - 1) - ((int32_t)centi - _lo * 100) * (_h - 1) / span;
+}
+
+void Sparkline::markColumn(uint8_t column)
+{
+    if (_first >= _last)
+    {
+        _first = column;
+        _last = column + 1;
+    }
+    else
+    {
+        if (column < _first)
+            _first = column;
+        if (column + 1 > _last)
+            _last = column + 1;
+    }
+}
+
+void Sparkline::invalidate()
+{
+    _all = true;
+}
+
+void Sparkline::clean()
+{
+    _all = false;
+    _first = _last = 0;
+    _top.clean();
+    _bottom.clean();
+}
+
+/**
+**  @brief  Panel window of what changed: the chart columns, or the chart
+**          and its labels after a rescale
+**/
+void Sparkline::window(uint8_t& x, uint16_t& y, uint8_t& w, uint16_t& h) const
+{
+    y = _y;
+    h = _h;
+    if (_all)
+    {
+        x = _x - SPARKLINE_LABEL_CELLS;
+        w = _w + SPARKLINE_LABEL_CELLS;
+    }
+    else
+    {
+        x = _x + _first / 8;
+        w = dirty() ? (_last - 1) / 8 - _first / 8 + 1 : 0;
+    }
+}
+
+//  a column's segment reaches from its reading to the one before it; the
+//  oldest reading, after the gap, is a dot
+bool Sparkline::inked(uint8_t column, uint8_t row) const
+{
+    uint8_t own = _rows[column];
+    if (own == SPARKLINE_EMPTY)
+        return false;
+    uint8_t prev = _rows[column ? column - 1 : _columns - 1];
+    if (prev == SPARKLINE_EMPTY)
+        return row == own;
+    return own < prev ? row >= own && row <= prev : row >= prev && row <= own;
+}
+
+/**
+**  @brief  The chart's and the labels' part of one panel row, other bytes
+**          are left alone
+**  @param  uint16_t    y       panel row
+**  @param  uint8_t     x       first RAM column of row[]
+**  @param  uint8_t     w       bytes in row[]
+**  @param  uint8_t*    row     1 = white, as the panel RAM
+**/
+void Sparkline::paint(uint16_t y, uint8_t x, uint8_t w, uint8_t* row) const
+{
+    _top.paint(y, x, w, row);
+    _bottom.paint(y, x, w, row);
+    if (y < _y || y >= _y + _h)
+        return;
+    uint8_t r = y - _y;
+    uint8_t end = _x + _w;
+    for (uint8_t col = x < _x ? _x : x; col < x + w && col < end; col++)
+    {
+        uint8_t bits = 0;
+        uint8_t column = (col - _x) * 8;
+        for (uint8_t b = 0; b < 8; b++)
+            if (inked(column + b, r))
+                bits |= 0x80 >> b;
+        row[col - x] = ~bits;
+    }
+}
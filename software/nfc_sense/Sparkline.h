@@ -0,0 +1,76 @@
+//  Trend of the recent readings on the e-paper panel
+//  -----------------------------------------
+//  A line chart with one pixel column per reading, fed one sample at a
+//  time. The widget is its own history: a ring of SPARKLINE_MAX_COLUMNS
+//  readings, the column of each one fixed by its slot. Moving every column
+//  left per sample would change the whole chart on the panel, so the chart
+//  sweeps instead: the newest reading goes into the slot after the last
+//  one, the slot after it is blanked as the gap that marks "now", and a
+//  new sample repaints two or three pixel columns (one or two RAM bytes)
+//  with a partial refresh.
+//
+//  The running minimum and maximum set the axis, in whole degrees and at
+//  least SPARKLINE_MIN_SPAN apart; they are rescanned only when the
+//  evicted reading was one of them. When the axis moves every column is
+//  rescaled and the chart repaints with its two labels (max at the top,
+//  min at the bottom, 8 x 16 glyphs left of the chart).
+//
+//  RAM: the readings, their pixel rows (so a panel row is computed without
+//  a division per pixel) and the labels, 3 bytes per column plus ~30.
+
+#ifndef SPARKLINE_H_
+#define SPARKLINE_H_
+#if ARDUINO >= 100
+ #include "Arduino.h"
+#else
+ #include "WProgram.h"
+#endif
+#include "GlyphLine.h"
+
+#define SPARKLINE_MAX_COLUMNS   96      // pixels, one per reading (the gap included)
+#define SPARKLINE_MIN_SPAN      2       // degrees between the labels at least
+#define SPARKLINE_LABEL_CELLS   3       // "-12", left of the chart
+#define SPARKLINE_EMPTY         0xFF    // pixel row of a column without a reading
+
+class Sparkline
+{
+public:
+    Sparkline(uint8_t x, uint16_t y, uint8_t w, uint8_t h);
+
+    void add(int16_t centi);
+    void clear();
+    void invalidate();                  // everything dirty, e.g. after a full refresh
+    bool dirty() const { return _all || _first < _last; }
+    void window(uint8_t& x, uint16_t& y, uint8_t& w, uint16_t& h) const;
+    void clean();
+
+    void paint(uint16_t y, uint8_t x, uint8_t w, uint8_t* row) const;
+    uint8_t columns() const { return _columns; }
+    uint8_t count() const { return _count; }
+    int16_t axisMin() const { return _lo; }
+    int16_t axisMax() const { return _hi; }
+
+    uint16_t rescales;                  // axis changes, each repaints the chart
+
+private:
+    uint8_t pixelRow(int16_t centi) const;
+    bool inked(uint8_t column, uint8_t row) const;
+    void rescan();
+    bool fitAxis();
+    void markColumn(uint8_t column);
+
+    uint8_t  _x, _w, _h;                // chart, bytes and rows
+    uint16_t _y;
+    uint8_t  _columns;
+    int16_t  _values[SPARKLINE_MAX_COLUMNS];
+    uint8_t  _rows[SPARKLINE_MAX_COLUMNS];  // from the top, SPARKLINE_EMPTY
+    uint8_t  _next;                     // slot of the next reading, the gap
+    uint8_t  _count;
+    int16_t  _min, _max;                // of the readings held
+    int16_t  _lo, _hi;                  // axis, degrees
+    uint8_t  _first, _last;             // dirty pixel columns [first, last)
+    bool     _all;                      // labels and every column
+    GlyphLine _top, _bottom;
+};
+
+#endif /* SPARKLINE_H_ */
@@ -0,0 +1,95 @@
+#include "Standby.h"
+#if defined(__AVR__)
+ #include <avr/interrupt.h>
+ #include <avr/sleep.h>
+#endif
+
+uint16_t Standby::wakes = 0;
+uint32_t Standby::sleptMicros = 0;
+volatile bool Standby::timedOut = false;
+
+void Standby::onTimeout()
+{
+    timedOut = true;
+}
+
+/**
+**  @brief  Sleeps for ms, e.g. while a part powers up
+**/
+void Standby::sleep(uint16_t ms)
+{
+    if (ms)
+        until(0, ms);
+}
+
+#if defined(__AVR__)
+
+/**
+**  @brief  Standby until done() or the time limit
+**  @param  bool (*done)()      checked with interrupts off after every
+**                              wake-up, 0 to wait the whole time
+**  @param  uint16_t timeoutMs  ~1 ms per RTC tick
+**  @retrun bool    false on timeout
+**/
+bool Standby::until(bool (*done)(), uint16_t timeoutMs)
+{
+    timedOut = false;
+    while (RTC.STATUS)
+        ;
+    RTC.CLKSEL = RTC_CLKSEL_INT1K_gc;
+    RTC.CNT = 0;
+    RTC.CMP = timeoutMs;
+    while (RTC.STATUS)
+        ;
+    RTC.INTFLAGS = RTC_CMP_bm | RTC_OVF_bm;
+    RTC.INTCTRL = RTC_CMP_bm;
+    RTC.CTRLA = RTC_PRESCALER_DIV1_gc | RTC_RUNSTDBY_bm | RTC_RTCEN_bm;
+
+    bool ok;
+    set_sleep_mode(SLEEP_MODE_STANDBY);
+    for (;;)
+    {
+        cli();
+        ok = done && done();
+        if (ok || timedOut)
+            break;
+        sleep_enable();
+        sei();
+        sleep_cpu();
+        sleep_disable();
+        wakes++;
+    }
+    sei();
+
+    while (RTC.STATUS)
+        ;
+    sleptMicros += (uint32_t)RTC.CNT * 1000000UL / 1024;
+    RTC.CTRLA = 0;
+    RTC.INTCTRL = 0;
+    return ok || (done && done());
+}
+
+ISR(RTC_CNT_vect)
+{
+    RTC.INTFLAGS = RTC_CMP_bm | RTC_OVF_bm;
+    Standby::onTimeout();
+}
+
+#else
+
+bool Standby::until(bool (*done)(), uint16_t timeoutMs)
+{
+    uint32_t start = micros();
+    for (;;)
+    {
+        if (done && done())
+            return true;
+        if (micros() - start >= timeoutMs * 1000UL)
+            return false;
+        delayMicroseconds(STANDBY_POLL_US);
+        sleptMicros += STANDBY_POLL_US;
+        wakes++;
+    }
+}
+
+#endif /* __AVR__ */
@@ -0,0 +1,38 @@
+//  Bounded waits in standby
+//  -----------------------------------------
+//  Waits of a few ms to a few s (a panel refresh, a supply rail settling)
+//  sleep in standby instead of spinning in delay(). The RTC counter on the
+//  1.024 kHz ULP runs in standby and wakes the CPU by its compare interrupt
+//  at the time limit; any other enabled interrupt (e.g. a pin change)
+//  wakes it earlier, and until() checks its condition with interrupts off
+//  before each sleep so a wake-up between check and sleep is not lost. The
+//  PIT shares the RTC clock selection and keeps running.
+//
+//  millis() does not advance while the CPU sleeps.
+
+#ifndef STANDBY_H_
+#define STANDBY_H_
+#if ARDUINO >= 100
+ #include "Arduino.h"
+#else
+ #include "WProgram.h"
+#endif
+
+#define STANDBY_POLL_US     500     // host builds: no sleep, the condition is polled on virtual time
+
+class Standby
+{
+public:
+    static bool until(bool (*done)(), uint16_t timeoutMs);
+    static void sleep(uint16_t ms);
+
+    static void onTimeout();        // RTC compare
+
+    static uint16_t wakes;          // CPU wake-ups while waiting
+    static uint32_t sleptMicros;    // time spent asleep, RTC resolution
+
+private:
+    static volatile bool timedOut;
+};
+
+#endif /* STANDBY_H_ */
@@ -0,0 +1,105 @@
+#include "Supply.h"
+
+uint16_t Supply::measurements = 0;
+
+//  Survives every reset except power-on, see WarmState.cpp
+#define SUPPLY_NOINIT_MAGIC 0x5AA5
+static uint16_t supplyMagic __attribute__((section(".noinit")));
+static uint8_t sinceMeasure __attribute__((section(".noinit")));
+static uint8_t supplyState __attribute__((section(".noinit")));
+static uint16_t lastMillivolts __attribute__((section(".noinit")));
+
+/**
+**  @brief  Counts a wake cycle and measures if one is due. Call early in
+**          the cycle, before the bus work loads the cell, in CLOCK_FAST.
+**  @param  bool powerOn   the cycle follows a power-on or brown-out reset
+**  @retrun bool    true if VDD was measured
+**/
+bool Supply::update(bool powerOn)
+{
+    if (supplyMagic != SUPPLY_NOINIT_MAGIC || powerOn)
+    {
+        supplyMagic = SUPPLY_NOINIT_MAGIC;
+        supplyState = SUPPLY_OK;
+        lastMillivolts = 0;
+        sinceMeasure = 0xFF;
+    }
+    uint8_t every = supplyState == SUPPLY_OK ? SUPPLY_MEASURE_EVERY : SUPPLY_MEASURE_EVERY_LOW;
+    if (sinceMeasure < 0xFF)
+        sinceMeasure++;
+    if (sinceMeasure < every)
+        return false;
+
+    sinceMeasure = 0;
+    lastMillivolts = measure();
+    supplyState = classify(lastMillivolts, supplyState);
+    measurements++;
+    return true;
+}
+
+uint8_t Supply::state()
+{
+    return supplyState;
+}
+
+uint16_t Supply::millivolts()
+{
+    return lastMillivolts;
+}
+
+uint8_t Supply::stretch()
+{
+    return supplyState == SUPPLY_CRITICAL ? 4 : supplyState == SUPPLY_LOW ? 2 : 1;
+}
+
+const char* Supply::label()
+{
+    return supplyState == SUPPLY_CRITICAL ? ", battery critical" : supplyState == SUPPLY_LOW ? ", battery low" : "";
+}
+
+/**
+**  @brief  A threshold is crossed downwards at its value and upwards only
+**          SUPPLY_HYSTERESIS_MV above it
+**/
+uint8_t Supply::classify(uint16_t mv, uint8_t from)
+{
+    uint16_t low = SUPPLY_LOW_MV + (from == SUPPLY_OK ? 0 : SUPPLY_HYSTERESIS_MV);
+    uint16_t critical = SUPPLY_CRITICAL_MV + (from == SUPPLY_CRITICAL ? SUPPLY_HYSTERESIS_MV : 0);
+    return mv < critical ? SUPPLY_CRITICAL : mv < low ? SUPPLY_LOW : SUPPLY_OK;
+}
+
+#if defined(__AVR__)
+
+/**
+**  @brief  VDD / 10 against the 1.024 V reference, 12 bits: 2.5 mV per
+**          count. ADC0 is off before and after, see Board::powerDownPeripherals().
+**/
+uint16_t Supply::measure()
+{
+    ADC0.CTRLB = ADC_PRESC_DIV4_gc;
+    ADC0.CTRLC = ADC_REFSEL_1024MV_gc | ((F_CPU + 999999UL) / 1000000UL) << ADC_TIMEBASE_gp;
+    ADC0.CTRLE = 40;                            // SAMPDUR, 16 us for the divider
+    ADC0.MUXPOS = ADC_MUXPOS_VDDDIV10_gc;
+    ADC0.CTRLA = ADC_ENABLE_bm;
+    delayMicroseconds(SUPPLY_SETTLE_US);
+    ADC0.COMMAND = ADC_MODE_SINGLE_12BIT_gc | ADC_START_IMMEDIATE_gc;
+    while (!(ADC0.INTFLAGS & ADC_RESRDY_bm))
+        ;
+    uint16_t result = ADC0.RESULT;              // clears RESRDY
+    ADC0.CTRLA = 0;
+    return (uint32_t)result * 10240 / 4096;
+}
+
+#else
+
+//  host builds: set by the simulator
+uint16_t supplyMillivolts = 3000;
+uint16_t (*supplySource)() = 0;
+
+uint16_t Supply::measure()
+{
+    delayMicroseconds(SUPPLY_SETTLE_US + SUPPLY_CONVERSION_US);
+    return supplySource ? supplySource() : supplyMillivolts;
+}
+
+#endif /* __AVR__ */
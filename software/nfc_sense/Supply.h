@@ -0,0 +1,75 @@
+//  Supply voltage monitor for the coin cell boards
+//  -----------------------------------------
+//  A CR2032 stays near 2.9 V for most of its life and then falls off a
+//  knee within a few percent of its capacity; past it the panel and the
+//  10 MHz clock give up long before the sensor does. update() measures VDD
+//  every SUPPLY_MEASURE_EVERY wake cycles (every SUPPLY_MEASURE_EVERY_LOW
+//  once the cell is low) and on the first cycle after a power-on or
+//  brown-out: ADC0 on the internal VDD/10 divider against the 1.024 V
+//  reference, one 12-bit conversion, the ADC off again. That is well under
+//  a millisecond of the wake cycle in SUPPLY_SETTLE_US and the conversion.
+//
+//  The measurement gives a state with SUPPLY_HYSTERESIS_MV between its
+//  thresholds, so a cell that recovers a little after a load does not
+//  toggle the tag text. The sketch appends label() to the published
+//  reading, stretches the background refresh by stretch() (FieldWake.h)
+//  and shows INDICATOR_LOW_BATTERY while low. Field wakes are never
+//  stretched: a phone on the tag still gets a fresh value.
+//
+//  The counters live in .noinit like WarmState's, so boards that publish
+//  once per reset count their wakes across watchdog resets as well.
+//
+//  Build with -DNFC_SENSE_SUPPLY_MONITOR. Not for boards running from the
+//  reader field (NFC_SENSE_HARVEST_BOOT), their VDD is the harvester's;
+//  Budget.h uses measure() alone there.
+
+#ifndef SUPPLY_H_
+#define SUPPLY_H_
+#if ARDUINO >= 100
+ #include "Arduino.h"
+#else
+ #include "WProgram.h"
+#endif
+
+#if !defined(F_CPU)
+ #define F_CPU 10000000UL       // host builds: 20 MHz oscillator / 2, the boards at 3 V
+#endif
+
+//states
+#define SUPPLY_OK               0
+#define SUPPLY_LOW              1       // past the knee, weeks left at the stretched interval
+#define SUPPLY_CRITICAL         2       // days left, the panel may stop updating first
+
+#define SUPPLY_LOW_MV           2600
+#define SUPPLY_CRITICAL_MV      2400
+#define SUPPLY_HYSTERESIS_MV    50      // to leave a state again
+
+#define SUPPLY_MEASURE_EVERY     16     // wake cycles between measurements while ok
+#define SUPPLY_MEASURE_EVERY_LOW 4      // and once low or critical
+
+#define SUPPLY_SETTLE_US        60      // reference and divider start-up after ADC enable
+#define SUPPLY_CONVERSION_US    24      // 16 us sample, 13 ADC clocks at F_CPU / 4, result
+
+class Supply
+{
+public:
+    static bool update(bool powerOn);   // true if it measured
+    static uint16_t measure();          // VDD in mV, one conversion
+
+    static uint8_t state();
+    static uint16_t millivolts();       // last measurement, 0 before the first
+    static uint8_t stretch();           // background refresh factor: 1, 2 or 4
+    static const char* label();         // tag text suffix, empty while ok
+
+    static uint16_t measurements;       // since boot
+
+private:
+    static uint8_t classify(uint16_t mv, uint8_t from);
+};
+
+#if !defined(__AVR__)
+extern uint16_t supplyMillivolts;       // host builds: what the VDD/10 channel reads
+extern uint16_t (*supplySource)();      // host builds: or this, when set
+#endif
+
+#endif /* SUPPLY_H_ */
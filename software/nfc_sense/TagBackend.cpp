@@ -0,0 +1,125 @@
+#include "TagBackend.h"
+#include <Wire.h>
+#include "I2cBus.h"
+#include "WarmState.h"
+#include "Ntag5.h"
+#include "RF430CL330H_Shield.h"
+
+//  The per-chip helpers were written as sketch headers with the same entry
+//  points; each gets a namespace here so both link into one build.
+namespace rf430 {
+#include "NfcUtils.h"
+}
+namespace ntag5 {
+#include "NtagUtils.h"
+}
+
+//  RF430: byte addressed RAM, each of the two NDEF slots holds NLEN and the
+//  message; updateNFC() writes the String's NUL as one more payload byte
+#define TAG_RF430_MAX_NDEF  (RF430_NDEF_MAX_SIZE - 2 - 1)
+//  NTAG 5: the CC announces 2040 bytes, but updateNFC() publishes through
+//  the 256-byte SRAM and writes a one-byte TLV length, the smaller bound wins
+#define TAG_NTAG5_MAX_NDEF  (NTAG5_MAX_SRAM_NDEF < NTAG5_MAX_TLV_NDEF ? NTAG5_MAX_SRAM_NDEF : NTAG5_MAX_TLV_NDEF)
+
+static const TagCapabilities CAPABILITIES[] = {
+    { 0, 0, 0 },                                                // TAG_NONE
+    { TAG_CAP_HW_CRC, TAG_RF430_MAX_NDEF, 1 },                  // TAG_RF430
+    { TAG_CAP_SRAM_MIRROR, TAG_NTAG5_MAX_NDEF, NTAG5_BLOCK_SIZE },  // TAG_NTAG5
+};
+
+uint8_t TagBackend::probes = 0;
+uint8_t TagBackend::current = TAG_NONE;
+bool TagBackend::detected = false;
+
+/**
+**  @brief  Which chip the board carries, found once per boot. Needs an
+**          open I2cBus session unless the warm state already knows.
+**  @retrun uint8_t TAG_RF430 or TAG_NTAG5
+**/
+uint8_t TagBackend::detect()
+{
+    if (detected)
+        return current;
+    detected = true;
+
+    const WarmStateBlock& saved = WarmState::get();
+    if (WarmState::valid() && (saved.peripherals & WARM_PERIPH_NTAG5))
+        current = TAG_NTAG5;
+    else if (WarmState::valid() && (saved.peripherals & WARM_PERIPH_RF430))
+        current = TAG_RF430;
+    else
+    {
+        probes++;
+        current = I2cBus::probe(NTAG5_I2C_ADDRESS) ? TAG_NTAG5 : TAG_RF430;
+    }
+    return current;
+}
+
+/**
+**  @brief  Back to the state after a reset: the next detect() starts over.
+**          The firmware boots once per reset, the simulator many times.
+**/
+void TagBackend::reset()
+{
+    detected = false;
+    current = TAG_NONE;
+    probes = 0;
+}
+
+uint8_t TagBackend::chip()
+{
+    return current;
+}
+
+const TagCapabilities& TagBackend::capabilities()
+{
+    return CAPABILITIES[current];
+}
+
+uint8_t TagBackend::warmFlag()
+{
+    return current == TAG_NTAG5 ? WARM_PERIPH_NTAG5 : current == TAG_RF430 ? WARM_PERIPH_RF430 : 0;
+}
+
+/**
+**  @brief  Detects the chip if not done yet and brings it up. A chip that
+**          fails here is forgotten, the next call probes again: on the
+**          field-wake boards that is the next wake cycle, not a reset.
+**  @retrun uint8_t TAG_ABSENT, TAG_WRITTEN or TAG_INTACT
+**/
+uint8_t TagBackend::setup(bool warm)
+{
+    uint8_t state;
+    switch (detect())
+    {
+    case TAG_NTAG5:
+        state = ntag5::setupNFC(warm);
+        break;
+    case TAG_RF430:
+        state = rf430::setupNFC(warm);
+        break;
+    default:
+        state = TAG_ABSENT;
+    }
+    if (state == TAG_ABSENT)
+    {
+        current = TAG_NONE;
+        detected = false;
+    }
+    return state;
+}
+
+/**
+**  @brief  Publishes text as a single text record on the detected chip
+**  @retrun bool    false without a chip, if the record does not fit the
+**                  tag layout or on write errors
+**/
+bool TagBackend::publish(int osType, const String& text)
+{
+    // short text record: TNF/flags, type length, payload length, 'T', status, "en"
+    if (current == TAG_NONE || text.length() + 7 > capabilities().maxNdef)
+        return false;
+    if (current == TAG_NTAG5)
+        return ntag5::updateNFC(osType, text);
+    return rf430::updateNFC(osType, text);
+}
@@ -0,0 +1,73 @@
+//  One interface for both tag chips, picked at run time
+//  -----------------------------------------
+//  The RF430CL330H boards (NfcUtils.h) and the NTAG 5 Link boards
+//  (NtagUtils.h) publish the same text record through different chips.
+//  TagBackend finds out which one is on the bus and forwards setup and
+//  publishing to it, so one build serves both. What differs between the
+//  chips is described by capability flags for code that cares, e.g. how a
+//  value is best updated:
+//
+//      TAG_CAP_SRAM_MIRROR     live values without programming EEPROM
+//      TAG_CAP_HW_CRC          CRC engine over tag memory (no read-back)
+//      maxNdef                 longest NDEF message the tag layout holds
+//      writeGranularity        smallest write unit in bytes
+//
+//  Detection runs once per boot. A warm boot takes the chip from the warm
+//  state (WARM_PERIPH_RF430 / WARM_PERIPH_NTAG5) without touching the bus;
+//  otherwise the NTAG 5 address is probed, and failing that the RF430 is
+//  assumed: it only answers at 0x28 once out of reset, so its probe is the
+//  reset and READY wait in setup().
+
+#ifndef TAG_BACKEND_H_
+#define TAG_BACKEND_H_
+#if ARDUINO >= 100
+ #include "Arduino.h"
+#else
+ #include "WProgram.h"
+#endif
+
+//chips
+#define TAG_NONE            0
+#define TAG_RF430           1
+#define TAG_NTAG5           2
+
+//capability flags
+#define TAG_CAP_SRAM_MIRROR 0x01
+#define TAG_CAP_HW_CRC      0x02
+
+//publish() osType, as updateNFC()
+#define OS_ANDROID          0
+#define OS_IOS              1
+
+//setup() results, as setupNFC()
+#define TAG_ABSENT          0
+#define TAG_WRITTEN         1
+#define TAG_INTACT          2
+
+struct TagCapabilities
+{
+    uint8_t  flags;             // TAG_CAP_*
+    uint16_t maxNdef;           // bytes
+    uint8_t  writeGranularity;  // bytes
+};
+
+class TagBackend
+{
+public:
+    static uint8_t detect();
+    static void reset();            // forget the chip, as a reset does
+    static uint8_t chip();
+    static const TagCapabilities& capabilities();
+    static uint8_t warmFlag();      // WARM_PERIPH_* of the detected chip
+
+    static uint8_t setup(bool warm);
+    static bool publish(int osType, const String& text);
+
+    static uint8_t probes;          // bus probes this boot, 0 when the warm state knew
+
+private:
+    static uint8_t current;
+    static bool detected;
+};
+
+#endif /* TAG_BACKEND_H_ */
@@ -0,0 +1,182 @@
+#include "WarmState.h"
+#include <avr/eeprom.h>
+#include <stddef.h>
+
+WarmStateBlock WarmState::state;
+bool WarmState::stateValid = false;
+bool WarmState::layoutDirty = false;
+uint8_t WarmState::cause = RESET_CAUSE_POWER_ON;
+uint16_t WarmState::eepromWrites = 0;
+
+//  Survives every reset except power-on; counts boots since the last write.
+//  The magic guards against RAM content after a power-on or deep brown-out.
+#define WARM_NOINIT_MAGIC   0xA55A
+static uint16_t noinitMagic __attribute__((section(".noinit")));
+static uint8_t bootsSinceWrite __attribute__((section(".noinit")));
+static int16_t committedValue __attribute__((section(".noinit")));
+static int16_t publishedValue __attribute__((section(".noinit")));
+static bool publishedValid __attribute__((section(".noinit")));
+static uint8_t shownSupply __attribute__((section(".noinit")));
+
+/**
+**  @brief  Captures the reset cause and reads the EEPROM block; once per
+**          boot, from setup(). Calling it again drops whatever was set
+**          since the last commit() and counts another boot. On target
+**          the core's start-up code (as Optiboot does) has already read
+**          and cleared RSTFR and left the flags in GPIOR0; RSTFR is added
+**          in for a start-up that did not.
+**/
+void WarmState::begin()
+{
+#if defined(__AVR__)
+    cause = GPIOR0 | RSTCTRL.RSTFR;
+    GPIOR0 = 0;
+#else
+    cause = RSTCTRL.RSTFR;
+#endif
+    RSTCTRL.RSTFR = cause;          // write one to clear
+    eeprom_read_block(&state, (const void*)WARM_STATE_EEPROM_ADDR, sizeof(state));
+    stateValid = state.version == WARM_STATE_VERSION &&
+                 state.crc == crc8((const uint8_t*)&state, offsetof(WarmStateBlock, crc));
+    if (!stateValid)
+    {
+        memset(&state, 0, sizeof(state));
+        state.version = WARM_STATE_VERSION;
+        layoutDirty = true;
+    }
+
+    if (noinitMagic != WARM_NOINIT_MAGIC || (cause & RESET_CAUSE_POWER_ON))
+    {
+        noinitMagic = WARM_NOINIT_MAGIC;
+        bootsSinceWrite = 0;
+        committedValue = state.lastValue;
+        publishedValid = false;
+    }
+    bootsSinceWrite++;
+}
+
+bool WarmState::valid()
+{
+    return stateValid;
+}
+
+uint8_t WarmState::resetCause()
+{
+    return cause;
+}
+
+const WarmStateBlock& WarmState::get()
+{
+    return state;
+}
+
+void WarmState::setPeripherals(uint8_t peripherals)
+{
+    layoutDirty |= state.peripherals != peripherals;
+    state.peripherals = peripherals;
+}
+
+void WarmState::setSensorConfig(uint8_t config)
+{
+    layoutDirty |= state.sensorConfig != config;
+    state.sensorConfig = config;
+}
+
+void WarmState::setTagLayout(uint8_t layout)
+{
+    layoutDirty |= state.tagLayout != layout;
+    state.tagLayout = layout;
+}
+
+void WarmState::setLastValue(int16_t value)
+{
+    state.lastValue = value;
+    publishedValue = value;
+    publishedValid = true;
+}
+
+/**
+**  @brief  Does not force a write: losing a few counts on power loss keeps
+**          the estimate close enough and spares the MCU EEPROM
+**/
+void WarmState::setTagWear(uint32_t cycles)
+{
+    state.tagWear = cycles;
+}
+
+/**
+**  @brief  Value currently on the tag, known only while MCU RAM survived the
+**          reset (the EEPROM copy may lag behind because of the rate limit)
+**/
+bool WarmState::lastPublished(int16_t& value)
+{
+    value = publishedValue;
+    return publishedValid;
+}
+
+/**
+**  @brief  The tag was written with something other than a reading
+**/
+void WarmState::forgetPublished()
+{
+    publishedValid = false;
+}
+
+/**
+**  @brief  Supply state the tag text carries next to the value (Supply.h),
+**          valid together with lastPublished()
+**/
+void WarmState::setPublishedSupply(uint8_t supply)
+{
+    shownSupply = supply;
+}
+
+uint8_t WarmState::publishedSupply()
+{
+    return shownSupply;
+}
+
+#if defined(SENSOR_BME280)
+void WarmState::setBmeCalibration(const Bme280Calibration& cal)
+{
+    layoutDirty |= memcmp(&state.bmeCal, &cal, sizeof(cal)) != 0;
+    state.bmeCal = cal;
+}
+#endif
+
+/**
+**  @brief  Writes the block if the rate limit allows it
+**  @retrun bool    true if EEPROM was updated
+**/
+bool WarmState::commit()
+{
+    int16_t delta = state.lastValue - committedValue;
+    if (delta < 0)
+        delta = -delta;
+
+    bool due = layoutDirty || delta >= WARM_STATE_VALUE_DELTA ||
+               (bootsSinceWrite >= WARM_STATE_WRITE_INTERVAL && state.lastValue != committedValue);
+    if (!due)
+        return false;
+
+    state.crc = crc8((const uint8_t*)&state, offsetof(WarmStateBlock, crc));
+    eeprom_update_block(&state, (void*)WARM_STATE_EEPROM_ADDR, sizeof(state));
+    stateValid = true;
+    layoutDirty = false;
+    committedValue = state.lastValue;
+    bootsSinceWrite = 0;
+    eepromWrites++;
+    return true;
+}
+
+uint8_t WarmState::crc8(const uint8_t* data, uint8_t len)
+{
+    uint8_t crc = 0xFF;
+    while (len--)
+    {
+        crc ^= *data++;
+        for (uint8_t i = 0; i < 8; i++)
+            crc = crc & 0x80 ? (uint8_t)(crc << 1) ^ 0x31 : (uint8_t)(crc << 1);
+    }
+    return crc;
+}
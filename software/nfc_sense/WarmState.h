@@ -0,0 +1,94 @@
+//  Warm-reset state kept in EEPROM
+//  -----------------------------------------
+//  A small versioned block remembers what the cold boot found out (which
+//  chips answered, sensor calibration/configuration, whether the tag layout
+//  was written) and the last published value. setup() reads it once; when
+//  it is valid the boot skips re-probing and only verifies the tag instead
+//  of pulsing reset and rewriting the CC file. Boards that run more wake
+//  cycles per boot (FieldWake.h) keep working on the RAM copy.
+//
+//  EEPROM writes use eeprom_update_block() (unchanged bytes are not
+//  programmed) and are rate limited: layout changes are written at once,
+//  the last value only every WARM_STATE_WRITE_INTERVAL boots or when it
+//  moved by WARM_STATE_VALUE_DELTA. The tag wear count rides along with
+//  those writes.
+
+#ifndef WARM_STATE_H_
+#define WARM_STATE_H_
+
+#include "BoardConfig.h"
+#if ARDUINO >= 100
+ #include "Arduino.h"
+#else
+ #include "WProgram.h"
+#endif
+#if defined(SENSOR_BME280)
+ #include "Bme280.h"
+#endif
+
+#define WARM_STATE_VERSION          2
+#define WARM_STATE_EEPROM_ADDR      0x00
+#define WARM_STATE_WRITE_INTERVAL   32      // boots between value-only writes
+#define WARM_STATE_VALUE_DELTA      50      // 0.5 C forces an earlier write
+
+//detected peripherals
+#define WARM_PERIPH_RF430       0x01
+#define WARM_PERIPH_NTAG5       0x02
+#define WARM_PERIPH_SENSOR      0x04
+
+//reset causes, RSTCTRL.RSTFR layout (GPIOR0 once the core has cleared RSTFR)
+#define RESET_CAUSE_POWER_ON    0x01
+#define RESET_CAUSE_BROWN_OUT   0x02
+#define RESET_CAUSE_EXTERNAL    0x04
+#define RESET_CAUSE_WATCHDOG    0x08
+#define RESET_CAUSE_SOFTWARE    0x10
+#define RESET_CAUSE_UPDI        0x20
+
+struct WarmStateBlock
+{
+    uint8_t  version;
+    uint8_t  peripherals;       // WARM_PERIPH_*
+    uint8_t  sensorConfig;      // sensor specific, e.g. BME280 oversampling
+    uint8_t  tagLayout;         // non-zero once the CC file was written
+    int16_t  lastValue;         // last published reading, 0.01 C
+    uint32_t tagWear;           // program cycles of the most worn tag EEPROM block
+#if defined(SENSOR_BME280)
+    Bme280Calibration bmeCal;
+#endif
+    uint8_t  crc;
+};
+
+class WarmState
+{
+public:
+    static void begin();
+    static bool valid();
+    static uint8_t resetCause();
+
+    static const WarmStateBlock& get();
+    static void setPeripherals(uint8_t peripherals);
+    static void setSensorConfig(uint8_t config);
+    static void setTagLayout(uint8_t layout);
+    static void setLastValue(int16_t value);
+    static void setTagWear(uint32_t cycles);
+    static bool lastPublished(int16_t& value);
+    static void forgetPublished();
+    static void setPublishedSupply(uint8_t supply);
+    static uint8_t publishedSupply();
+#if defined(SENSOR_BME280)
+    static void setBmeCalibration(const Bme280Calibration& cal);
+#endif
+    static bool commit();
+
+    static uint16_t eepromWrites;   // committed blocks since boot
+
+private:
+    static uint8_t crc8(const uint8_t* data, uint8_t len);
+
+    static WarmStateBlock state;
+    static bool stateValid;
+    static bool layoutDirty;
+    static uint8_t cause;
+};
+
+#endif /* WARM_STATE_H_ */
@@ -1,62 +1,197 @@
 #include "Wire.h"
-#include "NfcUtils.h"
-#include "RF430CL330H_Shield.h"
+#include "Board.h"
+#include "TagBackend.h"
+#include "Ntag5.h"
+#include "Sensors.h"
+#include "WarmState.h"
+#include "I2cBus.h"
+#include "Budget.h"
 #include <avr/sleep.h>
 
-#include <Adafruit_TMP117.h>
-#include <Adafruit_Sensor.h>
+// every bus call after this budget fails fast, see I2cBus.h for the bound
+#define AWAKE_BUDGET_MS 300
+
+// #define NFC_SENSE_DEBUG     // awake time and bus statistics on TX
+
+// NTAG boards sleep until ED reports a reader field, see FieldWake.h;
+// the others publish once per reset
+#if defined(BOARD_PIN_NTAG_ED)
+ #define NFC_SENSE_FIELD_WAKE
+ #include "FieldWake.h"
+#endif
+
+// the sensor converts by itself and wakes the MCU through ALERT at a
+// limit, instead of the background refresh, see FieldWake.h. Build with
+// -DNFC_SENSE_ALERT_WAKE -DBOARD_PIN_SENSOR_ALERT=13 after the ALERT
+// rework (Board.h), the limit in BoardConfig.h. It costs more charge than
+// the refresh and buys an alarm within seconds, so the refresh stays the
+// default.
+#if defined(NFC_SENSE_ALERT_WAKE)
+ #if !defined(NFC_SENSE_FIELD_WAKE) || !defined(BOARD_PIN_SENSOR_ALERT)
+  #error "NFC_SENSE_ALERT_WAKE needs a field-wake board with the sensor ALERT wired (BOARD_PIN_SENSOR_ALERT)"
+ #endif
+ #if defined(SENSOR_BME280) || defined(BOARD_PIN_RAIL_GATE)
+  #error "NFC_SENSE_ALERT_WAKE needs a TMP1xx sensor that stays powered"
+ #endif
+
+// sensor converting with its limits set, until a reset or a bus error
+bool alertArmed = false;
+#endif
+
+// status LED patterns, see Indicator.h; they run until the next cycle,
+// so only boards that wake again may drive it
+#if defined(BOARD_PIN_STATUS_LED)
+ #if !defined(NFC_SENSE_FIELD_WAKE)
+  #error "BOARD_PIN_STATUS_LED needs a field-wake board"
+ #endif
+ #include "Indicator.h"
+#endif
+
+// boards with the e-paper panel show the reading as well, see Display.h
+#if defined(BOARD_HAS_DISPLAY)
+ #include "Display.h"
+#endif
+
+// sensor and panel on a switched supply, only on while a cycle needs
+// them, see Rail.h
+#if defined(BOARD_PIN_RAIL_GATE)
+ #include "Rail.h"
+ #include "Epd.h"
+ #define RAIL_USERS (RAIL_SENSOR | RAIL_DISPLAY)
+#endif
+
+// boards powered from the NTAG 5 VOUT: reading on the tag before the core
+// starts, see HarvestBoot.h. Build with -DNFC_SENSE_HARVEST_BOOT.
+#if defined(NFC_SENSE_HARVEST_BOOT)
+ #if !defined(BOARD_HAS_NTAG5)
+  #error "NFC_SENSE_HARVEST_BOOT needs an NTAG 5 board"
+ #endif
+ #if defined(BOARD_PIN_RAIL_GATE)
+  #error "NFC_SENSE_HARVEST_BOOT: the board is off between fields, leave BOARD_PIN_RAIL_GATE out"
+ #endif
+ #include "HarvestBoot.h"
+
+// megaTinyCore calls this from main() before init()
+void onBeforeInit()
+{
+  HarvestBoot::publish();
+}
+#endif
+
+// bus and conversion waits from the prescaled clock, see Clock.h. Build
+// with -DNFC_SENSE_CLOCK_SCALING.
+#if defined(NFC_SENSE_CLOCK_SCALING)
+ #include "Clock.h"
+#endif
+
+// coin cell boards: VDD every few wakes, a battery note on the tag and a
+// longer background refresh as the cell runs down, see Supply.h. Build
+// with -DNFC_SENSE_SUPPLY_MONITOR.
+#if defined(NFC_SENSE_SUPPLY_MONITOR)
+ #if defined(NFC_SENSE_HARVEST_BOOT)
+  #error "NFC_SENSE_SUPPLY_MONITOR needs a battery, not the reader field"
+ #endif
+ #include "Supply.h"
+#endif
 
 bool postData = false;
-Adafruit_TMP117  tmp117;
+bool firstCycle = true;     // the wake cycle setup() runs
+
+// this cycle's reading, for the tasks after the headline
+int16_t centiCelsius;
+bool sensorOk = false;
+
+void wakeCycle();
+
+void commitState()
+{
+  WarmState::commit();
+}
+
+#if defined(BOARD_HAS_DISPLAY)
+void updateWidgets()
+{
+  if (!sensorOk)
+    return;
+#if defined(BOARD_PIN_RAIL_GATE)
+  // controller RAM from what the panel shows, or the refresh is a full one
+  Rail::settle(EPD_POWER_UP_MS);
+  Display::restore();
+#endif
+  Display::showCentiCelsius(centiCelsius);
+  Display::record(centiCelsius);
+}
+
+void refreshDisplay()
+{
+  if (sensorOk)
+    Display::refresh();
+}
+#endif
+
+// after the reading on the tag, by priority; on field-powered boards each
+// only while the supply can carry it, see Budget.h. The panel comes last:
+// a phone in the field reads the new value first, the refresh takes the
+// better part of a second.
+const BudgetTask CYCLE_TASKS[] = {
+  { commitState,    BUDGET_STATE_UC,   BUDGET_STATE },
+#if defined(BOARD_HAS_DISPLAY)
+  { updateWidgets,  BUDGET_HISTORY_UC, BUDGET_HISTORY },
+  { refreshDisplay, BUDGET_DISPLAY_UC, BUDGET_DISPLAY },
+#endif
+};
 
 void setup()
 {
  
   // Serial.begin(9600);
 
-  // power saving
-  TCA0.SPLIT.CTRLA = 0;
-  ADCPowerOptions(ADC_DISABLE);
+  // power saving: every unused pin input-disabled, functional pins per board
+  Board::init();
+  Board::powerDownPeripherals();
+#if defined(NFC_SENSE_CLOCK_SCALING)
+  Clock::begin(100000UL);   // Wire's default bus clock
+#endif
+#if defined(NFC_SENSE_HARVEST_BOOT)
+  Budget::begin(BUDGET_BUFFER_UF);
+#endif
+#if defined(BOARD_HAS_DISPLAY)
+  Display::begin(BOARD_PIN_EPD_CS, BOARD_PIN_EPD_DC, BOARD_PIN_EPD_RES, BOARD_PIN_EPD_BUSY);
+#endif
+#if defined(BOARD_PIN_RAIL_GATE)
+  Rail::begin(BOARD_PIN_RAIL_GATE);
+  Display::powerDown();
+#endif
+  // reset cause and the EEPROM block, once per boot: the wake cycles keep
+  // working on the RAM copy, commit() rate limits per boot
+  WarmState::begin();
 
-  pinMode(0, OUTPUT);
-  pinMode(1, OUTPUT);
-  pinMode(2, OUTPUT);
-  pinMode(3, OUTPUT);
+  wakeCycle();
+  firstCycle = false;
 
-  pinMode(5, OUTPUT);
-  
-  pinMode(6, OUTPUT);
-  pinMode(7, OUTPUT);
-  pinMode(8, OUTPUT);
-  pinMode(9, OUTPUT);
-  pinMode(10, OUTPUT);
-  pinMode(11, OUTPUT);
-  pinMode(12, OUTPUT);
-  pinMode(13, OUTPUT);
-  pinMode(14, OUTPUT);
-  pinMode(15, OUTPUT);
-  pinMode(16, OUTPUT);
-  
-  /*
-  pinMode(17, OUTPUT);
-  pinMode(19, OUTPUT);
-  pinMode(20, OUTPUT);
-  */
-  
-  // temp INPUT
-  // pinMode(18, OUTPUT);
-  
+#if defined(NFC_SENSE_FIELD_WAKE)
+  FieldWake::begin(BOARD_PIN_NTAG_ED);
+ #if defined(NFC_SENSE_ALERT_WAKE)
+  FieldWake::watchAlert(BOARD_PIN_SENSOR_ALERT);
+ #endif
+#else
+  // Before sleeping
+ 
+  ADC0.CTRLA &= ~ADC_ENABLE_bm; // Very important on the tinyAVR 2-series
   
-  /*
-  for (uint8_t pin=0; pin < 8; pin++) {
-     (&PORTA.PIN0CTRL)[pin] = PORT_ISC_INPUT_DISABLE_gc; //Disable on PAx pin
-     (&PORTB.PIN0CTRL)[pin] = PORT_ISC_INPUT_DISABLE_gc; //Disable on PBx pin
-     (&PORTC.PIN0CTRL)[pin] = PORT_ISC_INPUT_DISABLE_gc; //Disable on PCx pin
-    }
-  /*
-   
-  */
+  set_sleep_mode(SLEEP_MODE_PWR_DOWN);
+  sleep_enable();
+  sleep_cpu();
+#endif
+
+}
 
+/**
+**  @brief  One measurement: bring up the bus, check the tag, read the
+**          sensor, publish if the reading changed, remember the outcome
+**/
+void wakeCycle()
+{
   // join I2C bus (I2Cdev library doesn't do this automatically)
  
   // Serial.begin(9600);
@@ -74,46 +209,192 @@ void setup()
   #define TARGET_IOS
   // #define TARGET_ANDROID
 
+  // warm boot: peripherals known from the last cold boot, no re-probing;
+  // that includes which tag chip the board carries, see TagBackend.h.
+  // Later cycles of the same boot see what the earlier ones set.
+  const WarmStateBlock& saved = WarmState::get();
+  bool warm = WarmState::valid() && saved.sensorConfig == BoardSensor::ID &&
+              (saved.peripherals & WARM_PERIPH_SENSOR) &&
+              (saved.peripherals & (WARM_PERIPH_RF430 | WARM_PERIPH_NTAG5));
+
+#if defined(NFC_SENSE_SUPPLY_MONITOR)
+  // the cell at rest, before the sensor, tag and panel load it
+  Supply::update(firstCycle && (WarmState::resetCause() & (RESET_CAUSE_POWER_ON | RESET_CAUSE_BROWN_OUT)));
+#endif
+
+#if defined(BOARD_PIN_RAIL_GATE)
+  // sensor start-up runs while the tag is set up
+  Rail::acquire(RAIL_USERS);
+#endif
+
   Wire.begin();
+  I2cBus::begin();
+  I2cBus::beginSession(AWAKE_BUDGET_MS * 1000UL);
+#if defined(NFC_SENSE_CLOCK_SCALING)
+  // tag setup and the reading are bus transactions and the conversion
+  Clock::set(CLOCK_SLOW);
+#endif
 
   //enable interrupt 1
   // attachInterrupt(digitalPinToInterrupt(IRQ), nfcIntHandler, FALLING);
   
   // Try to initialize!
-  setupNFC();
+  uint8_t tag = TagBackend::setup(warm);
+  bool tagOk = tag != TAG_ABSENT;
+  bool tagIntact = tag == TAG_INTACT;
 
-  if (!tmp117.begin()) {
-    updateNFC(targetOS, "TMP117 not found. Aborting...");
+#if defined(SENSOR_BME280)
+  if (warm)
+    Bme280::setCalibration(saved.bmeCal);
+#endif
+  int16_t published;
+  bool wrote = false;
+#if defined(BOARD_PIN_RAIL_GATE)
+  // fresh from power-up: its first result or its reset state
+  Rail::settle(BoardSensor::POWER_UP_MS);
+  sensorOk = BoardThermometer::readFresh(warm, centiCelsius);
+#elif defined(NFC_SENSE_ALERT_WAKE)
+  // armed: the conversion that moved ALERT, or one at most a period old;
+  // a one-shot would end the sensor's own conversions
+  if (alertArmed) {
+    sensorOk = BoardThermometer::readLatest(centiCelsius);
+  } else {
+    sensorOk = (warm ? BoardThermometer::resume() : BoardThermometer::begin()) &&
+               BoardThermometer::read(centiCelsius) &&
+               BoardThermometer::armAlert(ALERT_HIGH_CENTI, ALERT_HIGH_CENTI - ALERT_HYSTERESIS_CENTI);
+  }
+  alertArmed = sensorOk;
+#else
+  sensorOk = warm ? BoardThermometer::resume() : BoardThermometer::begin();
+  sensorOk = sensorOk && BoardThermometer::read(centiCelsius);
+#endif
+#if defined(NFC_SENSE_CLOCK_SCALING)
+  // formatting, NDEF encoding and the panel (SPI runs from F_CPU settings)
+  Clock::set(CLOCK_FAST);
+#endif
+  if (!tagOk) {
+    // nothing to publish to, keep the reading for the next wake
+    WarmState::forgetPublished();
+  }
+  else if (!sensorOk) {
+    TagBackend::publish(targetOS, "Sensor not found. Aborting...");
+    WarmState::setPeripherals(TagBackend::warmFlag());
+    WarmState::forgetPublished();
+  }
+  else if (tagIntact && WarmState::lastPublished(published) && centiCelsius == published
+#if defined(NFC_SENSE_SUPPLY_MONITOR)
+           && Supply::state() == WarmState::publishedSupply()
+#endif
+          )
+  {
+    // tag still shows this reading, nothing to write
   }
   else
   {
 
-  sensors_event_t temp; // create an empty event to be filled
-  tmp117.getEvent(&temp); //fill the empty event object with the current measurements
+  char temp[8];
+  formatCentiCelsius(temp, centiCelsius);
    
   // Fahrenheit
-  // updateNFC(targetOS, "Temperature: " + String((temp.temperature * 9/5) + 32, 1) + " °F") ;
+  // formatCentiCelsius(temp, (int16_t)((int32_t)centiCelsius * 9 / 5 + 3200));
+  // TagBackend::publish(targetOS, "Temperature: " + String(temp) + " °F") ;
   
   // Celcius
-  updateNFC(targetOS, "Temperature: " + String(temp.temperature, 1) + " °C") ;
+  String text = "Temperature: " + String(temp) + " °C";
+#if defined(NFC_SENSE_ALERT_WAKE)
+  // the sensor's verdict, with its hysteresis
+  if (FieldWake::alertActive())
+    text += " ALARM";
+#endif
+#if defined(NFC_SENSE_SUPPLY_MONITOR)
+  text += Supply::label();
+  WarmState::setPublishedSupply(Supply::state());
+#endif
+  tagOk = TagBackend::publish(targetOS, text) ;
+  wrote = tagOk;
   
   // test
-  // updateNFC(targetOS, "http://ha:8123/api/webhook/nfc-temp-value?temp=" + String(temp.temperature, 1));
+  // TagBackend::publish(targetOS, "http://ha:8123/api/webhook/nfc-temp-value?temp=" + String(temp));
 
 
   // RF430CL330H_Shield nfc(IRQ, RESET);
   
   // nfc.begin();
   }
-  
 
-  // Before sleeping
- 
-  ADC0.CTRLA &= ~ADC_ENABLE_bm; // Very important on the tinyAVR 2-series
-  
-  set_sleep_mode(SLEEP_MODE_PWR_DOWN);
-  sleep_enable();
-  sleep_cpu();
+  if (sensorOk) {
+    WarmState::setPeripherals((tagOk ? TagBackend::warmFlag() : 0) | WARM_PERIPH_SENSOR);
+    WarmState::setSensorConfig(BoardSensor::ID);
+#if defined(SENSOR_BME280)
+    WarmState::setBmeCalibration(Bme280::cal);
+#endif
+    WarmState::setLastValue(centiCelsius);
+    if (!tagOk)
+      WarmState::forgetPublished();
+  }
+  WarmState::setTagLayout(tagOk ? 1 : 0);
+  I2cBus::endSession();
+#if defined(NFC_SENSE_DEBUG)
+  // the cycle's figures, Budget::run() reads the field in sessions of its own
+  uint32_t awakeUs = I2cBus::sessionMicros();
+  uint32_t boundUs = I2cBus::awakeBoundMicros();
+  I2cStats cycleStats = I2cBus::stats;
+  uint8_t cycleError = I2cBus::lastError;
+#endif
+
+#if defined(BOARD_PIN_STATUS_LED)
+ #if defined(NFC_SENSE_SUPPLY_MONITOR)
+  // the battery pattern while low, dark once critical
+  if (sensorOk && Supply::state() != SUPPLY_OK)
+    Indicator::show(Supply::state() == SUPPLY_LOW ? INDICATOR_LOW_BATTERY : INDICATOR_OFF);
+  else
+ #endif
+  Indicator::show(!sensorOk ? INDICATOR_SENSOR_FAULT : wrote ? INDICATOR_TAG_WRITTEN : INDICATOR_OFF);
+#endif
+
+#if defined(NFC_SENSE_SUPPLY_MONITOR) && defined(NFC_SENSE_FIELD_WAKE)
+  // fewer background refreshes as the cell runs down; a field still
+  // gets a fresh reading every time
+  FieldWake::setRefreshTicks(FIELD_WAKE_REFRESH_TICKS * Supply::stretch());
+#endif
+
+  Budget::run(CYCLE_TASKS, sizeof(CYCLE_TASKS) / sizeof(CYCLE_TASKS[0]));
+
+#if defined(BOARD_PIN_RAIL_GATE)
+  Display::powerDown();
+  Rail::release(RAIL_USERS);
+#endif
+
+#if defined(NFC_SENSE_DEBUG)
+  Serial.begin(115200);
+  Serial.print("awake us ");Serial.println(awakeUs);
+  Serial.print("bound us ");Serial.println(boundUs);
+  Serial.print("worst call us ");Serial.println(cycleStats.worstCallMicros);
+  Serial.print("retries ");Serial.println(cycleStats.retries);
+  Serial.print("failures ");Serial.println(cycleStats.failures);
+  Serial.print("last error ");Serial.println(cycleError);
+#if defined(NFC_SENSE_CLOCK_SCALING)
+  Serial.print("slow us ");Serial.println(Clock::slowMicros);
+#endif
+#if defined(NFC_SENSE_HARVEST_BOOT)
+  Serial.print("vout mV ");Serial.print(Budget::millivolts);
+  Serial.print(" shed ");Serial.print(Budget::shed);
+  Serial.print(" waits ");Serial.println(Budget::waits);
+#endif
+#if defined(NFC_SENSE_SUPPLY_MONITOR)
+  Serial.print("vdd mV ");Serial.print(Supply::millivolts());
+  Serial.print(" state ");Serial.print(Supply::state());
+  Serial.print(" measurements ");Serial.println(Supply::measurements);
+#endif
+  Serial.print("tag chip ");Serial.print(TagBackend::chip());
+  Serial.print(" probes ");Serial.println(TagBackend::probes);
+  if (TagBackend::chip() == TAG_NTAG5) {
+  Serial.print("tag blocks ");Serial.print(Ntag5::blocksWritten);
+  Serial.print(" skipped ");Serial.println(Ntag5::blocksSkipped);
+  Serial.print("tag cycles left ");Serial.println(Ntag5::remainingCycles());
+  }
+  Serial.flush();
+#endif
 
 }
 
@@ -128,6 +409,11 @@ void nfcIntHandler()
 
 void loop()
 { 
+#if defined(NFC_SENSE_FIELD_WAKE)
+  // power-down until a reader field or the background refresh
+  FieldWake::sleep();
+  wakeCycle();
+#endif
   /*
   Serial.println("loop");
   setupNFC();
@@ -61,6 +61,8 @@ void setup(){
   else
   {
 
+  // a part provisioned by nfc_sense powers up in shutdown: trigger the conversion
+  tmp117.setMeasurementMode(TMP117_MODE_ONE_SHOT);
   sensors_event_t temp; // create an empty event to be filled
   tmp117.getEvent(&temp); //fill the empty event object with the current measurements
 
@@ -82,8 +84,6 @@ void setup(){
   sleep_enable();
   sleep_cpu();
   */
-
-  tmp117.setMeasurementMode(TMP117_MODE_ONE_SHOT);
 }
 
 void loop(){
@@ -104,7 +104,8 @@ void loop(){
     // delay(5000);
 
     sensors_event_t temp; // create an empty event to be filled
-    tmp117.reset();
+    // one conversion; a reset() would reload the EEPROM image every time
+    tmp117.setMeasurementMode(TMP117_MODE_ONE_SHOT);
     tmp117.getEvent(&temp); //fill the empty event object with the current measurements
     // ntag.lockEepromToI2c();
     NdefMessage message = NdefMessage();
@@ -0,0 +1,282 @@
+#include "Iso15693Planner.h"
+
+static uint32_t nsToMicros(uint32_t ns)
+{
+    return (ns + 999) / 1000;
+}
+
+//  request on air, the part of a frame that passes before the tag acts on it
+static uint32_t requestAirMicros(const Iso15693Frame& frame, const Iso15693Timing& timing)
+{
+    return (timing.requestFramingNs + frame.requestLen * timing.requestByteNs) / 1000;
+}
+
+/**
+**  @brief  Appends a frame with flags, command, manufacturer code for the
+**          custom commands and the UID in addressed mode. The caller adds
+**          the parameters and finish()es it.
+**  @retrun Iso15693Frame*  0 if the plan is full
+**/
+Iso15693Frame* Iso15693Planner::add(Iso15693Plan& plan, uint8_t cmd, uint8_t options, const uint8_t* uid)
+{
+    if (plan.count >= ISO15693_MAX_FRAMES)
+        return 0;
+    Iso15693Frame* frame = &plan.frames[plan.count++];
+    memset(frame, 0, sizeof(*frame));
+    uint8_t n = 0;
+    frame->request[n++] = ISO15693_FLAG_HIGH_RATE | (options & ISO15693_PLAN_ADDRESSED ? ISO15693_FLAG_ADDRESS : 0);
+    frame->request[n++] = cmd;
+    if (cmd >= NTAG5_CMD_READ_CONFIG)
+        frame->request[n++] = NTAG5_MFG_CODE_NXP;
+    if (options & ISO15693_PLAN_ADDRESSED)
+    {
+        memcpy(frame->request + n, uid, ISO15693_UID_SIZE);
+        n += ISO15693_UID_SIZE;
+    }
+    frame->requestLen = n;
+    return frame;
+}
+
+/**
+**  @brief  CRC over the request, response size from the data it returns
+**/
+void Iso15693Planner::finish(Iso15693Frame& frame, uint16_t dataLen)
+{
+    uint16_t sum = crc(frame.request, frame.requestLen);
+    frame.request[frame.requestLen++] = sum & 0xFF;
+    frame.request[frame.requestLen++] = sum >> 8;
+    frame.responseLen = 1 + dataLen + ISO15693_CRC_SIZE;
+}
+
+//  Places a pending conversion wait. Frames that do not touch the result
+//  (pointer writes, status polls) run during the wait; the first one that
+//  does gets the rest of it in front, less its own request air time.
+static void overlap(Iso15693Plan& plan, uint32_t& pending, uint32_t& credit, bool independent,
+                    const Iso15693Timing& timing)
+{
+    if (!pending)
+        return;
+    Iso15693Frame& frame = plan.frames[plan.count - 1];
+    if (independent)
+    {
+        credit += Iso15693Planner::frameMicros(frame, timing);
+        return;
+    }
+    credit += requestAirMicros(frame, timing);
+    plan.frames[plan.count - 2].waitUs += pending > credit ? pending - credit : 0;
+    pending = 0;
+}
+
+/**
+**  @brief  Frames for one run of a Ntag5Master recipe
+**  @param  const uint8_t*  recipe      NTAG5_RECIPE_* or compatible
+**  @param  uint8_t         options     ISO15693_PLAN_*
+**  @param  const uint8_t*  uid         8 bytes, LSB first, for ISO15693_PLAN_ADDRESSED
+**  @param  Iso15693Timing  timing      to shorten waits by the air time spent in them
+**  @retrun bool    false if a write is too long or the plan does not fit
+**/
+bool Iso15693Planner::planRecipe(const uint8_t* recipe, uint8_t options, const uint8_t* uid,
+                                 const Iso15693Timing& timing, Iso15693Plan& plan)
+{
+    plan.count = 0;
+    plan.leadUs = 0;
+    bool naive = options & ISO15693_PLAN_NAIVE;
+    bool each = naive || (options & ISO15693_PLAN_CHECK_EACH);
+
+    Ntag5MasterOp op;
+    uint8_t reads = 0;
+    for (const uint8_t* p = recipe; (p = Ntag5Master::next(p, op));)
+        if (op.kind == NTAG5_OP_READ)
+            reads++;
+
+    uint32_t pending = 0, credit = 0;
+    while ((recipe = Ntag5Master::next(recipe, op)))
+    {
+        if (op.kind == NTAG5_OP_WAIT)
+        {
+            uint32_t us = op.len * 1000UL;
+            if (!plan.count)
+                plan.leadUs += us;
+            else if (naive)
+                plan.frames[plan.count - 1].waitUs += us;
+            else
+            {
+                if (!pending)
+                    credit = tailMicros(plan.frames[plan.count - 1], timing);
+                pending += us;
+            }
+            continue;
+        }
+
+        bool read = op.kind == NTAG5_OP_READ;
+        if (!read && op.len > ISO15693_MAX_WRITE)
+            return false;
+        Iso15693Frame* frame = add(plan, read ? NTAG5_CMD_READ_I2C : NTAG5_CMD_WRITE_I2C, options, uid);
+        if (!frame)
+            return false;
+        frame->request[frame->requestLen++] = op.addr;
+        frame->request[frame->requestLen++] = op.len - 1;
+        if (!read)
+        {
+            memcpy(frame->request + frame->requestLen, op.data, op.len);
+            frame->requestLen += op.len;
+        }
+        frame->i2cLen = op.len;
+        finish(*frame, 0);
+        overlap(plan, pending, credit, !naive && !read && op.len == 1, timing);
+
+        if (each || (read && !--reads))
+        {
+            frame = add(plan, NTAG5_CMD_READ_CONFIG, options, uid);
+            if (!frame)
+                return false;
+            frame->request[frame->requestLen++] = NTAG5_REG_I2C_MASTER_STATUS & 0xFF;
+            frame->request[frame->requestLen++] = 0;
+            frame->check = ISO15693_CHECK_MASTER_STATUS;
+            finish(*frame, NTAG5_BLOCK_SIZE);
+            overlap(plan, pending, credit, true, timing);
+        }
+        if (!read)
+            continue;
+
+        uint8_t blocks = (op.len + NTAG5_BLOCK_SIZE - 1) / NTAG5_BLOCK_SIZE;
+        uint8_t step = naive ? 1 : blocks;
+        for (uint8_t b = 0; b < blocks; b += step)
+        {
+            frame = add(plan, NTAG5_CMD_READ_SRAM, options, uid);
+            if (!frame)
+                return false;
+            frame->request[frame->requestLen++] = b;
+            frame->request[frame->requestLen++] = step - 1;
+            uint16_t left = op.len - b * NTAG5_BLOCK_SIZE;
+            frame->resultLen = left < step * NTAG5_BLOCK_SIZE ? left : step * NTAG5_BLOCK_SIZE;
+            finish(*frame, step * NTAG5_BLOCK_SIZE);
+        }
+    }
+    if (pending && plan.count)
+        plan.frames[plan.count - 1].waitUs += pending > credit ? pending - credit : 0;
+    return true;
+}
+
+/**
+**  @brief  Frames reading count EEPROM blocks from block, e.g. the NDEF
+**          message. maxBlocks is what the reader allows per command.
+**/
+bool Iso15693Planner::planRead(uint16_t block, uint16_t count, uint8_t maxBlocks, uint8_t options,
+                               const uint8_t* uid, Iso15693Plan& plan)
+{
+    plan.count = 0;
+    plan.leadUs = 0;
+    uint8_t step = options & ISO15693_PLAN_NAIVE ? 1 : maxBlocks;
+    if (step > 0xFF / NTAG5_BLOCK_SIZE)
+        step = 0xFF / NTAG5_BLOCK_SIZE;
+    if (!step)
+        return false;
+
+    while (count)
+    {
+        uint8_t n = count < step ? count : step;
+        bool extended = block + n > 0x100;
+        bool single = n == 1 && !extended && (options & ISO15693_PLAN_NAIVE);
+        Iso15693Frame* frame = add(plan, single ? ISO15693_CMD_READ_SINGLE :
+                                         extended ? ISO15693_CMD_EXT_READ_MULTIPLE : ISO15693_CMD_READ_MULTIPLE,
+                                   options, uid);
+        if (!frame)
+            return false;
+        frame->request[frame->requestLen++] = block & 0xFF;
+        if (extended)
+            frame->request[frame->requestLen++] = block >> 8;
+        if (!single)
+            frame->request[frame->requestLen++] = n - 1;
+        if (extended)
+            frame->request[frame->requestLen++] = 0;
+        frame->resultLen = n * NTAG5_BLOCK_SIZE;
+        finish(*frame, n * NTAG5_BLOCK_SIZE);
+        block += n;
+        count -= n;
+    }
+    return true;
+}
+
+/**
+**  @brief  Request on air and t1, up to where the tag starts its I2C transfer
+**/
+uint32_t Iso15693Planner::headMicros(const Iso15693Frame& frame, const Iso15693Timing& timing)
+{
+    return nsToMicros(timing.requestFramingNs + frame.requestLen * timing.requestByteNs + timing.t1Ns);
+}
+
+/**
+**  @brief  The tag's I2C transfer: start, address, data bytes, stop
+**/
+uint32_t Iso15693Planner::i2cMicros(const Iso15693Frame& frame, const Iso15693Timing& timing)
+{
+    if (!frame.i2cLen)
+        return 0;
+    uint32_t bits = 1 + 9 + 9UL * frame.i2cLen + 1;
+    return (bits * 1000000UL + timing.i2cHz - 1) / timing.i2cHz;
+}
+
+/**
+**  @brief  Response on air, t2 and the reader stack
+**/
+uint32_t Iso15693Planner::tailMicros(const Iso15693Frame& frame, const Iso15693Timing& timing)
+{
+    return nsToMicros(timing.responseFramingNs + frame.responseLen * timing.responseByteNs + timing.t2Ns) +
+           timing.hostUs;
+}
+
+uint32_t Iso15693Planner::frameMicros(const Iso15693Frame& frame, const Iso15693Timing& timing)
+{
+    return headMicros(frame, timing) + i2cMicros(frame, timing) + tailMicros(frame, timing);
+}
+
+/**
+**  @brief  Field on to the last response, waits included
+**/
+uint32_t Iso15693Planner::estimateMicros(const Iso15693Plan& plan, const Iso15693Timing& timing)
+{
+    uint32_t us = plan.leadUs;
+    for (uint8_t i = 0; i < plan.count; i++)
+        us += frameMicros(plan.frames[i], timing) + plan.frames[i].waitUs;
+    return us;
+}
+
+/**
+**  @brief  Checks a response and appends its result bytes
+**  @param  uint8_t*&   result  advanced past the bytes taken
+**  @retrun bool    false on a short or corrupt response, an error flag or
+**                  a master status other than OK
+**/
+bool Iso15693Planner::accept(const Iso15693Frame& frame, const uint8_t* response, uint16_t len,
+                             uint8_t*& result)
+{
+    if (len < 1 + ISO15693_CRC_SIZE || (response[0] & ISO15693_RESPONSE_ERROR))
+        return false;
+    uint16_t sum = crc(response, len - ISO15693_CRC_SIZE);
+    if (len != frame.responseLen || response[len - 2] != (sum & 0xFF) || response[len - 1] != sum >> 8)
+        return false;
+    const uint8_t* data = response + 1;
+    if (frame.check == ISO15693_CHECK_MASTER_STATUS &&
+        ((data[0] & NTAG5_I2C_M_BUSY) || (data[0] & NTAG5_I2C_M_TRANS_MASK) != NTAG5_I2C_M_TRANS_OK))
+        return false;
+    memcpy(result, data, frame.resultLen);
+    result += frame.resultLen;
+    return true;
+}
+
+/**
+**  @brief  CRC-16 of ISO/IEC 13239 as ISO 15693 uses it: reflected
+**          polynomial 0x8408, preset 0xFFFF, complemented. Sent LSB first.
+**/
+uint16_t Iso15693Planner::crc(const uint8_t* data, uint16_t len)
+{
+    uint16_t sum = 0xFFFF;
+    while (len--)
+    {
+        sum ^= *data++;
+        for (uint8_t bit = 0; bit < 8; bit++)
+            sum = sum & 1 ? (sum >> 1) ^ 0x8408 : sum >> 1;
+    }
+    return ~sum;
+}
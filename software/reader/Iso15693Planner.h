@@ -0,0 +1,129 @@
+//  ISO 15693 transaction planner for the MCU-less NTAG 5 boards
+//  -----------------------------------------
+//  Reader side (phone app, gateway) of Ntag5Master.h: turns a sensor recipe
+//  into the frames a reader sends and estimates how long the exchange
+//  takes. Every frame is a full round trip (request, t1, tag work,
+//  response, t2, plus whatever the reader's NFC stack adds), so the plan
+//  keeps their number down:
+//
+//   - non-addressed requests unless several tags share the field
+//   - one READ_SRAM for all blocks of a READ_I2C result
+//   - the I2C master status is read once, after the last READ_I2C. A
+//     missing VOUT or sensor NACKs every transfer, so that one poll sees
+//     it; ISO15693_PLAN_CHECK_EACH polls after every transfer.
+//   - a one-byte WRITE after a WAIT only moves the register pointer, it is
+//     sent while the conversion runs, and the wait is shortened by the
+//     air time already spent after the conversion started
+//   - consecutive waits coalesce
+//
+//  planRead() covers plain EEPROM reads (the NDEF message) with READ
+//  MULTIPLE BLOCKS, EXTENDED READ MULTIPLE BLOCKS beyond block 255.
+//
+//  ISO15693_PLAN_NAIVE gives the straightforward sequence for comparison:
+//  a status poll after every transfer, SRAM and EEPROM block by block,
+//  waits as written.
+//
+//  Host code; it links against Ntag5Master.cpp for the recipe decoder
+//  (host_sim builds both, its shim provides Arduino.h).
+
+#ifndef ISO15693_PLANNER_H_
+#define ISO15693_PLANNER_H_
+#if ARDUINO >= 100
+ #include "Arduino.h"
+#else
+ #include "WProgram.h"
+#endif
+#include "Ntag5Master.h"
+
+//ISO 15693 request flags and commands
+#define ISO15693_FLAG_HIGH_RATE         0x02
+#define ISO15693_FLAG_ADDRESS           0x20
+#define ISO15693_RESPONSE_ERROR         0x01
+#define ISO15693_CMD_READ_SINGLE        0x20
+#define ISO15693_CMD_READ_MULTIPLE      0x23
+#define ISO15693_CMD_EXT_READ_MULTIPLE  0x33
+#define ISO15693_UID_SIZE               8
+#define ISO15693_CRC_SIZE               2
+
+//planner options
+#define ISO15693_PLAN_ADDRESSED         0x01    // UID in every request
+#define ISO15693_PLAN_CHECK_EACH        0x02    // master status after every transfer
+#define ISO15693_PLAN_NAIVE             0x04    // one step per frame, no overlap
+
+#define ISO15693_MAX_FRAMES             40
+#define ISO15693_MAX_REQUEST            48
+#define ISO15693_MAX_WRITE              32      // WRITE op bytes in one WRITE_I2C
+
+//frame checks
+#define ISO15693_CHECK_NONE             0
+#define ISO15693_CHECK_MASTER_STATUS    1       // response data is NTAG5_REG_I2C_MASTER_STATUS
+
+struct Iso15693Timing
+{
+    uint32_t requestByteNs;     // reader to tag
+    uint32_t requestFramingNs;  // SOF + EOF
+    uint32_t responseByteNs;    // tag to reader
+    uint32_t responseFramingNs;
+    uint32_t t1Ns;              // request EOF to response SOF
+    uint32_t t2Ns;              // response EOF to the next request
+    uint32_t i2cHz;             // tag's I2C master clock
+    uint32_t hostUs;            // reader stack per command
+};
+
+//  1 out of 4 coding (8 bits of 37.76 us), high data rate single
+//  subcarrier response (fc/512, 37.76 us per bit; SOF and EOF 151.04 us
+//  each), 100 kHz master clock
+static const Iso15693Timing ISO15693_TIMING_FRONTEND = {
+    302080, 113280, 302080, 302080, 320900, 309200, 100000, 0
+};
+
+//  Same on air behind a phone's NFC API. The per command overhead is an
+//  assumption, it varies from phone to phone; measure it for a real budget.
+static const Iso15693Timing ISO15693_TIMING_PHONE = {
+    302080, 113280, 302080, 302080, 320900, 309200, 100000, 4000
+};
+
+struct Iso15693Frame
+{
+    uint8_t  request[ISO15693_MAX_REQUEST];     // CRC included
+    uint8_t  requestLen;
+    uint16_t responseLen;       // flags, data and CRC
+    uint16_t i2cLen;            // bytes the tag moves as I2C master before it answers
+    uint8_t  resultLen;         // leading response data bytes that are recipe result
+    uint8_t  check;             // ISO15693_CHECK_*
+    uint32_t waitUs;            // reader idles this long after the response
+};
+
+struct Iso15693Plan
+{
+    Iso15693Frame frames[ISO15693_MAX_FRAMES];
+    uint8_t  count;
+    uint32_t leadUs;            // field on to the first request
+};
+
+class Iso15693Planner
+{
+public:
+    static bool planRecipe(const uint8_t* recipe, uint8_t options, const uint8_t* uid,
+                           const Iso15693Timing& timing, Iso15693Plan& plan);
+    static bool planRead(uint16_t block, uint16_t count, uint8_t maxBlocks, uint8_t options,
+                         const uint8_t* uid, Iso15693Plan& plan);
+
+    // latency
+    static uint32_t headMicros(const Iso15693Frame& frame, const Iso15693Timing& timing);
+    static uint32_t i2cMicros(const Iso15693Frame& frame, const Iso15693Timing& timing);
+    static uint32_t tailMicros(const Iso15693Frame& frame, const Iso15693Timing& timing);
+    static uint32_t frameMicros(const Iso15693Frame& frame, const Iso15693Timing& timing);
+    static uint32_t estimateMicros(const Iso15693Plan& plan, const Iso15693Timing& timing);
+
+    // responses
+    static bool accept(const Iso15693Frame& frame, const uint8_t* response, uint16_t len,
+                       uint8_t*& result);
+    static uint16_t crc(const uint8_t* data, uint16_t len);
+
+private:
+    static Iso15693Frame* add(Iso15693Plan& plan, uint8_t cmd, uint8_t options, const uint8_t* uid);
+    static void finish(Iso15693Frame& frame, uint16_t dataLen);
+};
+
+#endif /* ISO15693_PLANNER_H_ */